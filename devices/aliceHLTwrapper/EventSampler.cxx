@@ -18,6 +18,7 @@
 #include "EventSampler.h"
 #include "FairMQLogger.h"
 #include "FairMQPoller.h"
+#include "Placement.h"
 #include "AliHLTDataTypes.h"
 
 #include <boost/thread.hpp>
@@ -65,6 +66,7 @@ void EventSampler::Run()
   int iResult=0;
 
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
+  AliceO2::Devices::Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
   boost::thread samplerThread(boost::bind(&EventSampler::samplerLoop, this));
 
   FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
@@ -19,6 +19,9 @@
 #include "Component.h"
 #include "FairMQLogger.h"
 #include "FairMQPoller.h"
+#include "Metrics.h"
+#include "Placement.h"
+#include "EventLoop.h"
 
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
@@ -45,6 +48,7 @@ WrapperDevice::WrapperDevice(int argc, char** argv, int verbosity)
   : mComponent(NULL)
   , mArgv()
   , mPollingPeriod(10)
+  , mMaxSpinInUs(50)
   , mSkipProcessing(0)
   , mLastCalcTime(-1)
   , mLastSampleTime(-1)
@@ -54,6 +58,10 @@ WrapperDevice::WrapperDevice(int argc, char** argv, int verbosity)
   , mMaxReadCycles(-1)
   , mNSamples(-1)
   , mVerbosity(verbosity)
+  , mSamplesMetric(NULL)
+  , mReadCyclesMetric(NULL)
+  , mSampleIntervalMetric(NULL)
+  , mProcessingTimeMetric(NULL)
 {
   mArgv.insert(mArgv.end(), argv, argv+argc);
 }
@@ -94,6 +102,13 @@ void WrapperDevice::Init()
   mMaxReadCycles=-1;
   mNSamples=0;
 
+  AliceO2::Metrics::Registry& metrics=AliceO2::Metrics::Registry::Default();
+  string label=AliceO2::Metrics::DeviceLabel(id);
+  mSamplesMetric=&metrics.AddCounter("o2_hlt_samples_total", "Samples processed by the HLT component", label);
+  mReadCyclesMetric=&metrics.AddHistogram("o2_hlt_read_cycles", "Read cycles until all inputs of a sample arrived", label);
+  mSampleIntervalMetric=&metrics.AddHistogram("o2_hlt_sample_interval_us", "Time between two complete samples", label);
+  mProcessingTimeMetric=&metrics.AddHistogram("o2_hlt_processing_time_us", "Processing time of the HLT component per sample", label);
+
   FairMQDevice::Init();
 }
 
@@ -104,10 +119,15 @@ void WrapperDevice::Run()
 
 #ifdef USE_CHRONO
   static system_clock::time_point refTime = system_clock::now();
+  std::chrono::steady_clock::time_point lastSample;
 #endif // USE_CHRONO
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
+  AliceO2::Devices::Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
 
   FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
+  // spins while samples come in quickly, otherwise waits up to the polling period
+  AliceO2::Devices::EventLoop loop;
+  loop.Init(poller, fNumInputs, NULL, mMaxSpinInUs, mPollingPeriod, fId);
 
   bool received = false;
 
@@ -126,7 +146,7 @@ void WrapperDevice::Run()
   while (fState == RUNNING) {
 
     // read input messages
-    poller->Poll(mPollingPeriod);
+    loop.Wait();
     int inputsReceived=0;
     bool receivedAtLeastOneMessage=false;
     for(int i = 0; i < fNumInputs; i++) {
@@ -165,6 +185,8 @@ void WrapperDevice::Run()
     }
     mNSamples++;
     mTotalReadCycles+=nReadCycles;
+    mSamplesMetric->Increment();
+    mReadCyclesMetric->Observe(nReadCycles);
     if (mMaxReadCycles<0 || mMaxReadCycles<nReadCycles)
       mMaxReadCycles=nReadCycles;
     // if (nReadCycles>1) {
@@ -172,6 +194,11 @@ void WrapperDevice::Run()
     // }
     nReadCycles=0;
 #ifdef USE_CHRONO
+    std::chrono::steady_clock::time_point sampleTime=std::chrono::steady_clock::now();
+    if (lastSample!=std::chrono::steady_clock::time_point())
+      mSampleIntervalMetric->Observe(std::chrono::duration_cast<std::chrono::microseconds>(sampleTime-lastSample).count());
+    lastSample=sampleTime;
+
     auto duration = std::chrono::duration_cast<TimeScale>(std::chrono::system_clock::now() - refTime);
 
     if (mLastSampleTime>=0) {
@@ -210,9 +237,15 @@ void WrapperDevice::Run()
       }
 
       // call the component
+#ifdef USE_CHRONO
+      std::chrono::steady_clock::time_point processingStart=std::chrono::steady_clock::now();
+#endif // USE_CHRONO
       if ((iResult=mComponent->process(dataArray))<0) {
 	LOG(ERROR) << "component processing failed with error code " << iResult;
       }
+#ifdef USE_CHRONO
+      mProcessingTimeMetric->Observe(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-processingStart).count());
+#endif // USE_CHRONO
 
       // build messages from output data
       if (dataArray.size() > 0) {
@@ -270,6 +303,8 @@ void WrapperDevice::Run()
     }
   }
 
+  loop.LogStatistics();
+
   delete poller;
 
   rateLogger.interrupt();
@@ -339,6 +374,9 @@ void WrapperDevice::SetProperty(const int key, const int value, const int slot)
   case SkipProcessing:
     mSkipProcessing = value;
     return;
+  case MaxSpinInUs:
+    mMaxSpinInUs = value;
+    return;
   }
   return FairMQDevice::SetProperty(key, value, slot);
 }
@@ -352,6 +390,8 @@ int WrapperDevice::GetProperty(const int key, const int default_, const int slot
     return mPollingPeriod;
   case SkipProcessing:
     return mSkipProcessing;
+  case MaxSpinInUs:
+    return mMaxSpinInUs;
   }
   return FairMQDevice::GetProperty(key, default_, slot);
 }
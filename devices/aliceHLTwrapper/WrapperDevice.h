@@ -22,6 +22,13 @@
 #include "FairMQDevice.h"
 #include <vector>
 
+namespace AliceO2 {
+namespace Metrics {
+class Counter;
+class Histogram;
+}
+}
+
 namespace ALICE {
 namespace HLT {
 class Component;
@@ -70,7 +77,7 @@ public:
 
   /////////////////////////////////////////////////////////////////
   // device property identifier
-  enum { Id = FairMQDevice::Last, PollingPeriod, SkipProcessing, Last };
+  enum { Id = FairMQDevice::Last, PollingPeriod, SkipProcessing, MaxSpinInUs, Last };
 
 protected:
 
@@ -83,7 +90,8 @@ private:
   Component* mComponent;     // component instance
   vector<char*> mArgv;       // array of arguments for the component
 
-  int mPollingPeriod;        // period of polling on input sockets in ms
+  int mPollingPeriod;        // longest blocking wait for input in ms
+  int mMaxSpinInUs;          // longest polling without blocking after input in us
   int mSkipProcessing;       // skip component processing
   int mLastCalcTime;         // start time of current statistic period
   int mLastSampleTime;       // time of last data sample
@@ -93,6 +101,11 @@ private:
   int mMaxReadCycles;        // max number of read cycles in statistic period
   int mNSamples;             // number of samples in statistic period
   int mVerbosity;            // verbosity level
+
+  AliceO2::Metrics::Counter* mSamplesMetric;            // processed samples
+  AliceO2::Metrics::Histogram* mReadCyclesMetric;       // read cycles per sample
+  AliceO2::Metrics::Histogram* mSampleIntervalMetric;   // time between samples in us
+  AliceO2::Metrics::Histogram* mProcessingTimeMetric;   // component processing time in us
 };
 
 } // namespace hlt
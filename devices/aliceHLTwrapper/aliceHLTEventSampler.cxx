@@ -27,6 +27,8 @@
 #include "FairMQTransportFactoryNN.h"
 #endif
 #include "FairMQTransportFactoryZMQ.h"
+#include "ShmTransportFactory.h"
+#include "Placement.h"
 #include "FairMQTools.h"
 
 #include "FairMQStateMachine.h"
@@ -161,6 +163,13 @@ int main(int argc, char** argv)
   vector<SocketProperties_t> outputSockets;
   std::string outputFile="";
   const char* factoryType = "zmq";
+  std::string shmSegment = "o2payload";
+  int shmSizeInMB = 1024;
+  bool shmAllLocal = false;
+  std::string cpusMain;
+  std::string cpusIo;
+  std::string cpusHelper;
+  std::string numaNode;
   int verbosity = -1;
   int deviceLogInterval = 10000;
   int pollingTimeout = -1;
@@ -173,7 +182,14 @@ int main(int argc, char** argv)
     { "input",       required_argument, 0, 'i' }, // input socket
     { "output",      required_argument, 0, 'o' }, // output socket
     { "latency-log", required_argument, 0, 'l' }, // output file name for logging of latency
-    { "factory-type",required_argument, 0, '4' }, // type of the factory "zmq", "nanomsg"
+    { "factory-type",required_argument, 0, '4' }, // type of the factory "zmq", "nanomsg", "shmem"
+    { "shm-segment", required_argument, 0, '6' }, // name of the shared memory segment
+    { "shm-size",    required_argument, 0, '7' }, // size of the shared memory segment in MB
+    { "shm-all-local", no_argument    , 0, '8' }, // all peers are on this node
+    { "cpus-main",   required_argument, 0, 'C' }, // CPUs of the device threads
+    { "cpus-io",     required_argument, 0, 'I' }, // CPUs of the transport I/O threads
+    { "cpus-helper", required_argument, 0, 'H' }, // CPUs of the helper threads
+    { "numa-node",   required_argument, 0, 'N' }, // NUMA node, or network interface, for the payload memory
     { "verbosity",   required_argument, 0, 'v' }, // verbosity
     { "loginterval", required_argument, 0, '5' }, // logging interval
     { "polltimeout", required_argument, 0, '1' }, // polling timeout of the device in ms
@@ -252,6 +268,27 @@ int main(int argc, char** argv)
       case '4':
         factoryType = optarg;
         break;
+      case '6':
+        shmSegment = optarg;
+        break;
+      case '7':
+        std::stringstream(optarg) >> shmSizeInMB;
+        break;
+      case '8':
+        shmAllLocal = true;
+        break;
+      case 'C':
+        cpusMain = optarg;
+        break;
+      case 'I':
+        cpusIo = optarg;
+        break;
+      case 'H':
+        cpusHelper = optarg;
+        break;
+      case 'N':
+        numaNode = optarg;
+        break;
       case 'v':
         std::stringstream(optarg) >> std::hex >> verbosity;
         break;
@@ -324,7 +361,14 @@ int main(int argc, char** argv)
     cout << "Usage : " << argv[0] << " ID numIoThreads [--factory type] [--input|--output "
                                      "type=value,size=value,method=value,address=value]" << endl;
     cout << "        The first two arguments are in fixed order, followed by optional arguments: " << endl;
-    cout << "        --factory-type,-t nanomsg|zmq" << endl;
+    cout << "        --factory-type,-t nanomsg|zmq|shmem" << endl;
+    cout << "        --shm-segment                name of the shared memory segment (shmem)" << endl;
+    cout << "        --shm-size                   size_in_MB of the shared memory segment (shmem)" << endl;
+    cout << "        --shm-all-local              treat all peers as on this node (shmem)" << endl;
+    cout << "        --cpus-main                  cpu_list of the device threads, e.g. 0-7,16, or node" << endl;
+    cout << "        --cpus-io                    cpu_list of the I/O threads of the transport" << endl;
+    cout << "        --cpus-helper                cpu_list of the helper threads" << endl;
+    cout << "        --numa-node                  node|interface for the payload memory" << endl;
     cout << "        --rate,-r                    rate_in_us" << endl;
     cout << "        --poll-period,-p             period_in_ms" << endl;
     cout << "        --loginterval,-l             period_in_ms" << endl;
@@ -337,6 +381,11 @@ int main(int argc, char** argv)
     return 0;
   }
 
+  AliceO2::Devices::Placement& placement = AliceO2::Devices::Placement::Default();
+  if (!placement.Configure(cpusMain, cpusIo, cpusHelper, numaNode)) {
+    return -EINVAL;
+  }
+
   FairMQTransportFactory* transportFactory = NULL;
   if (strcmp(factoryType, "nanomsg") == 0) {
 #ifdef NANOMSG
@@ -347,6 +396,10 @@ int main(int argc, char** argv)
 #endif
   } else if (strcmp(factoryType, "zmq") == 0) {
     transportFactory = new FairMQTransportFactoryZMQ();
+  } else if (strcmp(factoryType, "shmem") == 0) {
+    // payloads in shared memory, handles and everything for other nodes over zmq
+    transportFactory = new AliceO2::Shmem::TransportFactory(new FairMQTransportFactoryZMQ(), shmSegment,
+                                                            static_cast<size_t>(shmSizeInMB) << 20, shmAllLocal);
   } else {
     cerr << "invalid factory type: " << factoryType << endl;
     return -ENODEV;
@@ -398,6 +451,8 @@ int main(int argc, char** argv)
       device.SetProperty(FairMQDevice::OutputAddress, outputSockets[iOutput].address.c_str(), iOutput);
     }
 
+    // the transport starts its I/O threads with the first socket, they inherit the CPUs of this thread.
+    placement.EnterIoScope();
     device.ChangeState(FairMQDevice::SETOUTPUT);
     device.ChangeState(FairMQDevice::SETINPUT);
 #if defined(HAVE_FAIRMQ_INTERFACE_CHANGESTATE_STRING)
@@ -434,7 +489,9 @@ int main(int argc, char** argv)
     }
     device.ChangeState(FairMQDevice::CONNECT);
 #endif
+    placement.EnterMainScope();
     device.ChangeState(FairMQDevice::RUN);
+    placement.Report();
 
     boost::unique_lock<boost::mutex> lock(device.fRunningMutex);
     while (!device.fRunningFinished) {
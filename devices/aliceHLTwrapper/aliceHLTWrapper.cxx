@@ -16,6 +16,7 @@
 //  @brief  FairRoot/ALFA device running ALICE HLT code
 
 #include "WrapperDevice.h"
+#include "MetricsExporter.h"
 #include <iostream>
 #include <csignal>
 #include <getopt.h>
@@ -27,6 +28,8 @@
 #include "FairMQTransportFactoryNN.h"
 #endif
 #include "FairMQTransportFactoryZMQ.h"
+#include "ShmTransportFactory.h"
+#include "Placement.h"
 #include "FairMQTools.h"
 
 #include "FairMQStateMachine.h"
@@ -83,6 +86,7 @@ struct SocketProperties_t {
 };
 
 FairMQDevice* gDevice = NULL;
+AliceO2::Metrics::Exporter gMetricsExporter;
 static void s_signal_handler(int signal)
 {
   cout << endl << "Caught signal " << signal << endl;
@@ -160,21 +164,43 @@ int main(int argc, char** argv)
   vector<SocketProperties_t> inputSockets;
   vector<SocketProperties_t> outputSockets;
   const char* factoryType = "zmq";
+  std::string shmSegment = "o2payload";
+  int shmSizeInMB = 1024;
+  bool shmAllLocal = false;
+  std::string cpusMain;
+  std::string cpusIo;
+  std::string cpusHelper;
+  std::string numaNode;
   int verbosity = -1;
   int deviceLogInterval = 10000;
   int pollingPeriod = -1;
+  int maxSpin = -1;
   int skipProcessing = 0;
   bool bUseDDS = false;
+  std::string metricsTarget;
+  std::string metricsFormat = "prometheus";
+  int metricsInterval = 1000;
 
   static struct option programOptions[] = {
     { "input",       required_argument, 0, 'i' }, // input socket
     { "output",      required_argument, 0, 'o' }, // output socket
-    { "factory-type",required_argument, 0, 'f' }, // type of the factory "zmq", "nanomsg"
+    { "factory-type",required_argument, 0, 'f' }, // type of the factory "zmq", "nanomsg", "shmem"
+    { "shm-segment", required_argument, 0, 'S' }, // name of the shared memory segment
+    { "shm-size",    required_argument, 0, 'Z' }, // size of the shared memory segment in MB
+    { "shm-all-local", no_argument    , 0, 'L' }, // all peers are on this node
+    { "cpus-main",   required_argument, 0, 'C' }, // CPUs of the device threads
+    { "cpus-io",     required_argument, 0, 'I' }, // CPUs of the transport I/O threads
+    { "cpus-helper", required_argument, 0, 'H' }, // CPUs of the helper threads
+    { "numa-node",   required_argument, 0, 'N' }, // NUMA node, or network interface, for the payload memory
     { "verbosity",   required_argument, 0, 'v' }, // verbosity
     { "loginterval", required_argument, 0, 'l' }, // logging interval
     { "poll-period", required_argument, 0, 'p' }, // polling period of the device in ms
+    { "max-spin",    required_argument, 0, 's' }, // time the device polls without blocking after input, in us
     { "dry-run",     no_argument      , 0, 'n' }, // skip the component processing
     { "dds",         no_argument      , 0, 'd' }, // run in dds mode
+    { "metrics",     required_argument, 0, 'm' }, // metrics file, or tcp://*:port to serve them
+    { "metrics-format", required_argument, 0, 'M' }, // "prometheus", "json"
+    { "metrics-interval", required_argument, 0, 'T' }, // metrics file update interval in ms
     { 0, 0, 0, 0 }
   };
 
@@ -244,6 +270,27 @@ int main(int argc, char** argv)
       case 'f':
         factoryType = optarg;
         break;
+      case 'S':
+        shmSegment = optarg;
+        break;
+      case 'Z':
+        std::stringstream(optarg) >> shmSizeInMB;
+        break;
+      case 'L':
+        shmAllLocal = true;
+        break;
+      case 'C':
+        cpusMain = optarg;
+        break;
+      case 'I':
+        cpusIo = optarg;
+        break;
+      case 'H':
+        cpusHelper = optarg;
+        break;
+      case 'N':
+        numaNode = optarg;
+        break;
       case 'v':
         std::stringstream(optarg) >> std::hex >> verbosity;
         break;
@@ -253,12 +300,24 @@ int main(int argc, char** argv)
       case 'p':
         std::stringstream(optarg) >> pollingPeriod;
         break;
+      case 's':
+        std::stringstream(optarg) >> maxSpin;
+        break;
       case 'n':
         skipProcessing = 1;
         break;
       case 'd':
         bUseDDS = true;
         break;
+      case 'm':
+        metricsTarget = optarg;
+        break;
+      case 'M':
+        metricsFormat = optarg;
+        break;
+      case 'T':
+        std::stringstream(optarg) >> metricsInterval;
+        break;
       case '?': // all remaining arguments passed to the device instance
         iDeviceArg = optind - 1;
         break;
@@ -313,11 +372,22 @@ int main(int argc, char** argv)
     cout << "Usage : " << argv[0] << " ID numIoThreads [--factory type] [--input|--output "
                                      "type=value,size=value,method=value,address=value] componentArguments" << endl;
     cout << "        The first two arguments are in fixed order, followed by optional arguments: " << endl;
-    cout << "        --factory-type,-t nanomsg|zmq" << endl;
+    cout << "        --factory-type,-t nanomsg|zmq|shmem" << endl;
+    cout << "        --shm-segment                name of the shared memory segment (shmem)" << endl;
+    cout << "        --shm-size                   size_in_MB of the shared memory segment (shmem)" << endl;
+    cout << "        --shm-all-local              treat all peers as on this node (shmem)" << endl;
+    cout << "        --cpus-main                  cpu_list of the device threads, e.g. 0-7,16, or node" << endl;
+    cout << "        --cpus-io                    cpu_list of the I/O threads of the transport" << endl;
+    cout << "        --cpus-helper                cpu_list of the helper threads" << endl;
+    cout << "        --numa-node                  node|interface for the payload memory" << endl;
     cout << "        --poll-period,-p             period_in_ms" << endl;
+    cout << "        --max-spin,-s                time_in_us of polling without blocking after input, 0 always blocks" << endl;
     cout << "        --loginterval,-l             period_in_ms" << endl;
     cout << "        --verbosity,-v 0xhexval      verbosity level" << endl;
     cout << "        --dry-run,-n                 skip the component processing" << endl;
+    cout << "        --metrics,-m                 file|tcp://*:port" << endl;
+    cout << "        --metrics-format,-M          prometheus|json" << endl;
+    cout << "        --metrics-interval,-T        period_in_ms" << endl;
     cout << "        Multiple slots can be defined by --input/--output options" << endl;
     cout << "        HLT component arguments at the end of the list" << endl;
     cout << "        --library,-l     componentLibrary" << endl;
@@ -328,6 +398,11 @@ int main(int argc, char** argv)
     return 0;
   }
 
+  AliceO2::Devices::Placement& placement = AliceO2::Devices::Placement::Default();
+  if (!placement.Configure(cpusMain, cpusIo, cpusHelper, numaNode)) {
+    return -EINVAL;
+  }
+
   FairMQTransportFactory* transportFactory = NULL;
   if (strcmp(factoryType, "nanomsg") == 0) {
 #ifdef NANOMSG
@@ -338,6 +413,10 @@ int main(int argc, char** argv)
 #endif
   } else if (strcmp(factoryType, "zmq") == 0) {
     transportFactory = new FairMQTransportFactoryZMQ();
+  } else if (strcmp(factoryType, "shmem") == 0) {
+    // payloads in shared memory, handles and everything for other nodes over zmq
+    transportFactory = new AliceO2::Shmem::TransportFactory(new FairMQTransportFactoryZMQ(), shmSegment,
+                                                            static_cast<size_t>(shmSizeInMB) << 20, shmAllLocal);
   } else {
     cerr << "invalid factory type: " << factoryType << endl;
     return -ENODEV;
@@ -354,6 +433,18 @@ int main(int argc, char** argv)
     // above "Info"
   }
 
+  AliceO2::Metrics::Exporter::Format format;
+  if (!AliceO2::Metrics::Exporter::ParseFormat(metricsFormat, format)) {
+    cerr << "invalid metrics format: " << metricsFormat << endl;
+    return -EINVAL;
+  }
+  placement.EnterHelperScope();
+  bool metricsStarted = gMetricsExporter.Start(metricsTarget, format, metricsInterval);
+  placement.EnterMainScope();
+  if (!metricsStarted) {
+    return -EINVAL;
+  }
+
   vector<char*> deviceArgs;
   deviceArgs.push_back(argv[0]);
   if (iDeviceArg > 0) deviceArgs.insert(deviceArgs.end(), argv + iDeviceArg, argv + argc);
@@ -375,6 +466,7 @@ int main(int argc, char** argv)
     device.SetProperty(FairMQDevice::NumOutputs, numOutputs);
     device.SetProperty(FairMQDevice::LogIntervalInMs, deviceLogInterval);
     if (pollingPeriod > 0) device.SetProperty(ALICE::HLT::WrapperDevice::PollingPeriod, pollingPeriod);
+    if (maxSpin >= 0) device.SetProperty(ALICE::HLT::WrapperDevice::MaxSpinInUs, maxSpin);
     if (skipProcessing) device.SetProperty(ALICE::HLT::WrapperDevice::SkipProcessing, skipProcessing);
     device.ChangeState(FairMQDevice::INIT);
     for (unsigned iInput = 0; iInput < numInputs; iInput++) {
@@ -397,6 +489,8 @@ int main(int argc, char** argv)
       device.SetProperty(FairMQDevice::OutputAddress, outputSockets[iOutput].address.c_str(), iOutput);
     }
 
+    // the transport starts its I/O threads with the first socket, they inherit the CPUs of this thread.
+    placement.EnterIoScope();
     device.ChangeState(FairMQDevice::SETOUTPUT);
     device.ChangeState(FairMQDevice::SETINPUT);
 #if defined(HAVE_FAIRMQ_INTERFACE_CHANGESTATE_STRING)
@@ -433,7 +527,9 @@ int main(int argc, char** argv)
     }
     device.ChangeState(FairMQDevice::CONNECT);
 #endif
+    placement.EnterMainScope();
     device.ChangeState(FairMQDevice::RUN);
+    placement.Report();
 
     boost::unique_lock<boost::mutex> lock(device.fRunningMutex);
     while (!device.fRunningFinished) {
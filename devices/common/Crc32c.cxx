@@ -0,0 +1,276 @@
+/**
+ * Crc32c.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <cstring>
+
+#include "Crc32c.h"
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define O2_CRC32C_HARDWARE 1
+#define O2_CRC32C_TARGET __attribute__((target("sse4.2")))
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define O2_CRC32C_HARDWARE 1
+#define O2_CRC32C_TARGET
+#endif
+
+using namespace std;
+
+namespace AliceO2 {
+namespace Devices {
+
+namespace {
+
+const uint32_t kPolynomial = 0x82f63b78; // reflected
+
+// bytes per stream of the interleaved hardware loop: the long blocks amortise the
+// combination, the short ones keep the interleaving for the rest of a large buffer.
+const size_t kLongBlock = 8192;
+const size_t kShortBlock = 256;
+
+inline uint64_t load64(const unsigned char* p)
+{
+  uint64_t word;
+  memcpy(&word, p, sizeof(word));
+  return word;
+}
+
+/// product of a 32x32 matrix over GF(2) with a vector
+uint32_t multiply(const uint32_t* matrix, uint32_t vector)
+{
+  uint32_t sum = 0;
+  for (; vector != 0; vector >>= 1, ++matrix) {
+    if (vector & 1) {
+      sum ^= *matrix;
+    }
+  }
+  return sum;
+}
+
+void square(uint32_t* result, const uint32_t* matrix)
+{
+  for (int n = 0; n < 32; ++n) {
+    result[n] = multiply(matrix, matrix[n]);
+  }
+}
+
+struct Tables
+{
+  uint32_t slicing[8][256];
+  uint32_t shiftLong[4][256];  // appends kLongBlock zero bytes to a CRC
+  uint32_t shiftShort[4][256]; // appends kShortBlock zero bytes
+
+  Tables()
+  {
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t crc = n;
+      for (int k = 0; k < 8; ++k) {
+        crc = crc & 1 ? (crc >> 1) ^ kPolynomial : crc >> 1;
+      }
+      slicing[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; ++n) {
+      for (int k = 1; k < 8; ++k) {
+        slicing[k][n] = (slicing[k - 1][n] >> 8) ^ slicing[0][slicing[k - 1][n] & 0xff];
+      }
+    }
+
+    buildShift(shiftLong, kLongBlock);
+    buildShift(shiftShort, kShortBlock);
+  }
+
+  /// tables of the operator that appends length zero bytes (a power of two), one per byte of the CRC
+  static void buildShift(uint32_t table[4][256], size_t length)
+  {
+    uint32_t odd[32];
+    uint32_t even[32];
+
+    // one zero bit, then squared into two and four
+    odd[0] = kPolynomial;
+    for (int n = 1; n < 32; ++n) {
+      odd[n] = 1u << (n - 1);
+    }
+    square(even, odd);
+    square(odd, even);
+
+    // each square doubles the zeros, from one byte on
+    const uint32_t* op = odd;
+    do {
+      square(even, odd);
+      op = even;
+      length >>= 1;
+      if (length == 0) {
+        break;
+      }
+      square(odd, even);
+      op = odd;
+      length >>= 1;
+    } while (length != 0);
+
+    for (uint32_t n = 0; n < 256; ++n) {
+      table[0][n] = multiply(op, n);
+      table[1][n] = multiply(op, n << 8);
+      table[2][n] = multiply(op, n << 16);
+      table[3][n] = multiply(op, n << 24);
+    }
+  }
+};
+
+const Tables& tables()
+{
+  static const Tables t;
+  return t;
+}
+
+inline uint32_t shift(const uint32_t table[4][256], uint32_t crc)
+{
+  return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^ table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+}
+
+#ifdef O2_CRC32C_HARDWARE
+
+#if defined(__x86_64__)
+inline O2_CRC32C_TARGET uint64_t crcWord(uint64_t crc, uint64_t word) { return _mm_crc32_u64(crc, word); }
+inline O2_CRC32C_TARGET uint32_t crcByte(uint32_t crc, unsigned char byte) { return _mm_crc32_u8(crc, byte); }
+#else
+inline uint64_t crcWord(uint64_t crc, uint64_t word) { return __crc32cd(static_cast<uint32_t>(crc), word); }
+inline uint32_t crcByte(uint32_t crc, unsigned char byte) { return __crc32cb(crc, byte); }
+#endif
+
+/// three streams of block bytes each, combined into crc0
+template<size_t block>
+inline O2_CRC32C_TARGET void interleave(uint64_t& crc0, const unsigned char*& next, size_t& size, const uint32_t table[4][256])
+{
+  while (size >= 3 * block) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    const unsigned char* end = next + block;
+    do {
+      crc0 = crcWord(crc0, load64(next));
+      crc1 = crcWord(crc1, load64(next + block));
+      crc2 = crcWord(crc2, load64(next + 2 * block));
+      next += 8;
+    } while (next < end);
+    crc0 = shift(table, static_cast<uint32_t>(crc0)) ^ crc1;
+    crc0 = shift(table, static_cast<uint32_t>(crc0)) ^ crc2;
+    next += 2 * block;
+    size -= 3 * block;
+  }
+}
+
+O2_CRC32C_TARGET uint32_t crc32cHardware(const void* data, size_t size, uint32_t crc)
+{
+  const Tables& t = tables();
+  const unsigned char* next = static_cast<const unsigned char*>(data);
+  uint64_t crc0 = crc ^ 0xffffffff;
+
+  while (size > 0 && (reinterpret_cast<uintptr_t>(next) & 7) != 0) {
+    crc0 = crcByte(static_cast<uint32_t>(crc0), *next++);
+    --size;
+  }
+
+  interleave<kLongBlock>(crc0, next, size, t.shiftLong);
+  interleave<kShortBlock>(crc0, next, size, t.shiftShort);
+
+  const unsigned char* end = next + (size & ~static_cast<size_t>(7));
+  while (next < end) {
+    crc0 = crcWord(crc0, load64(next));
+    next += 8;
+  }
+  size &= 7;
+  while (size > 0) {
+    crc0 = crcByte(static_cast<uint32_t>(crc0), *next++);
+    --size;
+  }
+
+  return static_cast<uint32_t>(crc0) ^ 0xffffffff;
+}
+
+#endif
+
+bool detectHardware()
+{
+#if defined(__x86_64__)
+  return __builtin_cpu_supports("sse4.2");
+#elif defined(O2_CRC32C_HARDWARE)
+  return true;
+#else
+  return false;
+#endif
+}
+
+typedef uint32_t (*Implementation)(const void*, size_t, uint32_t);
+
+Implementation choose()
+{
+#ifdef O2_CRC32C_HARDWARE
+  if (detectHardware()) {
+    return &crc32cHardware;
+  }
+#endif
+  return &Crc32cPortable;
+}
+
+} // namespace
+
+uint32_t Crc32cPortable(const void* data, size_t size, uint32_t crc)
+{
+  const Tables& t = tables();
+  const unsigned char* next = static_cast<const unsigned char*>(data);
+  crc = ~crc;
+
+  while (size > 0 && (reinterpret_cast<uintptr_t>(next) & 7) != 0) {
+    crc = t.slicing[0][(crc ^ *next++) & 0xff] ^ (crc >> 8);
+    --size;
+  }
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  while (size >= 8) {
+    uint64_t word = load64(next) ^ crc;
+    crc = t.slicing[7][word & 0xff] ^ t.slicing[6][(word >> 8) & 0xff]
+        ^ t.slicing[5][(word >> 16) & 0xff] ^ t.slicing[4][(word >> 24) & 0xff]
+        ^ t.slicing[3][(word >> 32) & 0xff] ^ t.slicing[2][(word >> 40) & 0xff]
+        ^ t.slicing[1][(word >> 48) & 0xff] ^ t.slicing[0][word >> 56];
+    next += 8;
+    size -= 8;
+  }
+#endif
+
+  while (size > 0) {
+    crc = t.slicing[0][(crc ^ *next++) & 0xff] ^ (crc >> 8);
+    --size;
+  }
+
+  return ~crc;
+}
+
+uint32_t Crc32c(const void* data, size_t size, uint32_t crc)
+{
+  static const Implementation implementation = choose();
+  return implementation(data, size, crc);
+}
+
+bool HasHardwareCrc32c()
+{
+  static const bool hardware = detectHardware();
+  return hardware;
+}
+
+const char* GetCrc32cImplementation()
+{
+  if (!HasHardwareCrc32c()) {
+    return "slicing-by-8";
+  }
+#if defined(__x86_64__)
+  return "sse4.2";
+#else
+  return "armv8";
+#endif
+}
+
+} // namespace Devices
+} // namespace AliceO2
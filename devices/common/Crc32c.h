@@ -0,0 +1,41 @@
+/**
+ * Crc32c.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_CRC32C_H_
+#define ALICEO2_DEVICES_CRC32C_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AliceO2 {
+namespace Devices {
+
+/// CRC-32C (Castagnoli) of the payloads, as checked end to end between the
+/// FLPs and the EPNs.
+///
+/// On x86-64 with SSE4.2 and on ARMv8 with the CRC extension the crc32
+/// instruction runs on three interleaved streams of the buffer, which hides
+/// its latency of three cycles, and the three partial CRCs are combined with
+/// precomputed shift tables. Elsewhere a slicing-by-8 table walk is used. The
+/// choice is made once at run time. All functions are thread-safe.
+///
+/// crc is the CRC of the data before, 0 to start, so a buffer can be
+/// checked in pieces: Crc32c(b, n, Crc32c(a, m)) == CRC of a followed by b.
+uint32_t Crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+/// the slicing-by-8 implementation, on any CPU
+uint32_t Crc32cPortable(const void* data, size_t size, uint32_t crc = 0);
+
+/// true if the CPU has a crc32 instruction that Crc32c() uses
+bool HasHardwareCrc32c();
+
+/// "sse4.2", "armv8" or "slicing-by-8", for the logs
+const char* GetCrc32cImplementation();
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
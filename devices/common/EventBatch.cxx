@@ -0,0 +1,153 @@
+/**
+ * EventBatch.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <new>
+
+#include "EventBatch.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+static void freeBatch(void* data, void* /*hint*/)
+{
+  free(data);
+}
+
+EventBatchBuilder::EventBatchBuilder()
+  : fBuffer(NULL)
+  , fCapacity(0)
+  , fSize(sizeof(EventBatchHeader))
+  , fOffsets()
+  , fMaxEvents(0)
+  , fMaxBytes(0)
+{
+}
+
+EventBatchBuilder::~EventBatchBuilder()
+{
+  free(fBuffer);
+}
+
+void EventBatchBuilder::Init(size_t maxEvents, size_t maxBytes)
+{
+  fMaxEvents = maxEvents;
+  fMaxBytes = maxBytes;
+  fOffsets.reserve(maxEvents > 0 ? maxEvents : 1024);
+}
+
+bool EventBatchBuilder::Fits(size_t size) const
+{
+  // the offsets are 32 bit, the table included.
+  uint64_t total = static_cast<uint64_t>(fSize) + size + (fOffsets.size() + 2) * sizeof(uint32_t);
+  if (total > numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  return IsEmpty() || fMaxBytes == 0 || GetDataSize() + size <= fMaxBytes;
+}
+
+bool EventBatchBuilder::Add(const void* data, size_t size)
+{
+  if (!Fits(size)) {
+    return false;
+  }
+
+  reserve(fSize + size);
+  memcpy(fBuffer + fSize, data, size);
+  fOffsets.push_back(fSize);
+  fSize += size;
+
+  return true;
+}
+
+bool EventBatchBuilder::IsFull() const
+{
+  return (fMaxEvents > 0 && fOffsets.size() >= fMaxEvents) || (fMaxBytes > 0 && GetDataSize() >= fMaxBytes);
+}
+
+void EventBatchBuilder::Flush(FairMQMessage* msg)
+{
+  if (IsEmpty()) {
+    return;
+  }
+
+  size_t numEvents = fOffsets.size();
+  size_t total = fSize + (numEvents + 1) * sizeof(uint32_t);
+  reserve(total);
+
+  fOffsets.push_back(fSize);
+  memcpy(fBuffer + fSize, fOffsets.data(), fOffsets.size() * sizeof(uint32_t));
+
+  EventBatchHeader header;
+  header.magic = kEventBatchMagic;
+  header.version = kEventBatchVersion;
+  header.reserved = 0;
+  header.numEvents = numEvents;
+  header.tableOffset = fSize;
+  memcpy(fBuffer, &header, sizeof(EventBatchHeader));
+
+  msg->Rebuild(fBuffer, total, &freeBatch, NULL);
+
+  // the next batch likely needs as much room, it is allocated with the first event.
+  fBuffer = NULL;
+  fSize = sizeof(EventBatchHeader);
+  fOffsets.clear();
+}
+
+void EventBatchBuilder::reserve(size_t size)
+{
+  if (fBuffer && size <= fCapacity) {
+    return;
+  }
+
+  size_t capacity = fBuffer ? max(size, 2 * fCapacity) : max(size, fCapacity);
+  if (!fBuffer && fMaxBytes > 0) {
+    // a full batch and its table.
+    capacity = max(capacity, sizeof(EventBatchHeader) + fMaxBytes + (fMaxEvents + 1) * sizeof(uint32_t));
+  }
+  capacity = max(capacity, static_cast<size_t>(4096));
+
+  char* buffer = static_cast<char*>(realloc(fBuffer, capacity));
+  if (!buffer) {
+    throw bad_alloc();
+  }
+  fBuffer = buffer;
+  fCapacity = capacity;
+}
+
+EventBatch::EventBatch(const void* data, size_t size)
+  : fData(static_cast<const char*>(data))
+  , fHeader()
+  , fTable(NULL)
+  , fValid(false)
+{
+  if (size < sizeof(EventBatchHeader)) {
+    return;
+  }
+  memcpy(&fHeader, data, sizeof(EventBatchHeader));
+  if (fHeader.magic != kEventBatchMagic || fHeader.version != kEventBatchVersion
+      || fHeader.tableOffset < sizeof(EventBatchHeader)
+      || fHeader.tableOffset + (static_cast<uint64_t>(fHeader.numEvents) + 1) * sizeof(uint32_t) > size) {
+    return;
+  }
+  fTable = fData + fHeader.tableOffset;
+
+  // every event lies between the header and the table.
+  uint32_t previous = sizeof(EventBatchHeader);
+  for (uint32_t i = 0; i <= fHeader.numEvents; ++i) {
+    uint32_t offset;
+    memcpy(&offset, fTable + i * sizeof(uint32_t), sizeof(uint32_t));
+    if (offset < previous || offset > fHeader.tableOffset) {
+      return;
+    }
+    previous = offset;
+  }
+
+  fValid = true;
+}
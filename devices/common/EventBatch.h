@@ -0,0 +1,139 @@
+/**
+ * EventBatch.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_EVENTBATCH_H_
+#define ALICEO2_DEVICES_EVENTBATCH_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "FairMQMessage.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Payload that packs many small events into one message.
+///
+/// An EventBatchHeader, the events back to back without padding, then the
+/// offset table: numEvents + 1 offsets from the start of the batch, event i
+/// spans [offset[i], offset[i + 1]). The table comes last, so events are
+/// appended without knowing in advance how many there will be, and costs 4
+/// bytes per event. Nothing in the batch is aligned, neither the events nor
+/// the table, structured data is read with memcpy. Plain structures in host
+/// byte order, like the timeframe headers.
+
+static const uint32_t kEventBatchMagic = 0x4245324f; // "O2EB"
+static const uint16_t kEventBatchVersion = 1;
+
+struct EventBatchHeader
+{
+  uint32_t magic;       ///< kEventBatchMagic
+  uint16_t version;     ///< kEventBatchVersion
+  uint16_t reserved;
+  uint32_t numEvents;
+  uint32_t tableOffset; ///< start of the offset table
+};
+
+/// Packs events into a batch, which is handed over to a message without a copy.
+///
+/// The batch is full when it holds maxEvents events or maxBytes of event
+/// data, 0 lifts either limit. The caller flushes full batches, and batches
+/// that have waited long enough, with Flush(). Not thread-safe.
+class EventBatchBuilder
+{
+  public:
+    EventBatchBuilder();
+    ~EventBatchBuilder();
+
+    void Init(size_t maxEvents, size_t maxBytes);
+
+    /// false if the event would take a non-empty batch beyond the byte limit,
+    /// the batch has to be flushed first. An empty batch takes any event.
+    bool Fits(size_t size) const;
+    /// copies the event into the batch, false if it does not fit
+    bool Add(const void* data, size_t size);
+
+    bool IsEmpty() const { return fOffsets.empty(); }
+    bool IsFull() const;
+    size_t GetNumEvents() const { return fOffsets.size(); }
+    /// event bytes in the batch
+    size_t GetDataSize() const { return fSize - sizeof(EventBatchHeader); }
+
+    /// rebuilds msg over the batch, which the message frees, and starts a new
+    /// one. An empty batch leaves the message alone.
+    void Flush(FairMQMessage* msg);
+
+  private:
+    /// copy constructor prohibited
+    EventBatchBuilder(const EventBatchBuilder&);
+    /// assignment operator prohibited
+    EventBatchBuilder& operator=(const EventBatchBuilder&);
+
+    void reserve(size_t size);
+
+    char* fBuffer;
+    size_t fCapacity;
+    size_t fSize; // header and events
+    std::vector<uint32_t> fOffsets; // of the events added so far
+    size_t fMaxEvents;
+    size_t fMaxBytes;
+};
+
+/// Read access to a received batch, works on the message data in place.
+class EventBatch
+{
+  public:
+    struct Event
+    {
+      const char* data;
+      size_t size;
+    };
+
+    class Iterator
+    {
+      public:
+        Iterator(const EventBatch* batch, size_t index) : fBatch(batch), fIndex(index) {}
+
+        Event operator*() const { return fBatch->GetEvent(fIndex); }
+        Iterator& operator++() { ++fIndex; return *this; }
+        bool operator==(const Iterator& other) const { return fIndex == other.fIndex; }
+        bool operator!=(const Iterator& other) const { return fIndex != other.fIndex; }
+
+      private:
+        const EventBatch* fBatch;
+        size_t fIndex;
+    };
+
+    /// checks the header and the offset table once, the accessors rely on it
+    EventBatch(const void* data, size_t size);
+
+    bool IsValid() const { return fValid; }
+    size_t GetNumEvents() const { return fValid ? fHeader.numEvents : 0; }
+
+    Event GetEvent(size_t i) const
+    {
+      uint32_t range[2];
+      memcpy(range, fTable + i * sizeof(uint32_t), sizeof(range));
+      Event event = { fData + range[0], range[1] - range[0] };
+      return event;
+    }
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, GetNumEvents()); }
+
+  private:
+    const char* fData;
+    EventBatchHeader fHeader;
+    const char* fTable;
+    bool fValid;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
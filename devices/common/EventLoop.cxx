@@ -0,0 +1,159 @@
+/**
+ * EventLoop.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm>
+
+#include "FairMQLogger.h"
+
+#include "EventLoop.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+// the smallest spin window worth having, a few non-blocking polls.
+static const chrono::microseconds kMinSpinWindow(10);
+
+EventLoop::EventLoop()
+  : fPoller(NULL)
+  , fNumInputs(0)
+  , fTimers(NULL)
+  , fMaxSpin(Clock::duration::zero())
+  , fSpinWindow(Clock::duration::zero())
+  , fMaxTimeoutInMs(100)
+  , fWorking(false)
+  , fLastWork()
+  , fReturned()
+  , fWork(Clock::duration::zero())
+  , fSpin(Clock::duration::zero())
+  , fBlocked(Clock::duration::zero())
+  , fNumBlocking(0)
+  , fMetricWork(NULL)
+  , fMetricSpin(NULL)
+  , fMetricBlocked(NULL)
+  , fMetricWakeups(NULL)
+  , fMetricSpinWindow(NULL)
+{
+}
+
+EventLoop::~EventLoop()
+{
+}
+
+void EventLoop::Init(FairMQPoller* poller, int numInputs, TimerWheel* timers, int maxSpinInUs, int maxTimeoutInMs,
+                     const string& deviceId)
+{
+  fPoller = poller;
+  fNumInputs = numInputs;
+  fTimers = timers;
+  fMaxSpin = chrono::microseconds(max(maxSpinInUs, 0));
+  fSpinWindow = Clock::duration::zero();
+  fMaxTimeoutInMs = max(maxTimeoutInMs, 1);
+
+  fWorking = false;
+  fLastWork = Clock::time_point();
+  fReturned = Clock::now();
+  fWork = fSpin = fBlocked = Clock::duration::zero();
+  fNumBlocking = 0;
+
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  string label = Metrics::DeviceLabel(deviceId);
+  fMetricWork = &metrics.AddCounter("o2_loop_work_us_total", "Time the main loop spent on input and timers", label);
+  fMetricSpin = &metrics.AddCounter("o2_loop_spin_us_total", "Time the main loop spent polling without finding work", label);
+  fMetricBlocked = &metrics.AddCounter("o2_loop_blocked_us_total", "Time the main loop slept waiting for input or a timer", label);
+  fMetricWakeups = &metrics.AddCounter("o2_loop_blocking_waits_total", "Waits of the main loop that slept in the poller", label);
+  fMetricSpinWindow = &metrics.AddGauge("o2_loop_spin_window_us", "Time the main loop spins after work before it sleeps", label);
+}
+
+void EventLoop::Wait()
+{
+  Clock::time_point now = Clock::now();
+
+  if (fWorking) {
+    account(fMetricWork, fWork, now - fReturned);
+    fLastWork = now;
+  } else {
+    account(fMetricSpin, fSpin, now - fReturned);
+  }
+
+  Clock::time_point after;
+  if (now - fLastWork < fSpinWindow) {
+    fPoller->Poll(0);
+    after = Clock::now();
+    account(fMetricSpin, fSpin, after - now);
+#if defined(__x86_64__) || defined(__i386__)
+    if (!hasInput()) {
+      // leave the pipeline to the hyperthread sibling for a moment.
+      __builtin_ia32_pause();
+    }
+#endif
+  } else {
+    fPoller->Poll(fTimers ? fTimers->GetTimeoutInMs(now, fMaxTimeoutInMs) : fMaxTimeoutInMs);
+    after = Clock::now();
+    account(fMetricBlocked, fBlocked, after - now);
+    fMetricWakeups->Increment();
+    ++fNumBlocking;
+    if (hasInput()) {
+      // waits that end on a timeout say nothing about the traffic.
+      adapt(after - now);
+    }
+  }
+
+  fWorking = hasInput();
+  if (fTimers && fTimers->Advance(after) > 0) {
+    fWorking = true;
+  }
+  fReturned = after;
+}
+
+bool EventLoop::hasInput() const
+{
+  for (int i = 0; i < fNumInputs; ++i) {
+    if (fPoller->CheckInput(i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void EventLoop::adapt(Clock::duration blocked)
+{
+  if (blocked <= fMaxSpin) {
+    fSpinWindow = fSpinWindow < kMinSpinWindow ? Clock::duration(kMinSpinWindow) : 2 * fSpinWindow;
+    fSpinWindow = min(fSpinWindow, fMaxSpin);
+  } else {
+    fSpinWindow /= 2;
+    if (fSpinWindow < kMinSpinWindow) {
+      fSpinWindow = Clock::duration::zero();
+    }
+  }
+  fMetricSpinWindow->Set(chrono::duration_cast<chrono::microseconds>(fSpinWindow).count());
+}
+
+void EventLoop::account(Metrics::Counter* metric, Clock::duration& total, Clock::duration d)
+{
+  // the counters get whole microseconds, the remainder is carried in the total.
+  int64_t before = chrono::duration_cast<chrono::microseconds>(total).count();
+  total += d;
+  int64_t after = chrono::duration_cast<chrono::microseconds>(total).count();
+  if (after > before) {
+    metric->Increment(after - before);
+  }
+}
+
+void EventLoop::LogStatistics() const
+{
+  double total = chrono::duration<double>(fWork + fSpin + fBlocked).count();
+  if (total <= 0.) {
+    return;
+  }
+
+  LOG(INFO) << "Main loop: " << 100. * chrono::duration<double>(fWork).count() / total << "% working, "
+            << 100. * chrono::duration<double>(fSpin).count() / total << "% spinning, "
+            << 100. * chrono::duration<double>(fBlocked).count() / total << "% sleeping in " << fNumBlocking
+            << " waits, spin window " << chrono::duration_cast<chrono::microseconds>(fSpinWindow).count() << " us of at most "
+            << chrono::duration_cast<chrono::microseconds>(fMaxSpin).count();
+}
@@ -0,0 +1,91 @@
+/**
+ * EventLoop.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_EVENTLOOP_H_
+#define ALICEO2_DEVICES_EVENTLOOP_H_
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+#include "FairMQPoller.h"
+
+#include "Metrics.h"
+
+#include "TimerWheel.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Wait strategy of the device main loops: polls the inputs without blocking
+/// while traffic is flowing and blocks in the poller when the device is idle,
+/// firing the timers of the device in between.
+///
+/// After every iteration that had work (a readable input or a timer that
+/// fired), the loop spins on non-blocking polls for the spin window before it
+/// blocks again. The window adapts to the traffic: a blocking wait that input
+/// ended within the longest allowed spin would have been caught by spinning,
+/// so the window doubles, a longer one halves it. At high rates the loop
+/// never enters the kernel to sleep, an idle device sleeps until the next
+/// timer or the maximum timeout, which bounds the delay to notice a state
+/// change.
+///
+/// The time between two Wait() calls is work if the previous one returned
+/// with something to do and spinning otherwise, the time in the poller is
+/// spinning or blocked, depending on the kind of poll. The three add up to
+/// the run time of the loop and are exported as metrics.
+class EventLoop
+{
+  public:
+    typedef TimerWheel::Clock Clock;
+
+    EventLoop();
+    ~EventLoop();
+
+    /// the poller over numInputs inputs and the timers (may be NULL) are not
+    /// owned. A maximum spin of 0 never spins.
+    void Init(FairMQPoller* poller, int numInputs, TimerWheel* timers, int maxSpinInUs, int maxTimeoutInMs,
+              const std::string& deviceId);
+
+    /// returns when an input is readable, after due timers have been fired, or
+    /// after the maximum timeout; the inputs are then checked on the poller
+    void Wait();
+
+    /// logs the shares of work, spinning and blocking since Init()
+    void LogStatistics() const;
+
+  private:
+    bool hasInput() const;
+    void adapt(Clock::duration blocked);
+    void account(Metrics::Counter* metric, Clock::duration& total, Clock::duration d);
+
+    FairMQPoller* fPoller;
+    int fNumInputs;
+    TimerWheel* fTimers;
+    Clock::duration fMaxSpin;
+    Clock::duration fSpinWindow;
+    int fMaxTimeoutInMs;
+
+    bool fWorking; // the last Wait() returned with work
+    Clock::time_point fLastWork;
+    Clock::time_point fReturned; // from the last Wait()
+
+    Clock::duration fWork;
+    Clock::duration fSpin;
+    Clock::duration fBlocked;
+    uint64_t fNumBlocking;
+
+    Metrics::Counter* fMetricWork;
+    Metrics::Counter* fMetricSpin;
+    Metrics::Counter* fMetricBlocked;
+    Metrics::Counter* fMetricWakeups;
+    Metrics::Gauge* fMetricSpinWindow;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ * LatencyHistogram.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "LatencyHistogram.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+namespace {
+
+inline int msb(uint64_t v)
+{
+  return 63 - __builtin_clzll(v);
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram(int precision)
+  : fPrecision(precision < 2 ? 2 : (precision > 16 ? 16 : precision))
+  , fSubBuckets(1ULL << fPrecision)
+  , fCounts(fSubBuckets + (64 - fPrecision) * (fSubBuckets / 2), 0)
+  , fCount(0)
+  , fSum(0)
+  , fMin(UINT64_MAX)
+  , fMax(0)
+{
+}
+
+size_t LatencyHistogram::Index(uint64_t value) const
+{
+  if (value < fSubBuckets) {
+    return value;
+  }
+
+  // the top `precision` bits of the value select the sub-bucket of its power of two.
+  int shift = msb(value) - fPrecision + 1;
+  uint64_t half = fSubBuckets / 2;
+  return fSubBuckets + (shift - 1) * half + ((value >> shift) - half);
+}
+
+uint64_t LatencyHistogram::HighestEquivalent(size_t index) const
+{
+  if (index < fSubBuckets) {
+    return index;
+  }
+
+  uint64_t half = fSubBuckets / 2;
+  int shift = (index - fSubBuckets) / half + 1;
+  uint64_t sub = (index - fSubBuckets) % half + half;
+  return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+  ++fCounts[Index(value)];
+  ++fCount;
+  fSum += value;
+  if (value < fMin) {
+    fMin = value;
+  }
+  if (value > fMax) {
+    fMax = value;
+  }
+}
+
+void LatencyHistogram::Add(const LatencyHistogram& other)
+{
+  if (other.fPrecision != fPrecision) {
+    return;
+  }
+
+  for (size_t i = 0; i < fCounts.size(); ++i) {
+    fCounts[i] += other.fCounts[i];
+  }
+  fCount += other.fCount;
+  fSum += other.fSum;
+  fMin = min(fMin, other.fMin);
+  fMax = max(fMax, other.fMax);
+}
+
+void LatencyHistogram::Reset()
+{
+  fill(fCounts.begin(), fCounts.end(), 0);
+  fCount = 0;
+  fSum = 0;
+  fMin = UINT64_MAX;
+  fMax = 0;
+}
+
+uint64_t LatencyHistogram::GetValueAtPercentile(double percentile) const
+{
+  if (fCount == 0) {
+    return 0;
+  }
+
+  uint64_t target = static_cast<uint64_t>(ceil(min(percentile, 100.) / 100. * fCount));
+  if (target < 1) {
+    target = 1;
+  }
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < fCounts.size(); ++i) {
+    seen += fCounts[i];
+    if (seen >= target) {
+      return min(HighestEquivalent(i), fMax);
+    }
+  }
+
+  return fMax;
+}
+
+string LatencyHistogram::Summary() const
+{
+  stringstream ss;
+  ss << "count " << fCount << ", mean " << fixed << setprecision(1) << GetMean()
+     << ", p50 " << GetValueAtPercentile(50.)
+     << ", p90 " << GetValueAtPercentile(90.)
+     << ", p99 " << GetValueAtPercentile(99.)
+     << ", p99.9 " << GetValueAtPercentile(99.9)
+     << ", max " << GetMax();
+  return ss.str();
+}
+
+void LatencyHistogram::WriteDistribution(ostream& out, int ticksPerHalfDistance) const
+{
+  out << setw(12) << "Value" << " " << setw(14) << "Percentile" << " "
+      << setw(10) << "TotalCount" << " " << setw(14) << "1/(1-Percentile)" << "\n\n";
+
+  if (fCount > 0) {
+    size_t i = 0;
+    uint64_t seen = 0; // count of the buckets before i
+    double percentile = 0.;
+
+    while (true) {
+      uint64_t target = static_cast<uint64_t>(ceil(percentile / 100. * fCount));
+      // every line moves on by at least one value.
+      target = max(target, seen + 1);
+      while (seen < target) {
+        seen += fCounts[i++];
+      }
+
+      double reached = static_cast<double>(seen) / fCount;
+      out << fixed << setw(12) << setprecision(3) << static_cast<double>(min(HighestEquivalent(i - 1), fMax)) << " "
+          << setw(14) << setprecision(12) << reached << " "
+          << setw(10) << seen << " ";
+      if (seen == fCount) {
+        out << setw(14) << "inf" << "\n";
+        break;
+      }
+      out << setw(14) << setprecision(2) << 1. / (1. - reached) << "\n";
+
+      // the step halves with every halving of the distance to 100%, as in HdrHistogram.
+      double halvings = floor(log2(1. / (1. - reached))) + 1.;
+      percentile = 100. * reached + 100. / (ticksPerHalfDistance * pow(2., halvings));
+    }
+  }
+
+  double variance = 0.;
+  if (fCount > 0) {
+    double mean = GetMean();
+    for (size_t i = 0; i < fCounts.size(); ++i) {
+      if (fCounts[i] > 0) {
+        double d = static_cast<double>(min(HighestEquivalent(i), fMax)) - mean;
+        variance += d * d * fCounts[i];
+      }
+    }
+    variance /= fCount;
+  }
+
+  out << fixed << setprecision(3)
+      << "#[Mean    = " << setw(12) << GetMean() << ", StdDeviation   = " << setw(12) << sqrt(variance) << "]\n"
+      << "#[Max     = " << setw(12) << static_cast<double>(GetMax()) << ", Total count    = " << setw(12) << fCount << "]\n"
+      << "#[Buckets = " << setw(12) << fCounts.size() << ", SubBuckets     = " << setw(12) << fSubBuckets << "]\n";
+}
@@ -0,0 +1,62 @@
+/**
+ * LatencyHistogram.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_LATENCYHISTOGRAM_H_
+#define ALICEO2_DEVICES_LATENCYHISTOGRAM_H_
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Fixed-memory histogram of latencies (any unit, typically microseconds) in
+/// the style of HdrHistogram: values below 2^precision are counted exactly,
+/// above that every power of two is split into 2^(precision-1) linear
+/// sub-buckets, so the relative error stays below 2^(1-precision) over the
+/// whole 64 bit range. Recording is a shift and an increment, percentiles are
+/// read by a scan over the buckets. Not thread-safe, merge with Add().
+class LatencyHistogram
+{
+  public:
+    /// precision in bits, 7 gives < 1.6% error in about 3700 buckets
+    explicit LatencyHistogram(int precision = 7);
+
+    void Record(uint64_t value);
+    void Add(const LatencyHistogram& other);
+    void Reset();
+
+    uint64_t GetCount() const { return fCount; }
+    uint64_t GetMin() const { return fCount > 0 ? fMin : 0; }
+    uint64_t GetMax() const { return fMax; }
+    double GetMean() const { return fCount > 0 ? static_cast<double>(fSum) / fCount : 0.; }
+    /// highest value equivalent to the one at this percentile (0-100)
+    uint64_t GetValueAtPercentile(double percentile) const;
+
+    /// one line with count, mean and the usual percentiles
+    std::string Summary() const;
+    /// percentile distribution in the HdrHistogram text format
+    void WriteDistribution(std::ostream& out, int ticksPerHalfDistance = 5) const;
+
+  private:
+    size_t Index(uint64_t value) const;
+    uint64_t HighestEquivalent(size_t index) const;
+
+    int fPrecision;
+    uint64_t fSubBuckets; // 2^precision
+    std::vector<uint64_t> fCounts;
+    uint64_t fCount;
+    uint64_t fSum;
+    uint64_t fMin;
+    uint64_t fMax;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,248 @@
+/**
+ * PayloadGenerator.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "FairMQLogger.h"
+
+#include "PayloadGenerator.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+namespace {
+
+inline uint64_t splitMix(uint64_t& x)
+{
+  uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+} // namespace
+
+PayloadGenerator::PayloadGenerator()
+  : fDistribution(Fixed)
+  , fDescription()
+  , fFixedSize(0)
+  , fTrace()
+  , fTracePosition(0)
+  , fLogNormal()
+  , fMaxSize(0)
+  , fBuffers()
+  , fUses()
+  , fNext(0)
+  , fRefreshEvery(0)
+  , fRandom()
+  , fNumMessages(0)
+  , fNumRefreshed(0)
+{
+  memset(fState0, 0, sizeof(fState0));
+  memset(fState1, 0, sizeof(fState1));
+}
+
+PayloadGenerator::~PayloadGenerator()
+{
+  releaseBuffers();
+}
+
+bool PayloadGenerator::Init(const string& sizes, size_t numBuffers, unsigned int refreshEvery, uint64_t seed)
+{
+  releaseBuffers();
+
+  if (!parse(sizes)) {
+    return false;
+  }
+
+  fRandom.seed(seed);
+  uint64_t x = seed;
+  for (int l = 0; l < 4; ++l) {
+    fState0[l] = splitMix(x);
+    fState1[l] = splitMix(x);
+  }
+
+  fRefreshEvery = refreshEvery;
+  fNext = 0;
+  fNumMessages = 0;
+  fNumRefreshed = 0;
+
+  for (size_t i = 0; i < max(numBuffers, static_cast<size_t>(1)); ++i) {
+    SharedBuffer* buffer = SharedBuffer::Create(fMaxSize);
+    if (!buffer) {
+      LOG(ERROR) << "Could not allocate a payload buffer of " << fMaxSize << " bytes";
+      releaseBuffers();
+      return false;
+    }
+    Fill(buffer->GetData(), fMaxSize);
+    fBuffers.push_back(buffer);
+    fUses.push_back(0);
+  }
+
+  LOG(INFO) << "Payload sizes: " << fDescription << ", " << fBuffers.size() << " buffers of " << fMaxSize << " bytes";
+
+  return true;
+}
+
+bool PayloadGenerator::parse(const string& sizes)
+{
+  vector<string> fields;
+  stringstream ss(sizes);
+  string field;
+  while (getline(ss, field, ':')) {
+    fields.push_back(field);
+  }
+
+  if (fields.size() == 2 && fields[0] == "fixed") {
+    fDistribution = Fixed;
+    fFixedSize = strtoull(fields[1].c_str(), NULL, 10);
+    fMaxSize = fFixedSize;
+  } else if ((fields.size() == 3 || fields.size() == 4) && fields[0] == "lognormal") {
+    double mean = atof(fields[1].c_str());
+    double deviation = atof(fields[2].c_str());
+    if (mean <= 0. || deviation < 0.) {
+      LOG(ERROR) << "Log-normal payload sizes need a positive mean and a non-negative deviation: " << sizes;
+      return false;
+    }
+    // parameters of the underlying normal distribution for the requested mean and deviation.
+    double sigma2 = log(1. + (deviation * deviation) / (mean * mean));
+    fDistribution = LogNormal;
+    fLogNormal = lognormal_distribution<double>(log(mean) - sigma2 / 2., sqrt(sigma2));
+    // without an explicit maximum the tail is cut where less than 1e-6 of the payloads would be.
+    fMaxSize = fields.size() == 4 ? strtoull(fields[3].c_str(), NULL, 10)
+                                  : static_cast<size_t>(exp(log(mean) - sigma2 / 2. + 4.75 * sqrt(sigma2)));
+  } else if (fields.size() == 2 && fields[0] == "trace") {
+    ifstream trace(fields[1].c_str());
+    if (!trace) {
+      LOG(ERROR) << "Could not open the payload size trace " << fields[1];
+      return false;
+    }
+    fTrace.clear();
+    string line;
+    while (getline(trace, line)) {
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      fTrace.push_back(strtoull(line.c_str(), NULL, 10));
+    }
+    if (fTrace.empty()) {
+      LOG(ERROR) << "The payload size trace " << fields[1] << " holds no sizes";
+      return false;
+    }
+    fDistribution = Trace;
+    fTracePosition = 0;
+    fMaxSize = *max_element(fTrace.begin(), fTrace.end());
+  } else {
+    LOG(ERROR) << "Invalid payload sizes \"" << sizes << "\", expected fixed:<bytes>, lognormal:<mean>:<deviation>[:<max>] or trace:<file>";
+    return false;
+  }
+
+  fDescription = sizes;
+  return true;
+}
+
+size_t PayloadGenerator::NextSize()
+{
+  switch (fDistribution) {
+    case LogNormal:
+      return min(static_cast<size_t>(fLogNormal(fRandom)), fMaxSize);
+    case Trace: {
+      size_t size = fTrace[fTracePosition];
+      fTracePosition = (fTracePosition + 1) % fTrace.size();
+      return size;
+    }
+    default:
+      return fFixedSize;
+  }
+}
+
+double PayloadGenerator::GetMeanSize() const
+{
+  switch (fDistribution) {
+    case LogNormal:
+      return exp(fLogNormal.m() + fLogNormal.s() * fLogNormal.s() / 2.);
+    case Trace: {
+      double sum = 0.;
+      for (size_t i = 0; i < fTrace.size(); ++i) {
+        sum += fTrace[i];
+      }
+      return sum / fTrace.size();
+    }
+    default:
+      return fFixedSize;
+  }
+}
+
+FairMQMessage* PayloadGenerator::CreateMessage(FairMQTransportFactory* factory)
+{
+  return CreateMessage(factory, NextSize());
+}
+
+FairMQMessage* PayloadGenerator::CreateMessage(FairMQTransportFactory* factory, size_t size)
+{
+  SharedBuffer* buffer = fBuffers[fNext];
+  unsigned int& uses = fUses[fNext];
+  fNext = (fNext + 1) % fBuffers.size();
+
+  // new data only while no message looks at the buffer, otherwise it stays as it is for another round.
+  if (fRefreshEvery > 0 && ++uses >= fRefreshEvery && buffer->IsUnique()) {
+    Fill(buffer->GetData(), fMaxSize);
+    uses = 0;
+    ++fNumRefreshed;
+  }
+
+  ++fNumMessages;
+
+  return buffer->CreateMessage(factory, size);
+}
+
+void PayloadGenerator::Fill(void* data, size_t size)
+{
+  // four independent xorshift128+ generators, one per 64 bit lane of a 32 byte block. The lanes
+  // do not depend on each other, so the compiler keeps them in vector registers.
+  char* out = static_cast<char*>(data);
+  uint64_t s0[4];
+  uint64_t s1[4];
+  memcpy(s0, fState0, sizeof(s0));
+  memcpy(s1, fState1, sizeof(s1));
+
+  uint64_t block[4];
+  size_t numBlocks = size / sizeof(block);
+  size_t tail = size % sizeof(block);
+
+  for (size_t i = 0; i <= numBlocks; ++i) {
+    if (i == numBlocks && tail == 0) {
+      break;
+    }
+    for (int l = 0; l < 4; ++l) {
+      uint64_t x = s0[l];
+      const uint64_t y = s1[l];
+      block[l] = x + y;
+      s0[l] = y;
+      x ^= x << 23;
+      s1[l] = x ^ y ^ (x >> 18) ^ (y >> 5);
+    }
+    memcpy(out + i * sizeof(block), block, i < numBlocks ? sizeof(block) : tail);
+  }
+
+  memcpy(fState0, s0, sizeof(s0));
+  memcpy(fState1, s1, sizeof(s1));
+}
+
+void PayloadGenerator::releaseBuffers()
+{
+  for (size_t i = 0; i < fBuffers.size(); ++i) {
+    fBuffers[i]->Unref();
+  }
+  fBuffers.clear();
+  fUses.clear();
+}
@@ -0,0 +1,95 @@
+/**
+ * PayloadGenerator.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_PAYLOADGENERATOR_H_
+#define ALICEO2_DEVICES_PAYLOADGENERATOR_H_
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+
+#include "FairMQMessage.h"
+#include "FairMQTransportFactory.h"
+
+#include "SharedBuffer.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Synthetic payloads for emulated FLPs at the rate of the transport.
+///
+/// A few buffers of the maximum payload size are filled with pseudo-random
+/// data once. CreateMessage() hands out a zero-copy message over the next
+/// buffer, with the size drawn from the configured distribution:
+///   fixed:<bytes>
+///   lognormal:<mean bytes>:<standard deviation bytes>[:<max bytes>]
+///   trace:<file>    one size in bytes per line, replayed in a loop
+/// The buffers are SharedBuffers, so one outlives the generator if messages
+/// still use it. With a refresh interval, a buffer gets new data after that many
+/// uses, provided no message holds it at that moment. Not thread-safe, apart
+/// from the release of the messages, which may happen on any thread.
+class PayloadGenerator
+{
+  public:
+    PayloadGenerator();
+    ~PayloadGenerator();
+
+    /// returns false (and logs why) for an invalid size specification or trace file
+    bool Init(const std::string& sizes, size_t numBuffers = 8, unsigned int refreshEvery = 0, uint64_t seed = 0);
+
+    /// size of the next payload according to the distribution
+    size_t NextSize();
+
+    /// zero-copy message of NextSize() bytes over a pool buffer
+    FairMQMessage* CreateMessage(FairMQTransportFactory* factory);
+    /// same for a given size, at most GetMaxSize()
+    FairMQMessage* CreateMessage(FairMQTransportFactory* factory, size_t size);
+
+    /// fills data with fresh pseudo-random bytes
+    void Fill(void* data, size_t size);
+
+    size_t GetMaxSize() const { return fMaxSize; }
+    double GetMeanSize() const;
+    std::string GetDescription() const { return fDescription; }
+    unsigned long GetNumMessages() const { return fNumMessages; }
+    unsigned long GetNumRefreshed() const { return fNumRefreshed; }
+
+  private:
+    enum Distribution { Fixed, LogNormal, Trace };
+
+    PayloadGenerator(const PayloadGenerator&);
+    PayloadGenerator& operator=(const PayloadGenerator&);
+
+    bool parse(const std::string& sizes);
+    void releaseBuffers();
+
+    Distribution fDistribution;
+    std::string fDescription;
+    size_t fFixedSize;
+    std::vector<size_t> fTrace;
+    size_t fTracePosition;
+    std::lognormal_distribution<double> fLogNormal;
+    size_t fMaxSize;
+
+    std::vector<SharedBuffer*> fBuffers;
+    std::vector<unsigned int> fUses; ///< messages since the last refresh, per buffer
+    size_t fNext;
+    unsigned int fRefreshEvery;
+
+    std::mt19937_64 fRandom; // sizes
+    uint64_t fState0[4]; // fill, four xorshift128+ lanes
+    uint64_t fState1[4];
+
+    unsigned long fNumMessages;
+    unsigned long fNumRefreshed;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
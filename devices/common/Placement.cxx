@@ -0,0 +1,290 @@
+/**
+ * Placement.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "FairMQLogger.h"
+
+#include "Placement.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+namespace {
+
+// from <numaif.h>, which comes with libnuma. The system calls need no library.
+const int kMpolPreferred = 1;
+const unsigned kMpolMfMove = 1 << 1;
+
+const int kMaxNumaNodes = 1024;
+const size_t kNodeMaskWords = kMaxNumaNodes / (8 * sizeof(unsigned long));
+
+string readLine(const string& path)
+{
+  ifstream file(path.c_str());
+  string line;
+  getline(file, line);
+  return line;
+}
+
+bool isNumber(const string& s)
+{
+  return !s.empty() && s.find_first_not_of("0123456789") == string::npos;
+}
+
+} // namespace
+
+Placement& Placement::Default()
+{
+  static Placement placement;
+  return placement;
+}
+
+Placement::Placement()
+  : fHasMain(false)
+  , fHasIo(false)
+  , fHasHelper(false)
+  , fNumaNode(-1)
+  , fNumaSource()
+{
+  CPU_ZERO(&fMainCpus);
+  CPU_ZERO(&fIoCpus);
+  CPU_ZERO(&fHelperCpus);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &fProcessCpus) != 0) {
+    CPU_ZERO(&fProcessCpus);
+  }
+}
+
+bool Placement::ParseCpuList(const string& list, cpu_set_t& cpus)
+{
+  CPU_ZERO(&cpus);
+
+  stringstream ranges(list);
+  string range;
+  while (getline(ranges, range, ',')) {
+    size_t dash = range.find('-');
+    string first = range.substr(0, dash);
+    string last = dash == string::npos ? first : range.substr(dash + 1);
+    if (!isNumber(first) || !isNumber(last)) {
+      return false;
+    }
+    int begin = atoi(first.c_str());
+    int end = atoi(last.c_str());
+    if (begin > end || end >= CPU_SETSIZE) {
+      return false;
+    }
+    for (int cpu = begin; cpu <= end; ++cpu) {
+      CPU_SET(cpu, &cpus);
+    }
+  }
+
+  return CPU_COUNT(&cpus) > 0;
+}
+
+string Placement::FormatCpuList(const cpu_set_t& cpus)
+{
+  stringstream list;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &cpus)) {
+      continue;
+    }
+    int last = cpu;
+    while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &cpus)) {
+      ++last;
+    }
+    list << (list.tellp() > 0 ? "," : "") << cpu;
+    if (last > cpu) {
+      list << "-" << last;
+    }
+    cpu = last;
+  }
+  return list.str();
+}
+
+bool Placement::Configure(const string& mainCpus, const string& ioCpus, const string& helperCpus, const string& numaNode)
+{
+  if (!numaNode.empty()) {
+    if (isNumber(numaNode)) {
+      fNumaNode = atoi(numaNode.c_str());
+    } else {
+      // the node the kernel reports for the NIC, -1 on machines with a single node.
+      string node = readLine("/sys/class/net/" + numaNode + "/device/numa_node");
+      if (node.empty()) {
+        LOG(ERROR) << "Cannot find the NUMA node of network interface " << numaNode;
+        return false;
+      }
+      fNumaNode = atoi(node.c_str());
+      fNumaSource = numaNode;
+      if (fNumaNode < 0) {
+        LOG(WARN) << "Network interface " << numaNode << " belongs to no NUMA node, memory is not bound";
+      }
+    }
+    if (fNumaNode >= kMaxNumaNodes) {
+      LOG(ERROR) << "NUMA node " << fNumaNode << " out of range";
+      return false;
+    }
+  }
+
+  if (!parseGroup("main", mainCpus, fMainCpus, fHasMain) || !parseGroup("I/O", ioCpus, fIoCpus, fHasIo)
+      || !parseGroup("helper", helperCpus, fHelperCpus, fHasHelper)) {
+    return false;
+  }
+
+  if (fNumaNode >= 0) {
+    // inherited by every thread started from now on, the I/O threads of the transport included.
+    unsigned long mask[kNodeMaskWords] = {};
+    mask[fNumaNode / (8 * sizeof(unsigned long))] |= 1UL << (fNumaNode % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_set_mempolicy, kMpolPreferred, mask, kMaxNumaNodes + 1) != 0) {
+      LOG(ERROR) << "Cannot prefer memory of NUMA node " << fNumaNode << ": " << strerror(errno);
+      return false;
+    }
+  }
+
+  if (fHasMain) {
+    // the runner's thread is the main thread until it enters another scope.
+    pin(pthread_self(), fMainCpus, "main");
+  }
+
+  return true;
+}
+
+bool Placement::parseGroup(const string& name, const string& list, cpu_set_t& cpus, bool& set)
+{
+  set = false;
+  if (list.empty()) {
+    return true;
+  }
+
+  if (list == "node") {
+    if (fNumaNode < 0) {
+      LOG(ERROR) << "The " << name << " CPUs are those of the NUMA node, but there is none";
+      return false;
+    }
+    stringstream path;
+    path << "/sys/devices/system/node/node" << fNumaNode << "/cpulist";
+    if (!ParseCpuList(readLine(path.str()), cpus)) {
+      LOG(ERROR) << "Cannot read the CPUs of NUMA node " << fNumaNode;
+      return false;
+    }
+  } else if (!ParseCpuList(list, cpus)) {
+    LOG(ERROR) << "Invalid list of " << name << " CPUs: \"" << list << "\"";
+    return false;
+  }
+
+  // CPUs the process may not use, e.g. outside its cgroup, are left out.
+  CPU_AND(&cpus, &cpus, &fProcessCpus);
+  if (CPU_COUNT(&cpus) == 0) {
+    LOG(ERROR) << "None of the " << name << " CPUs " << list << " is available to the process, which may use "
+               << FormatCpuList(fProcessCpus);
+    return false;
+  }
+
+  set = true;
+  return true;
+}
+
+void Placement::pin(pthread_t thread, const cpu_set_t& cpus, const char* name) const
+{
+  int result = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpus);
+  if (result != 0) {
+    LOG(ERROR) << "Cannot pin the " << name << " thread to CPUs " << FormatCpuList(cpus) << ": " << strerror(result);
+  }
+}
+
+void Placement::EnterIoScope()
+{
+  if (fHasIo) {
+    pin(pthread_self(), fIoCpus, "I/O");
+  }
+}
+
+void Placement::EnterMainScope()
+{
+  if (fHasMain) {
+    pin(pthread_self(), fMainCpus, "main");
+  } else if (fHasIo) {
+    // leave the I/O CPUs to the I/O threads.
+    pin(pthread_self(), fProcessCpus, "main");
+  }
+}
+
+void Placement::EnterHelperScope()
+{
+  if (fHasHelper) {
+    pin(pthread_self(), fHelperCpus, "helper");
+  }
+}
+
+void Placement::PinHelper(pthread_t thread, const char* name)
+{
+  if (fHasHelper) {
+    pin(thread, fHelperCpus, name);
+  }
+}
+
+void Placement::BindMemory(void* data, size_t size) const
+{
+  if (fNumaNode < 0) {
+    return;
+  }
+
+  // the policy applies to whole pages, the partial ones at the edges may be shared with other data.
+  uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = (reinterpret_cast<uintptr_t>(data) + pageSize - 1) & ~(pageSize - 1);
+  uintptr_t end = (reinterpret_cast<uintptr_t>(data) + size) & ~(pageSize - 1);
+  if (end <= begin) {
+    return;
+  }
+
+  unsigned long mask[kNodeMaskWords] = {};
+  mask[fNumaNode / (8 * sizeof(unsigned long))] |= 1UL << (fNumaNode % (8 * sizeof(unsigned long)));
+  if (syscall(SYS_mbind, begin, end - begin, kMpolPreferred, mask, kMaxNumaNodes + 1, kMpolMfMove) != 0) {
+    LOG(WARN) << "Cannot move a buffer of " << size << " bytes to NUMA node " << fNumaNode << ": " << strerror(errno);
+  }
+}
+
+void Placement::Report() const
+{
+  LOG(INFO) << "Placement: main threads on CPUs " << (fHasMain ? FormatCpuList(fMainCpus) : "of the process")
+            << ", I/O threads on " << (fHasIo ? FormatCpuList(fIoCpus) : "CPUs of the process")
+            << ", helper threads on " << (fHasHelper ? FormatCpuList(fHelperCpus) : "CPUs of the process")
+            << ", memory " << (fNumaNode < 0 ? string("from any NUMA node") : "preferably from NUMA node " + to_string(fNumaNode))
+            << (fNumaSource.empty() ? "" : " of " + fNumaSource);
+
+  // what the kernel actually applies, per thread.
+  DIR* tasks = opendir("/proc/self/task");
+  if (!tasks) {
+    return;
+  }
+  while (struct dirent* task = readdir(tasks)) {
+    if (!isNumber(task->d_name)) {
+      continue;
+    }
+    string path = string("/proc/self/task/") + task->d_name;
+    string name = readLine(path + "/comm");
+    string cpus;
+    ifstream status((path + "/status").c_str());
+    string line;
+    while (getline(status, line)) {
+      if (line.compare(0, 18, "Cpus_allowed_list:") == 0) {
+        size_t begin = line.find_first_not_of(" \t", 18);
+        cpus = begin == string::npos ? "" : line.substr(begin);
+      }
+    }
+    LOG(INFO) << "  thread " << task->d_name << " (" << name << "): CPUs " << cpus;
+  }
+  closedir(tasks);
+}
@@ -0,0 +1,86 @@
+/**
+ * Placement.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_PLACEMENT_H_
+#define ALICEO2_DEVICES_PLACEMENT_H_
+
+#include <string>
+#include <cstddef>
+
+#include <sched.h>
+#include <pthread.h>
+
+namespace AliceO2 {
+namespace Devices {
+
+/// CPU and NUMA placement of the threads and payload memory of a device
+/// process, configured by the runner from its command line.
+///
+/// There are three groups of threads. The main group is the thread that runs
+/// the device and every processing thread it starts. The I/O group are the
+/// I/O threads of the transport, which cannot be reached from outside, so the
+/// runner creates the sockets while its own thread is in the I/O group and the
+/// new threads inherit it. Helper threads (rate logger, ack listener, ...) are
+/// pinned by the device right after it starts them. A group without CPUs stays
+/// where the process was started.
+///
+/// With a NUMA node, memory the process allocates after Configure() prefers
+/// that node, and long lived payload buffers are moved there explicitly.
+class Placement
+{
+  public:
+    /// the placement of this process
+    static Placement& Default();
+
+    /// CPU lists are like "0-3,8,10-11", "node" for the CPUs of the NUMA node,
+    /// or empty. The NUMA node is a number, the name of the network interface
+    /// whose node to use, or empty. False if something cannot be applied.
+    bool Configure(const std::string& mainCpus, const std::string& ioCpus, const std::string& helperCpus, const std::string& numaNode);
+
+    /// pins the calling thread to the I/O CPUs, threads it starts inherit them
+    void EnterIoScope();
+    /// pins the calling thread to the main CPUs
+    void EnterMainScope();
+    /// pins the calling thread to the helper CPUs, for helpers started by libraries
+    void EnterHelperScope();
+    /// pins a helper thread, name is for the log
+    void PinHelper(pthread_t thread, const char* name);
+
+    /// -1 without a node
+    int GetNumaNode() const { return fNumaNode; }
+    /// moves the whole pages of a buffer to the NUMA node
+    void BindMemory(void* data, size_t size) const;
+
+    /// logs the configuration and the CPUs every thread of the process may use
+    void Report() const;
+
+    /// false if the list is malformed or names CPUs beyond CPU_SETSIZE
+    static bool ParseCpuList(const std::string& list, cpu_set_t& cpus);
+    static std::string FormatCpuList(const cpu_set_t& cpus);
+
+  private:
+    Placement();
+    Placement(const Placement&);
+    Placement& operator=(const Placement&);
+
+    bool parseGroup(const std::string& name, const std::string& list, cpu_set_t& cpus, bool& set);
+    void pin(pthread_t thread, const cpu_set_t& cpus, const char* name) const;
+
+    cpu_set_t fProcessCpus; // where the process was started
+    cpu_set_t fMainCpus;
+    cpu_set_t fIoCpus;
+    cpu_set_t fHelperCpus;
+    bool fHasMain;
+    bool fHasIo;
+    bool fHasHelper;
+    int fNumaNode;
+    std::string fNumaSource; // the interface the node was taken from
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
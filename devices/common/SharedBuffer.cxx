@@ -0,0 +1,62 @@
+/**
+ * SharedBuffer.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <cstdlib>
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "SharedBuffer.h"
+#include "Placement.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+SharedBuffer* SharedBuffer::Create(size_t size)
+{
+  // whole cache lines, so that writers never share a line with other data.
+  size_t bytes = (max(size, static_cast<size_t>(1)) + 63) & ~static_cast<size_t>(63);
+  // large buffers start on a page, so that all of them can be bound to a NUMA node.
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  void* data = NULL;
+  if (posix_memalign(&data, bytes >= pageSize ? pageSize : 64, bytes) != 0) {
+    return NULL;
+  }
+  // before the first write, so that the pages are allocated on the NUMA node of the NIC.
+  Placement::Default().BindMemory(data, bytes);
+  return new SharedBuffer(static_cast<char*>(data), size);
+}
+
+SharedBuffer::SharedBuffer(char* data, size_t size)
+  : fRefs(1)
+  , fData(data)
+  , fSize(size)
+{
+}
+
+SharedBuffer::~SharedBuffer()
+{
+  free(fData);
+}
+
+FairMQMessage* SharedBuffer::CreateMessage(FairMQTransportFactory* factory, size_t size)
+{
+  Ref();
+  return factory->CreateMessage(fData, min(size, fSize), &SharedBuffer::release, this);
+}
+
+void SharedBuffer::Unref()
+{
+  if (fRefs.fetch_sub(1, memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+void SharedBuffer::release(void* /*data*/, void* hint)
+{
+  static_cast<SharedBuffer*>(hint)->Unref();
+}
@@ -0,0 +1,64 @@
+/**
+ * SharedBuffer.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_SHAREDBUFFER_H_
+#define ALICEO2_DEVICES_SHAREDBUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "FairMQMessage.h"
+#include "FairMQTransportFactory.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Reference counted, cache line aligned memory that any number of messages
+/// can point to without a copy.
+///
+/// The owner holds one reference from Create() until it calls Unref(), every
+/// message from CreateMessage() holds another one, which the transport drops
+/// when it is done with the message, on whichever thread that is. The memory
+/// goes away with the last reference, so a buffer can outlive its owner while
+/// messages over it are still queued.
+class SharedBuffer
+{
+  public:
+    /// NULL if the memory could not be allocated
+    static SharedBuffer* Create(size_t size);
+
+    void* GetData() const { return fData; }
+    size_t GetSize() const { return fSize; }
+
+    /// true while no message references the buffer, i.e. the owner may write to it
+    bool IsUnique() const { return fRefs.load(std::memory_order_acquire) == 1; }
+
+    /// zero-copy message over the first size bytes, at most GetSize()
+    FairMQMessage* CreateMessage(FairMQTransportFactory* factory, size_t size);
+    /// same over the whole buffer
+    FairMQMessage* CreateMessage(FairMQTransportFactory* factory) { return CreateMessage(factory, fSize); }
+
+    void Ref() { fRefs.fetch_add(1, std::memory_order_relaxed); }
+    void Unref();
+
+  private:
+    SharedBuffer(char* data, size_t size);
+    ~SharedBuffer();
+    SharedBuffer(const SharedBuffer&);
+    SharedBuffer& operator=(const SharedBuffer&);
+
+    /// free function of the messages
+    static void release(void* data, void* hint);
+
+    std::atomic<int> fRefs;
+    char* fData;
+    size_t fSize;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
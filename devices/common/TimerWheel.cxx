@@ -0,0 +1,291 @@
+/**
+ * TimerWheel.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include "TimerWheel.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+const TimerWheel::TimerId TimerWheel::kInvalidTimer;
+
+TimerWheel::TimerWheel()
+  : fNodes()
+  , fFreeNodes()
+  , fStart()
+  , fResolution(chrono::milliseconds(1))
+  , fCurrentTick(0)
+  , fNumPending(0)
+{
+  for (int i = 0; i < kNumLists; ++i) {
+    fHeads[i] = -1;
+  }
+}
+
+TimerWheel::~TimerWheel()
+{
+}
+
+void TimerWheel::Init(Clock::duration resolution, size_t capacity, Clock::time_point now)
+{
+  fStart = now;
+  fResolution = resolution;
+  fCurrentTick = 0;
+  fNumPending = 0;
+
+  for (int i = 0; i < kNumLists; ++i) {
+    fHeads[i] = -1;
+  }
+
+  fNodes.clear();
+  fFreeNodes.clear();
+  fNodes.reserve(capacity);
+  fFreeNodes.reserve(capacity);
+  for (size_t i = 0; i < capacity; ++i) {
+    AllocateNode();
+  }
+  fFreeNodes.clear();
+  for (size_t i = capacity; i > 0; --i) {
+    fFreeNodes.push_back(i - 1);
+  }
+}
+
+uint64_t TimerWheel::ToTick(Clock::time_point t, bool roundUp) const
+{
+  if (t <= fStart) {
+    return 0;
+  }
+  Clock::duration d = t - fStart;
+  uint64_t ticks = d / fResolution;
+  if (roundUp && d % fResolution != Clock::duration::zero()) {
+    ++ticks;
+  }
+  return ticks;
+}
+
+int32_t TimerWheel::AllocateNode()
+{
+  if (!fFreeNodes.empty()) {
+    int32_t node = fFreeNodes.back();
+    fFreeNodes.pop_back();
+    return node;
+  }
+
+  Node n;
+  n.expiry = 0;
+  n.callback = NULL;
+  n.context = NULL;
+  n.cookie = 0;
+  n.generation = 1;
+  n.list = -1;
+  n.prev = -1;
+  n.next = -1;
+  fNodes.push_back(n);
+  return fNodes.size() - 1;
+}
+
+TimerWheel::TimerId TimerWheel::Schedule(Clock::time_point deadline, Callback callback, void* context, uint64_t cookie)
+{
+  int32_t node = AllocateNode();
+  Node& n = fNodes[node];
+
+  n.expiry = ToTick(deadline, true);
+  n.callback = callback;
+  n.context = context;
+  n.cookie = cookie;
+
+  Place(node);
+  ++fNumPending;
+
+  return (static_cast<uint64_t>(n.generation) << 32) | static_cast<uint32_t>(node);
+}
+
+bool TimerWheel::Cancel(TimerId id)
+{
+  int32_t node = static_cast<int32_t>(id & 0xffffffff);
+
+  if (id == kInvalidTimer || node >= static_cast<int32_t>(fNodes.size())) {
+    return false;
+  }
+
+  Node& n = fNodes[node];
+  if (n.generation != (id >> 32) || n.list < 0) {
+    return false;
+  }
+
+  Unlink(node);
+  ++n.generation;
+  fFreeNodes.push_back(node);
+  --fNumPending;
+
+  return true;
+}
+
+void TimerWheel::Place(int32_t node)
+{
+  uint64_t expiry = fNodes[node].expiry;
+
+  if (expiry <= fCurrentTick) {
+    Link(node, kDueList);
+    return;
+  }
+
+  uint64_t delta = expiry - fCurrentTick;
+
+  for (int level = 0; level < kLevels; ++level) {
+    if (delta < (1ULL << (kSlotBits * (level + 1)))) {
+      Link(node, level * kSlots + ((expiry >> (kSlotBits * level)) & (kSlots - 1)));
+      return;
+    }
+  }
+
+  // beyond the range of the wheel: park in the last slot that will be cascaded, the node is placed again from there.
+  uint64_t parked = fCurrentTick + (1ULL << (kSlotBits * kLevels)) - 1;
+  Link(node, (kLevels - 1) * kSlots + ((parked >> (kSlotBits * (kLevels - 1))) & (kSlots - 1)));
+}
+
+void TimerWheel::Link(int32_t node, int list)
+{
+  Node& n = fNodes[node];
+
+  n.list = list;
+  n.prev = -1;
+  n.next = fHeads[list];
+  if (n.next >= 0) {
+    fNodes[n.next].prev = node;
+  }
+  fHeads[list] = node;
+}
+
+void TimerWheel::Unlink(int32_t node)
+{
+  Node& n = fNodes[node];
+
+  if (n.prev >= 0) {
+    fNodes[n.prev].next = n.next;
+  } else {
+    fHeads[n.list] = n.next;
+  }
+  if (n.next >= 0) {
+    fNodes[n.next].prev = n.prev;
+  }
+
+  n.list = -1;
+  n.prev = -1;
+  n.next = -1;
+}
+
+void TimerWheel::Cascade(int level)
+{
+  int list = level * kSlots + ((fCurrentTick >> (kSlotBits * level)) & (kSlots - 1));
+
+  int32_t node = fHeads[list];
+  fHeads[list] = -1;
+
+  while (node >= 0) {
+    int32_t next = fNodes[node].next;
+    Place(node);
+    node = next;
+  }
+}
+
+size_t TimerWheel::FireList(int list)
+{
+  size_t fired = 0;
+
+  // move the list aside first, callbacks may schedule new timers or cancel pending ones.
+  int32_t node = fHeads[list];
+  fHeads[list] = -1;
+  while (node >= 0) {
+    int32_t next = fNodes[node].next;
+    Link(node, kFiringList);
+    node = next;
+  }
+
+  while ((node = fHeads[kFiringList]) >= 0) {
+    Node& n = fNodes[node];
+    Callback callback = n.callback;
+    void* context = n.context;
+    uint64_t cookie = n.cookie;
+
+    Unlink(node);
+    ++n.generation;
+    fFreeNodes.push_back(node);
+    --fNumPending;
+
+    callback(context, cookie);
+    ++fired;
+  }
+
+  return fired;
+}
+
+size_t TimerWheel::Advance(Clock::time_point now)
+{
+  uint64_t target = ToTick(now, false);
+  size_t fired = FireList(kDueList);
+
+  if (fNumPending == 0 && target > fCurrentTick) {
+    fCurrentTick = target;
+    return fired;
+  }
+
+  while (fCurrentTick < target) {
+    ++fCurrentTick;
+
+    // when a level wraps, move the next slot of the level above down, highest level first.
+    int levels = 0;
+    while (levels < kLevels - 1 && ((fCurrentTick >> (kSlotBits * levels)) & (kSlots - 1)) == 0) {
+      ++levels;
+    }
+    for (int level = levels; level > 0; --level) {
+      Cascade(level);
+    }
+
+    fired += FireList(fCurrentTick & (kSlots - 1));
+    fired += FireList(kDueList);
+
+    if (fNumPending == 0) {
+      fCurrentTick = target;
+    }
+  }
+
+  return fired;
+}
+
+int TimerWheel::GetTimeoutInMs(Clock::time_point now, int maxTimeoutInMs) const
+{
+  if (fHeads[kDueList] >= 0) {
+    return 0;
+  }
+  if (fNumPending == 0) {
+    return maxTimeoutInMs;
+  }
+
+  // nearest occupied slot of the lowest level, otherwise the next cascade.
+  uint64_t tick = fCurrentTick + 1;
+  for (; tick <= fCurrentTick + kSlots; ++tick) {
+    if (fHeads[tick & (kSlots - 1)] >= 0) {
+      break;
+    }
+    if ((tick & (kSlots - 1)) == 0) {
+      break;
+    }
+  }
+
+  Clock::time_point wakeup = fStart + fResolution * tick;
+  if (wakeup <= now) {
+    return 0;
+  }
+
+  // with ticks finer than the poll timeout the last millisecond is polled without blocking, the tick is not taken late.
+  Clock::duration wait = wakeup - now;
+  if (fResolution >= chrono::milliseconds(1)) {
+    wait += chrono::milliseconds(1) - chrono::nanoseconds(1);
+  }
+  long long ms = chrono::duration_cast<chrono::milliseconds>(wait).count();
+  return ms < maxTimeoutInMs ? static_cast<int>(ms) : maxTimeoutInMs;
+}
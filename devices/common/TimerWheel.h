@@ -0,0 +1,102 @@
+/**
+ * TimerWheel.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TIMERWHEEL_H_
+#define ALICEO2_DEVICES_TIMERWHEEL_H_
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Hierarchical timer wheel for the deadlines of the devices (timeframe expiry,
+/// staggered sending, heartbeats, rate ticks), driven by the monotonic clock.
+///
+/// Four levels of 64 slots cover 2^24 ticks; later deadlines are parked in the
+/// top level and cascaded again. Scheduling and cancelling are O(1), Advance()
+/// costs O(elapsed ticks + expired timers) and never looks at timers that are
+/// not due. Timer nodes are recycled, callbacks are plain function pointers, so
+/// no allocation happens once the node pool has reached its working size.
+/// Callbacks may schedule and cancel timers. Not thread-safe.
+class TimerWheel
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+    typedef uint64_t TimerId;
+    typedef void (*Callback)(void* context, uint64_t cookie);
+
+    static const TimerId kInvalidTimer = 0;
+
+    /// adapter to use a member function void T::F(uint64_t cookie) as callback
+    template<class T, void (T::*F)(uint64_t)>
+    static void Member(void* object, uint64_t cookie)
+    {
+      (static_cast<T*>(object)->*F)(cookie);
+    }
+
+    TimerWheel();
+    ~TimerWheel();
+
+    void Init(Clock::duration resolution, size_t capacity, Clock::time_point now);
+
+    /// callback(context, cookie) is invoked from the first Advance() at or after the deadline
+    TimerId Schedule(Clock::time_point deadline, Callback callback, void* context, uint64_t cookie);
+    /// returns false if the timer has already fired or been cancelled
+    bool Cancel(TimerId id);
+
+    /// fire everything due at now, returns the number of callbacks invoked
+    size_t Advance(Clock::time_point now);
+
+    /// milliseconds until Advance() may have work to do, capped at maxTimeoutInMs, for use as poll timeout.
+    /// Rounded down with a resolution finer than a millisecond, 0 within the last one.
+    int GetTimeoutInMs(Clock::time_point now, int maxTimeoutInMs) const;
+
+    size_t GetNumPending() const { return fNumPending; }
+
+  private:
+    static const int kLevels = 4;
+    static const int kSlotBits = 6;
+    static const int kSlots = 1 << kSlotBits;
+    static const int kDueList = kLevels * kSlots;     // deadlines already passed when scheduled
+    static const int kFiringList = kDueList + 1;      // being fired in the current Advance()
+    static const int kNumLists = kFiringList + 1;
+
+    struct Node
+    {
+      uint64_t expiry; // in ticks
+      Callback callback;
+      void* context;
+      uint64_t cookie;
+      uint32_t generation;
+      int32_t list;
+      int32_t prev;
+      int32_t next;
+    };
+
+    uint64_t ToTick(Clock::time_point t, bool roundUp) const;
+    int32_t AllocateNode();
+    void Place(int32_t node);
+    void Link(int32_t node, int list);
+    void Unlink(int32_t node);
+    void Cascade(int level);
+    size_t FireList(int list);
+
+    std::vector<Node> fNodes;
+    std::vector<int32_t> fFreeNodes;
+    int32_t fHeads[kNumLists];
+
+    Clock::time_point fStart;
+    Clock::duration fResolution;
+    uint64_t fCurrentTick;
+    size_t fNumPending;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
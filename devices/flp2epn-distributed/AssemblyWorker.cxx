@@ -0,0 +1,206 @@
+/**
+ * AssemblyWorker.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm>
+
+#include "FairMQLogger.h"
+
+#include "AssemblyWorker.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+AssemblyWorker::AssemblyWorker(size_t queueCapacity)
+  : fInput(queueCapacity)
+  , fOutput(queueCapacity)
+  , fReturned(queueCapacity)
+  , fAssembler()
+  , fDiscarded()
+  , fTimers()
+  , fNumFLPs(1)
+  , fVerifyChecksums(false)
+  , fMetricRejected(NULL)
+  , fMetricLateParts(NULL)
+  , fMetricChecksumFailures(NULL)
+  , fRunning(false)
+  , fNumAssembling(0)
+  , fNumDiscarded(0)
+  , fNumFinished(0)
+  , fThread()
+{
+}
+
+AssemblyWorker::~AssemblyWorker()
+{
+  Stop();
+}
+
+void AssemblyWorker::Init(FairMQTransportFactory* factory, size_t windowSize, int numFLPs, int bufferTimeoutInMs, int releaseDeadlineInMs,
+                          bool verifyChecksums)
+{
+  fNumFLPs = numFLPs;
+  fVerifyChecksums = verifyChecksums;
+
+  // the pool starts empty, it only parks the parts of discarded timeframes.
+  fDiscarded.Init(factory, 0);
+  fTimers.Init(chrono::milliseconds(1), windowSize, TimerWheel::Clock::now());
+  fAssembler.Init(windowSize, numFLPs, &fDiscarded, bufferTimeoutInMs, releaseDeadlineInMs, &fTimers, this);
+}
+
+void AssemblyWorker::SetMetrics(Metrics::Counter* completed, Metrics::Counter* partial, Metrics::Counter* released,
+                                Metrics::Counter* discarded, Metrics::Counter* rejected, Metrics::Counter* late,
+                                Metrics::Counter* checksumFailures, Metrics::Histogram* assemblyTime)
+{
+  fAssembler.SetMetrics(completed, partial, released, discarded, discarded, assemblyTime);
+  fMetricRejected = rejected;
+  fMetricLateParts = late;
+  fMetricChecksumFailures = checksumFailures;
+}
+
+void AssemblyWorker::Start()
+{
+  fRunning = true;
+  fThread = boost::thread(&AssemblyWorker::Run, this);
+}
+
+void AssemblyWorker::Stop()
+{
+  if (!fThread.joinable()) {
+    return;
+  }
+
+  fRunning = false;
+  fThread.join();
+
+  fAssembler.Clear();
+  fNumAssembling = 0;
+
+  Part part;
+  while (fInput.TryPop(part)) {
+    if (part.data != NULL) {
+      fDiscarded.Release(part.data);
+    }
+  }
+  ReturnDiscarded();
+}
+
+void AssemblyWorker::Run()
+{
+  Backoff backoff;
+
+  while (fRunning.load(memory_order_relaxed)) {
+    TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+
+    // a bounded batch, so that the timers are not starved by a busy input.
+    Part part;
+    int n = 0;
+    while (n < 64 && fInput.TryPop(part)) {
+      Handle(part, now);
+      ++n;
+    }
+
+    fTimers.Advance(TimerWheel::Clock::now());
+    ReturnDiscarded();
+    fNumAssembling.store(fAssembler.GetNumAssembling(), memory_order_relaxed);
+    fNumDiscarded.store(fAssembler.GetWindow().GetNumDiscarded(), memory_order_relaxed);
+    fNumFinished.store(fAssembler.GetNumFinished(), memory_order_relaxed);
+
+    if (n > 0) {
+      backoff.Reset();
+    } else {
+      int timeout = fTimers.GetTimeoutInMs(TimerWheel::Clock::now(), 1);
+      backoff.Pause(timeout > 0 ? chrono::microseconds(100) : chrono::microseconds(0));
+    }
+  }
+}
+
+void AssemblyWorker::Handle(const Part& part, TimerWheel::Clock::time_point now)
+{
+  if (part.data == NULL) {
+    if (part.header.flags & kLeaving) {
+      fAssembler.Forgo(part.flpIndex);
+    } else {
+      fAssembler.Expect(part.flpIndex);
+    }
+    return;
+  }
+
+  if (part.header.flags & kDropped) {
+    // discarded, or with a release deadline forwarded without the part of the FLP.
+    fAssembler.Drop(part.id, part.flpIndex, now);
+    fDiscarded.Release(part.data);
+    return;
+  }
+
+  SubTimeframeHeader header = part.header;
+  if (fVerifyChecksums && !VerifyPayloadChecksum(header, part.data->GetData(), part.data->GetSize())) {
+    // forwarded all the same, the directory tells the consumer.
+    LOG(ERROR) << "Timeframe #" << part.id << " from FLP " << header.flpId << " does not match its checksum";
+    header.flags |= kChecksumFailed;
+    fMetricChecksumFailures->Increment();
+  }
+
+  switch (fAssembler.Add(header, part.flpIndex, part.data, now)) {
+    case TimeframeWindow::Added:
+    case TimeframeWindow::Completed:
+      break;
+    case TimeframeWindow::Released:
+      fDiscarded.Release(part.data);
+      fMetricLateParts->Increment();
+      break;
+    default:
+      // duplicate, or the timeframe is already gone.
+      fDiscarded.Release(part.data);
+      fMetricRejected->Increment();
+      break;
+  }
+}
+
+void AssemblyWorker::Forward(uint64_t id, TimeframeWindow::Slot& slot)
+{
+  vector<FairMQMessage*>& parts = slot.parts;
+  vector<SubTimeframeHeader>& headers = slot.headers;
+
+  // FLPs that have left leave gaps, the last part present ends the timeframe.
+  int last = fNumFLPs - 1;
+  while (last > 0 && parts[last] == NULL) {
+    --last;
+  }
+
+  // the output thread sends the parts as one multipart message, it waits for the rest once it has the first.
+  Backoff backoff;
+  for (int i = 0; i <= last; ++i) {
+    if (parts[i] == NULL) {
+      continue;
+    }
+    Output output;
+    output.id = id;
+    output.flpIndex = i;
+    output.header = headers[i];
+    output.data = parts[i];
+    output.last = i == last;
+    while (!fOutput.TryPush(output)) {
+      if (!fRunning.load(memory_order_relaxed)) {
+        // shutting down, the output thread may be gone already.
+        fDiscarded.Release(parts[i]);
+        break;
+      }
+      backoff.Pause();
+    }
+  }
+}
+
+void AssemblyWorker::ReturnDiscarded()
+{
+  while (fDiscarded.GetNumAvailable() > 0) {
+    FairMQMessage* msg = fDiscarded.Acquire();
+    if (!fReturned.TryPush(msg)) {
+      fDiscarded.Release(msg);
+      break;
+    }
+  }
+}
@@ -0,0 +1,126 @@
+/**
+ * AssemblyWorker.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_ASSEMBLYWORKER_H_
+#define ALICEO2_DEVICES_ASSEMBLYWORKER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "FairMQMessage.h"
+#include "FairMQTransportFactory.h"
+
+#include "Metrics.h"
+
+#include "MessagePool.h"
+#include "SPSCQueue.h"
+#include "TimeframeAssembler.h"
+#include "TimeframeHeader.h"
+#include "TimerWheel.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Assembles the timeframes of one shard (id % numWorkers == k) on its own
+/// thread, for the threaded mode of the EPN.
+///
+/// Three single-producer/single-consumer queues connect it to the rest:
+///  - input:    sub-timeframes from the I/O thread
+///  - output:   parts of completed timeframes for the output thread, pushed
+///              back to back and terminated by a part with `last` set, fewer
+///              than numFLPs of them when FLPs have left or at the release deadline
+///  - returned: message objects of rejected and discarded parts, back to the
+///              I/O thread whose pool they came from
+/// The TimeframeAssembler and its timers are private to the worker, so no
+/// locks are taken on the data path.
+class AssemblyWorker : private TimeframeAssembler::Output
+{
+  public:
+    /// a part without data changes the membership instead: the FLP has left
+    /// (kLeaving) or is expected again (kKeepalive)
+    struct Part
+    {
+      uint64_t id;
+      int flpIndex;
+      SubTimeframeHeader header;
+      FairMQMessage* data;
+    };
+
+    struct Output
+    {
+      uint64_t id;
+      int flpIndex; // for the missing-part mask of the directory
+      SubTimeframeHeader header; // for the directory of the timeframe
+      FairMQMessage* data;
+      bool last; // last part of the timeframe
+    };
+
+    explicit AssemblyWorker(size_t queueCapacity);
+    ~AssemblyWorker();
+
+    /// a release deadline > 0 forwards the timeframes with the parts they have at the deadline instead of
+    /// discarding them after the buffer timeout. The checksums are verified on the worker thread.
+    void Init(FairMQTransportFactory* factory, size_t windowSize, int numFLPs, int bufferTimeoutInMs, int releaseDeadlineInMs,
+              bool verifyChecksums);
+    /// counters and histograms of the device, they can be updated from any thread
+    void SetMetrics(Metrics::Counter* completed, Metrics::Counter* partial, Metrics::Counter* released,
+                    Metrics::Counter* discarded, Metrics::Counter* rejected, Metrics::Counter* late,
+                    Metrics::Counter* checksumFailures, Metrics::Histogram* assemblyTime);
+
+    void Start();
+    /// stops the thread and moves everything still assembling to the returned queue as far as it fits
+    void Stop();
+
+    // I/O thread
+    bool Push(const Part& part) { return fInput.TryPush(part); }
+    bool PopReturned(FairMQMessage*& msg) { return fReturned.TryPop(msg); }
+
+    // output thread
+    bool PopOutput(Output& output) { return fOutput.TryPop(output); }
+
+    int GetNumAssembling() const { return fNumAssembling.load(std::memory_order_relaxed); }
+    unsigned long GetNumDiscarded() const { return fNumDiscarded.load(std::memory_order_relaxed); }
+    /// timeframes forwarded or discarded in any way, the basis of the credit of the EPN
+    uint64_t GetNumFinished() const { return fNumFinished.load(std::memory_order_relaxed); }
+
+  private:
+    AssemblyWorker(const AssemblyWorker&);
+    AssemblyWorker& operator=(const AssemblyWorker&);
+
+    void Run();
+    void Handle(const Part& part, TimerWheel::Clock::time_point now);
+    /// pushes the parts present to the output queue
+    virtual void Forward(uint64_t id, TimeframeWindow::Slot& slot);
+    void ReturnDiscarded();
+
+    SPSCQueue<Part> fInput;
+    SPSCQueue<Output> fOutput;
+    SPSCQueue<FairMQMessage*> fReturned;
+
+    TimeframeAssembler fAssembler;
+    MessagePool fDiscarded; // parts dropped by the window, until they fit into the returned queue
+    TimerWheel fTimers;
+    int fNumFLPs;
+    bool fVerifyChecksums;
+
+    Metrics::Counter* fMetricRejected;
+    Metrics::Counter* fMetricLateParts;
+    Metrics::Counter* fMetricChecksumFailures;
+
+    std::atomic<bool> fRunning;
+    std::atomic<int> fNumAssembling;
+    std::atomic<unsigned long> fNumDiscarded;
+    std::atomic<uint64_t> fNumFinished;
+    boost::thread fThread;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
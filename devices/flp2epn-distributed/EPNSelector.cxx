@@ -0,0 +1,235 @@
+/**
+ * EPNSelector.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <cmath>
+#include <algorithm> // max
+
+#include "EPNSelector.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+namespace {
+
+// splitmix64 finalizer, the same on every FLP independent of platform and library.
+inline uint64_t mix(uint64_t x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+} // namespace
+
+OccupancyStamper::OccupancyStamper()
+  : fInterval(1)
+  , fLastStamp(0)
+{
+}
+
+void OccupancyStamper::Init(uint64_t interval)
+{
+  fInterval = interval > 0 ? interval : 1;
+  fLastStamp = 0;
+}
+
+uint64_t OccupancyStamper::Stamp(uint64_t newestId)
+{
+  fLastStamp = max(fLastStamp, getStamp(newestId));
+  return fLastStamp;
+}
+
+EPNSelector* EPNSelector::Create(const string& policy, int numEPNs)
+{
+  if (policy == "round-robin") {
+    return new RoundRobinSelector(numEPNs);
+  } else if (policy == "weighted-hash") {
+    return new WeightedHashSelector(numEPNs);
+  } else if (policy == "free-buffer") {
+    return new FreeBufferSelector(numEPNs);
+  }
+  return NULL;
+}
+
+EPNSelector::EPNSelector(int numEPNs)
+  : fNumEPNs(numEPNs > 0 ? numEPNs : 1)
+  , fAlive(fNumEPNs, true)
+  , fNumAlive(fNumEPNs)
+{
+}
+
+EPNSelector::~EPNSelector()
+{
+}
+
+int EPNSelector::Route(uint64_t timeframeId)
+{
+  int epn = Select(timeframeId);
+
+  if (fAlive[epn]) {
+    return epn;
+  }
+
+  int best = -1;
+  uint64_t bestScore = 0;
+
+  for (int i = 0; i < fNumEPNs; ++i) {
+    if (!fAlive[i]) {
+      continue;
+    }
+    uint64_t score = mix(timeframeId ^ mix(i));
+    if (best < 0 || score > bestScore) {
+      best = i;
+      bestScore = score;
+    }
+  }
+
+  return best;
+}
+
+void EPNSelector::SetAlive(int epn, bool alive)
+{
+  if (epn < 0 || epn >= fNumEPNs || fAlive[epn] == alive) {
+    return;
+  }
+
+  fAlive[epn] = alive;
+  fNumAlive += alive ? 1 : -1;
+}
+
+void EPNSelector::SetWeight(int /*epn*/, double /*weight*/)
+{
+}
+
+void EPNSelector::Report(int /*epn*/, const EPNOccupancy& /*occupancy*/)
+{
+}
+
+RoundRobinSelector::RoundRobinSelector(int numEPNs)
+  : EPNSelector(numEPNs)
+{
+}
+
+int RoundRobinSelector::Select(uint64_t timeframeId)
+{
+  return timeframeId % fNumEPNs;
+}
+
+WeightedHashSelector::WeightedHashSelector(int numEPNs)
+  : EPNSelector(numEPNs)
+  , fWeights(fNumEPNs, 1.)
+{
+}
+
+int WeightedHashSelector::Select(uint64_t timeframeId)
+{
+  int epn = SelectWeighted(timeframeId, fWeights);
+  return epn >= 0 ? epn : timeframeId % fNumEPNs;
+}
+
+void WeightedHashSelector::SetWeight(int epn, double weight)
+{
+  if (epn >= 0 && epn < fNumEPNs) {
+    fWeights[epn] = weight;
+  }
+}
+
+int WeightedHashSelector::SelectWeighted(uint64_t timeframeId, const vector<double>& weights) const
+{
+  int best = -1;
+  double bestScore = 0.;
+
+  for (int i = 0; i < fNumEPNs; ++i) {
+    if (weights[i] <= 0.) {
+      continue;
+    }
+    // uniform in (0,1) from the top 53 bits; -w/ln(u) picks EPN i with probability w_i / sum(w).
+    double u = ((mix(timeframeId ^ mix(i)) >> 11) + 0.5) * (1. / 9007199254740992.);
+    double score = -weights[i] / log(u);
+    if (best < 0 || score > bestScore) {
+      best = i;
+      bestScore = score;
+    }
+  }
+
+  return best;
+}
+
+FreeBufferSelector::FreeBufferSelector(int numEPNs)
+  : WeightedHashSelector(numEPNs)
+  , fReports(fNumEPNs, RingBuffer<EPNOccupancy>(4))
+  , fEffectiveWeights(fNumEPNs, 0.)
+  , fLastSelected(0)
+  , fNumLateReports(0)
+{
+}
+
+void FreeBufferSelector::Report(int epn, const EPNOccupancy& occupancy)
+{
+  if (epn < 0 || epn >= fNumEPNs) {
+    return;
+  }
+
+  RingBuffer<EPNOccupancy>& reports = fReports[epn];
+
+  if (!reports.empty() && occupancy.effectiveFrom <= reports.back().effectiveFrom) {
+    // a repeated report, or an older one overtaken by a newer one: an FLP that has the report in time and
+    // one that gets its replacement late would weigh the EPNs differently, so the first one stays.
+    return;
+  }
+
+  if (occupancy.effectiveFrom <= fLastSelected) {
+    ++fNumLateReports;
+  }
+
+  reports.push(occupancy);
+}
+
+int FreeBufferSelector::Select(uint64_t timeframeId)
+{
+  fLastSelected = timeframeId;
+
+  int maxFree = 0;
+  bool unknown = false;
+
+  for (int i = 0; i < fNumEPNs; ++i) {
+    RingBuffer<EPNOccupancy>& reports = fReports[i];
+
+    // timeframe ids only grow, so reports superseded for this id are not needed any more.
+    while (reports.size() > 1 && reports[1].effectiveFrom <= timeframeId) {
+      reports.pop();
+    }
+
+    if (!reports.empty() && reports.front().effectiveFrom <= timeframeId) {
+      fEffectiveWeights[i] = reports.front().freeSlots;
+      if (reports.front().freeSlots > maxFree) {
+        maxFree = reports.front().freeSlots;
+      }
+    } else {
+      fEffectiveWeights[i] = -1.;
+      unknown = true;
+    }
+  }
+
+  // EPNs that have not reported yet count as fully free, i.e. as free as the emptiest known one.
+  if (unknown) {
+    for (int i = 0; i < fNumEPNs; ++i) {
+      if (fEffectiveWeights[i] < 0.) {
+        fEffectiveWeights[i] = maxFree > 0 ? maxFree : 1;
+      }
+    }
+  }
+
+  for (int i = 0; i < fNumEPNs; ++i) {
+    fEffectiveWeights[i] *= fWeights[i];
+  }
+
+  int epn = SelectWeighted(timeframeId, fEffectiveWeights);
+  // every EPN is full: fall back to the static weights, the timeframe may still fit once it arrives.
+  return epn >= 0 ? epn : WeightedHashSelector::Select(timeframeId);
+}
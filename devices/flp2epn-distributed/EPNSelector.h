@@ -0,0 +1,173 @@
+/**
+ * EPNSelector.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_EPNSELECTOR_H_
+#define ALICEO2_DEVICES_EPNSELECTOR_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "RingBuffer.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Occupancy report of an EPN: free assembly slots, valid for timeframes >= effectiveFrom.
+struct EPNOccupancy
+{
+  uint64_t effectiveFrom;
+  int32_t freeSlots;
+};
+
+/// Heartbeat published by an EPN to all FLPs, 32 bytes. ZeroMQ stores it
+/// inside the message from 4.2 on, older versions allocate it; once per
+/// heartbeat interval that does not matter.
+struct EPNHeartbeat
+{
+  uint32_t epnIndex;  ///< position of the EPN in the output list of the FLPs
+  int32_t freeSlots;
+  uint64_t effectiveFrom;
+  uint64_t session;   ///< changes when the EPN restarts or moves to another node, its clock starts again
+  int64_t timestamp;  ///< steady clock of the EPN in microseconds, orders the heartbeats of a session
+};
+
+/// Stamps the occupancy reports of an EPN with the timeframe id they take effect at.
+///
+/// The ids are cut into epochs of a fixed number of timeframes. A report sent
+/// while the newest timeframe received by the EPN is in epoch n takes effect at
+/// the start of epoch n + 2, at least a whole epoch after anything the EPN has
+/// seen, so that it reaches every FLP before they schedule that id. The EPN
+/// sends a report as soon as its timeframes enter a new epoch; the reports
+/// repeated with the heartbeats carry the same stamp and the FLPs keep the first.
+class OccupancyStamper
+{
+  public:
+    OccupancyStamper();
+
+    /// epochs of interval timeframes, it has to exceed the timeframes in flight between the FLPs and the EPN
+    void Init(uint64_t interval);
+
+    /// a report for the epoch of the newest timeframe received has not been stamped yet
+    bool IsDue(uint64_t newestId) const { return getStamp(newestId) > fLastStamp; }
+    /// the stamp for a report sent now, never lower than the one before
+    uint64_t Stamp(uint64_t newestId);
+
+    uint64_t GetInterval() const { return fInterval; }
+
+  private:
+    uint64_t getStamp(uint64_t newestId) const { return (newestId / fInterval + 2) * fInterval; }
+
+    uint64_t fInterval;
+    uint64_t fLastStamp;
+};
+
+/// Decides which EPN receives a timeframe.
+///
+/// All FLPs have to send the sub-timeframes of a timeframe to the same EPN
+/// without talking to each other, so a policy must be a pure function of the
+/// timeframe id and of state that every FLP sees identically: the static
+/// configuration and occupancy reports that the EPNs send to all FLPs.
+///
+/// Route() remaps the timeframes of dead EPNs by rendezvous hashing over the
+/// live ones, so FLPs that agree on the live set agree on the replacement and
+/// the timeframes of a dead EPN spread evenly instead of piling onto one.
+class EPNSelector
+{
+  public:
+    /// "round-robin", "weighted-hash" or "free-buffer"; returns NULL for an unknown policy
+    static EPNSelector* Create(const std::string& policy, int numEPNs);
+
+    EPNSelector(int numEPNs);
+    virtual ~EPNSelector();
+
+    virtual std::string GetName() const = 0;
+
+    /// index of the EPN for this timeframe according to the policy, regardless of liveness
+    virtual int Select(uint64_t timeframeId) = 0;
+
+    /// index of the live EPN for this timeframe, -1 if no EPN is alive
+    int Route(uint64_t timeframeId);
+
+    void SetAlive(int epn, bool alive);
+    bool IsAlive(int epn) const { return fAlive[epn]; }
+    int GetNumAlive() const { return fNumAlive; }
+
+    /// relative capacity of an EPN, used by the weighted policies
+    virtual void SetWeight(int epn, double weight);
+    /// occupancy report of an EPN, used by load-aware policies
+    virtual void Report(int epn, const EPNOccupancy& occupancy);
+
+    int GetNumEPNs() const { return fNumEPNs; }
+
+  protected:
+    int fNumEPNs;
+
+  private:
+    std::vector<bool> fAlive;
+    int fNumAlive;
+};
+
+/// timeframeId % numEPNs
+class RoundRobinSelector : public EPNSelector
+{
+  public:
+    RoundRobinSelector(int numEPNs);
+
+    virtual std::string GetName() const { return "round-robin"; }
+    virtual int Select(uint64_t timeframeId);
+};
+
+/// Weighted rendezvous hashing: every EPN draws a score from hash(timeframeId, epn)
+/// scaled by its weight, the highest score wins. EPNs get timeframes in
+/// proportion to their weights, and changing one weight only moves timeframes
+/// to or from that EPN.
+class WeightedHashSelector : public EPNSelector
+{
+  public:
+    WeightedHashSelector(int numEPNs);
+
+    virtual std::string GetName() const { return "weighted-hash"; }
+    virtual int Select(uint64_t timeframeId);
+    virtual void SetWeight(int epn, double weight);
+
+  protected:
+    /// highest weighted score, EPNs with weight <= 0 are skipped; -1 if there is none
+    int SelectWeighted(uint64_t timeframeId, const std::vector<double>& weights) const;
+
+    std::vector<double> fWeights;
+};
+
+/// Weighted rendezvous hashing with the weight of an EPN set to the free
+/// buffer it reported, times its static weight. A report takes effect at the
+/// timeframe id the EPN stamped on it rather than on arrival, so FLPs that
+/// receive it at slightly different times still agree, as long as it reaches
+/// them before that timeframe. Of several reports with the same stamp the
+/// first one counts, later ones may reach some FLPs only after they scheduled
+/// the timeframe. Until an EPN reports, it counts as fully free.
+class FreeBufferSelector : public WeightedHashSelector
+{
+  public:
+    FreeBufferSelector(int numEPNs);
+
+    virtual std::string GetName() const { return "free-buffer"; }
+    virtual int Select(uint64_t timeframeId);
+    virtual void Report(int epn, const EPNOccupancy& occupancy);
+
+    /// reports that arrived after their effective timeframe had already been scheduled
+    unsigned long GetNumLateReports() const { return fNumLateReports; }
+
+  private:
+    std::vector<RingBuffer<EPNOccupancy>> fReports; // per EPN, ascending effectiveFrom
+    std::vector<double> fEffectiveWeights;
+    uint64_t fLastSelected;
+    unsigned long fNumLateReports;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
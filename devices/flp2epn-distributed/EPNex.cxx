@@ -5,29 +5,70 @@
  * @author D. Klein, A. Rybalchenko, M. Al-Turany, C. Kouzinopoulos
  */
 
+#include <algorithm> // max
+
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
-#include <fstream> // writing to file (DEBUG)
 
 #include "EPNex.h"
 #include "FairMQLogger.h"
+#include "Placement.h"
 
 using namespace std;
 
 using namespace AliceO2::Devices;
 
-struct f2eHeader {
-  uint64_t timeFrameId;
-  int      flpId;
-};
-
 EPNex::EPNex()
   : fHeartbeatIntervalInMs(3000)
   , fBufferTimeoutInMs(1000)
   , fNumFLPs(1)
   , fTestMode(0)
-  , fTimeframeBuffer()
-  , fDiscardedSet()
+  , fWindowSize(509)
+  , fEPNIndex(0)
+  , fNumWorkers(0)
+  , fHeartbeatAddresses()
+  , fCreditTimeframes(0)
+  , fCreditBufferInMB(0)
+  , fMaxSpinInUs(50)
+  , fMembershipTimeoutInMs(3000)
+  , fVerifyChecksums(1)
+  , fReleasePolicy("complete")
+  , fReleaseDeadlineInMs(100)
+  , fEarlyRelease(false)
+  , fOccupancyInterval(32)
+  , fSession(0)
+  , fCreditFinished(0)
+  , fAssembler()
+  , fMembership()
+  , fRemovedFLPs()
+  , fParts()
+  , fHeaders()
+  , fLastTimeframeId(0)
+  , fOccupancy()
+  , fMessagePool()
+  , fTimers()
+  , fLoop()
+  , fWorkers()
+  , fSentParts()
+  , fForwarding(false)
+  , fLastReceive()
+  , fMetricReceived(NULL)
+  , fMetricReceivedBytes(NULL)
+  , fMetricCompleted(NULL)
+  , fMetricPartial(NULL)
+  , fMetricReleased(NULL)
+  , fMetricLateParts(NULL)
+  , fMetricChecksumFailures(NULL)
+  , fMetricDiscarded(NULL)
+  , fMetricRejected(NULL)
+  , fMetricDropNotices(NULL)
+  , fMetricEvents(NULL)
+  , fMetricBadBatches(NULL)
+  , fMetricAssembling(NULL)
+  , fMetricBuffered(NULL)
+  , fMetricMembers(NULL)
+  , fMetricAssemblyTime(NULL)
+  , fMetricReceiveInterval(NULL)
 {
 }
 
@@ -35,9 +76,8 @@ EPNex::~EPNex()
 {
 }
 
-void EPNex::PrintBuffer(unordered_map<uint64_t,timeframeBuffer> &buffer)
+void EPNex::PrintBuffer()
 {
-  int size = buffer.size();
   string header = "===== ";
 
   for (int i = 1; i <= fNumFLPs; ++i) {
@@ -48,32 +88,17 @@ void EPNex::PrintBuffer(unordered_map<uint64_t,timeframeBuffer> &buffer)
   }
   LOG(INFO) << header;
 
-  for (unordered_map<uint64_t,timeframeBuffer>::iterator it = buffer.begin(); it != buffer.end(); ++it) {
-    string stars = "";
-    for (int j = 1; j <= (it->second).count; ++j) {
-      stars += "*";
+  TimeframeWindow& window = fAssembler.GetWindow();
+  for (size_t i = 0; i < window.GetCapacity(); ++i) {
+    TimeframeWindow::Slot& slot = window.Get(i);
+    if (slot.state != TimeframeWindow::Slot::Assembling) {
+      continue;
     }
-    LOG(INFO) << setw(4) << it->first << ": " << stars;
-  }
-}
-
-void EPNex::DiscardIncompleteTimeframes()
-{
-  unordered_map<uint64_t,timeframeBuffer>::iterator it = fTimeframeBuffer.begin();
-  while (it != fTimeframeBuffer.end()) {
-    if ((boost::posix_time::microsec_clock::local_time() - (it->second).startTime).total_milliseconds() > fBufferTimeoutInMs) {
-      LOG(WARN) << "Timeframe #" << it->first << " incomplete after " << fBufferTimeoutInMs << " milliseconds, discarding";
-      fDiscardedSet.insert(it->first);
-      for(int i = 0; i < (it->second).parts.size(); ++i) {
-        delete (it->second).parts.at(i);
-      }
-      it->second.parts.clear();
-      fTimeframeBuffer.erase(it++);
-      LOG(WARN) << "Number of discarded timeframes: " << fDiscardedSet.size();
-    } else {
-      // LOG(INFO) << "Timeframe #" << it->first << " within timeout, buffering...";
-      ++it;
+    string stars = "";
+    for (int j = 0; j < fNumFLPs; ++j) {
+      stars += slot.parts[j] ? "*" : " ";
     }
+    LOG(INFO) << setw(4) << slot.id << ": " << stars;
   }
 }
 
@@ -82,168 +107,756 @@ void EPNex::Run()
   LOG(INFO) << ">>>>>>> Run <<<<<<<";
 
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
-  boost::thread heartbeatSender(boost::bind(&EPNex::sendHeartbeats, this));
+  Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
 
   FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
 
-  int SNDMORE = fPayloadInputs->at(0)->SNDMORE;
-  int NOBLOCK = fPayloadInputs->at(0)->NOBLOCK;
+  // output 0 publishes the heartbeats, one send reaches every FLP it is connected to.
+  for (size_t i = 0; i < fHeartbeatAddresses.size(); ++i) {
+    if (fHeartbeatAddresses.at(i) != GetProperty(OutputAddress, "", 0)) {
+      fPayloadOutputs->at(0)->Connect(fHeartbeatAddresses.at(i));
+    }
+  }
+
+  fLastReceive.assign(fNumFLPs, TimerWheel::Clock::time_point());
+
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  string label = Metrics::DeviceLabel(fId);
+  fMetricReceived = &metrics.AddCounter("o2_epn_sub_timeframes_received_total", "Sub-timeframes received from the FLPs", label);
+  fMetricReceivedBytes = &metrics.AddCounter("o2_epn_received_bytes_total", "Payload bytes received from the FLPs", label);
+  fMetricCompleted = &metrics.AddCounter("o2_epn_timeframes_completed_total", "Timeframes assembled and forwarded", label);
+  fMetricPartial = &metrics.AddCounter("o2_epn_timeframes_partial_total", "Timeframes forwarded with parts missing, of FLPs that have left or at the release deadline", label);
+  fMetricReleased = &metrics.AddCounter("o2_epn_timeframes_released_total", "Incomplete timeframes forwarded at the release deadline", label);
+  fMetricLateParts = &metrics.AddCounter("o2_epn_late_parts_total", "Parts arriving after their timeframe was forwarded without them", label);
+  fMetricChecksumFailures = &metrics.AddCounter("o2_epn_checksum_failures_total", "Sub-timeframes whose payload does not match their CRC32C", label);
+  fMetricDiscarded = &metrics.AddCounter("o2_epn_timeframes_discarded_total", "Incomplete timeframes discarded after the buffer timeout", label);
+  fMetricRejected = &metrics.AddCounter("o2_epn_sub_timeframes_rejected_total", "Duplicate sub-timeframes and parts of timeframes already gone", label);
+  fMetricEvents = &metrics.AddCounter("o2_epn_events_received_total", "Events received, a sub-timeframe that is no batch counts as one", label);
+  fMetricBadBatches = &metrics.AddCounter("o2_epn_malformed_batches_total", "Batched sub-timeframes whose offset table does not match the payload", label);
+  fMetricDropNotices = &metrics.AddCounter("o2_epn_drop_notices_total", "Notices of FLPs that dropped their part of a timeframe", label);
+  fMetricAssembling = &metrics.AddGauge("o2_epn_timeframes_assembling", "Timeframes waiting for parts", label);
+  fMetricBuffered = &metrics.AddGauge("o2_epn_buffered_messages", "Messages held in the assembly window", label);
+  fMetricMembers = &metrics.AddGauge("o2_epn_flps_expected", "FLPs whose parts are waited for", label);
+  fMetricAssemblyTime = &metrics.AddHistogram("o2_epn_assembly_time_us", "Time from the first to the last part of a timeframe", label);
+  fMetricReceiveInterval = &metrics.AddHistogram("o2_epn_receive_interval_us", "Time between two parts from the same FLP", label);
+
+  fSession = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+  fCreditFinished = 0;
+  fLastTimeframeId = 0;
+  fOccupancy.Init(max(fOccupancyInterval, 1));
+
+  if (fReleasePolicy == "early") {
+    fEarlyRelease = true;
+    fReleaseDeadlineInMs = max(fReleaseDeadlineInMs, 1);
+    LOG(INFO) << "Forwarding the timeframes with the parts they have " << fReleaseDeadlineInMs << " ms after their first part";
+  } else {
+    if (fReleasePolicy != "complete") {
+      LOG(ERROR) << "Unknown release policy \"" << fReleasePolicy << "\", forwarding complete timeframes only";
+    }
+    fEarlyRelease = false;
+  }
+
+  fMembership.Init(fNumFLPs, fMembershipTimeoutInMs, TimerWheel::Clock::now());
+  fMetricMembers->Set(fMembership.GetNumMembers());
+  if (fMembership.IsEnabled()) {
+    LOG(INFO) << "Waiting for the FLPs heard from in the last " << fMembershipTimeoutInMs << " ms";
+  }
+
+  if (fNumWorkers > 0) {
+    runWorkers(poller);
+  } else {
+    runSingle(poller);
+  }
+
+  delete poller;
+
+  rateLogger.interrupt();
+  rateLogger.join();
+
+  FairMQDevice::Shutdown();
+
+  // notify parent thread about end of processing.
+  boost::lock_guard<boost::mutex> lock(fRunningMutex);
+  fRunningFinished = true;
+  fRunningCondition.notify_one();
+}
+
+int EPNex::getFLPIndex(const SubTimeframeHeader& h) const
+{
+  // FLP ids are expected to be fNumFLPs consecutive numbers, which makes the modulo unique.
+  if (h.flpId < 0 || fNumFLPs <= 0) {
+    return -1;
+  }
+  return h.flpId % fNumFLPs;
+}
 
-  // DEBUG: store receive intervals per FLP
-  vector<vector<int>> rcvIntervals(fNumFLPs, vector<int>());
-  vector<boost::posix_time::ptime> rcvTimestamp(fNumFLPs);
-  // end DEBUG
+void EPNex::countEvents(const SubTimeframeHeader& h, FairMQMessage* dataPart)
+{
+  if (h.dataType != kDataTypeEventBatch) {
+    fMetricEvents->Increment();
+    return;
+  }
+
+  EventBatch batch(dataPart->GetData(), dataPart->GetSize());
+  if (!batch.IsValid()) {
+    // it is forwarded all the same, the consumer sees the same bytes.
+    LOG(ERROR) << "Timeframe #" << h.timeframeId << " from FLP " << h.flpId << " holds a malformed event batch";
+    fMetricBadBatches->Increment();
+    return;
+  }
+  fMetricEvents->Increment(batch.GetNumEvents());
+}
+
+void EPNex::runSingle(FairMQPoller* poller)
+{
+  // the header part, the sub-timeframes of a few timeframes in the buffer, the directory and the acknowledgement.
+  fMessagePool.Init(fTransportFactory, 4 * fNumFLPs + 3);
+
+  // timeframe expiry for every slot of the window plus the heartbeat and the membership check.
+  fTimers.Init(chrono::milliseconds(1), fWindowSize + 2, TimerWheel::Clock::now());
+  fAssembler.Init(fWindowSize, fNumFLPs, &fMessagePool, fBufferTimeoutInMs, fEarlyRelease ? fReleaseDeadlineInMs : 0, &fTimers, this);
+  fAssembler.SetMetrics(fMetricCompleted, fMetricPartial, fMetricReleased, fMetricDiscarded, fMetricDiscarded, fMetricAssemblyTime);
+  fTimers.Schedule(TimerWheel::Clock::now(), &TimerWheel::Member<EPNex, &EPNex::sendHeartbeats>, this, 0);
+  if (fMembership.IsEnabled()) {
+    fTimers.Schedule(TimerWheel::Clock::now(), &TimerWheel::Member<EPNex, &EPNex::checkMembership>, this, 0);
+  }
+  fLoop.Init(poller, fNumInputs, &fTimers, fMaxSpinInUs, 100, fId);
 
-  f2eHeader* h; // holds the header of the currently arrived message.
+  SubTimeframeHeader received;
+  SubTimeframeHeader* h; // holds the header of the currently arrived message.
   uint64_t id = 0; // holds the timeframe id of the currently arrived sub-timeframe.
   int rcvDataSize = 0;
 
   while (fState == RUNNING) {
-    poller->Poll(100);
+    // also discards incomplete timeframes that reached the timeout and sends the heartbeats when due.
+    fLoop.Wait();
 
     if (poller->CheckInput(0)) {
-      FairMQMessage* headerPart = fTransportFactory->CreateMessage();
+      FairMQMessage* headerPart = fMessagePool.Acquire();
 
       if (fPayloadInputs->at(0)->Receive(headerPart) > 0) {
+        FairMQMessage* dataPart = fMessagePool.Acquire();
+        rcvDataSize = fPayloadInputs->at(0)->Receive(dataPart);
+
+        if (!IsValidSubTimeframeHeader(headerPart->GetData(), headerPart->GetSize())) {
+          LOG(ERROR) << "Received a sub-timeframe without a valid header (version " << kTimeframeFormatVersion << " expected), dropping it";
+          fMessagePool.Release(dataPart);
+          fMessagePool.Release(headerPart);
+          fMetricRejected->Increment();
+          continue;
+        }
+
+        ReadSubTimeframeHeader(received, headerPart->GetData(), rcvDataSize > 0 ? rcvDataSize : 0);
+        h = &received;
+        int flpIndex = getFLPIndex(*h);
+        if (flpIndex < 0) {
+          LOG(ERROR) << "Received a sub-timeframe with the invalid FLP id " << h->flpId << ", dropping it";
+          fMessagePool.Release(dataPart);
+          fMessagePool.Release(headerPart);
+          fMetricRejected->Increment();
+          continue;
+        }
+        TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+
+        updateMembership(*h, flpIndex, now);
+        if (h->flags & (kKeepalive | kLeaving)) {
+          fMessagePool.Release(dataPart);
+          fMessagePool.Release(headerPart);
+          continue;
+        }
+
         // store the received ID
-        h = reinterpret_cast<f2eHeader*>(headerPart->GetData());
-        id = h->timeFrameId;
+        id = h->timeframeId;
+        updateLastTimeframeId(id);
+
+        if (h->flags & kDropped) {
+          // an FLP gave up its part: the timeframe is discarded, or with early release forwarded without it.
+          fMetricDropNotices->Increment();
+          fAssembler.Drop(id, flpIndex, now);
+          fMetricAssembling->Set(fAssembler.GetNumAssembling());
+          fMessagePool.Release(dataPart);
+          fMessagePool.Release(headerPart);
+          updateCredit();
+          continue;
+        }
         // LOG(INFO) << "Received Timeframe #" << id << " from FLP" << h->flpId;
 
-        // DEBUG:: store receive intervals per FLP
-        // if (fTestMode > 0) {
-        //   int flp_id = h->flpId - 1; // super dirty temporary hack 
-        //   if (to_simple_string(rcvTimestamp.at(flp_id)) != "not_a_date_time") {
-        //     rcvIntervals.at(flp_id).push_back( (boost::posix_time::microsec_clock::local_time() - rcvTimestamp.at(flp_id)).total_microseconds() );
-        //     // LOG(WARN) << rcvIntervals.at(flp_id).back();
-        //   }
-        //   rcvTimestamp.at(flp_id) = boost::posix_time::microsec_clock::local_time();
-        // }
-        // end DEBUG
-
-        FairMQMessage* dataPart = fTransportFactory->CreateMessage();
-        rcvDataSize = fPayloadInputs->at(0)->Receive(dataPart);
+        if (rcvDataSize > 0) {
+          countEvents(*h, dataPart);
 
-        if (fDiscardedSet.find(id) == fDiscardedSet.end()) {
-          // if received ID has not previously been discarded.
-          if (fTimeframeBuffer.find(id) == fTimeframeBuffer.end()) {
-            // if received ID is not yet in the buffer.
-            if (rcvDataSize > 0) {
-              // receive data, store it in the buffer, save the receive time.
-              fTimeframeBuffer[id].count = 1;
-              fTimeframeBuffer[id].parts.push_back(dataPart);
-              fTimeframeBuffer[id].startTime = boost::posix_time::microsec_clock::local_time();
-            } else {
-              LOG(ERROR) << "no data received from input socket";
-              delete dataPart;
-            }
-            // PrintBuffer(fTimeframeBuffer);
-          } else {
-            // if received ID is already in the buffer
-            if (rcvDataSize > 0) {
-              fTimeframeBuffer[id].count++;
-              fTimeframeBuffer[id].parts.push_back(dataPart);
-            } else {
-              LOG(ERROR) << "no data received from input socket 0";
-              delete dataPart;
-            }
-            // PrintBuffer(fTimeframeBuffer);
+          if (fVerifyChecksums > 0 && !VerifyPayloadChecksum(*h, dataPart->GetData(), dataPart->GetSize())) {
+            // forwarded all the same, the directory tells the consumer.
+            LOG(ERROR) << "Timeframe #" << id << " from FLP " << h->flpId << " does not match its checksum";
+            h->flags |= kChecksumFailed;
+            fMetricChecksumFailures->Increment();
+          }
+
+          fMetricReceived->Increment();
+          fMetricReceivedBytes->Increment(rcvDataSize);
+          if (fLastReceive[flpIndex] != TimerWheel::Clock::time_point()) {
+            fMetricReceiveInterval->Observe(chrono::duration_cast<chrono::microseconds>(now - fLastReceive[flpIndex]).count());
           }
+          fLastReceive[flpIndex] = now;
+
+          // a complete timeframe is forwarded right away.
+          switch (fAssembler.Add(*h, flpIndex, dataPart, now)) {
+            case TimeframeWindow::Added:
+            case TimeframeWindow::Completed:
+              break;
+            case TimeframeWindow::Released:
+              // expected with early release, the consumer has the timeframe already.
+              fMessagePool.Release(dataPart);
+              fMetricLateParts->Increment();
+              break;
+            case TimeframeWindow::Duplicate:
+              LOG(WARN) << "Received duplicate part from FLP " << h->flpId << " for timeframe with id " << id;
+              fMessagePool.Release(dataPart);
+              fMetricRejected->Increment();
+              break;
+            default:
+              // the timeframe has already been sent or discarded.
+              LOG(WARN) << "Received part from an already discarded timeframe with id " << id;
+              fMessagePool.Release(dataPart);
+              fMetricRejected->Increment();
+              break;
+          }
+          // PrintBuffer();
         } else {
-          // if received ID has been previously discarded.
-          LOG(WARN) << "Received part from an already discarded timeframe with id " << id;
-          delete dataPart;
+          LOG(ERROR) << "no data received from input socket 0";
+          fMessagePool.Release(dataPart);
         }
 
-        if (fTimeframeBuffer[id].count == fNumFLPs) {
-          // when all parts are collected send all except last one with 'snd-more' flag, and last one without the flag.
-          for (int i = 0; i < fNumFLPs - 1; ++i) {
-            fPayloadOutputs->at(fNumFLPs)->Send(fTimeframeBuffer[id].parts.at(i), SNDMORE);
+        fMetricAssembling->Set(fAssembler.GetNumAssembling());
+        fMetricBuffered->Set(fMessagePool.GetNumInUse());
+
+        // LOG(WARN) << "Buffer size: " << fAssembler.GetNumAssembling();
+      }
+      fMessagePool.Release(headerPart);
+    }
+
+    updateCredit();
+  }
+
+  fLoop.LogStatistics();
+
+  LOG(INFO) << "Number of discarded timeframes: " << fAssembler.GetWindow().GetNumDiscarded();
+  fAssembler.Clear();
+
+  LOG(INFO) << "Message pool: " << fMessagePool.GetNumAcquired() << " messages used, "
+            << fMessagePool.GetNumAllocations() << " allocated after start-up";
+}
+
+void EPNex::Forward(uint64_t id, TimeframeWindow::Slot& slot)
+{
+  int SNDMORE = fPayloadInputs->at(0)->SNDMORE;
+  int NOBLOCK = fPayloadInputs->at(0)->NOBLOCK;
+
+  // FLPs that have left leave gaps, the directory lists the parts present.
+  fParts.clear();
+  fHeaders.clear();
+  for (int i = 0; i < fNumFLPs; ++i) {
+    if (slot.parts[i] != NULL) {
+      fParts.push_back(slot.parts[i]);
+      fHeaders.push_back(slot.headers[i]);
+    }
+  }
+
+  if (fParts.empty()) {
+    // the assembler discards timeframes without parts, a directory alone would not be a timeframe either.
+    LOG(ERROR) << "Timeframe #" << id << " has no parts, not forwarding it";
+    return;
+  }
+
+  // the directory describes the parts that follow it, in FLP order, and the ones missing.
+  FairMQMessage* directoryPart = fMessagePool.Acquire();
+  directoryPart->Rebuild(GetTimeframeDirectorySize(fParts.size(), fNumFLPs));
+  WriteTimeframeDirectory(directoryPart->GetData(), id, fHeaders.data(), fParts.size(), slot.flpMask.data(), fNumFLPs);
+  fPayloadOutputs->at(1)->Send(directoryPart, SNDMORE);
+  fMessagePool.Release(directoryPart);
+
+  // when all parts are collected send all except last one with 'snd-more' flag, and last one without the flag.
+  for (size_t i = 0; i < fParts.size() - 1; ++i) {
+    fPayloadOutputs->at(1)->Send(fParts[i], SNDMORE);
+  }
+  fPayloadOutputs->at(1)->Send(fParts.back());
+
+  if (fTestMode > 0) {
+    // Send an acknowledgement back to the sampler to measure the round trip time
+    FairMQMessage* ack = fMessagePool.Acquire();
+    ack->Rebuild(sizeof(uint64_t));
+    memcpy(ack->GetData(), &id, sizeof(uint64_t));
+
+    if (fPayloadOutputs->at(2)->Send(ack, NOBLOCK) == 0) {
+      LOG(ERROR) << "Could not send acknowledgement without blocking";
+    }
+
+    fMessagePool.Release(ack);
+  }
+
+  // let transport know that the data is no longer needed. transport will clean up after it is sent out.
+  for (size_t i = 0; i < fParts.size(); ++i) {
+    fMessagePool.Release(fParts[i]);
+  }
+}
+
+void EPNex::runWorkers(FairMQPoller* poller)
+{
+  // a worker queue holds the parts of a few timeframes, beyond that the I/O thread stops reading
+  // and the socket buffers throttle the FLPs.
+  size_t queueCapacity = 16 * fNumFLPs;
+
+  // the header parts and the parts on their way to the workers, the rest comes back over the queues.
+  fMessagePool.Init(fTransportFactory, (queueCapacity + 1) * fNumWorkers + 2);
+
+  // the workers keep their own expiry timers, only the heartbeat and the membership check are left here.
+  fTimers.Init(chrono::milliseconds(1), 2, TimerWheel::Clock::now());
+  fTimers.Schedule(TimerWheel::Clock::now(), &TimerWheel::Member<EPNex, &EPNex::sendHeartbeats>, this, 0);
+  if (fMembership.IsEnabled()) {
+    fTimers.Schedule(TimerWheel::Clock::now(), &TimerWheel::Member<EPNex, &EPNex::checkMembership>, this, 0);
+  }
+  fLoop.Init(poller, fNumInputs, &fTimers, fMaxSpinInUs, 100, fId);
+
+  fWorkers.clear();
+  for (int k = 0; k < fNumWorkers; ++k) {
+    fWorkers.push_back(unique_ptr<AssemblyWorker>(new AssemblyWorker(queueCapacity)));
+    fWorkers.back()->Init(fTransportFactory, fWindowSize, fNumFLPs, fBufferTimeoutInMs, fEarlyRelease ? fReleaseDeadlineInMs : 0,
+                          fVerifyChecksums > 0);
+    fWorkers.back()->SetMetrics(fMetricCompleted, fMetricPartial, fMetricReleased, fMetricDiscarded, fMetricRejected,
+                                fMetricLateParts, fMetricChecksumFailures, fMetricAssemblyTime);
+    fWorkers.back()->Start();
+  }
+
+  fSentParts.reset(new SPSCQueue<FairMQMessage*>(queueCapacity * fNumWorkers));
+  fForwarding = true;
+  boost::thread output(boost::bind(&EPNex::forwardTimeframes, this));
+
+  LOG(INFO) << "Assembling timeframes on " << fNumWorkers << " worker threads";
+
+  while (fState == RUNNING) {
+    // also sends the heartbeats when due.
+    fLoop.Wait();
+
+    if (poller->CheckInput(0)) {
+      FairMQMessage* headerPart = fMessagePool.Acquire();
+
+      if (fPayloadInputs->at(0)->Receive(headerPart) > 0) {
+        FairMQMessage* dataPart = fMessagePool.Acquire();
+        int rcvDataSize = fPayloadInputs->at(0)->Receive(dataPart);
+
+        SubTimeframeHeader header;
+        bool dropped = false;
+        int flpIndex = -1;
+        if (!IsValidSubTimeframeHeader(headerPart->GetData(), headerPart->GetSize())) {
+          LOG(ERROR) << "Received a sub-timeframe without a valid header (version " << kTimeframeFormatVersion << " expected), dropping it";
+          fMetricRejected->Increment();
+          rcvDataSize = 0;
+        } else {
+          ReadSubTimeframeHeader(header, headerPart->GetData(), rcvDataSize > 0 ? rcvDataSize : 0);
+          SubTimeframeHeader* h = &header;
+          flpIndex = getFLPIndex(*h);
+          if (flpIndex < 0) {
+            LOG(ERROR) << "Received a sub-timeframe with the invalid FLP id " << h->flpId << ", dropping it";
+            fMetricRejected->Increment();
+            rcvDataSize = 0;
+          } else {
+            // the notice of an FLP that dropped its part has an empty payload, the worker discards the timeframe
+            // or, with early release, forwards it without that part.
+            dropped = h->flags & kDropped;
+            // keepalive and leave notices end here, the workers only learn about changes of the membership.
+            updateMembership(*h, flpIndex, TimerWheel::Clock::now());
+            if (h->flags & (kKeepalive | kLeaving)) {
+              rcvDataSize = 0;
+            }
           }
-          fPayloadOutputs->at(fNumFLPs)->Send(fTimeframeBuffer[id].parts.at(fNumFLPs - 1));
+        }
+
+        if (rcvDataSize > 0 || dropped) {
+          SubTimeframeHeader* h = &header;
+          uint64_t id = h->timeframeId;
+          updateLastTimeframeId(id);
 
-          if (fTestMode > 0) {
-            // Send an acknowledgement back to the sampler to measure the round trip time
-            FairMQMessage* ack = fTransportFactory->CreateMessage(sizeof(uint64_t));
-            memcpy(ack->GetData(), &id, sizeof(uint64_t));
+          TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
 
-            if (fPayloadOutputs->at(fNumFLPs + 1)->Send(ack, NOBLOCK) == 0) {
-              LOG(ERROR) << "Could not send acknowledgement without blocking";
+          if (dropped) {
+            fMetricDropNotices->Increment();
+          } else {
+            fMetricReceived->Increment();
+            fMetricReceivedBytes->Increment(rcvDataSize);
+            countEvents(*h, dataPart);
+            if (fLastReceive[flpIndex] != TimerWheel::Clock::time_point()) {
+              fMetricReceiveInterval->Observe(chrono::duration_cast<chrono::microseconds>(now - fLastReceive[flpIndex]).count());
             }
+            fLastReceive[flpIndex] = now;
+          }
 
-            delete ack;
+          // all parts of a timeframe go to the same worker, which owns it alone.
+          AssemblyWorker::Part part = { id, flpIndex, *h, dataPart };
+          if (!pushToWorker(*fWorkers[id % fNumWorkers], part)) {
+            fMessagePool.Release(dataPart);
           }
+        } else {
+          fMessagePool.Release(dataPart);
+        }
+      }
+      fMessagePool.Release(headerPart);
+    }
+
+    returnMessages();
+
+    fMetricAssembling->Set(getNumAssembling());
+    fMetricBuffered->Set(fMessagePool.GetNumInUse());
+
+    updateCredit();
+  }
+
+  fLoop.LogStatistics();
+
+  // the workers first, they may wait on the output queue, which is abandoned when the output thread stops.
+  for (size_t k = 0; k < fWorkers.size(); ++k) {
+    fWorkers[k]->Stop();
+  }
+  fForwarding = false;
+  output.join();
+
+  returnMessages();
+  for (size_t k = 0; k < fWorkers.size(); ++k) {
+    AssemblyWorker::Output left;
+    while (fWorkers[k]->PopOutput(left)) {
+      fMessagePool.Release(left.data);
+    }
+  }
+
+  unsigned long numDiscarded = 0;
+  for (size_t k = 0; k < fWorkers.size(); ++k) {
+    numDiscarded += fWorkers[k]->GetNumDiscarded();
+  }
+  LOG(INFO) << "Number of discarded timeframes: " << numDiscarded;
+  LOG(INFO) << "Message pool: " << fMessagePool.GetNumAcquired() << " messages used, "
+            << fMessagePool.GetNumAllocations() << " allocated after start-up";
+
+  fWorkers.clear();
+  fSentParts.reset();
+}
+
+void EPNex::forwardTimeframes()
+{
+  int SNDMORE = fPayloadInputs->at(0)->SNDMORE;
+  int NOBLOCK = fPayloadInputs->at(0)->NOBLOCK;
+
+  // the pool of the I/O thread is not to be touched from here, this one holds the directories and acknowledgements.
+  MessagePool outputPool;
+  outputPool.Init(fTransportFactory, 2);
+
+  vector<FairMQMessage*> parts;
+  vector<SubTimeframeHeader> headers;
+  vector<uint64_t> present(GetMissingMaskWords(fNumFLPs));
+  parts.reserve(fNumFLPs);
+  headers.reserve(fNumFLPs);
+
+  Backoff backoff;
+  size_t next = 0;
+
+  while (fForwarding.load()) {
+    bool sent = false;
+
+    for (size_t n = 0; n < fWorkers.size() && fForwarding.load(); ++n) {
+      AssemblyWorker& worker = *fWorkers[(next + n) % fWorkers.size()];
+      AssemblyWorker::Output output;
+      if (!worker.PopOutput(output)) {
+        continue;
+      }
+
+      // the worker pushes the parts of a timeframe back to back, collect them for the directory.
+      uint64_t id = output.id;
+      parts.clear();
+      headers.clear();
+      present.assign(present.size(), 0);
+      bool collected = false;
+      Backoff partBackoff;
+      while (true) {
+        parts.push_back(output.data);
+        headers.push_back(output.header);
+        present[output.flpIndex / 64] |= 1ULL << (output.flpIndex % 64);
+        if (output.last) {
+          collected = true;
+          break;
+        }
+        while (!worker.PopOutput(output) && fForwarding.load()) {
+          partBackoff.Pause();
+        }
+        if (!fForwarding.load()) {
+          break;
+        }
+        partBackoff.Reset();
+      }
 
-          // let transport know that the data is no longer needed. transport will clean up after it is sent out.
-          for(int i = 0; i < fTimeframeBuffer[id].parts.size(); ++i) {
-            delete fTimeframeBuffer[id].parts.at(i);
+      if (collected) {
+        // fewer parts than FLPs when some have left or at the release deadline, see AssemblyWorker::Forward().
+        FairMQMessage* directoryPart = outputPool.Acquire();
+        directoryPart->Rebuild(GetTimeframeDirectorySize(parts.size(), fNumFLPs));
+        WriteTimeframeDirectory(directoryPart->GetData(), id, headers.data(), parts.size(), present.data(), fNumFLPs);
+        fPayloadOutputs->at(1)->Send(directoryPart, SNDMORE);
+        outputPool.Release(directoryPart);
+
+        for (size_t i = 0; i < parts.size() - 1; ++i) {
+          fPayloadOutputs->at(1)->Send(parts[i], SNDMORE);
+        }
+        fPayloadOutputs->at(1)->Send(parts.back());
+
+        if (fTestMode > 0) {
+          // Send an acknowledgement back to the sampler to measure the round trip time
+          FairMQMessage* ack = outputPool.Acquire();
+          ack->Rebuild(sizeof(uint64_t));
+          memcpy(ack->GetData(), &id, sizeof(uint64_t));
+
+          if (fPayloadOutputs->at(2)->Send(ack, NOBLOCK) == 0) {
+            LOG(ERROR) << "Could not send acknowledgement without blocking";
           }
-          fTimeframeBuffer[id].parts.clear();
 
-          // fTimeframeBuffer[id].endTime = boost::posix_time::microsec_clock::local_time();
-          // do something with time here ...
-          fTimeframeBuffer.erase(id);
+          outputPool.Release(ack);
         }
+      }
 
-        // LOG(WARN) << "Buffer size: " << fTimeframeBuffer.size();
+      for (size_t i = 0; i < parts.size(); ++i) {
+        returnSent(parts[i]);
       }
-      delete headerPart;
+
+      sent = true;
+      next = (next + n + 1) % fWorkers.size();
+      break;
+    }
+
+    if (sent) {
+      backoff.Reset();
+    } else {
+      backoff.Pause();
     }
+  }
+}
 
-    // check if any incomplete timeframes in the buffer are older than timeout period, and discard them if they are
-    DiscardIncompleteTimeframes();
+bool EPNex::pushToWorker(AssemblyWorker& worker, const AssemblyWorker::Part& part)
+{
+  Backoff backoff;
+  while (!worker.Push(part)) {
+    // keep taking the messages back meanwhile, the worker may be waiting for the output thread.
+    returnMessages();
+    if (fState != RUNNING) {
+      return false;
+    }
+    backoff.Pause();
   }
+  return true;
+}
 
-  // DEBUG: save
-  // if (fTestMode > 0) {
-  //   string name = to_iso_string(boost::posix_time::microsec_clock::local_time()).substr(0, 20);
-  //   for (int x = 0; x < fNumFLPs; ++x) {
-  //     ofstream flpRcvTimes(fId + "-" + name + "-flp-" + to_string(x) + ".log");
-  //     for (auto it = rcvIntervals.at(x).begin() ; it != rcvIntervals.at(x).end(); ++it) {
-  //       flpRcvTimes << *it << endl;
-  //     }
-  //     flpRcvTimes.close();
-  //   }
-  // }
-  // end DEBUG
+void EPNex::updateMembership(const SubTimeframeHeader& h, int flpIndex, TimerWheel::Clock::time_point now)
+{
+  if (h.flags & kLeaving) {
+    if (fMembership.Remove(flpIndex)) {
+      LOG(INFO) << "FLP " << h.flpId << " has left, waiting for the remaining " << fMembership.GetNumMembers() << " FLPs";
+      forgoFLP(flpIndex);
+    }
+    return;
+  }
 
-  rateLogger.interrupt();
-  rateLogger.join();
+  if (fMembership.Refresh(flpIndex, now)) {
+    LOG(INFO) << "FLP " << h.flpId << " is back, waiting for its parts from its next timeframe on";
+    expectFLP(flpIndex);
+  }
+}
+
+void EPNex::checkMembership(uint64_t)
+{
+  TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+
+  fRemovedFLPs.clear();
+  fMembership.Expire(now, fRemovedFLPs);
+  for (size_t i = 0; i < fRemovedFLPs.size(); ++i) {
+    LOG(WARN) << "Nothing from FLP#" << fRemovedFLPs[i] << " for " << fMembershipTimeoutInMs
+              << " ms, waiting for the remaining " << fMembership.GetNumMembers() << " FLPs";
+    forgoFLP(fRemovedFLPs[i]);
+  }
 
-  heartbeatSender.interrupt();
-  heartbeatSender.join();
+  // a quarter of the timeout bounds the detection delay to 1.25 timeouts.
+  fTimers.Schedule(now + chrono::milliseconds(max(fMembershipTimeoutInMs / 4, 1)),
+                   &TimerWheel::Member<EPNex, &EPNex::checkMembership>, this, 0);
+}
 
-  FairMQDevice::Shutdown();
+void EPNex::forgoFLP(int flpIndex)
+{
+  fMetricMembers->Set(fMembership.GetNumMembers());
+
+  if (!fWorkers.empty()) {
+    // every worker has timeframes of its own waiting for the FLP.
+    AssemblyWorker::Part change = { 0, flpIndex, SubTimeframeHeader(), NULL };
+    change.header.flags = kLeaving;
+    for (size_t k = 0; k < fWorkers.size(); ++k) {
+      pushToWorker(*fWorkers[k], change);
+    }
+    return;
+  }
 
-  // notify parent thread about end of processing.
-  boost::lock_guard<boost::mutex> lock(fRunningMutex);
-  fRunningFinished = true;
-  fRunningCondition.notify_one();
+  fAssembler.Forgo(flpIndex);
+
+  fMetricAssembling->Set(fAssembler.GetNumAssembling());
+  updateCredit();
 }
 
-void EPNex::sendHeartbeats()
+void EPNex::expectFLP(int flpIndex)
 {
-  while (true) {
-    try {
-      for (int i = 0; i < fNumFLPs; ++i) {
-        FairMQMessage* heartbeatMsg = fTransportFactory->CreateMessage(fInputAddress.at(0).size());
-        memcpy(heartbeatMsg->GetData(), fInputAddress.at(0).c_str(), fInputAddress.at(0).size());
+  fMetricMembers->Set(fMembership.GetNumMembers());
 
-        fPayloadOutputs->at(i)->Send(heartbeatMsg);
+  if (!fWorkers.empty()) {
+    AssemblyWorker::Part change = { 0, flpIndex, SubTimeframeHeader(), NULL };
+    change.header.flags = kKeepalive;
+    for (size_t k = 0; k < fWorkers.size(); ++k) {
+      pushToWorker(*fWorkers[k], change);
+    }
+    return;
+  }
 
-        delete heartbeatMsg;
-      }
-      boost::this_thread::sleep(boost::posix_time::milliseconds(fHeartbeatIntervalInMs));
-    } catch (boost::thread_interrupted&) {
-      LOG(INFO) << "EPNex::sendHeartbeat() interrupted";
-      break;
+  fAssembler.Expect(flpIndex);
+}
+
+void EPNex::returnSent(FairMQMessage* msg)
+{
+  Backoff backoff;
+  while (!fSentParts->TryPush(msg)) {
+    if (!fForwarding.load()) {
+      // the I/O thread is done, nothing takes it back anymore.
+      delete msg;
+      return;
+    }
+    backoff.Pause();
+  }
+}
+
+void EPNex::returnMessages()
+{
+  FairMQMessage* msg;
+  for (size_t k = 0; k < fWorkers.size(); ++k) {
+    while (fWorkers[k]->PopReturned(msg)) {
+      fMessagePool.Release(msg);
     }
-  } // while (true)
+  }
+  while (fSentParts->TryPop(msg)) {
+    fMessagePool.Release(msg);
+  }
+}
+
+int EPNex::getNumAssembling() const
+{
+  if (fWorkers.empty()) {
+    return fAssembler.GetNumAssembling();
+  }
+
+  int numAssembling = 0;
+  for (size_t k = 0; k < fWorkers.size(); ++k) {
+    numAssembling += fWorkers[k]->GetNumAssembling();
+  }
+  return numAssembling;
+}
+
+uint64_t EPNex::getNumFinished() const
+{
+  if (fWorkers.empty()) {
+    return fAssembler.GetNumFinished();
+  }
+
+  uint64_t numFinished = 0;
+  for (size_t k = 0; k < fWorkers.size(); ++k) {
+    numFinished += fWorkers[k]->GetNumFinished();
+  }
+  return numFinished;
+}
+
+void EPNex::sendCredit()
+{
+  EPNCredit credit;
+  credit.magic = kEPNCreditMagic;
+  credit.epnIndex = fEPNIndex;
+  credit.session = fSession;
+  credit.finished = getNumFinished();
+  // in the threaded mode every worker has a window of its own.
+  uint64_t capacity = fWorkers.empty() ? fAssembler.GetCapacity() : fWindowSize * fWorkers.size();
+  credit.limit = credit.finished + (fCreditTimeframes > 0 ? fCreditTimeframes : capacity);
+  credit.bytesPerFLP = (static_cast<uint64_t>(fCreditBufferInMB) << 20) / fNumFLPs;
+
+  FairMQMessage* creditMsg = fMessagePool.Acquire();
+  creditMsg->Rebuild(sizeof(EPNCredit));
+  memcpy(creditMsg->GetData(), &credit, sizeof(EPNCredit));
+
+  fPayloadOutputs->at(0)->Send(creditMsg);
+
+  fMessagePool.Release(creditMsg);
+
+  fCreditFinished = credit.finished;
+}
+
+void EPNex::updateCredit()
+{
+  // a quarter of the credit keeps the FLPs going without a message per timeframe.
+  uint64_t step = max<uint64_t>((fCreditTimeframes > 0 ? fCreditTimeframes : fWindowSize) / 4, 1);
+  if (getNumFinished() >= fCreditFinished + step) {
+    sendCredit();
+  }
+}
+
+void EPNex::sendHeartbeat()
+{
+  // every FLP gets the same occupancy report, so that they agree on the EPN of each timeframe.
+  EPNHeartbeat heartbeat;
+  heartbeat.epnIndex = fEPNIndex;
+  // in the threaded mode every worker has a window of its own.
+  int capacity = fWorkers.empty() ? fAssembler.GetCapacity() : fWindowSize * fWorkers.size();
+  heartbeat.freeSlots = capacity - getNumAssembling();
+  heartbeat.effectiveFrom = fOccupancy.Stamp(fLastTimeframeId);
+  heartbeat.session = fSession;
+  heartbeat.timestamp = chrono::duration_cast<chrono::microseconds>(TimerWheel::Clock::now().time_since_epoch()).count();
+
+  FairMQMessage* heartbeatMsg = fMessagePool.Acquire();
+  heartbeatMsg->Rebuild(sizeof(EPNHeartbeat));
+  memcpy(heartbeatMsg->GetData(), &heartbeat, sizeof(EPNHeartbeat));
+
+  fPayloadOutputs->at(0)->Send(heartbeatMsg);
+
+  fMessagePool.Release(heartbeatMsg);
+}
+
+void EPNex::sendHeartbeats(uint64_t)
+{
+  sendHeartbeat();
+
+  // repeated with every heartbeat, in case the FLP missed one or has just connected.
+  sendCredit();
+
+  fTimers.Schedule(TimerWheel::Clock::now() + chrono::milliseconds(fHeartbeatIntervalInMs),
+                   &TimerWheel::Member<EPNex, &EPNex::sendHeartbeats>, this, 0);
+}
+
+void EPNex::updateLastTimeframeId(uint64_t id)
+{
+  if (id > fLastTimeframeId) {
+    fLastTimeframeId = id;
+  }
+
+  // the heartbeats alone would leave the FLPs with an occupancy seconds old.
+  if (fOccupancy.IsDue(fLastTimeframeId)) {
+    sendHeartbeat();
+  }
 }
 
 void EPNex::SetProperty(const int key, const string& value, const int slot/*= 0*/)
 {
   switch (key) {
+    case HeartbeatAddress:
+      if (fHeartbeatAddresses.size() <= static_cast<size_t>(slot)) {
+        fHeartbeatAddresses.resize(slot + 1);
+      }
+      fHeartbeatAddresses.at(slot) = value;
+      break;
+    case ReleasePolicy:
+      fReleasePolicy = value;
+      break;
     default:
       FairMQDevice::SetProperty(key, value, slot);
       break;
@@ -253,6 +866,10 @@ void EPNex::SetProperty(const int key, const string& value, const int slot/*= 0*
 string EPNex::GetProperty(const int key, const string& default_/*= ""*/, const int slot/*= 0*/)
 {
   switch (key) {
+    case HeartbeatAddress:
+      return static_cast<size_t>(slot) < fHeartbeatAddresses.size() ? fHeartbeatAddresses.at(slot) : default_;
+    case ReleasePolicy:
+      return fReleasePolicy;
     default:
       return FairMQDevice::GetProperty(key, default_, slot);
   }
@@ -273,6 +890,36 @@ void EPNex::SetProperty(const int key, const int value, const int slot/*= 0*/)
     case TestMode:
       fTestMode = value;
       break;
+    case WindowSize:
+      fWindowSize = value;
+      break;
+    case EPNIndex:
+      fEPNIndex = value;
+      break;
+    case NumWorkers:
+      fNumWorkers = value;
+      break;
+    case CreditTimeframes:
+      fCreditTimeframes = value;
+      break;
+    case CreditBufferInMB:
+      fCreditBufferInMB = value;
+      break;
+    case MaxSpinInUs:
+      fMaxSpinInUs = value;
+      break;
+    case MembershipTimeoutInMs:
+      fMembershipTimeoutInMs = value;
+      break;
+    case VerifyChecksums:
+      fVerifyChecksums = value;
+      break;
+    case ReleaseDeadlineInMs:
+      fReleaseDeadlineInMs = value;
+      break;
+    case OccupancyInterval:
+      fOccupancyInterval = value;
+      break;
     default:
       FairMQDevice::SetProperty(key, value, slot);
       break;
@@ -290,6 +937,26 @@ int EPNex::GetProperty(const int key, const int default_/*= 0*/, const int slot/
       return fNumFLPs;
     case TestMode:
       return fTestMode;
+    case WindowSize:
+      return fWindowSize;
+    case EPNIndex:
+      return fEPNIndex;
+    case NumWorkers:
+      return fNumWorkers;
+    case CreditTimeframes:
+      return fCreditTimeframes;
+    case CreditBufferInMB:
+      return fCreditBufferInMB;
+    case MaxSpinInUs:
+      return fMaxSpinInUs;
+    case MembershipTimeoutInMs:
+      return fMembershipTimeoutInMs;
+    case VerifyChecksums:
+      return fVerifyChecksums;
+    case ReleaseDeadlineInMs:
+      return fReleaseDeadlineInMs;
+    case OccupancyInterval:
+      return fOccupancyInterval;
     default:
       return FairMQDevice::GetProperty(key, default_, slot);
   }
@@ -9,25 +9,30 @@
 #define ALICEO2_DEVICES_EPNEX_H_
 
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
-
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include <vector>
+#include <memory>
+#include <atomic>
 
 #include "FairMQDevice.h"
 
+#include "Metrics.h"
+
+#include "AssemblyWorker.h"
+#include "EPNSelector.h"
+#include "EventBatch.h"
+#include "EventLoop.h"
+#include "FLPMembership.h"
+#include "FlowControl.h"
+#include "MessagePool.h"
+#include "SPSCQueue.h"
+#include "TimeframeAssembler.h"
+#include "TimeframeHeader.h"
+#include "TimerWheel.h"
+
 namespace AliceO2 {
 namespace Devices {
 
-struct timeframeBuffer
-{
-  int count;
-  vector<FairMQMessage*> parts;
-  boost::posix_time::ptime startTime;
-  boost::posix_time::ptime endTime;
-};
-
-class EPNex : public FairMQDevice
+class EPNex : public FairMQDevice, private TimeframeAssembler::Output
 {
   public:
     enum {
@@ -35,14 +40,25 @@ class EPNex : public FairMQDevice
       NumFLPs,
       BufferTimeoutInMs,
       TestMode,
+      WindowSize,
+      EPNIndex,
+      HeartbeatAddress,
+      NumWorkers,
+      CreditTimeframes,
+      CreditBufferInMB,
+      MaxSpinInUs,
+      MembershipTimeoutInMs,
+      VerifyChecksums,
+      ReleasePolicy,
+      ReleaseDeadlineInMs,
+      OccupancyInterval,
       Last
     };
 
     EPNex();
     virtual ~EPNex();
 
-    void PrintBuffer(std::unordered_map<uint64_t,timeframeBuffer> &buffer);
-    void DiscardIncompleteTimeframes();
+    void PrintBuffer();
 
     virtual void SetProperty(const int key, const std::string& value, const int slot = 0);
     virtual std::string GetProperty(const int key, const std::string& default_ = "", const int slot = 0);
@@ -51,15 +67,97 @@ class EPNex : public FairMQDevice
 
   protected:
     virtual void Run();
-    void sendHeartbeats();
+    void runSingle(FairMQPoller* poller);
+    void runWorkers(FairMQPoller* poller);
+    void forwardTimeframes();
+    void returnSent(FairMQMessage* msg);
+    /// index of the sending FLP in the window and the membership, -1 for an id that cannot be one
+    int getFLPIndex(const SubTimeframeHeader& h) const;
+    /// events of a sub-timeframe, unpacking batches. An FLP sends a batch once it has the events of all its
+    /// ids, a slow input delays the batch and with it the whole timeframe without bound.
+    void countEvents(const SubTimeframeHeader& h, FairMQMessage* dataPart);
+    /// single mode: sends the parts present in FLP order behind their directory
+    virtual void Forward(uint64_t id, TimeframeWindow::Slot& slot);
+    /// hands a part to a worker, false if the device stopped while its queue was full
+    bool pushToWorker(AssemblyWorker& worker, const AssemblyWorker::Part& part);
+    /// every valid header refreshes its FLP in the membership, a leave notice removes it
+    void updateMembership(const SubTimeframeHeader& h, int flpIndex, TimerWheel::Clock::time_point now);
+    void checkMembership(uint64_t);
+    /// stops waiting for the parts of an FLP that has left, forwarding the timeframes complete without it
+    void forgoFLP(int flpIndex);
+    /// waits for the parts of an FLP that is back, from its next timeframe on
+    void expectFLP(int flpIndex);
+    void returnMessages();
+    int getNumAssembling() const;
+    uint64_t getNumFinished() const;
+    /// the heartbeat with the occupancy report, to all FLPs
+    void sendHeartbeat();
+    void sendHeartbeats(uint64_t);
+    /// the newest timeframe id received, sends the occupancy report once it enters a new epoch
+    void updateLastTimeframeId(uint64_t id);
+    void sendCredit();
+    /// sends the credit when enough timeframes have finished since the last one
+    void updateCredit();
 
     int fHeartbeatIntervalInMs;
     int fBufferTimeoutInMs;
     int fNumFLPs;
     int fTestMode; // run in test mode
+    int fWindowSize; // number of timeframes that can be assembled at the same time
+    int fEPNIndex; // position of this EPN in the output list of the FLPs
+    int fNumWorkers; // assembly threads, 0 assembles on the I/O thread
+    std::vector<std::string> fHeartbeatAddresses; // heartbeat inputs of all FLPs, connected to by the heartbeat output
+    int fCreditTimeframes; // timeframes the FLPs may have in flight, 0 for the capacity of the window(s)
+    int fCreditBufferInMB; // payload the FLPs may have in flight together, 0 for no limit
+    int fMaxSpinInUs; // longest spin of the I/O loop before it sleeps, 0 never spins
+    int fMembershipTimeoutInMs; // an FLP silent for this long is no longer waited for, 0 always waits for all
+    int fVerifyChecksums; // check the payloads that carry a checksum (1) or not (0)
+    std::string fReleasePolicy; // when to forward the timeframes: complete/early
+    int fReleaseDeadlineInMs; // early release: time from the first part to forwarding what is there
+    bool fEarlyRelease;
+    int fOccupancyInterval; // timeframes per occupancy report, more than are in flight between the FLPs and the EPN
+
+    uint64_t fSession; // start time, tells the FLPs that the credit counts and the heartbeat clock start again
+    uint64_t fCreditFinished; // finished count of the last credit sent
+
+    TimeframeAssembler fAssembler; // single mode
+    FLPMembership fMembership;
+    std::vector<int> fRemovedFLPs;
+    std::vector<FairMQMessage*> fParts; // parts of the timeframe being forwarded
+    std::vector<SubTimeframeHeader> fHeaders;
+    uint64_t fLastTimeframeId; // highest timeframe id received, basis for the effective id of occupancy reports
+    OccupancyStamper fOccupancy;
+
+    MessagePool fMessagePool;
+    TimerWheel fTimers;
+    EventLoop fLoop;
+
+    // threaded mode: the Run() thread receives and sends heartbeats, the workers assemble the
+    // timeframes of their shard and forwardTimeframes() sends them out on its own thread.
+    std::vector<std::unique_ptr<AssemblyWorker> > fWorkers;
+    std::unique_ptr<SPSCQueue<FairMQMessage*> > fSentParts; // sent parts back to the I/O thread
+    std::atomic<bool> fForwarding;
+
+    std::vector<TimerWheel::Clock::time_point> fLastReceive; // per FLP, for the receive intervals
 
-    std::unordered_map<uint64_t,timeframeBuffer> fTimeframeBuffer;
-    std::unordered_set<uint64_t> fDiscardedSet;
+    // metrics, registered in Run() with the device id as label
+    Metrics::Counter* fMetricReceived; // sub-timeframes
+    Metrics::Counter* fMetricReceivedBytes;
+    Metrics::Counter* fMetricCompleted;
+    Metrics::Counter* fMetricPartial; // forwarded with parts missing
+    Metrics::Counter* fMetricReleased; // forwarded incomplete at the release deadline
+    Metrics::Counter* fMetricLateParts; // parts of timeframes forwarded without them
+    Metrics::Counter* fMetricChecksumFailures;
+    Metrics::Counter* fMetricDiscarded; // timed out or evicted from the window
+    Metrics::Counter* fMetricRejected; // duplicate or late parts
+    Metrics::Counter* fMetricDropNotices; // timeframes dropped by an FLP
+    Metrics::Counter* fMetricEvents;
+    Metrics::Counter* fMetricBadBatches;
+    Metrics::Gauge* fMetricAssembling; // timeframes in flight
+    Metrics::Gauge* fMetricBuffered; // messages held from the pool
+    Metrics::Gauge* fMetricMembers; // FLPs waited for
+    Metrics::Histogram* fMetricAssemblyTime; // us from the first to the last part
+    Metrics::Histogram* fMetricReceiveInterval; // us between two parts of the same FLP
 };
 
 } // namespace Devices
@@ -0,0 +1,65 @@
+/**
+ * FLPMembership.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include "FLPMembership.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+FLPMembership::FLPMembership()
+  : fLastHeard()
+  , fMember()
+  , fNumMembers(0)
+  , fTimeout(Clock::duration::zero())
+{
+}
+
+void FLPMembership::Init(int numFLPs, int timeoutInMs, Clock::time_point now)
+{
+  fLastHeard.assign(numFLPs, now);
+  fMember.assign(numFLPs, true);
+  fNumMembers = numFLPs;
+  fTimeout = chrono::milliseconds(timeoutInMs > 0 ? timeoutInMs : 0);
+}
+
+bool FLPMembership::Refresh(int flpIndex, Clock::time_point now)
+{
+  fLastHeard[flpIndex] = now;
+
+  if (fMember[flpIndex]) {
+    return false;
+  }
+  fMember[flpIndex] = true;
+  ++fNumMembers;
+  return true;
+}
+
+bool FLPMembership::Remove(int flpIndex)
+{
+  if (!IsEnabled() || !fMember[flpIndex]) {
+    return false;
+  }
+  fMember[flpIndex] = false;
+  --fNumMembers;
+  return true;
+}
+
+void FLPMembership::Expire(Clock::time_point now, vector<int>& removed)
+{
+  if (!IsEnabled()) {
+    return;
+  }
+
+  Clock::time_point deadline = now - fTimeout;
+  for (size_t i = 0; i < fMember.size(); ++i) {
+    if (fMember[i] && fLastHeard[i] < deadline) {
+      fMember[i] = false;
+      --fNumMembers;
+      removed.push_back(i);
+    }
+  }
+}
@@ -0,0 +1,56 @@
+/**
+ * FLPMembership.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_FLPMEMBERSHIP_H_
+#define ALICEO2_DEVICES_FLPMEMBERSHIP_H_
+
+#include <vector>
+
+#include "TimerWheel.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// The FLPs an EPN expects parts from, the reverse of the liveness table the
+/// FLPs keep of the EPNs.
+///
+/// The FLPs keep themselves in the view: every sub-timeframe and every
+/// keepalive notice refreshes an FLP, a leave notice removes it at once and
+/// Expire() removes the FLPs silent for the timeout. All FLPs are members
+/// from Init() on until they have been silent for the timeout, so an FLP that
+/// never starts stops being waited for after one timeout. A timeout of 0
+/// disables the tracking, all FLPs then stay members.
+class FLPMembership
+{
+  public:
+    typedef TimerWheel::Clock Clock;
+
+    FLPMembership();
+
+    void Init(int numFLPs, int timeoutInMs, Clock::time_point now);
+
+    /// the FLP has been heard from, returns true if it was not a member and joins again
+    bool Refresh(int flpIndex, Clock::time_point now);
+    /// the FLP leaves, returns true if it was a member
+    bool Remove(int flpIndex);
+    /// removes the members silent for the timeout and appends their indices to removed
+    void Expire(Clock::time_point now, std::vector<int>& removed);
+
+    bool IsEnabled() const { return fTimeout > Clock::duration::zero(); }
+    bool IsMember(int flpIndex) const { return fMember[flpIndex]; }
+    int GetNumMembers() const { return fNumMembers; }
+
+  private:
+    std::vector<Clock::time_point> fLastHeard;
+    std::vector<bool> fMember;
+    int fNumMembers;
+    Clock::duration fTimeout;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -7,6 +7,8 @@
 
 #include <vector>
 #include <cstdint> // UINT64_MAX
+#include <sstream>
+#include <algorithm> // max
 
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
@@ -15,25 +17,53 @@
 #include "FairMQPoller.h"
 
 #include "FLPex.h"
+#include "Crc32c.h"
+#include "Placement.h"
 
 using namespace std;
-using boost::posix_time::ptime;
 
 using namespace AliceO2::Devices;
 
-struct f2eHeader {
-  uint64_t timeFrameId;
-  int      flpId;
-};
-
 FLPex::FLPex()
   : fHeartbeatTimeoutInMs(20000)
-  , fOutputHeartbeat()
   , fSendOffset(0)
-  , fHeaderBuffer()
-  , fDataBuffer()
+  , fOutputRate(0)
+  , fOutputBurst(0)
+  , fNumSlots(0)
+  , fSlotLength(1000)
+  , fFlowControl(0)
+  , fQueueCapacity(256)
+  , fMaxSpinInUs(50)
+  , fBatchEvents(1)
+  , fKeepaliveIntervalInMs(1000)
+  , fChecksum(0)
+  , fQueueDropPolicy("timeframe")
+  , fBatch()
+  , fBatchTimeframeId(0)
+  , fEPNSelection("round-robin")
+  , fEPNWeights()
+  , fScheduler()
+  , fMessagePool()
+  , fTimers()
+  , fLoop()
   , fEventSize(10000)
   , fTestMode(0)
+  , fFlpId(0)
+  , fNextTimeframeId(0)
+  , fMetricSent(NULL)
+  , fMetricSentBytes(NULL)
+  , fMetricSendErrors(NULL)
+  , fMetricDropped(NULL)
+  , fMetricDropNotices(NULL)
+  , fMetricCreditWaits(NULL)
+  , fMetricDiscarded(NULL)
+  , fMetricHeartbeats(NULL)
+  , fMetricBatchedEvents(NULL)
+  , fMetricChecksumBytes(NULL)
+  , fMetricQueued(NULL)
+  , fMetricEPNsAlive(NULL)
+  , fMetricShapingDelay(NULL)
+  , fMetricBatchSize(NULL)
 {
 }
 
@@ -45,36 +75,101 @@ void FLPex::Init()
 {
   FairMQDevice::Init();
 
-  ptime nullTime;
+  DropPolicy dropPolicy;
+  if (!ParseDropPolicy(fQueueDropPolicy, dropPolicy)) {
+    LOG(ERROR) << "Unknown drop policy \"" << fQueueDropPolicy << "\", dropping whole timeframes";
+    dropPolicy = kDropTimeframe;
+  }
+  if (fFlowControl > 0) {
+    LOG(INFO) << "Sending against the credit of the EPNs";
+  }
+  if (fQueueCapacity > 0) {
+    LOG(INFO) << "Up to " << fQueueCapacity << " sub-timeframes queued per EPN, beyond that dropping the "
+              << (dropPolicy == kDropTimeframe ? "whole timeframe" : GetDropPolicyName(dropPolicy));
+  }
 
-  for (int i = 0; i < fNumOutputs; ++i) {
-    fOutputHeartbeat.push_back(nullTime);
+  if (fBatchEvents < 1) {
+    // the EPNs assemble the batches of the same events, the FLPs can only agree on a fixed number.
+    LOG(WARN) << "Batches need a number of events, sending every event on its own";
+    fBatchEvents = 1;
+  }
+  if (fBatchEvents > 1) {
+    fBatch.Init(fBatchEvents, 0);
+    LOG(INFO) << "Packing events into sub-timeframes of " << fBatchEvents << " events, sub-timeframe #n holds the events #"
+              << fBatchEvents << "n to #" << fBatchEvents << "n + " << fBatchEvents - 1;
   }
-}
 
-bool FLPex::updateIPHeartbeat(string reply)
-{
-  for (int i = 0; i < fNumOutputs; ++i) {
-    if (GetProperty(OutputAddress, "", i) == reply) {
-      ptime currentTime = boost::posix_time::microsec_clock::local_time();
-      ptime storedHeartbeat = GetProperty(OutputHeartbeat, storedHeartbeat, i);
+  if (fChecksum > 0) {
+    LOG(INFO) << "Checksumming the payloads with CRC32C (" << GetCrc32cImplementation() << ")";
+  }
 
-      if (to_simple_string(storedHeartbeat) != "not-a-date-time") {
-        // LOG(INFO) << "EPN " << i << " (" << reply << ")" << " last seen "
-        //           << (currentTime - storedHeartbeat).total_milliseconds() << " ms ago.";
-      }
-      else {
-        LOG(INFO) << "IP has no heartbeat associated. Adding heartbeat: " << currentTime;
-      }
+  TrafficShaper& shaper = fScheduler.GetShaper();
+  shaper.Init(fNumOutputs, fOutputRate * 1e6, fOutputBurst);
+  // slots are aligned to the system clock, which is the one shared by all FLPs.
+  TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+  TimerWheel::Clock::time_point epoch = now - chrono::duration_cast<TimerWheel::Clock::duration>(chrono::system_clock::now().time_since_epoch());
+  if (fNumSlots > 0) {
+    shaper.SetTimeSlots(fSendOffset, fNumSlots, chrono::microseconds(fSlotLength), epoch);
+    LOG(INFO) << "Sending in slot " << fSendOffset % fNumSlots << " of " << fNumSlots << " slots of " << fSlotLength << " us";
+  }
+  if (fOutputRate > 0) {
+    LOG(INFO) << "Output rate limited to " << fOutputRate << " MB/s per EPN, burst " << fOutputBurst << " bytes";
+  }
 
-      SetProperty(OutputHeartbeat, currentTime, i);
+  // the sub-timeframes waiting in the queues, the unbounded queues start from 64 in all, plus the messages being
+  // received and sent.
+  size_t numQueued = fQueueCapacity > 0 ? static_cast<size_t>(fQueueCapacity) * fNumOutputs : 64;
+  fMessagePool.Init(fTransportFactory, numQueued + 8);
+  // one timer per queued sub-timeframe, a send retry per output, the liveness check, the shaper statistics and the
+  // keepalives. In slot mode the ticks fall on the slot boundaries, a departure at the start of the slot
+  // is not taken late into the next one.
+  TimerWheel::Clock::duration resolution = shaper.GetSlotResolution(chrono::milliseconds(1));
+  fTimers.Init(resolution, numQueued + fNumOutputs + 4, epoch + (now - epoch) / resolution * resolution);
+
+  EPNSelector* selector = EPNSelector::Create(fEPNSelection, fNumOutputs);
+  if (!selector) {
+    LOG(ERROR) << "Unknown EPN selection policy \"" << fEPNSelection << "\", using round-robin";
+    selector = EPNSelector::Create("round-robin", fNumOutputs);
+  }
 
-      return true;
+  if (!fEPNWeights.empty()) {
+    vector<double> weights;
+    stringstream ss(fEPNWeights);
+    string weight;
+    while (getline(ss, weight, ',')) {
+      weights.push_back(atof(weight.c_str()));
+    }
+    if (weights.size() == static_cast<size_t>(fNumOutputs)) {
+      for (int i = 0; i < fNumOutputs; ++i) {
+        selector->SetWeight(i, weights.at(i));
+      }
+    } else {
+      LOG(ERROR) << "Got " << weights.size() << " EPN weights for " << fNumOutputs << " EPNs, ignoring them";
     }
   }
-  LOG(ERROR) << "IP " << reply << " unknown, not provided at execution time";
 
-  return false;
+  fScheduler.Init(fNumOutputs, selector, fHeartbeatTimeoutInMs, fFlowControl > 0, max(fQueueCapacity, 0), dropPolicy, &fTimers, this);
+
+  LOG(INFO) << "EPN selection policy: " << fScheduler.GetSelector().GetName();
+
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  string label = Metrics::DeviceLabel(fId);
+  fMetricSent = &metrics.AddCounter("o2_flp_sub_timeframes_sent_total", "Sub-timeframes sent to the EPNs", label);
+  fMetricSentBytes = &metrics.AddCounter("o2_flp_sent_bytes_total", "Payload bytes sent to the EPNs", label);
+  fMetricSendErrors = &metrics.AddCounter("o2_flp_send_errors_total", "Sub-timeframes lost to failed sends", label);
+  fMetricDropped = &metrics.AddCounter("o2_flp_sub_timeframes_dropped_total", "Sub-timeframes dropped from full queues", label);
+  fMetricDropNotices = &metrics.AddCounter("o2_flp_drop_notices_total", "EPNs told to discard a timeframe the FLP dropped", label);
+  fMetricCreditWaits = &metrics.AddCounter("o2_flp_credit_waits_total", "Sub-timeframes queued for lack of EPN credit", label);
+  fMetricDiscarded = &metrics.AddCounter("o2_flp_timeframes_discarded_total", "Timeframes discarded because no EPN was alive", label);
+  fMetricHeartbeats = &metrics.AddCounter("o2_flp_heartbeats_total", "EPN heartbeats received", label);
+  fMetricBatchedEvents = &metrics.AddCounter("o2_flp_events_batched_total", "Events packed into batched sub-timeframes", label);
+  fMetricChecksumBytes = &metrics.AddCounter("o2_flp_checksummed_bytes_total", "Payload bytes covered by a CRC32C", label);
+  fMetricQueued = &metrics.AddGauge("o2_flp_queued_sub_timeframes", "Sub-timeframes waiting for their departure", label);
+  fMetricEPNsAlive = &metrics.AddGauge("o2_flp_epns_alive", "EPNs with a recent heartbeat", label);
+  fMetricShapingDelay = &metrics.AddHistogram("o2_flp_shaping_delay_us", "Delay of the sub-timeframes by the traffic shaper", label);
+  fMetricBatchSize = &metrics.AddHistogram("o2_flp_batch_events", "Events per batched sub-timeframe", label);
+  fScheduler.SetMetrics(fMetricDropped, fMetricDropNotices, fMetricCreditWaits, fMetricDiscarded, fMetricQueued,
+                        fMetricEPNsAlive, fMetricShapingDelay);
 }
 
 void FLPex::Run()
@@ -82,6 +177,7 @@ void FLPex::Run()
   LOG(INFO) << ">>>>>>> Run <<<<<<<";
 
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
+  Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
 
   FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
 
@@ -89,101 +185,119 @@ void FLPex::Run()
   void* buffer = operator new[](fEventSize);
   FairMQMessage* baseMsg = fTransportFactory->CreateMessage(buffer, fEventSize);
 
-  ptime currentTime;
-  ptime storedHeartbeat;
+  fNextTimeframeId = 0;
+  // the EPNs track the FLPs of a timeframe by their (consecutive) numeric ids.
+  fFlpId = 0;
+  try {
+    fFlpId = stoi(fId);
+  } catch (const exception& e) {
+    LOG(WARN) << "FLP id " << fId << " is not a number, using 0 in the sub-timeframe headers";
+  }
 
-  uint64_t timeFrameId = 0;
+  if (fKeepaliveIntervalInMs > 0) {
+    fTimers.Schedule(TimerWheel::Clock::now(), &TimerWheel::Member<FLPex, &FLPex::sendKeepalives>, this, 0);
+  }
+  if (fScheduler.GetShaper().IsEnabled()) {
+    fTimers.Schedule(TimerWheel::Clock::now() + chrono::seconds(10), &TimerWheel::Member<FLPex, &FLPex::logShaper>, this, 0);
+  }
+
+  fLoop.Init(poller, fNumInputs, &fTimers, fMaxSpinInUs, 100, fId);
 
   while (fState == RUNNING) {
-    poller->Poll(2);
+    // also sends what the shaper and the credit held back when it is due.
+    fLoop.Wait();
 
     // input 0 - commands
     if (poller->CheckInput(0)) {
-      FairMQMessage* commandMsg = fTransportFactory->CreateMessage();
+      FairMQMessage* commandMsg = fMessagePool.Acquire();
 
       if (fPayloadInputs->at(0)->Receive(commandMsg) > 0) {
         //... handle command ...
       }
 
-      delete commandMsg;
+      fMessagePool.Release(commandMsg);
     }
 
     // input 1 - heartbeats
     if (poller->CheckInput(1)) {
-      FairMQMessage* heartbeatMsg = fTransportFactory->CreateMessage();
+      FairMQMessage* heartbeatMsg = fMessagePool.Acquire();
 
       if (fPayloadInputs->at(1)->Receive(heartbeatMsg) > 0) {
-        string reply = string(static_cast<char*>(heartbeatMsg->GetData()), heartbeatMsg->GetSize());
-        updateIPHeartbeat(reply);
+        if (heartbeatMsg->GetSize() == sizeof(EPNHeartbeat)) {
+          EPNHeartbeat heartbeat;
+          memcpy(&heartbeat, heartbeatMsg->GetData(), sizeof(EPNHeartbeat));
+          fScheduler.UpdateHeartbeat(heartbeat);
+          fMetricHeartbeats->Increment();
+        } else if (heartbeatMsg->GetSize() == sizeof(EPNCredit)
+                   && *static_cast<uint32_t*>(heartbeatMsg->GetData()) == kEPNCreditMagic) {
+          EPNCredit credit;
+          memcpy(&credit, heartbeatMsg->GetData(), sizeof(EPNCredit));
+          fScheduler.UpdateCredit(credit);
+        } else {
+          LOG(ERROR) << "Received heartbeat of " << heartbeatMsg->GetSize() << " bytes, expected " << sizeof(EPNHeartbeat);
+        }
       }
 
-      delete heartbeatMsg;
+      fMessagePool.Release(heartbeatMsg);
     }
 
     // input 2 - data (in test-mode: signal with a timeframe ID)
     if (poller->CheckInput(2)) {
 
-      // initialize f2e header
-      f2eHeader* h = new f2eHeader;
+      uint64_t id = 0;
 
       if (fTestMode > 0) {
         // test-mode: receive and store id part in the buffer.
-        FairMQMessage* idPart = fTransportFactory->CreateMessage();
+        FairMQMessage* idPart = fMessagePool.Acquire();
         fPayloadInputs->at(2)->Receive(idPart);
 
-        h->timeFrameId = *(reinterpret_cast<uint64_t*>(idPart->GetData()));
-        h->flpId = stoi(fId);
+        id = *(reinterpret_cast<uint64_t*>(idPart->GetData()));
 
-        delete idPart;
+        fMessagePool.Release(idPart);
       } else {
-        // regular mode: use the id generated locally
-        h->timeFrameId = timeFrameId;
-        // h->flpId = stoi(fId);
-        h->flpId = 0;
-
-        if (++timeFrameId == UINT64_MAX - 1) {
-          timeFrameId = 0;
-        }
+        // regular mode: use the id generated locally, counting the events in batch mode
+        id = nextTimeframeId();
       }
 
-      FairMQMessage* headerPart = fTransportFactory->CreateMessage(h, sizeof(f2eHeader));
-
-      fHeaderBuffer.push(headerPart);
-
-      // save the arrival time of the message.
-      fArrivalTime.push(boost::posix_time::microsec_clock::local_time());
+      FairMQMessage* dataPart = fMessagePool.Acquire();
 
       if (fTestMode > 0) {
-        // test-mode: initialize and store data part in the buffer.
-        FairMQMessage* dataPart = fTransportFactory->CreateMessage();
+        // test-mode: initialize the data part.
         dataPart->Copy(baseMsg);
-        fDataBuffer.push(dataPart);
       } else {
         // regular mode: receive data part from input
-        FairMQMessage* dataPart = fTransportFactory->CreateMessage();
         fPayloadInputs->at(2)->Receive(dataPart);
-        fDataBuffer.push(dataPart);
       }
-    }
-
-    // LOG(INFO) << fDataBuffer.size();
 
-    // if offset is 0 - send data out without staggering.
-    if (fSendOffset == 0 && fDataBuffer.size() > 0) {
-      sendFrontData();
-    } else if (fDataBuffer.size() > 0) {
-      size_t dataSize = fDataBuffer.front()->GetSize();
-      ptime now = boost::posix_time::microsec_clock::local_time();
-      if ((now - fArrivalTime.front()).total_milliseconds() >= (8 * fSendOffset)) {
-        sendFrontData();
+      if (fBatchEvents == 1) {
+        SubTimeframeHeader h;
+        InitSubTimeframeHeader(h, id, fFlpId, kDataTypeRaw, dataPart->GetSize());
+        dispatch(h, dataPart);
       } else {
-        // LOG(INFO) << "buffering...";
+        addToBatch(id, dataPart);
       }
     }
   }
 
+  fLoop.LogStatistics();
+
+  // the events of a partial batch would otherwise be lost, the other FLPs send theirs as well.
+  sendBatch();
+
+  // the EPNs stop waiting for this FLP right away instead of after their membership timeout.
+  SubTimeframeHeader leaving;
+  InitSubTimeframeHeader(leaving, 0, fFlpId, kDataTypeRaw, 0);
+  for (int i = 0; i < fNumOutputs; ++i) {
+    SendNotice(i, leaving, kLeaving);
+  }
+
   delete baseMsg;
 
+  fScheduler.Clear();
+
+  LOG(INFO) << "Message pool: " << fMessagePool.GetNumAcquired() << " messages used, "
+            << fMessagePool.GetNumAllocations() << " allocated after start-up";
+
   rateLogger.interrupt();
   rateLogger.join();
 
@@ -195,44 +309,174 @@ void FLPex::Run()
   fRunningCondition.notify_one();
 }
 
-inline void FLPex::sendFrontData()
+uint64_t FLPex::nextTimeframeId()
 {
-  f2eHeader h = *(reinterpret_cast<f2eHeader*>(fHeaderBuffer.front()->GetData()));
-  uint64_t currentTimeframeId = h.timeFrameId;
+  uint64_t id = fNextTimeframeId;
+
+  if (++fNextTimeframeId == UINT64_MAX - 1) {
+    fNextTimeframeId = 0;
+  }
+
+  return id;
+}
+
+void FLPex::dispatch(SubTimeframeHeader& h, FairMQMessage* dataPart)
+{
+  if (fChecksum > 0) {
+    // the EPN verifies it, a queued or retried part keeps it.
+    h.checksum = Crc32c(dataPart->GetData(), dataPart->GetSize());
+    h.flags |= kHasChecksum;
+    fMetricChecksumBytes->Increment(dataPart->GetSize());
+  }
+
+  fScheduler.Dispatch(h, dataPart);
+}
 
+void FLPex::addToBatch(uint64_t id, FairMQMessage* event)
+{
+  // the boundaries follow from the event ids alone, so every FLP cuts its batches at the same events.
+  uint64_t batchId = id / fBatchEvents;
+
+  if (!fBatch.IsEmpty() && batchId != fBatchTimeframeId) {
+    // the last events of the previous batch did not come, e.g. lost on the way from the sampler.
+    sendBatch();
+  }
+  fBatchTimeframeId = batchId;
+
+  fBatch.Add(event->GetData(), event->GetSize());
+  fMetricBatchedEvents->Increment();
+  fMessagePool.Release(event);
+
+  if (id % fBatchEvents == static_cast<uint64_t>(fBatchEvents - 1)) {
+    sendBatch();
+  }
+}
+
+void FLPex::sendBatch()
+{
+  if (fBatch.IsEmpty()) {
+    return;
+  }
+
+  fMetricBatchSize->Observe(fBatch.GetNumEvents());
+
+  FairMQMessage* dataPart = fMessagePool.Acquire();
+  fBatch.Flush(dataPart);
+
+  SubTimeframeHeader h;
+  InitSubTimeframeHeader(h, fBatchTimeframeId, fFlpId, kDataTypeEventBatch, dataPart->GetSize());
+  dispatch(h, dataPart);
+}
+
+bool FLPex::Send(int direction, const SubTimeframeHeader& h, FairMQMessage* dataPart)
+{
   int SNDMORE = fPayloadInputs->at(0)->SNDMORE;
   int NOBLOCK = fPayloadInputs->at(0)->NOBLOCK;
 
-  // for which EPN is the message?
-  int direction = currentTimeframeId % fNumOutputs;
-  // LOG(INFO) << "Sending event " << currentTimeframeId << " to EPN#" << direction << "...";
+  // LOG(INFO) << "Sending event " << h.timeframeId << " to EPN#" << direction << "...";
 
-  ptime currentTime = boost::posix_time::microsec_clock::local_time();
-  ptime storedHeartbeat = GetProperty(OutputHeartbeat, storedHeartbeat, direction);
+  // the header part fits into the transport message itself, see SubTimeframeHeader.
+  FairMQMessage* headerPart = fMessagePool.Acquire();
+  headerPart->Rebuild(kSubTimeframeWireSize);
+  WriteSubTimeframeHeader(headerPart->GetData(), h);
 
-  // if the heartbeat from the corresponding EPN is within timeout period, send the data.
-  if (to_simple_string(storedHeartbeat) != "not-a-date-time" ||
-      (currentTime - storedHeartbeat).total_milliseconds() < fHeartbeatTimeoutInMs) {
-    if(fPayloadOutputs->at(direction)->Send(fHeaderBuffer.front(), SNDMORE|NOBLOCK) == 0) {
-      LOG(ERROR) << "Could not queue ID part of event #" << currentTimeframeId << " without blocking";
-    }
-    if (fPayloadOutputs->at(direction)->Send(fDataBuffer.front(), NOBLOCK) == 0) {
-      LOG(ERROR) << "Could not send message with event #" << currentTimeframeId << " without blocking";
-    }
-    fHeaderBuffer.pop();
-    fArrivalTime.pop();
-    fDataBuffer.pop();
-  } else { // if the heartbeat is too old, discard the data.
-    LOG(WARN) << "Heartbeat too old for EPN#" << direction << ", discarding message.";
-    fHeaderBuffer.pop();
-    fArrivalTime.pop();
-    fDataBuffer.pop();
+  size_t bytes = dataPart->GetSize();
+
+  int sent = fPayloadOutputs->at(direction)->Send(headerPart, SNDMORE|NOBLOCK);
+  fMessagePool.Release(headerPart);
+
+  if (sent == 0) {
+    // the socket is full, the sub-timeframe stays in the queue.
+    return false;
+  }
+
+  if (sent < 0) {
+    LOG(ERROR) << "Could not send the header of timeframe #" << h.timeframeId << " to EPN#" << direction;
+    fMetricSendErrors->Increment();
+  } else if (fPayloadOutputs->at(direction)->Send(dataPart, NOBLOCK) < 0) {
+    // once the first part is accepted the transport takes the rest of the message.
+    LOG(ERROR) << "Could not send the data of timeframe #" << h.timeframeId << " to EPN#" << direction;
+    fMetricSendErrors->Increment();
+  } else {
+    fMetricSent->Increment();
+    fMetricSentBytes->Increment(bytes);
   }
+
+  fMessagePool.Release(dataPart);
+  return true;
+}
+
+bool FLPex::SendNotice(int direction, const SubTimeframeHeader& h, uint16_t flag)
+{
+  int SNDMORE = fPayloadInputs->at(0)->SNDMORE;
+  int NOBLOCK = fPayloadInputs->at(0)->NOBLOCK;
+
+  // a header without payload, it needs neither credit nor buffer space at the EPN.
+  SubTimeframeHeader notice = h;
+  notice.flags |= flag;
+  notice.size = 0;
+
+  FairMQMessage* headerPart = fMessagePool.Acquire();
+  headerPart->Rebuild(kSubTimeframeWireSize);
+  WriteSubTimeframeHeader(headerPart->GetData(), notice);
+  FairMQMessage* emptyPart = fMessagePool.Acquire();
+  emptyPart->Rebuild();
+
+  bool sent = fPayloadOutputs->at(direction)->Send(headerPart, SNDMORE|NOBLOCK) > 0;
+  if (sent) {
+    fPayloadOutputs->at(direction)->Send(emptyPart, NOBLOCK);
+  }
+
+  fMessagePool.Release(emptyPart);
+  fMessagePool.Release(headerPart);
+  return sent;
+}
+
+void FLPex::Release(FairMQMessage* dataPart)
+{
+  fMessagePool.Release(dataPart);
+}
+
+void FLPex::sendKeepalives(uint64_t)
+{
+  TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+
+  SubTimeframeHeader h;
+  InitSubTimeframeHeader(h, 0, fFlpId, kDataTypeRaw, 0);
+
+  // an output that is full has sub-timeframes on the way, which keep the FLP in the membership as well.
+  for (int i = 0; i < fNumOutputs; ++i) {
+    SendNotice(i, h, kKeepalive);
+  }
+
+  fTimers.Schedule(now + chrono::milliseconds(fKeepaliveIntervalInMs),
+                   &TimerWheel::Member<FLPex, &FLPex::sendKeepalives>, this, 0);
+}
+
+void FLPex::logShaper(uint64_t)
+{
+  TrafficShaper& shaper = fScheduler.GetShaper();
+  LOG(INFO) << "Traffic shaper: " << shaper.GetQueueDepth() << " queued (max " << shaper.GetMaxQueueDepth() << "), "
+            << shaper.GetNumDelayed() << "/" << shaper.GetNumReserved() << " delayed, shaping delay avg "
+            << chrono::duration_cast<chrono::microseconds>(shaper.GetAverageDelay()).count() << " us, max "
+            << chrono::duration_cast<chrono::microseconds>(shaper.GetMaxDelay()).count() << " us";
+  shaper.ResetStatistics();
+
+  fTimers.Schedule(TimerWheel::Clock::now() + chrono::seconds(10), &TimerWheel::Member<FLPex, &FLPex::logShaper>, this, 0);
 }
 
 void FLPex::SetProperty(const int key, const string& value, const int slot/*= 0*/)
 {
   switch (key) {
+    case EPNSelection:
+      fEPNSelection = value;
+      break;
+    case EPNWeights:
+      fEPNWeights = value;
+      break;
+    case QueueDropPolicy:
+      fQueueDropPolicy = value;
+      break;
     default:
       FairMQDevice::SetProperty(key, value, slot);
       break;
@@ -242,6 +486,12 @@ void FLPex::SetProperty(const int key, const string& value, const int slot/*= 0*
 string FLPex::GetProperty(const int key, const string& default_/*= ""*/, const int slot/*= 0*/)
 {
   switch (key) {
+    case EPNSelection:
+      return fEPNSelection;
+    case EPNWeights:
+      return fEPNWeights;
+    case QueueDropPolicy:
+      return fQueueDropPolicy;
     default:
       return FairMQDevice::GetProperty(key, default_, slot);
   }
@@ -259,9 +509,39 @@ void FLPex::SetProperty(const int key, const int value, const int slot/*= 0*/)
     case SendOffset:
       fSendOffset = value;
       break;
+    case OutputRate:
+      fOutputRate = value;
+      break;
+    case OutputBurst:
+      fOutputBurst = value;
+      break;
+    case NumSlots:
+      fNumSlots = value;
+      break;
+    case SlotLength:
+      fSlotLength = value;
+      break;
     case EventSize:
       fEventSize = value;
       break;
+    case FlowControl:
+      fFlowControl = value;
+      break;
+    case QueueCapacity:
+      fQueueCapacity = value;
+      break;
+    case MaxSpinInUs:
+      fMaxSpinInUs = value;
+      break;
+    case BatchEvents:
+      fBatchEvents = value;
+      break;
+    case KeepaliveIntervalInMs:
+      fKeepaliveIntervalInMs = value;
+      break;
+    case Checksum:
+      fChecksum = value;
+      break;
     default:
       FairMQDevice::SetProperty(key, value, slot);
       break;
@@ -277,29 +557,29 @@ int FLPex::GetProperty(const int key, const int default_/*= 0*/, const int slot/
       return fTestMode;
     case SendOffset:
       return fSendOffset;
+    case OutputRate:
+      return fOutputRate;
+    case OutputBurst:
+      return fOutputBurst;
+    case NumSlots:
+      return fNumSlots;
+    case SlotLength:
+      return fSlotLength;
     case EventSize:
       return fEventSize;
+    case FlowControl:
+      return fFlowControl;
+    case QueueCapacity:
+      return fQueueCapacity;
+    case MaxSpinInUs:
+      return fMaxSpinInUs;
+    case BatchEvents:
+      return fBatchEvents;
+    case KeepaliveIntervalInMs:
+      return fKeepaliveIntervalInMs;
+    case Checksum:
+      return fChecksum;
     default:
       return FairMQDevice::GetProperty(key, default_, slot);
   }
 }
-
-// Method for setting properties represented as a heartbeat.
-void FLPex::SetProperty(const int key, const ptime value, const int slot /*= 0*/)
-{
-  switch (key) {
-    case OutputHeartbeat:
-      fOutputHeartbeat.erase(fOutputHeartbeat.begin() + slot);
-      fOutputHeartbeat.insert(fOutputHeartbeat.begin() + slot, value);
-      break;
-  }
-}
-
-// Method for getting properties represented as a heartbeat.
-ptime FLPex::GetProperty(const int key, const ptime default_, const int slot /*= 0*/)
-{
-  switch (key) {
-    case OutputHeartbeat:
-      return fOutputHeartbeat.at(slot);
-  }
-}
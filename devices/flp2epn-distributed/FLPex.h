@@ -9,25 +9,47 @@
 #define ALICEO2_DEVICES_FLPEX_H_
 
 #include <string>
-#include <queue>
 #include <unordered_map>
+#include <cstdint>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "FairMQDevice.h"
 
+#include "Metrics.h"
+
+#include "EventBatch.h"
+#include "EventLoop.h"
+#include "FlowControl.h"
+#include "MessagePool.h"
+#include "SubTimeframeScheduler.h"
+#include "TimeframeHeader.h"
+#include "TimerWheel.h"
+
 namespace AliceO2 {
 namespace Devices {
 
-class FLPex : public FairMQDevice
+class FLPex : public FairMQDevice, private SubTimeframeScheduler::Transport
 {
   public:
     enum {
-      OutputHeartbeat = FairMQDevice::Last,
-      HeartbeatTimeoutInMs,
+      HeartbeatTimeoutInMs = FairMQDevice::Last,
       TestMode,
       SendOffset,
       EventSize,
+      EPNSelection,
+      EPNWeights,
+      OutputRate,
+      OutputBurst,
+      NumSlots,
+      SlotLength,
+      FlowControl,
+      QueueCapacity,
+      MaxSpinInUs,
+      BatchEvents,
+      QueueDropPolicy,
+      KeepaliveIntervalInMs,
+      Checksum,
       Last
     };
 
@@ -40,29 +62,83 @@ class FLPex : public FairMQDevice
     virtual std::string GetProperty(const int key, const std::string& default_ = "", const int slot = 0);
     virtual void SetProperty(const int key, const int value, const int slot = 0);
     virtual int GetProperty(const int key, const int default_ = 0, const int slot = 0);
-    virtual void SetProperty(const int key, const boost::posix_time::ptime value, const int slot = 0);
-    virtual boost::posix_time::ptime GetProperty(const int key, const boost::posix_time::ptime value, const int slot = 0);
 
   protected:
     virtual void Init();
     virtual void Run();
 
   private:
-    bool updateIPHeartbeat(std::string str);
-    void sendFrontData();
+    // the sockets of the scheduler
+    /// false if the output would block, dataPart then stays with the caller
+    virtual bool Send(int direction, const SubTimeframeHeader& h, FairMQMessage* dataPart);
+    /// a header with the flag and an empty payload, false if the output would block
+    virtual bool SendNotice(int direction, const SubTimeframeHeader& h, uint16_t flag);
+    virtual void Release(FairMQMessage* dataPart);
+
+    /// keeps this FLP in the membership of the EPNs while it has nothing to send them
+    void sendKeepalives(uint64_t);
+    uint64_t nextTimeframeId();
+    /// routes a sub-timeframe to its EPN, sending it right away or queueing it
+    /// fills in the checksum of h if enabled
+    void dispatch(SubTimeframeHeader& h, FairMQMessage* dataPart);
+    /// packs the event of id into the sub-timeframe of id / fBatchEvents, sent after its last event.
+    /// There is no time limit: a partial batch waits for the events of its ids however long they take,
+    /// or for the next batch to start or the end of the run.
+    void addToBatch(uint64_t id, FairMQMessage* event);
+    void sendBatch();
+    void logShaper(uint64_t);
 
     int fHeartbeatTimeoutInMs;
-    vector<boost::posix_time::ptime> fOutputHeartbeat;
 
-    unsigned int fSendOffset;
-    std::queue<FairMQMessage*> fHeaderBuffer;
-    std::queue<FairMQMessage*> fDataBuffer;
-    std::queue<boost::posix_time::ptime> fArrivalTime;
+    unsigned int fSendOffset; // slot of this FLP in time-slotted sending
+    int fOutputRate; // MB/s per output, 0 for unlimited
+    int fOutputBurst; // bytes
+    int fNumSlots; // 0 disables time-slotted sending
+    int fSlotLength; // microseconds
+
+    int fFlowControl; // send against the credit of the EPNs
+    int fQueueCapacity; // sub-timeframes per output, 0 for unbounded
+    int fMaxSpinInUs; // longest spin of the main loop before it sleeps, 0 never spins
+    int fBatchEvents; // events packed into one sub-timeframe, 1 sends each on its own
+    int fKeepaliveIntervalInMs; // notices to the EPNs that this FLP is alive, 0 sends none
+    int fChecksum; // CRC32C of every payload in its header (1) or not (0)
+    std::string fQueueDropPolicy; // what to drop from a full queue: oldest/newest/timeframe
+
+    EventBatchBuilder fBatch;
+    uint64_t fBatchTimeframeId; // event id / fBatchEvents, the same on all FLPs
+
+    std::string fEPNSelection; // name of the EPN selection policy
+    std::string fEPNWeights; // comma-separated relative EPN capacities for the weighted policies
+
+    // routing, liveness, shaping, credit and queues of the outputs
+    SubTimeframeScheduler fScheduler;
+
+    MessagePool fMessagePool;
+    TimerWheel fTimers;
+    EventLoop fLoop;
 
     std::unordered_map<int,boost::posix_time::ptime> fRTTimes;
 
     int fEventSize;
     int fTestMode; // run in test mode
+    int fFlpId; // numeric id in the sub-timeframe headers
+    uint64_t fNextTimeframeId; // regular mode
+
+    // metrics, registered in Init() with the device id as label
+    Metrics::Counter* fMetricSent; // sub-timeframes
+    Metrics::Counter* fMetricSentBytes;
+    Metrics::Counter* fMetricSendErrors;
+    Metrics::Counter* fMetricDropped; // full queue
+    Metrics::Counter* fMetricDropNotices;
+    Metrics::Counter* fMetricCreditWaits;
+    Metrics::Counter* fMetricDiscarded; // no EPN alive
+    Metrics::Counter* fMetricHeartbeats;
+    Metrics::Counter* fMetricBatchedEvents;
+    Metrics::Counter* fMetricChecksumBytes;
+    Metrics::Gauge* fMetricQueued; // waiting in the shaper queues
+    Metrics::Gauge* fMetricEPNsAlive;
+    Metrics::Histogram* fMetricShapingDelay; // us
+    Metrics::Histogram* fMetricBatchSize; // events per batch
 };
 
 } // namespace Devices
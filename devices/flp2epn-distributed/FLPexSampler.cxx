@@ -8,21 +8,36 @@
 #include <vector>
 #include <fstream>
 #include <cstdint> // UINT64_MAX
+#include <cmath>
+#include <thread>
 
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "FairMQLogger.h"
 #include "FLPexSampler.h"
+#include "Placement.h"
 
 using namespace std;
-using boost::posix_time::ptime;
 
 using namespace AliceO2::Devices;
 
 FLPexSampler::FLPexSampler()
   : fEventRate(1)
-  , fEventCounter(0)
+  , fArrival("constant")
+  , fBurstSize(1)
+  , fBurstOn(0)
+  , fBurstOff(0)
+  , fMaxInFlight(10000)
+  , fHistogramInterval(10)
+  , fStartDelay(10000)
+  , fNumTimeframes(0)
+  , fBatchEvents(1)
+  , fInFlight()
+  , fNumSent(0)
+  , fNumOverwritten(0)
+  , fRandom(random_device()())
 {
 }
 
@@ -30,47 +45,121 @@ FLPexSampler::~FLPexSampler()
 {
 }
 
+double FLPexSampler::NextArrival(double t)
+{
+  // a burst counts as one arrival, so that the average rate does not depend on the burst size.
+  double meanGap = static_cast<double>(fBurstSize) / fEventRate;
+
+  if (fArrival == "poisson") {
+    t += exponential_distribution<double>(1. / meanGap)(fRandom);
+  } else {
+    t += meanGap;
+  }
+
+  if (fBurstOn > 0) {
+    double on = fBurstOn / 1000.;
+    double cycle = on + fBurstOff / 1000.;
+    double position = fmod(t, cycle);
+    if (position >= on) {
+      t += cycle - position;
+    }
+  }
+
+  return t;
+}
+
 void FLPexSampler::Run()
 {
   LOG(INFO) << ">>>>>>> Run <<<<<<<";
-  boost::this_thread::sleep(boost::posix_time::milliseconds(10000));
+  boost::this_thread::sleep(boost::posix_time::milliseconds(fStartDelay));
+
+  if (fArrival != "constant" && fArrival != "poisson") {
+    LOG(ERROR) << "Unknown arrival process \"" << fArrival << "\", using constant arrivals";
+    fArrival = "constant";
+  }
+  fBurstSize = max(fBurstSize, 1);
+  fMaxInFlight = max(fMaxInFlight, 1);
+  fBatchEvents = max(fBatchEvents, 1);
+
+  vector<InFlight>(fMaxInFlight).swap(fInFlight);
+  for (auto& entry : fInFlight) {
+    entry.id.store(UINT64_MAX, memory_order_relaxed);
+    entry.sent.store(0, memory_order_relaxed);
+  }
 
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
-  boost::thread resetEventCounter(boost::bind(&FLPexSampler::ResetEventCounter, this));
   boost::thread ackListener(boost::bind(&FLPexSampler::ListenForAcks, this));
+  Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
+  Placement::Default().PinHelper(ackListener.native_handle(), "ack listener");
 
-  int NOBLOCK = fPayloadInputs->at(0)->NOBLOCK;
+  int NOBLOCK = fPayloadOutputs->at(0)->NOBLOCK;
 
   uint64_t timeFrameId = 0;
 
-  while (fState == RUNNING) {
-    FairMQMessage* msg = fTransportFactory->CreateMessage(sizeof(uint64_t));
-    memcpy(msg->GetData(), &timeFrameId, sizeof(uint64_t));
+  // the schedule is absolute (seconds since start), so late wake-ups do not shift the following sends.
+  Clock::time_point start = Clock::now();
+  double next = 0.;
 
-    if (fPayloadOutputs->at(0)->Send(msg, NOBLOCK) == 0) {
-      LOG(ERROR) << "Could not send signal without blocking";
+  while (fState == RUNNING) {
+    if (fNumTimeframes > 0 && fNumSent.load(memory_order_relaxed) >= static_cast<uint64_t>(fNumTimeframes)) {
+      // all sent, the acknowledgements keep coming in until the device is stopped.
+      this_thread::sleep_for(chrono::milliseconds(100));
+      continue;
     }
 
-    fTimeframeRTT[timeFrameId].start = boost::posix_time::microsec_clock::local_time();
+    Clock::time_point scheduled = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(next));
 
-    if (++timeFrameId == UINT64_MAX - 1) {
-      timeFrameId = 0;
+    if (fEventRate > 0) {
+      // sleep in short pieces to notice a state change during long off periods.
+      Clock::time_point now = Clock::now();
+      while (now < scheduled && fState == RUNNING) {
+        this_thread::sleep_until(min(scheduled, now + chrono::milliseconds(100)));
+        now = Clock::now();
+      }
+    } else {
+      scheduled = Clock::now();
     }
 
-    --fEventCounter;
+    for (int i = 0; i < fBurstSize && fState == RUNNING; ++i) {
+      if (fNumTimeframes > 0 && fNumSent.load(memory_order_relaxed) >= static_cast<uint64_t>(fNumTimeframes)) {
+        break;
+      }
 
-    while (fEventCounter == 0) {
-      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+      // the RTT is measured from the scheduled time, not from the actual send, so that a stalled
+      // sender shows up in the latencies instead of silently lowering the load (coordinated omission).
+      InFlight& entry = fInFlight[timeFrameId % fMaxInFlight];
+      if (entry.id.load(memory_order_relaxed) != UINT64_MAX) {
+        fNumOverwritten.fetch_add(1, memory_order_relaxed);
+      }
+      entry.id.store(UINT64_MAX, memory_order_relaxed);
+      atomic_thread_fence(memory_order_release);
+      entry.sent.store(chrono::duration_cast<chrono::nanoseconds>(scheduled.time_since_epoch()).count(), memory_order_relaxed);
+      entry.id.store(timeFrameId, memory_order_release);
+
+      FairMQMessage* msg = fTransportFactory->CreateMessage(sizeof(uint64_t));
+      memcpy(msg->GetData(), &timeFrameId, sizeof(uint64_t));
+
+      if (fPayloadOutputs->at(0)->Send(msg, NOBLOCK) == 0) {
+        LOG(ERROR) << "Could not send signal without blocking";
+      }
+
+      delete msg;
+
+      fNumSent.fetch_add(1, memory_order_relaxed);
+
+      if (++timeFrameId == UINT64_MAX - 1) {
+        timeFrameId = 0;
+      }
     }
 
-    delete msg;
+    if (fEventRate > 0) {
+      next = NextArrival(next);
+    }
   }
 
   try {
     rateLogger.interrupt();
     rateLogger.join();
-    resetEventCounter.interrupt();
-    resetEventCounter.join();
     ackListener.interrupt();
     ackListener.join();
   } catch(boost::thread_resource_error& e) {
@@ -90,56 +179,94 @@ void FLPexSampler::ListenForAcks()
   FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
 
   uint64_t id = 0;
+  uint64_t numUntracked = 0;
+
+  // RTTs in microseconds, the interval histogram is logged and merged into the total periodically.
+  LatencyHistogram interval;
+  LatencyHistogram total;
+  Clock::time_point nextDump = Clock::now() + chrono::seconds(fHistogramInterval);
 
   string name = to_iso_string(boost::posix_time::microsec_clock::local_time()).substr(0, 20);
-  ofstream ofsFrames(name + "-frames.log");
-  ofstream ofsTimes(name + "-times.log");
 
   while (fState == RUNNING) {
     try {
       poller->Poll(100);
 
+      Clock::time_point now = Clock::now();
+
       if (poller->CheckInput(0)) {
         FairMQMessage* idMsg = fTransportFactory->CreateMessage();
 
         if (fPayloadInputs->at(0)->Receive(idMsg) > 0) {
-          id = *(reinterpret_cast<uint64_t*>(idMsg->GetData()));
-          fTimeframeRTT[id].end = boost::posix_time::microsec_clock::local_time();
-          // store values in a file
-          ofsFrames << id << "\n";
-          ofsTimes  << (fTimeframeRTT[id].end - fTimeframeRTT[id].start).total_microseconds() << "\n";
-
-          LOG(INFO) << "Timeframe #" << id << " acknowledged after "
-                    << (fTimeframeRTT[id].end - fTimeframeRTT[id].start).total_microseconds() << " μs.";
+          now = Clock::now();
+          uint64_t batchId = *(reinterpret_cast<uint64_t*>(idMsg->GetData()));
+
+          // the FLPs pack the events of a batch into one sub-timeframe, its acknowledgement stands for all of them.
+          bool tracked = false;
+          for (uint64_t i = 0; i < static_cast<uint64_t>(fBatchEvents); ++i) {
+            id = batchId * fBatchEvents + i;
+
+            // the entry may have been reused by a later timeframe if too many are in flight.
+            InFlight& entry = fInFlight[id % fMaxInFlight];
+            bool valid = entry.id.load(memory_order_acquire) == id;
+            int64_t sent = entry.sent.load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            uint64_t expected = id;
+            valid = valid && entry.id.compare_exchange_strong(expected, UINT64_MAX, memory_order_relaxed);
+
+            if (valid) {
+              tracked = true;
+              int64_t rtt = chrono::duration_cast<chrono::nanoseconds>(now.time_since_epoch()).count() - sent;
+              interval.Record(rtt > 0 ? rtt / 1000 : 0);
+              LOG(DEBUG) << "Timeframe #" << id << " acknowledged after " << rtt / 1000 << " μs.";
+            }
+          }
+          if (!tracked) {
+            ++numUntracked;
+          }
         }
+
+        delete idMsg;
+      }
+
+      if (fHistogramInterval > 0 && now >= nextDump) {
+        LOG(INFO) << "RTT (μs) last " << fHistogramInterval << " s: " << interval.Summary();
+        total.Add(interval);
+        interval.Reset();
+        nextDump += chrono::seconds(fHistogramInterval);
       }
     } catch (boost::thread_interrupted&) {
       break;
     }
   }
 
-  ofsFrames.close();
-  ofsTimes.close();
+  total.Add(interval);
 
-
-  delete poller;
-}
-
-void FLPexSampler::ResetEventCounter()
-{
-  while (true) {
-    try {
-      fEventCounter = fEventRate / 100;
-      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-    } catch (boost::thread_interrupted&) {
-      break;
+  uint64_t numUnacked = 0;
+  for (auto& entry : fInFlight) {
+    if (entry.id.load(memory_order_relaxed) != UINT64_MAX) {
+      ++numUnacked;
     }
   }
+
+  LOG(INFO) << "RTT (μs) total: " << total.Summary();
+  LOG(INFO) << "Sent " << fNumSent.load() << " timeframes, " << numUnacked << " not acknowledged, "
+            << fNumOverwritten.load() << " dropped from the in-flight table (" << fMaxInFlight << " entries), "
+            << numUntracked << " acknowledgements without a send time";
+
+  ofstream ofsHistogram(name + "-rtt.hgrm");
+  total.WriteDistribution(ofsHistogram);
+  ofsHistogram.close();
+
+  delete poller;
 }
 
 void FLPexSampler::SetProperty(const int key, const string& value, const int slot /*= 0*/)
 {
   switch (key) {
+    case Arrival:
+      fArrival = value;
+      break;
     default:
       FairMQDevice::SetProperty(key, value, slot);
       break;
@@ -149,6 +276,8 @@ void FLPexSampler::SetProperty(const int key, const string& value, const int slo
 string FLPexSampler::GetProperty(const int key, const string& default_ /*= ""*/, const int slot /*= 0*/)
 {
   switch (key) {
+    case Arrival:
+      return fArrival;
     default:
       return FairMQDevice::GetProperty(key, default_, slot);
   }
@@ -160,6 +289,30 @@ void FLPexSampler::SetProperty(const int key, const int value, const int slot /*
     case EventRate:
       fEventRate = value;
       break;
+    case BurstSize:
+      fBurstSize = value;
+      break;
+    case BurstOn:
+      fBurstOn = value;
+      break;
+    case BurstOff:
+      fBurstOff = value;
+      break;
+    case MaxInFlight:
+      fMaxInFlight = value;
+      break;
+    case HistogramInterval:
+      fHistogramInterval = value;
+      break;
+    case StartDelay:
+      fStartDelay = value;
+      break;
+    case NumTimeframes:
+      fNumTimeframes = value;
+      break;
+    case BatchEvents:
+      fBatchEvents = value;
+      break;
     default:
       FairMQDevice::SetProperty(key, value, slot);
       break;
@@ -171,6 +324,22 @@ int FLPexSampler::GetProperty(const int key, const int default_ /*= 0*/, const i
   switch (key) {
     case EventRate:
       return fEventRate;
+    case BurstSize:
+      return fBurstSize;
+    case BurstOn:
+      return fBurstOn;
+    case BurstOff:
+      return fBurstOff;
+    case MaxInFlight:
+      return fMaxInFlight;
+    case HistogramInterval:
+      return fHistogramInterval;
+    case StartDelay:
+      return fStartDelay;
+    case NumTimeframes:
+      return fNumTimeframes;
+    case BatchEvents:
+      return fBatchEvents;
     default:
       return FairMQDevice::GetProperty(key, default_, slot);
   }
@@ -9,33 +9,44 @@
 #define ALICEO2_DEVICES_FLPEXSAMPLER_H_
 
 #include <string>
-
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <random>
 
 #include "FairMQDevice.h"
 
+#include "LatencyHistogram.h"
+
 namespace AliceO2 {
 namespace Devices {
 
-struct timeframeDuration
-{
-  boost::posix_time::ptime start;
-  boost::posix_time::ptime end;
-};
-
+/// Open-loop load generator for the FLP->EPN path: sends timeframe IDs to
+/// the FLPs at a given rate, independently of the acknowledgements, and
+/// measures the round trip time of every acknowledged timeframe.
 class FLPexSampler : public FairMQDevice
 {
   public:
+    typedef std::chrono::steady_clock Clock;
+
     enum {
       EventRate = FairMQDevice::Last,
       EventSize,
+      Arrival,
+      BurstSize,
+      BurstOn,
+      BurstOff,
+      MaxInFlight,
+      HistogramInterval,
+      StartDelay,
+      NumTimeframes,
+      BatchEvents,
       Last
     };
 
     FLPexSampler();
     virtual ~FLPexSampler();
 
-    void ResetEventCounter();
     void ListenForAcks();
 
     virtual void SetProperty(const int key, const std::string& value, const int slot = 0);
@@ -44,12 +55,34 @@ class FLPexSampler : public FairMQDevice
     virtual int GetProperty(const int key, const int default_ = 0, const int slot = 0);
 
   protected:
+    /// send time of a timeframe that is not acknowledged yet
+    struct InFlight
+    {
+      std::atomic<uint64_t> id; // UINT64_MAX when free
+      std::atomic<int64_t> sent; // ns since the clock epoch
+    };
+
     virtual void Run();
 
-    int fEventRate;
-    int fEventCounter;
+    /// next send time after `t` (seconds since the start), skipping the off periods of the burst pattern
+    double NextArrival(double t);
+
+    int fEventRate; // timeframes per second, 0 sends as fast as possible
+    std::string fArrival; // "constant" or "poisson"
+    int fBurstSize; // timeframes sent back to back at every arrival
+    int fBurstOn; // ms, 0 disables the on/off pattern
+    int fBurstOff; // ms
+    int fMaxInFlight;
+    int fHistogramInterval; // s
+    int fStartDelay; // ms before the first timeframe, for the FLPs and EPNs to connect
+    int fNumTimeframes; // stops sending after this many, 0 for no limit
+    int fBatchEvents; // events per sub-timeframe on the FLPs, an acknowledgement of #n covers the events #n*N to #n*N+N-1
+
+    std::vector<InFlight> fInFlight; // indexed by id % fMaxInFlight
+    std::atomic<uint64_t> fNumSent;
+    std::atomic<uint64_t> fNumOverwritten; // sent while the in-flight table was full, read by the ack thread
 
-    std::map<uint64_t,timeframeDuration> fTimeframeRTT;
+    std::mt19937_64 fRandom;
 };
 
 } // namespace Devices
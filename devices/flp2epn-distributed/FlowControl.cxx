@@ -0,0 +1,138 @@
+/**
+ * FlowControl.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm> // max
+
+#include "FlowControl.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+bool AliceO2::Devices::ParseDropPolicy(const string& name, DropPolicy& policy)
+{
+  if (name == "oldest") {
+    policy = kDropOldest;
+  } else if (name == "newest") {
+    policy = kDropNewest;
+  } else if (name == "timeframe") {
+    policy = kDropTimeframe;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* AliceO2::Devices::GetDropPolicyName(DropPolicy policy)
+{
+  switch (policy) {
+    case kDropOldest:
+      return "oldest";
+    case kDropNewest:
+      return "newest";
+    default:
+      return "timeframe";
+  }
+}
+
+CreditTracker::CreditTracker()
+  : fEnabled(false)
+  , fOutputs()
+{
+}
+
+CreditTracker::~CreditTracker()
+{
+}
+
+void CreditTracker::Init(int numOutputs, bool enabled)
+{
+  fEnabled = enabled;
+
+  Output output;
+  output.granted = false;
+  output.session = 0;
+  output.sent = 0;
+  output.finished = 0;
+  output.limit = 0;
+  output.bytesPerFLP = 0;
+  output.bytesInFlight = 0;
+  output.inFlight = RingBuffer<size_t>(16);
+
+  fOutputs.assign(numOutputs, output);
+}
+
+bool CreditTracker::Grant(const EPNCredit& credit)
+{
+  if (credit.epnIndex >= fOutputs.size()) {
+    return false;
+  }
+
+  Output& output = fOutputs[credit.epnIndex];
+
+  if (!output.granted || output.session != credit.session) {
+    // a new EPN process, whatever was in flight to the old one is gone.
+    output.granted = true;
+    output.session = credit.session;
+    output.sent = 0;
+    output.finished = 0;
+    output.limit = 0;
+    output.bytesInFlight = 0;
+    while (!output.inFlight.empty()) {
+      output.inFlight.pop();
+    }
+  }
+
+  uint64_t oldLimit = output.limit;
+  uint64_t oldBytes = output.bytesInFlight;
+
+  output.finished = max(output.finished, credit.finished);
+  output.limit = max(output.limit, credit.limit);
+  output.bytesPerFLP = credit.bytesPerFLP;
+  retire(output);
+
+  return output.limit > oldLimit || output.bytesInFlight < oldBytes;
+}
+
+bool CreditTracker::CanSend(int output, size_t bytes) const
+{
+  if (!fEnabled) {
+    return true;
+  }
+
+  const Output& o = fOutputs.at(output);
+  if (!o.granted || o.sent >= o.limit) {
+    return false;
+  }
+  return o.bytesPerFLP == 0 || o.bytesInFlight == 0 || o.bytesInFlight + bytes <= o.bytesPerFLP;
+}
+
+void CreditTracker::Charge(int output, size_t bytes)
+{
+  if (!fEnabled) {
+    return;
+  }
+
+  Output& o = fOutputs.at(output);
+  ++o.sent;
+  o.inFlight.push(bytes);
+  o.bytesInFlight += bytes;
+}
+
+uint64_t CreditTracker::GetNumInFlight(int output) const
+{
+  const Output& o = fOutputs.at(output);
+  return o.sent > o.finished ? o.sent - o.finished : 0;
+}
+
+void CreditTracker::retire(Output& output)
+{
+  uint64_t inFlight = output.sent > output.finished ? output.sent - output.finished : 0;
+  while (output.inFlight.size() > inFlight) {
+    output.bytesInFlight -= output.inFlight.front();
+    output.inFlight.pop();
+  }
+}
@@ -0,0 +1,103 @@
+/**
+ * FlowControl.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_FLOWCONTROL_H_
+#define ALICEO2_DEVICES_FLOWCONTROL_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "RingBuffer.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+static const uint32_t kEPNCreditMagic = 0x5243324f; // "O2CR"
+
+/// Buffer credit of an EPN, published to all FLPs on the heartbeat channel.
+///
+/// Every FLP sends one sub-timeframe per timeframe routed to an EPN, so one
+/// count serves all of them: an FLP may have sent `limit` sub-timeframes to
+/// the EPN in total, which is the number of timeframes the EPN has finished
+/// (forwarded or discarded) plus the timeframes it can hold. The counts are
+/// cumulative, a lost or reordered credit message is made up for by the next.
+struct EPNCredit
+{
+  uint32_t magic;       ///< kEPNCreditMagic
+  uint32_t epnIndex;    ///< position of the EPN in the output list of the FLPs
+  uint64_t session;     ///< changes when the EPN restarts and its counts start from 0
+  uint64_t finished;    ///< timeframes forwarded or discarded
+  uint64_t limit;       ///< sub-timeframes an FLP may have sent in total
+  uint64_t bytesPerFLP; ///< payload bytes an FLP may have in flight, 0 for no limit
+};
+
+/// What an FLP gives up when the queue of an output is full. With flow control
+/// the EPN is told about every drop, the credit counts the dropped parts as sent.
+enum DropPolicy {
+  kDropOldest,   ///< the sub-timeframe that waited longest
+  kDropNewest,   ///< the arriving sub-timeframe
+  kDropTimeframe ///< the arriving sub-timeframe, and the EPN is told to discard its whole timeframe
+};
+
+/// "oldest", "newest" or "timeframe", false for anything else
+bool ParseDropPolicy(const std::string& name, DropPolicy& policy);
+const char* GetDropPolicyName(DropPolicy policy);
+
+/// Credit of the EPNs as seen by an FLP.
+///
+/// Sub-timeframes in flight to an EPN are the ones sent beyond its finished
+/// count. Timeframes finish roughly in the order they were sent, so the bytes
+/// in flight are taken to be the sizes of the most recent ones. Without a
+/// credit message from an EPN nothing may be sent to it.
+class CreditTracker
+{
+  public:
+    CreditTracker();
+    ~CreditTracker();
+
+    /// enabled == false lets everything pass
+    void Init(int numOutputs, bool enabled);
+    bool IsEnabled() const { return fEnabled; }
+
+    /// applies the credit of an EPN, returns true if its output got more room
+    bool Grant(const EPNCredit& credit);
+
+    /// true if a sub-timeframe of bytes may be sent to output now. A single
+    /// sub-timeframe larger than the byte credit passes when nothing is in flight.
+    bool CanSend(int output, size_t bytes) const;
+    /// charges a sent sub-timeframe to the credit of output. A sub-timeframe
+    /// dropped for output is charged with 0 bytes, its timeframe counts as
+    /// finished on the EPN as well.
+    void Charge(int output, size_t bytes);
+
+    uint64_t GetNumInFlight(int output) const;
+    uint64_t GetBytesInFlight(int output) const { return fOutputs.at(output).bytesInFlight; }
+
+  private:
+    struct Output
+    {
+      bool granted;
+      uint64_t session;
+      uint64_t sent;
+      uint64_t finished;
+      uint64_t limit;
+      uint64_t bytesPerFLP;
+      uint64_t bytesInFlight;
+      RingBuffer<size_t> inFlight; ///< sizes of the sub-timeframes in flight, oldest first
+    };
+
+    void retire(Output& output);
+
+    bool fEnabled;
+    std::vector<Output> fOutputs;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
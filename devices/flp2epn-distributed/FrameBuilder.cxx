@@ -11,7 +11,10 @@
 #include "FairMQLogger.h"
 #include "FairMQPoller.h"
 
+#include "Metrics.h"
+
 #include "FrameBuilder.h"
+#include "Placement.h"
 
 using namespace AliceO2::Devices;
 
@@ -24,12 +27,19 @@ void FrameBuilder::Run()
   LOG(INFO) << ">>>>>>> Run <<<<<<<";
 
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
+  Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
 
   FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
 
   int received = 0;
   int noOfMsgParts = fNumInputs - 1;
 
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  std::string label = Metrics::DeviceLabel(fId);
+  Metrics::Counter& partsMetric = metrics.AddCounter("o2_framebuilder_parts_total", "Message parts forwarded", label);
+  Metrics::Counter& bytesMetric = metrics.AddCounter("o2_framebuilder_bytes_total", "Bytes forwarded", label);
+  Metrics::Counter& framesMetric = metrics.AddCounter("o2_framebuilder_frames_total", "Frames completed (last part sent)", label);
+
   while (fState == RUNNING) {
     FairMQMessage* msg = fTransportFactory->CreateMessage();
 
@@ -43,7 +53,10 @@ void FrameBuilder::Run()
             fPayloadOutputs->at(0)->Send(msg, "snd-more");
           } else {
             fPayloadOutputs->at(0)->Send(msg);
+            framesMetric.Increment();
           }
+          partsMetric.Increment();
+          bytesMetric.Increment(received);
         }
       }
     }
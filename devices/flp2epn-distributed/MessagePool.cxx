@@ -0,0 +1,65 @@
+/**
+ * MessagePool.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include "FairMQLogger.h"
+
+#include "MessagePool.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+MessagePool::MessagePool()
+  : fTransportFactory(NULL)
+  , fFree()
+  , fCapacity(0)
+  , fNumAcquired(0)
+  , fNumAllocations(0)
+{
+}
+
+MessagePool::~MessagePool()
+{
+  for (size_t i = 0; i < fFree.size(); ++i) {
+    delete fFree.at(i);
+  }
+}
+
+void MessagePool::Init(FairMQTransportFactory* factory, size_t capacity)
+{
+  fTransportFactory = factory;
+  fCapacity = capacity;
+
+  fFree.reserve(fCapacity);
+  while (fFree.size() < fCapacity) {
+    fFree.push_back(fTransportFactory->CreateMessage());
+  }
+}
+
+FairMQMessage* MessagePool::Acquire()
+{
+  ++fNumAcquired;
+
+  if (fFree.empty()) {
+    // grow the pool: the new message is kept on release, so the allocation is not repeated.
+    ++fCapacity;
+    ++fNumAllocations;
+    // room for it in the free list now, Release() must not allocate.
+    fFree.reserve(fCapacity);
+    return fTransportFactory->CreateMessage();
+  }
+
+  FairMQMessage* msg = fFree.back();
+  fFree.pop_back();
+  return msg;
+}
+
+void MessagePool::Release(FairMQMessage* msg)
+{
+  // drop the content (the transport frees it once it is sent), keep the object.
+  msg->Rebuild();
+  fFree.push_back(msg);
+}
@@ -0,0 +1,63 @@
+/**
+ * MessagePool.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_MESSAGEPOOL_H_
+#define ALICEO2_DEVICES_MESSAGEPOOL_H_
+
+#include <vector>
+#include <cstddef>
+
+#include "FairMQMessage.h"
+#include "FairMQTransportFactory.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Recycles FairMQMessage objects on the send/receive path of the devices.
+///
+/// The pool is filled once with empty messages. Acquire() hands one out,
+/// Release() drops its content (Rebuild()) and puts the object back, so in
+/// steady state no message objects are created or destroyed. If the pool runs
+/// dry it grows by one message, counted in GetNumAllocations(); a value that
+/// stops increasing after the warm-up proves that the hot path is free of
+/// message allocations. Not thread-safe, every thread uses its own pool.
+class MessagePool
+{
+  public:
+    MessagePool();
+    ~MessagePool();
+
+    void Init(FairMQTransportFactory* factory, size_t capacity);
+
+    FairMQMessage* Acquire();
+    void Release(FairMQMessage* msg);
+
+    size_t GetCapacity() const { return fCapacity; }
+    size_t GetNumAvailable() const { return fFree.size(); }
+    /// messages currently handed out
+    size_t GetNumInUse() const { return fCapacity - fFree.size(); }
+    /// messages handed out since Init()
+    unsigned long GetNumAcquired() const { return fNumAcquired; }
+    /// messages created because the pool was empty (not counting the preallocated ones)
+    unsigned long GetNumAllocations() const { return fNumAllocations; }
+
+  private:
+    /// copy constructor prohibited
+    MessagePool(const MessagePool&);
+    /// assignment operator prohibited
+    MessagePool& operator=(const MessagePool&);
+
+    FairMQTransportFactory* fTransportFactory;
+    std::vector<FairMQMessage*> fFree;
+    size_t fCapacity;
+    unsigned long fNumAcquired;
+    unsigned long fNumAllocations;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * RingBuffer.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_RINGBUFFER_H_
+#define ALICEO2_DEVICES_RINGBUFFER_H_
+
+#include <vector>
+#include <cstddef>
+
+namespace AliceO2 {
+namespace Devices {
+
+/// FIFO with the interface subset of std::queue used by the devices.
+/// Storage is a contiguous ring that only grows (doubling) when full, so once
+/// the steady-state depth has been reached push/pop do not touch the heap
+/// (std::queue over std::deque allocates and frees a chunk every few entries).
+template<typename T>
+class RingBuffer
+{
+  public:
+    explicit RingBuffer(size_t capacity = 64)
+      : fBuffer(capacity > 0 ? capacity : 1)
+      , fHead(0)
+      , fSize(0)
+    {
+    }
+
+    bool empty() const { return fSize == 0; }
+    size_t size() const { return fSize; }
+    size_t capacity() const { return fBuffer.size(); }
+
+    T& front() { return fBuffer[fHead]; }
+    const T& front() const { return fBuffer[fHead]; }
+
+    T& back() { return fBuffer[index(fSize - 1)]; }
+
+    /// element i counted from the front
+    T& operator[](size_t i) { return fBuffer[index(i)]; }
+
+    void push(const T& value)
+    {
+      if (fSize == fBuffer.size()) {
+        grow();
+      }
+      fBuffer[index(fSize)] = value;
+      ++fSize;
+    }
+
+    void pop()
+    {
+      fHead = index(1);
+      --fSize;
+    }
+
+  private:
+    size_t index(size_t i) const
+    {
+      size_t pos = fHead + i;
+      return pos < fBuffer.size() ? pos : pos - fBuffer.size();
+    }
+
+    void grow()
+    {
+      std::vector<T> buffer(fBuffer.size() * 2);
+      for (size_t i = 0; i < fSize; ++i) {
+        buffer[i] = fBuffer[index(i)];
+      }
+      fBuffer.swap(buffer);
+      fHead = 0;
+    }
+
+    std::vector<T> fBuffer;
+    size_t fHead;
+    size_t fSize;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * SPSCQueue.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_SPSCQUEUE_H_
+#define ALICEO2_DEVICES_SPSCQUEUE_H_
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstddef>
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Bounded lock-free queue between exactly one producer and one consumer
+/// thread. The capacity is rounded up to a power of two. Producer and
+/// consumer indices live on separate cache lines and each side caches the
+/// other's index, so a push or pop touches shared memory only when the cached
+/// value says the queue is full or empty.
+template<typename T>
+class SPSCQueue
+{
+  public:
+    explicit SPSCQueue(size_t capacity)
+      : fBuffer(RoundUp(capacity))
+      , fMask(fBuffer.size() - 1)
+      , fTail(0)
+      , fCachedHead(0)
+      , fHead(0)
+      , fCachedTail(0)
+    {
+    }
+
+    /// producer side, false if the queue is full
+    bool TryPush(const T& value)
+    {
+      size_t tail = fTail.load(std::memory_order_relaxed);
+      if (tail - fCachedHead == fBuffer.size()) {
+        fCachedHead = fHead.load(std::memory_order_acquire);
+        if (tail - fCachedHead == fBuffer.size()) {
+          return false;
+        }
+      }
+      fBuffer[tail & fMask] = value;
+      fTail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// consumer side, false if the queue is empty
+    bool TryPop(T& value)
+    {
+      size_t head = fHead.load(std::memory_order_relaxed);
+      if (head == fCachedTail) {
+        fCachedTail = fTail.load(std::memory_order_acquire);
+        if (head == fCachedTail) {
+          return false;
+        }
+      }
+      value = fBuffer[head & fMask];
+      fHead.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// exact only when called from one of the two sides while the other is idle
+    size_t SizeApprox() const
+    {
+      return fTail.load(std::memory_order_acquire) - fHead.load(std::memory_order_acquire);
+    }
+
+    size_t GetCapacity() const { return fBuffer.size(); }
+
+  private:
+    SPSCQueue(const SPSCQueue&);
+    SPSCQueue& operator=(const SPSCQueue&);
+
+    static size_t RoundUp(size_t n)
+    {
+      size_t size = 1;
+      while (size < n) {
+        size <<= 1;
+      }
+      return size;
+    }
+
+    std::vector<T> fBuffer;
+    size_t fMask;
+    char fPadding0[64];
+    std::atomic<size_t> fTail; // written by the producer
+    size_t fCachedHead;
+    char fPadding1[64];
+    std::atomic<size_t> fHead; // written by the consumer
+    size_t fCachedTail;
+    char fPadding2[64];
+};
+
+/// Waiting strategy for a thread polling lock-free queues: spins first, then
+/// yields, then sleeps for up to maxSleep, so an idle thread does not burn a
+/// core and a busy one does not pay for a syscall per item.
+class Backoff
+{
+  public:
+    Backoff() : fCount(0) {}
+
+    void Reset() { fCount = 0; }
+
+    void Pause(std::chrono::microseconds maxSleep = std::chrono::microseconds(100))
+    {
+      if (fCount < 64) {
+        ++fCount;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+      } else if (fCount < 128) {
+        ++fCount;
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(maxSleep);
+      }
+    }
+
+  private:
+    int fCount;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
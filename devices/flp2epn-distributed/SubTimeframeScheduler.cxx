@@ -0,0 +1,315 @@
+/**
+ * SubTimeframeScheduler.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm> // max
+#include <limits>
+
+#include "FairMQLogger.h"
+
+#include "SubTimeframeScheduler.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+SubTimeframeScheduler::SubTimeframeScheduler()
+  : fSelector()
+  , fShaper()
+  , fCredit()
+  , fDropPolicy(kDropTimeframe)
+  , fQueueCapacity(0)
+  , fHeartbeatTimeoutInMs(20000)
+  , fTimers(NULL)
+  , fTransport(NULL)
+  , fQueues()
+  , fRetryScheduled()
+  , fLastHeartbeat()
+  , fLastHeartbeatSession()
+  , fLastHeartbeatTimestamp()
+  , fMetricDropped(NULL)
+  , fMetricDropNotices(NULL)
+  , fMetricCreditWaits(NULL)
+  , fMetricDiscarded(NULL)
+  , fMetricQueued(NULL)
+  , fMetricEPNsAlive(NULL)
+  , fMetricShapingDelay(NULL)
+{
+}
+
+SubTimeframeScheduler::~SubTimeframeScheduler()
+{
+}
+
+void SubTimeframeScheduler::Init(int numOutputs, EPNSelector* selector, int heartbeatTimeoutInMs, bool flowControl,
+                                 size_t queueCapacity, DropPolicy dropPolicy, TimerWheel* timers, Transport* transport)
+{
+  fSelector.reset(selector);
+  fHeartbeatTimeoutInMs = heartbeatTimeoutInMs;
+  fQueueCapacity = queueCapacity;
+  fDropPolicy = dropPolicy;
+  fTimers = timers;
+  fTransport = transport;
+
+  fCredit.Init(numOutputs, flowControl);
+
+  fQueues.assign(numOutputs, RingBuffer<Entry>(8));
+  fRetryScheduled.assign(numOutputs, false);
+
+  Clock::time_point now = fTransport->Now();
+  fLastHeartbeat.assign(numOutputs, now);
+  fLastHeartbeatSession.assign(numOutputs, 0);
+  fLastHeartbeatTimestamp.assign(numOutputs, numeric_limits<int64_t>::min());
+
+  schedule(now, &TimerWheel::Member<SubTimeframeScheduler, &SubTimeframeScheduler::checkLiveness>, 0);
+}
+
+void SubTimeframeScheduler::SetMetrics(Metrics::Counter* dropped, Metrics::Counter* dropNotices, Metrics::Counter* creditWaits,
+                                       Metrics::Counter* discarded, Metrics::Gauge* queued, Metrics::Gauge* epnsAlive,
+                                       Metrics::Histogram* shapingDelay)
+{
+  fMetricDropped = dropped;
+  fMetricDropNotices = dropNotices;
+  fMetricCreditWaits = creditWaits;
+  fMetricDiscarded = discarded;
+  fMetricQueued = queued;
+  fMetricEPNsAlive = epnsAlive;
+  fMetricShapingDelay = shapingDelay;
+
+  fMetricEPNsAlive->Set(fSelector->GetNumAlive());
+}
+
+bool SubTimeframeScheduler::Dispatch(const SubTimeframeHeader& h, FairMQMessage* payload)
+{
+  // for which EPN is the message? timeframes of dead EPNs are remapped to live ones.
+  int output = fSelector->Route(h.timeframeId);
+
+  if (output < 0) {
+    // no EPN has sent a heartbeat within the timeout, discard the data.
+    LOG(WARN) << "No EPN alive, discarding timeframe #" << h.timeframeId;
+    fTransport->Release(payload);
+    fMetricDiscarded->Increment();
+    return false;
+  }
+
+  Clock::time_point now = fTransport->Now();
+  Clock::time_point departure = fShaper.Reserve(output, h.size, now);
+  fMetricShapingDelay->Observe(departure > now ? chrono::duration_cast<chrono::microseconds>(departure - now).count() : 0);
+
+  bool credit = fCredit.CanSend(output, h.size);
+  if (!credit) {
+    fMetricCreditWaits->Increment();
+  }
+
+  if (!(departure <= now && credit && fQueues[output].empty() && send(output, h, payload))) {
+    Entry entry = { h, payload, departure };
+    enqueue(output, entry);
+  }
+  return true;
+}
+
+void SubTimeframeScheduler::UpdateHeartbeat(const EPNHeartbeat& heartbeat)
+{
+  if (heartbeat.epnIndex >= fQueues.size()) {
+    LOG(ERROR) << "Heartbeat from EPN#" << heartbeat.epnIndex << ", but only " << fQueues.size() << " EPNs are configured";
+    return;
+  }
+  int epn = heartbeat.epnIndex;
+
+  // the stamps order the occupancy reports, the EPN may send one in the same microsecond as a heartbeat.
+  EPNOccupancy occupancy;
+  occupancy.effectiveFrom = heartbeat.effectiveFrom;
+  occupancy.freeSlots = heartbeat.freeSlots;
+  fSelector->Report(epn, occupancy);
+
+  // a restarted or moved EPN has a clock of its own, its heartbeats are ordered from its first one on.
+  if (heartbeat.session != fLastHeartbeatSession[epn]) {
+    if (fLastHeartbeatSession[epn] != 0) {
+      LOG(INFO) << "EPN#" << epn << " has restarted";
+    }
+    fLastHeartbeatSession[epn] = heartbeat.session;
+  } else if (heartbeat.timestamp <= fLastHeartbeatTimestamp[epn]) {
+    return;
+  }
+  fLastHeartbeatTimestamp[epn] = heartbeat.timestamp;
+  fLastHeartbeat[epn] = fTransport->Now();
+
+  if (!fSelector->IsAlive(epn)) {
+    LOG(INFO) << "EPN#" << epn << " is alive again";
+    fSelector->SetAlive(epn, true);
+    fMetricEPNsAlive->Set(fSelector->GetNumAlive());
+  }
+}
+
+void SubTimeframeScheduler::UpdateCredit(const EPNCredit& credit)
+{
+  if (credit.epnIndex >= fQueues.size()) {
+    LOG(ERROR) << "Credit from EPN#" << credit.epnIndex << ", but only " << fQueues.size() << " EPNs are configured";
+    return;
+  }
+
+  if (fCredit.Grant(credit)) {
+    flush(credit.epnIndex);
+  }
+}
+
+void SubTimeframeScheduler::Clear()
+{
+  for (size_t i = 0; i < fQueues.size(); ++i) {
+    while (!fQueues[i].empty()) {
+      fTransport->Release(fQueues[i].front().payload);
+      fShaper.Refund(i, fQueues[i].front().header.size);
+      fQueues[i].pop();
+      fShaper.Dequeue(i);
+    }
+  }
+  fMetricQueued->Set(fShaper.GetQueueDepth());
+}
+
+void SubTimeframeScheduler::schedule(Clock::time_point deadline, TimerWheel::Callback callback, uint64_t cookie)
+{
+  fTimers->Schedule(deadline, callback, this, cookie);
+  fTransport->Scheduled(deadline);
+}
+
+bool SubTimeframeScheduler::send(int output, const SubTimeframeHeader& h, FairMQMessage* payload)
+{
+  if (!fTransport->Send(output, h, payload)) {
+    return false;
+  }
+  // a send that failed after the socket took the header is lost like a dropped one, the EPN finishes it all the same.
+  fCredit.Charge(output, h.size);
+  return true;
+}
+
+void SubTimeframeScheduler::drop(int output, const Entry& entry)
+{
+  fMetricDropped->Increment();
+
+  // the EPN finishes the timeframe without this part, for the credit the part counts as sent. The EPN has
+  // to hear about it then: a timeframe dropped by every FLP would never reach it and never be finished.
+  fCredit.Charge(output, 0);
+  if (fDropPolicy == kDropTimeframe || fCredit.IsEnabled()) {
+    if (fTransport->SendNotice(output, entry.header, kDropped)) {
+      fMetricDropNotices->Increment();
+    }
+  }
+  // otherwise the EPN discards the timeframe after its buffer timeout.
+  fTransport->Release(entry.payload);
+  // the bytes never went out, the rate limit of the output does not count them.
+  fShaper.Refund(output, entry.header.size);
+}
+
+void SubTimeframeScheduler::enqueue(int output, const Entry& entry)
+{
+  RingBuffer<Entry>& queue = fQueues[output];
+
+  if (fQueueCapacity > 0 && queue.size() >= fQueueCapacity) {
+    if (fDropPolicy == kDropOldest) {
+      drop(output, queue.front());
+      queue.pop();
+      fShaper.Dequeue(output);
+    } else {
+      drop(output, entry);
+      return;
+    }
+  }
+
+  queue.push(entry);
+  fShaper.Enqueue(output);
+  fMetricQueued->Set(fShaper.GetQueueDepth());
+
+  if (entry.departure > fTransport->Now()) {
+    schedule(entry.departure, &TimerWheel::Member<SubTimeframeScheduler, &SubTimeframeScheduler::sendQueued>, output);
+  } else {
+    flush(output);
+  }
+}
+
+void SubTimeframeScheduler::flush(int output)
+{
+  RingBuffer<Entry>& queue = fQueues[output];
+  Clock::time_point now = fTransport->Now();
+
+  // departures of an output never decrease, what is not due yet has a timer of its own.
+  while (!queue.empty() && queue.front().departure <= now) {
+    Entry& entry = queue.front();
+
+    if (!fCredit.CanSend(output, entry.header.size)) {
+      // the next credit message from the EPN continues.
+      break;
+    }
+    // a departure within the slot comes due outside of it after a wait for credit, the socket or the timer.
+    Clock::time_point slot = fShaper.AlignToSlot(now);
+    if (slot > now) {
+      retry(output, slot);
+      break;
+    }
+    if (!send(output, entry.header, entry.payload)) {
+      retry(output, now + chrono::milliseconds(1));
+      break;
+    }
+
+    queue.pop();
+    fShaper.Dequeue(output);
+  }
+
+  fMetricQueued->Set(fShaper.GetQueueDepth());
+}
+
+void SubTimeframeScheduler::retry(int output, Clock::time_point deadline)
+{
+  if (!fRetryScheduled[output]) {
+    fRetryScheduled[output] = true;
+    schedule(deadline, &TimerWheel::Member<SubTimeframeScheduler, &SubTimeframeScheduler::retrySend>, output);
+  }
+}
+
+void SubTimeframeScheduler::dropQueued(int output)
+{
+  RingBuffer<Entry>& queue = fQueues[output];
+
+  while (!queue.empty()) {
+    drop(output, queue.front());
+    queue.pop();
+    fShaper.Dequeue(output);
+  }
+
+  fMetricQueued->Set(fShaper.GetQueueDepth());
+}
+
+void SubTimeframeScheduler::sendQueued(uint64_t output)
+{
+  flush(output);
+}
+
+void SubTimeframeScheduler::retrySend(uint64_t output)
+{
+  fRetryScheduled[output] = false;
+  flush(output);
+}
+
+void SubTimeframeScheduler::checkLiveness(uint64_t)
+{
+  Clock::time_point now = fTransport->Now();
+  Clock::time_point deadline = now - chrono::milliseconds(fHeartbeatTimeoutInMs);
+
+  for (size_t i = 0; i < fQueues.size(); ++i) {
+    if (fLastHeartbeat[i] < deadline && fSelector->IsAlive(i)) {
+      LOG(WARN) << "No heartbeat from EPN#" << i << " for " << fHeartbeatTimeoutInMs
+                << " ms, sending its timeframes to the remaining " << fSelector->GetNumAlive() - 1 << " EPNs";
+      fSelector->SetAlive(i, false);
+      fMetricEPNsAlive->Set(fSelector->GetNumAlive());
+      if (fCredit.IsEnabled()) {
+        // no credit comes from a dead EPN, its queue would never drain.
+        dropQueued(i);
+      }
+    }
+  }
+
+  // a quarter of the timeout bounds the detection delay to 1.25 timeouts.
+  schedule(now + chrono::milliseconds(max(fHeartbeatTimeoutInMs / 4, 1)),
+           &TimerWheel::Member<SubTimeframeScheduler, &SubTimeframeScheduler::checkLiveness>, 0);
+}
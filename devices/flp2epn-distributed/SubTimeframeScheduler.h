@@ -0,0 +1,143 @@
+/**
+ * SubTimeframeScheduler.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_SUBTIMEFRAMESCHEDULER_H_
+#define ALICEO2_DEVICES_SUBTIMEFRAMESCHEDULER_H_
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "FairMQMessage.h"
+
+#include "Metrics.h"
+
+#include "EPNSelector.h"
+#include "FlowControl.h"
+#include "RingBuffer.h"
+#include "TimeframeHeader.h"
+#include "TimerWheel.h"
+#include "TrafficShaper.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// The sending side of an FLP without the sockets: the route of every
+/// timeframe to its EPN and the liveness table behind it, the traffic shaper,
+/// the credit of the EPNs and a queue per output with its drop policy.
+///
+/// The owner hands over the sub-timeframes and the heartbeat and credit
+/// messages of the EPNs, the scheduler sends through Transport when the
+/// shaper, the credit and the socket let it. FLPex drives it with its
+/// sockets and the clock, TopologySimulator with simulated links and time.
+/// The timers go on the wheel of the owner. Not thread-safe.
+class SubTimeframeScheduler
+{
+  public:
+    typedef TimerWheel::Clock Clock;
+
+    class Transport
+    {
+      public:
+        virtual ~Transport() {}
+
+        /// sends the header and the payload, false if the output would block and the payload stays queued
+        virtual bool Send(int output, const SubTimeframeHeader& h, FairMQMessage* payload) = 0;
+        /// a header with flag and an empty payload, false if the output would block
+        virtual bool SendNotice(int output, const SubTimeframeHeader& h, uint16_t flag) = 0;
+        /// takes back the payload of a sub-timeframe the scheduler dropped
+        virtual void Release(FairMQMessage* payload) = 0;
+
+        virtual Clock::time_point Now() const { return Clock::now(); }
+        /// a timer of the scheduler has been set for deadline, for an owner that does not advance the wheel on its own
+        virtual void Scheduled(Clock::time_point /*deadline*/) {}
+    };
+
+    SubTimeframeScheduler();
+    ~SubTimeframeScheduler();
+
+    /// takes ownership of the selector. The EPNs count as alive until they have been silent for the heartbeat
+    /// timeout from now. A queue capacity of 0 leaves the queues unbounded.
+    void Init(int numOutputs, EPNSelector* selector, int heartbeatTimeoutInMs, bool flowControl, size_t queueCapacity,
+              DropPolicy dropPolicy, TimerWheel* timers, Transport* transport);
+    /// counters and histograms of the owner
+    void SetMetrics(Metrics::Counter* dropped, Metrics::Counter* dropNotices, Metrics::Counter* creditWaits,
+                    Metrics::Counter* discarded, Metrics::Gauge* queued, Metrics::Gauge* epnsAlive,
+                    Metrics::Histogram* shapingDelay);
+
+    /// routes a sub-timeframe of h.size bytes to its EPN and sends it right away or queues it.
+    /// Returns false and releases the payload if no EPN is alive.
+    bool Dispatch(const SubTimeframeHeader& h, FairMQMessage* payload);
+
+    void UpdateHeartbeat(const EPNHeartbeat& heartbeat);
+    void UpdateCredit(const EPNCredit& credit);
+
+    /// releases everything queued
+    void Clear();
+
+    int GetNumOutputs() const { return fQueues.size(); }
+    EPNSelector& GetSelector() { return *fSelector; }
+    const EPNSelector& GetSelector() const { return *fSelector; }
+    TrafficShaper& GetShaper() { return fShaper; }
+    const TrafficShaper& GetShaper() const { return fShaper; }
+
+  private:
+    struct Entry
+    {
+      SubTimeframeHeader header; // the header message is built at send time
+      FairMQMessage* payload;
+      Clock::time_point departure;
+    };
+
+    SubTimeframeScheduler(const SubTimeframeScheduler&);
+    SubTimeframeScheduler& operator=(const SubTimeframeScheduler&);
+
+    void schedule(Clock::time_point deadline, TimerWheel::Callback callback, uint64_t cookie);
+    bool send(int output, const SubTimeframeHeader& h, FairMQMessage* payload);
+    /// gives up a sub-timeframe for output: charges it to the credit, refunds it to the shaper, tells the EPN where needed
+    void drop(int output, const Entry& entry);
+    void enqueue(int output, const Entry& entry);
+    /// sends from the front of the queue what is due and covered by credit
+    void flush(int output);
+    /// flushes output again at deadline, once
+    void retry(int output, Clock::time_point deadline);
+    void dropQueued(int output);
+    void sendQueued(uint64_t output);
+    void retrySend(uint64_t output);
+    void checkLiveness(uint64_t);
+
+    std::unique_ptr<EPNSelector> fSelector;
+    TrafficShaper fShaper;
+    CreditTracker fCredit;
+    DropPolicy fDropPolicy;
+    size_t fQueueCapacity;
+    int fHeartbeatTimeoutInMs;
+    TimerWheel* fTimers;
+    Transport* fTransport;
+
+    // per output: sub-timeframes waiting for their departure, for credit or for room in the socket
+    std::vector<RingBuffer<Entry> > fQueues;
+    std::vector<bool> fRetryScheduled;
+
+    // liveness table, indexed by EPN
+    std::vector<Clock::time_point> fLastHeartbeat; // local arrival time
+    std::vector<uint64_t> fLastHeartbeatSession;
+    std::vector<int64_t> fLastHeartbeatTimestamp; // EPN clock, to skip reordered heartbeats of a session
+
+    Metrics::Counter* fMetricDropped; // full queue
+    Metrics::Counter* fMetricDropNotices;
+    Metrics::Counter* fMetricCreditWaits;
+    Metrics::Counter* fMetricDiscarded; // no EPN alive
+    Metrics::Gauge* fMetricQueued;
+    Metrics::Gauge* fMetricEPNsAlive;
+    Metrics::Histogram* fMetricShapingDelay; // us
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
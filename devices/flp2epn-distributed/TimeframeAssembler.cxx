@@ -0,0 +1,223 @@
+/**
+ * TimeframeAssembler.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include "FairMQLogger.h"
+
+#include "TimeframeAssembler.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+TimeframeAssembler::TimeframeAssembler()
+  : fWindow()
+  , fNumFLPs(0)
+  , fBufferTimeoutInMs(1000)
+  , fReleaseDeadlineInMs(0)
+  , fTimers(NULL)
+  , fOutput(NULL)
+  , fForgone()
+  , fNumForwarded(0)
+  , fMetricCompleted(NULL)
+  , fMetricPartial(NULL)
+  , fMetricReleased(NULL)
+  , fMetricTimedOut(NULL)
+  , fMetricDropped(NULL)
+  , fMetricAssemblyTime(NULL)
+{
+}
+
+TimeframeAssembler::~TimeframeAssembler()
+{
+}
+
+void TimeframeAssembler::Init(size_t windowSize, int numFLPs, MessagePool* pool, int bufferTimeoutInMs, int releaseDeadlineInMs,
+                              TimerWheel* timers, Output* output)
+{
+  fWindow.Init(windowSize, numFLPs, pool);
+  fNumFLPs = numFLPs;
+  fBufferTimeoutInMs = bufferTimeoutInMs;
+  fReleaseDeadlineInMs = releaseDeadlineInMs;
+  fTimers = timers;
+  fOutput = output;
+  fForgone.reserve(windowSize);
+  fNumForwarded = 0;
+}
+
+void TimeframeAssembler::SetMetrics(Metrics::Counter* completed, Metrics::Counter* partial, Metrics::Counter* released,
+                                    Metrics::Counter* timedOut, Metrics::Counter* dropped, Metrics::Histogram* assemblyTime)
+{
+  fMetricCompleted = completed;
+  fMetricPartial = partial;
+  fMetricReleased = released;
+  fMetricTimedOut = timedOut;
+  fMetricDropped = dropped;
+  fMetricAssemblyTime = assemblyTime;
+}
+
+TimeframeWindow::Result TimeframeAssembler::Add(const SubTimeframeHeader& h, int flpIndex, FairMQMessage* part, Clock::time_point now)
+{
+  uint64_t id = h.timeframeId;
+
+  evict(id);
+  TimeframeWindow::Result result = fWindow.Add(id, flpIndex, part, now);
+
+  switch (result) {
+    case TimeframeWindow::Added:
+      fWindow.Get(id).headers[flpIndex] = h;
+      scheduleDeadline(id, now);
+      break;
+    case TimeframeWindow::Completed:
+      fWindow.Get(id).headers[flpIndex] = h;
+      fTimers->Cancel(fWindow.Get(id).timer);
+      fMetricAssemblyTime->Observe(chrono::duration_cast<chrono::microseconds>(now - fWindow.Get(id).startTime).count());
+      forward(id);
+      break;
+    default:
+      break;
+  }
+
+  return result;
+}
+
+void TimeframeAssembler::Drop(uint64_t id, int flpIndex, Clock::time_point now)
+{
+  evict(id);
+
+  if (fReleaseDeadlineInMs <= 0) {
+    // an FLP gave up its part, the rest of the timeframe is of no use.
+    TimeframeWindow::Slot& slot = fWindow.Get(id);
+    if (fWindow.IsAssembling(id)) {
+      fTimers->Cancel(slot.timer);
+      fOutput->Discarding(slot);
+    }
+    if (fWindow.Abandon(id)) {
+      LOG(WARN) << "Timeframe #" << id << " dropped by FLP#" << flpIndex << ", discarding";
+      fMetricDropped->Increment();
+    }
+    return;
+  }
+
+  // the consumer takes incomplete timeframes, this one goes out without the part of the FLP.
+  switch (fWindow.Skip(id, flpIndex, now)) {
+    case TimeframeWindow::Added:
+      scheduleDeadline(id, now);
+      break;
+    case TimeframeWindow::Completed:
+      fTimers->Cancel(fWindow.Get(id).timer);
+      finish(id);
+      break;
+    default:
+      // already forwarded or discarded, or the FLP has delivered its part after all.
+      break;
+  }
+}
+
+void TimeframeAssembler::Forgo(int flpIndex)
+{
+  fForgone.clear();
+  fWindow.Forgo(flpIndex, fForgone);
+  for (size_t i = 0; i < fForgone.size(); ++i) {
+    fTimers->Cancel(fWindow.Get(fForgone[i]).timer);
+    finish(fForgone[i]);
+  }
+}
+
+void TimeframeAssembler::Expect(int flpIndex)
+{
+  fWindow.Expect(flpIndex, true);
+}
+
+void TimeframeAssembler::Clear()
+{
+  for (size_t i = 0; i < fWindow.GetCapacity(); ++i) {
+    TimeframeWindow::Slot& slot = fWindow.Get(i);
+    if (slot.state == TimeframeWindow::Slot::Assembling) {
+      fTimers->Cancel(slot.timer);
+      fOutput->Discarding(slot);
+    }
+  }
+  fWindow.Clear();
+}
+
+void TimeframeAssembler::evict(uint64_t id)
+{
+  TimeframeWindow::Slot& slot = fWindow.Get(id);
+
+  if (slot.state == TimeframeWindow::Slot::Assembling && slot.id < id) {
+    fTimers->Cancel(slot.timer);
+    fOutput->Discarding(slot);
+  }
+}
+
+void TimeframeAssembler::scheduleDeadline(uint64_t id, Clock::time_point now)
+{
+  TimeframeWindow::Slot& slot = fWindow.Get(id);
+  if (slot.timer != TimerWheel::kInvalidTimer) {
+    return;
+  }
+
+  // the timeframe has just started, with a part or a drop notice: its timeout, or its release deadline instead.
+  Clock::time_point deadline;
+  if (fReleaseDeadlineInMs > 0) {
+    deadline = now + chrono::milliseconds(fReleaseDeadlineInMs);
+    slot.timer = fTimers->Schedule(deadline, &TimerWheel::Member<TimeframeAssembler, &TimeframeAssembler::release>, this, id);
+  } else {
+    deadline = now + chrono::milliseconds(fBufferTimeoutInMs);
+    slot.timer = fTimers->Schedule(deadline, &TimerWheel::Member<TimeframeAssembler, &TimeframeAssembler::expire>, this, id);
+  }
+  fOutput->Scheduled(deadline);
+}
+
+bool TimeframeAssembler::finish(uint64_t id, bool released)
+{
+  if (fWindow.Get(id).count > 0) {
+    forward(id, released);
+    return true;
+  }
+
+  // opened by drop notices only, every FLP still expected dropped its part: there is nothing to forward.
+  LOG(WARN) << "Timeframe #" << id << " dropped by all FLPs, discarding";
+  fOutput->Discarding(fWindow.Get(id));
+  fWindow.Discard(id);
+  fMetricDropped->Increment();
+  return false;
+}
+
+void TimeframeAssembler::forward(uint64_t id, bool released)
+{
+  TimeframeWindow::Slot& slot = fWindow.Get(id);
+  bool partial = slot.count < fNumFLPs;
+
+  fOutput->Forward(id, slot);
+
+  fWindow.Close(id, released);
+  ++fNumForwarded;
+  fMetricCompleted->Increment();
+  if (partial) {
+    fMetricPartial->Increment();
+  }
+}
+
+void TimeframeAssembler::expire(uint64_t id)
+{
+  // like the release deadline, only reached while the timeframe is assembling; checked all the same.
+  if (!fWindow.IsAssembling(id)) {
+    return;
+  }
+
+  fOutput->Discarding(fWindow.Get(id));
+  fWindow.Discard(id);
+  LOG(WARN) << "Timeframe #" << id << " incomplete after " << fBufferTimeoutInMs << " milliseconds, discarding";
+  fMetricTimedOut->Increment();
+}
+
+void TimeframeAssembler::release(uint64_t id)
+{
+  if (fWindow.IsAssembling(id) && finish(id, true)) {
+    fMetricReleased->Increment();
+  }
+}
@@ -0,0 +1,120 @@
+/**
+ * TimeframeAssembler.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TIMEFRAMEASSEMBLER_H_
+#define ALICEO2_DEVICES_TIMEFRAMEASSEMBLER_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "FairMQMessage.h"
+
+#include "Metrics.h"
+
+#include "MessagePool.h"
+#include "TimeframeHeader.h"
+#include "TimeframeWindow.h"
+#include "TimerWheel.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// The assembly of the timeframes on an EPN without the sockets: the
+/// TimeframeWindow, the buffer timeout or the release deadline of every
+/// timeframe, the drop notices and the departures of the FLPs, and the count
+/// of finished timeframes behind the credit of the EPN.
+///
+/// The owner receives the parts, the assembler hands the done timeframes back
+/// through Output. EPNex runs one on its I/O thread in single-threaded mode,
+/// every AssemblyWorker one on its own thread, TopologySimulator one per
+/// simulated EPN. The timers go on the wheel of the owner. Not thread-safe.
+class TimeframeAssembler
+{
+  public:
+    typedef TimerWheel::Clock Clock;
+
+    class Output
+    {
+      public:
+        virtual ~Output() {}
+
+        /// sends the parts present in the slot in FLP order, fewer than the FLPs when some have left or at the
+        /// release deadline. The assembler closes the timeframe afterwards, the parts belong to the owner.
+        virtual void Forward(uint64_t id, TimeframeWindow::Slot& slot) = 0;
+        /// the parts of the slot are about to go to the pool of the window, after a timeout, a drop or an eviction
+        virtual void Discarding(const TimeframeWindow::Slot& /*slot*/) {}
+        /// a timer of the assembler has been set for deadline, for an owner that does not advance the wheel on its own
+        virtual void Scheduled(Clock::time_point /*deadline*/) {}
+    };
+
+    TimeframeAssembler();
+    ~TimeframeAssembler();
+
+    /// pool receives the parts of discarded timeframes (may be NULL). A release deadline > 0 forwards the
+    /// timeframes with the parts they have at the deadline instead of discarding them after the buffer timeout.
+    void Init(size_t windowSize, int numFLPs, MessagePool* pool, int bufferTimeoutInMs, int releaseDeadlineInMs,
+              TimerWheel* timers, Output* output);
+    /// counters and histograms of the owner, timedOut and dropped may be the same
+    void SetMetrics(Metrics::Counter* completed, Metrics::Counter* partial, Metrics::Counter* released,
+                    Metrics::Counter* timedOut, Metrics::Counter* dropped, Metrics::Histogram* assemblyTime);
+
+    /// stores the part of FLP flpIndex with its header h, forwarding the timeframe once it is complete.
+    /// On anything but Added/Completed the part is not stored and stays with the caller.
+    TimeframeWindow::Result Add(const SubTimeframeHeader& h, int flpIndex, FairMQMessage* part, Clock::time_point now);
+    /// the FLP dropped its part: the timeframe is discarded, or with a release deadline forwarded without the part
+    void Drop(uint64_t id, int flpIndex, Clock::time_point now);
+
+    /// stops waiting for the parts of an FLP that has left, forwarding the timeframes complete without it
+    void Forgo(int flpIndex);
+    /// waits for the parts of an FLP that is back, from its next timeframe on
+    void Expect(int flpIndex);
+
+    /// discards everything still assembling
+    void Clear();
+
+    TimeframeWindow& GetWindow() { return fWindow; }
+    const TimeframeWindow& GetWindow() const { return fWindow; }
+    int GetNumAssembling() const { return fWindow.GetNumAssembling(); }
+    size_t GetCapacity() const { return fWindow.GetCapacity(); }
+    /// timeframes forwarded or discarded in any way, the basis of the credit of the EPN
+    uint64_t GetNumFinished() const { return fNumForwarded + fWindow.GetNumDiscarded(); }
+
+  private:
+    TimeframeAssembler(const TimeframeAssembler&);
+    TimeframeAssembler& operator=(const TimeframeAssembler&);
+
+    /// tells the owner about an incomplete timeframe that a newer one of id is about to take the slot of
+    void evict(uint64_t id);
+    /// starts the timeout or the release deadline of a timeframe that has none yet
+    void scheduleDeadline(uint64_t id, Clock::time_point now);
+    /// forwards the timeframe, or discards it if it has no part at all; true if forwarded
+    bool finish(uint64_t id, bool released = false);
+    void forward(uint64_t id, bool released = false);
+    void expire(uint64_t id);
+    void release(uint64_t id);
+
+    TimeframeWindow fWindow;
+    int fNumFLPs;
+    int fBufferTimeoutInMs;
+    int fReleaseDeadlineInMs;
+    TimerWheel* fTimers;
+    Output* fOutput;
+    std::vector<uint64_t> fForgone; // timeframes complete once an FLP has left
+    uint64_t fNumForwarded;
+
+    Metrics::Counter* fMetricCompleted;
+    Metrics::Counter* fMetricPartial;
+    Metrics::Counter* fMetricReleased;
+    Metrics::Counter* fMetricTimedOut;
+    Metrics::Counter* fMetricDropped;
+    Metrics::Histogram* fMetricAssemblyTime;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,380 @@
+/**
+ * TimeframeFile.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <climits> // IOV_MAX
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "FairMQLogger.h"
+
+#include "TimeframeFile.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+namespace {
+
+const char kPadding[kTimeframeFileAlignment] = {};
+
+void initFileHeader(TimeframeFileHeader& header, uint64_t magic)
+{
+  memset(&header, 0, sizeof(TimeframeFileHeader));
+  header.magic = magic;
+  header.version = kTimeframeFileVersion;
+  header.alignment = kTimeframeFileAlignment;
+}
+
+bool isValidFileHeader(const TimeframeFileHeader& header, uint64_t magic)
+{
+  return header.magic == magic && header.version == kTimeframeFileVersion && header.alignment == kTimeframeFileAlignment;
+}
+
+/// writes all of iov, continuing after partial writes
+bool writeAll(int fd, struct iovec* iov, int count)
+{
+  while (count > 0) {
+    ssize_t n = writev(fd, iov, min(count, IOV_MAX));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    size_t written = n;
+    while (count > 0 && written >= iov->iov_len) {
+      written -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+      iov->iov_len -= written;
+    }
+  }
+  return true;
+}
+
+/// opens a file of the recording, writing the header into a new one. Returns the file size, -1 on failure.
+off_t openFile(const string& name, uint64_t magic, int& fd)
+{
+  fd = open(name.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) {
+    LOG(ERROR) << "Cannot open " << name << ": " << strerror(errno);
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    LOG(ERROR) << "Cannot stat " << name << ": " << strerror(errno);
+    return -1;
+  }
+
+  TimeframeFileHeader header;
+  if (st.st_size == 0) {
+    initFileHeader(header, magic);
+    struct iovec iov = { &header, sizeof(TimeframeFileHeader) };
+    if (!writeAll(fd, &iov, 1)) {
+      LOG(ERROR) << "Cannot write to " << name << ": " << strerror(errno);
+      return -1;
+    }
+    return sizeof(TimeframeFileHeader);
+  }
+
+  if (pread(fd, &header, sizeof(TimeframeFileHeader), 0) != sizeof(TimeframeFileHeader) || !isValidFileHeader(header, magic)) {
+    LOG(ERROR) << name << " is no timeframe recording of version " << kTimeframeFileVersion;
+    return -1;
+  }
+  return st.st_size;
+}
+
+} // namespace
+
+TimeframeFileWriter::TimeframeFileWriter()
+  : fDataFd(-1)
+  , fIndexFd(-1)
+  , fDataSize(0)
+  , fNumTimeframes(0)
+  , fIndexRecord()
+{
+}
+
+TimeframeFileWriter::~TimeframeFileWriter()
+{
+  Close();
+}
+
+bool TimeframeFileWriter::Open(const string& name)
+{
+  Close();
+
+  off_t dataSize = openFile(name, kTimeframeDataMagic, fDataFd);
+  off_t indexSize = dataSize < 0 ? -1 : openFile(name + ".idx", kTimeframeIndexMagic, fIndexFd);
+  if (indexSize < 0) {
+    Close();
+    return false;
+  }
+
+  // count the entries, and cut off one that was only partly written when the last recorder stopped.
+  off_t end = sizeof(TimeframeFileHeader);
+  TimeframeIndexEntry entry;
+  while (end + static_cast<off_t>(sizeof(TimeframeIndexEntry)) <= indexSize
+         && pread(fIndexFd, &entry, sizeof(TimeframeIndexEntry), end) == sizeof(TimeframeIndexEntry)) {
+    off_t next = end + sizeof(TimeframeIndexEntry) + entry.numParts * sizeof(uint64_t);
+    if (next > indexSize) {
+      break;
+    }
+    end = next;
+    ++fNumTimeframes;
+  }
+  if (end < indexSize) {
+    LOG(WARN) << "Removing an incomplete index entry at the end of " << name << ".idx";
+    if (ftruncate(fIndexFd, end) != 0) {
+      LOG(ERROR) << "Cannot truncate " << name << ".idx: " << strerror(errno);
+      Close();
+      return false;
+    }
+  }
+
+  fDataSize = dataSize;
+
+  if (fNumTimeframes > 0) {
+    LOG(INFO) << "Appending to " << name << ", which holds " << fNumTimeframes << " timeframes";
+  }
+  return true;
+}
+
+void TimeframeFileWriter::Close()
+{
+  if (fDataFd >= 0) {
+    close(fDataFd);
+  }
+  if (fIndexFd >= 0) {
+    close(fIndexFd);
+  }
+  fDataFd = -1;
+  fIndexFd = -1;
+  fDataSize = 0;
+  fNumTimeframes = 0;
+}
+
+bool TimeframeFileWriter::Append(uint64_t timeframeId, int64_t time, FairMQMessage* directory, const vector<FairMQMessage*>& parts)
+{
+  if (!IsOpen()) {
+    return false;
+  }
+
+  // every part, the directory first, behind the padding to the next aligned offset.
+  vector<struct iovec> iov;
+  iov.reserve(2 * (parts.size() + 1));
+
+  fIndexRecord.resize(sizeof(TimeframeIndexEntry) + parts.size() * sizeof(uint64_t));
+  TimeframeIndexEntry* entry = reinterpret_cast<TimeframeIndexEntry*>(fIndexRecord.data());
+  uint64_t* sizes = reinterpret_cast<uint64_t*>(entry + 1);
+
+  uint64_t offset = fDataSize;
+  for (size_t i = 0; i <= parts.size(); ++i) {
+    FairMQMessage* part = i == 0 ? directory : parts[i - 1];
+    uint64_t aligned = AlignTimeframeFileOffset(offset);
+    if (aligned > offset) {
+      struct iovec padding = { const_cast<char*>(kPadding), aligned - offset };
+      iov.push_back(padding);
+    }
+    if (part->GetSize() > 0) {
+      struct iovec data = { part->GetData(), part->GetSize() };
+      iov.push_back(data);
+    }
+    if (i == 0) {
+      entry->offset = aligned;
+    } else {
+      sizes[i - 1] = part->GetSize();
+    }
+    offset = aligned + part->GetSize();
+  }
+
+  entry->timeframeId = timeframeId;
+  entry->time = time;
+  entry->numParts = parts.size();
+  entry->directorySize = directory->GetSize();
+
+  struct iovec index = { fIndexRecord.data(), fIndexRecord.size() };
+
+  if (!writeAll(fDataFd, iov.data(), iov.size()) || !writeAll(fIndexFd, &index, 1)) {
+    LOG(ERROR) << "Cannot write timeframe #" << timeframeId << " to the recording: " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  fDataSize = offset;
+  ++fNumTimeframes;
+  return true;
+}
+
+TimeframeFileReader::TimeframeFileReader()
+  : fMapping(NULL)
+  , fTimeframes()
+  , fParts()
+{
+}
+
+TimeframeFileReader::~TimeframeFileReader()
+{
+  Close();
+}
+
+bool TimeframeFileReader::Open(const string& name)
+{
+  Close();
+
+  int fd = open(name.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    LOG(ERROR) << "Cannot open " << name << ": " << strerror(errno);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return false;
+  }
+
+  size_t size = st.st_size;
+  void* data = size >= sizeof(TimeframeFileHeader) ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+  close(fd);
+
+  if (data == MAP_FAILED || !isValidFileHeader(*static_cast<const TimeframeFileHeader*>(data), kTimeframeDataMagic)) {
+    LOG(ERROR) << name << " is no timeframe recording of version " << kTimeframeFileVersion;
+    if (data != MAP_FAILED) {
+      munmap(data, size);
+    }
+    return false;
+  }
+
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  fMapping = new Mapping;
+  fMapping->refs.store(1, memory_order_relaxed);
+  fMapping->data = static_cast<char*>(data);
+  fMapping->size = size;
+
+  // the index is small next to the data, it is read as a whole.
+  vector<char> index;
+  fd = open((name + ".idx").c_str(), O_RDONLY);
+  if (fd >= 0 && fstat(fd, &st) == 0) {
+    index.resize(st.st_size);
+    size_t done = 0;
+    while (done < index.size()) {
+      ssize_t n = read(fd, index.data() + done, index.size() - done);
+      if (n <= 0) {
+        break;
+      }
+      done += n;
+    }
+    index.resize(done);
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  if (index.size() < sizeof(TimeframeFileHeader)
+      || !isValidFileHeader(*reinterpret_cast<const TimeframeFileHeader*>(index.data()), kTimeframeIndexMagic)) {
+    LOG(ERROR) << "Cannot read the index " << name << ".idx";
+    Close();
+    return false;
+  }
+
+  size_t position = sizeof(TimeframeFileHeader);
+  while (position + sizeof(TimeframeIndexEntry) <= index.size()) {
+    TimeframeIndexEntry entry;
+    memcpy(&entry, index.data() + position, sizeof(TimeframeIndexEntry));
+    size_t next = position + sizeof(TimeframeIndexEntry) + entry.numParts * sizeof(uint64_t);
+    if (next > index.size()) {
+      break;
+    }
+
+    Timeframe timeframe;
+    timeframe.timeframeId = entry.timeframeId;
+    timeframe.time = entry.time;
+    timeframe.directory.offset = entry.offset;
+    timeframe.directory.size = entry.directorySize;
+    timeframe.firstPart = fParts.size();
+    timeframe.numParts = entry.numParts;
+
+    uint64_t offset = entry.offset + entry.directorySize;
+    for (uint32_t i = 0; i < entry.numParts; ++i) {
+      Part part;
+      memcpy(&part.size, index.data() + position + sizeof(TimeframeIndexEntry) + i * sizeof(uint64_t), sizeof(uint64_t));
+      part.offset = AlignTimeframeFileOffset(offset);
+      offset = part.offset + part.size;
+      fParts.push_back(part);
+    }
+
+    if (offset > size) {
+      // the data file is shorter than its index says, e.g. copied while being recorded.
+      fParts.resize(timeframe.firstPart);
+      break;
+    }
+
+    fTimeframes.push_back(timeframe);
+    position = next;
+  }
+
+  if (position < index.size()) {
+    LOG(WARN) << name << " ends with an incomplete timeframe, reading the first " << fTimeframes.size();
+  }
+
+  return true;
+}
+
+void TimeframeFileReader::Close()
+{
+  if (fMapping) {
+    unref(fMapping);
+    fMapping = NULL;
+  }
+  fTimeframes.clear();
+  fParts.clear();
+}
+
+FairMQMessage* TimeframeFileReader::CreateMessage(FairMQTransportFactory* factory, const Part& part)
+{
+  if (part.size == 0) {
+    return factory->CreateMessage();
+  }
+  fMapping->refs.fetch_add(1, memory_order_relaxed);
+  return factory->CreateMessage(fMapping->data + part.offset, part.size, &TimeframeFileReader::release, fMapping);
+}
+
+void TimeframeFileReader::Prefetch(const Timeframe& timeframe) const
+{
+  // madvise() wants page aligned addresses.
+  uint64_t pageSize = sysconf(_SC_PAGESIZE);
+  uint64_t begin = timeframe.directory.offset & ~(pageSize - 1);
+  uint64_t end = timeframe.directory.offset + timeframe.directory.size;
+  if (timeframe.numParts > 0) {
+    const Part& last = GetPart(timeframe, timeframe.numParts - 1);
+    end = last.offset + last.size;
+  }
+  madvise(fMapping->data + begin, end - begin, MADV_WILLNEED);
+}
+
+void TimeframeFileReader::unref(Mapping* mapping)
+{
+  if (mapping->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+    munmap(mapping->data, mapping->size);
+    delete mapping;
+  }
+}
+
+void TimeframeFileReader::release(void* /*data*/, void* hint)
+{
+  unref(static_cast<Mapping*>(hint));
+}
@@ -0,0 +1,162 @@
+/**
+ * TimeframeFile.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TIMEFRAMEFILE_H_
+#define ALICEO2_DEVICES_TIMEFRAMEFILE_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "FairMQMessage.h"
+#include "FairMQTransportFactory.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// File format of recorded timeframes.
+///
+/// A recording is a data file and an index file next to it, "<name>.idx".
+/// Both start with a TimeframeFileHeader. The data file holds the timeframes
+/// as the EPN sends them: the directory part, then the payload parts, every
+/// part starting at a multiple of kTimeframeFileAlignment. The index holds a
+/// TimeframeIndexEntry per timeframe followed by the sizes of its payload
+/// parts, so a reader finds every part without touching the data.
+///
+/// Both files are only ever appended to, the data of a timeframe before its
+/// index entry. A recording cut short by a crash is therefore readable up to
+/// the last complete index entry.
+
+static const uint64_t kTimeframeDataMagic = 0x415441444654324fULL; // "O2TFDATA"
+static const uint64_t kTimeframeIndexMagic = 0x58444e494654324fULL; // "O2TFINDX"
+static const uint32_t kTimeframeFileVersion = 1;
+static const size_t kTimeframeFileAlignment = 64;
+
+/// Start of the data and the index file, 64 bytes.
+struct TimeframeFileHeader
+{
+  uint64_t magic;     ///< kTimeframeDataMagic or kTimeframeIndexMagic
+  uint32_t version;   ///< kTimeframeFileVersion
+  uint32_t alignment; ///< kTimeframeFileAlignment
+  uint64_t reserved[6];
+};
+
+/// Index record of one timeframe, followed by numParts uint64_t part sizes.
+struct TimeframeIndexEntry
+{
+  uint64_t timeframeId;
+  uint64_t offset;        ///< of the directory part in the data file
+  int64_t time;           ///< µs since the epoch at which the recorder received the timeframe
+  uint32_t numParts;      ///< payload parts after the directory
+  uint32_t directorySize;
+};
+
+inline uint64_t AlignTimeframeFileOffset(uint64_t offset)
+{
+  return (offset + kTimeframeFileAlignment - 1) & ~static_cast<uint64_t>(kTimeframeFileAlignment - 1);
+}
+
+/// Appends timeframes to a recording, creating it if it does not exist.
+///
+/// The parts are written straight from the messages with one writev() per
+/// timeframe. Any write error closes the recording, the timeframes written
+/// up to then stay readable.
+class TimeframeFileWriter
+{
+  public:
+    TimeframeFileWriter();
+    ~TimeframeFileWriter();
+
+    /// false if the files cannot be opened or are no recording of this version
+    bool Open(const std::string& name);
+    void Close();
+    bool IsOpen() const { return fDataFd >= 0; }
+
+    /// appends a timeframe received at time (µs since the epoch)
+    bool Append(uint64_t timeframeId, int64_t time, FairMQMessage* directory, const std::vector<FairMQMessage*>& parts);
+
+    uint64_t GetNumTimeframes() const { return fNumTimeframes; }
+    /// size of the data file
+    uint64_t GetSize() const { return fDataSize; }
+
+  private:
+    TimeframeFileWriter(const TimeframeFileWriter&);
+    TimeframeFileWriter& operator=(const TimeframeFileWriter&);
+
+    int fDataFd;
+    int fIndexFd;
+    uint64_t fDataSize;
+    uint64_t fNumTimeframes;
+    std::vector<char> fIndexRecord;
+};
+
+/// Read-only view of a recording, mapped into memory.
+///
+/// The messages of CreateMessage() point into the mapping, which stays until
+/// the reader is closed and the transport has released the last of them.
+class TimeframeFileReader
+{
+  public:
+    struct Part
+    {
+      uint64_t offset;
+      uint64_t size;
+    };
+
+    struct Timeframe
+    {
+      uint64_t timeframeId;
+      int64_t time;
+      Part directory;
+      size_t firstPart; ///< position of the first payload part in the parts of the reader
+      size_t numParts;
+    };
+
+    TimeframeFileReader();
+    ~TimeframeFileReader();
+
+    /// false if the recording cannot be read
+    bool Open(const std::string& name);
+    void Close();
+
+    size_t GetNumTimeframes() const { return fTimeframes.size(); }
+    const Timeframe& GetTimeframe(size_t i) const { return fTimeframes[i]; }
+    const Part& GetPart(const Timeframe& timeframe, size_t i) const { return fParts[timeframe.firstPart + i]; }
+    const void* GetData(const Part& part) const { return fMapping->data + part.offset; }
+
+    /// zero-copy message over a part of the mapping
+    FairMQMessage* CreateMessage(FairMQTransportFactory* factory, const Part& part);
+
+    /// asks the kernel to read the timeframe ahead of its replay
+    void Prefetch(const Timeframe& timeframe) const;
+
+  private:
+    TimeframeFileReader(const TimeframeFileReader&);
+    TimeframeFileReader& operator=(const TimeframeFileReader&);
+
+    /// the data file in memory, referenced by the reader and its messages
+    struct Mapping
+    {
+      std::atomic<int> refs;
+      char* data;
+      size_t size;
+    };
+
+    static void unref(Mapping* mapping);
+    /// free function of the messages
+    static void release(void* data, void* hint);
+
+    Mapping* fMapping;
+    std::vector<Timeframe> fTimeframes;
+    std::vector<Part> fParts;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,259 @@
+/**
+ * TimeframeHeader.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TIMEFRAMEHEADER_H_
+#define ALICEO2_DEVICES_TIMEFRAMEHEADER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Crc32c.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Wire format of the timeframes between the flp2epn devices.
+///
+/// An FLP sends every sub-timeframe as two parts: a SubTimeframeHeader and
+/// the payload. An EPN forwards a completed timeframe as a directory part,
+/// a TimeframeDirectoryHeader followed by one TimeframeDirectoryEntry per
+/// part and a mask of the FLPs whose part is missing, and then the payload
+/// parts unmodified and in the order of the entries. Entry i describes
+/// message part i + 1, so a consumer can pick any sub-timeframe from the
+/// directory without copying or parsing the payload. Notices of an FLP to an
+/// EPN are a header with a flag and an empty payload. The header part holds
+/// the first kSubTimeframeWireSize bytes of the SubTimeframeHeader, the
+/// payload size travels as the size of the payload part.
+///
+/// All structures are plain, naturally aligned and in host byte order. A
+/// change of the layout increments kTimeframeFormatVersion, receivers reject
+/// other versions.
+
+static const uint16_t kTimeframeFormatVersion = 3;
+
+static const uint32_t kSubTimeframeMagic = 0x5453324f; // "O2ST"
+static const uint32_t kTimeframeDirectoryMagic = 0x4654324f; // "O2TF"
+
+/// payload descriptions, four characters packed into an integer
+inline uint32_t MakeDataType(const char (&name)[5])
+{
+  return static_cast<uint32_t>(name[0]) | static_cast<uint32_t>(name[1]) << 8
+       | static_cast<uint32_t>(name[2]) << 16 | static_cast<uint32_t>(name[3]) << 24;
+}
+
+static const uint32_t kDataTypeRaw = 0x20574152; // "RAW "
+static const uint32_t kDataTypeEventBatch = 0x42545645; // "EVTB", many events in the EventBatch format
+
+/// flags of the headers and directory entries
+enum TimeframeFlags {
+  kHasChecksum = 1 << 0,    ///< checksum holds the CRC32C of the payload, see Crc32c.h
+  kIncomplete = 1 << 1,     ///< directory: parts are missing, the entries list the ones present and the mask the others
+  kDropped = 1 << 2,        ///< sub-timeframe: the FLP dropped its part, the payload is empty and the EPN discards the timeframe
+  kKeepalive = 1 << 3,      ///< notice: the FLP is alive, the timeframe id is not used
+  kLeaving = 1 << 4,        ///< notice: the FLP stops, the EPN no longer waits for its parts
+  kChecksumFailed = 1 << 5  ///< entry: the payload does not match its checksum, forwarded as received; directory: on any entry
+};
+
+/// Header of a sub-timeframe. Only the fields up to the checksum go over the
+/// wire, 28 bytes: ZeroMQ keeps messages of up to 29 bytes (33 from 4.2 on)
+/// inside the message itself, a larger header part would be allocated on
+/// every send. The receiver fills in size from the payload part.
+struct SubTimeframeHeader
+{
+  uint32_t magic;       ///< kSubTimeframeMagic
+  uint16_t version;     ///< kTimeframeFormatVersion
+  uint16_t flags;       ///< TimeframeFlags
+  uint64_t timeframeId;
+  int32_t flpId;
+  uint32_t dataType;    ///< payload description
+  uint32_t checksum;    ///< valid with kHasChecksum
+  uint32_t reserved;    ///< not sent
+  uint64_t size;        ///< payload bytes, not sent
+};
+
+/// bytes of the header part of a sub-timeframe
+static const size_t kSubTimeframeWireSize = offsetof(SubTimeframeHeader, reserved);
+static_assert(kSubTimeframeWireSize <= 29, "the header part does not fit into a ZeroMQ message");
+
+/// Start of the directory part of a timeframe.
+struct TimeframeDirectoryHeader
+{
+  uint32_t magic;       ///< kTimeframeDirectoryMagic
+  uint16_t version;     ///< kTimeframeFormatVersion
+  uint16_t flags;
+  uint64_t timeframeId;
+  uint32_t numParts;    ///< payload parts following the directory
+  uint32_t numFLPs;     ///< bits of the missing-part mask behind the entries, bit i for flpId % numFLPs == i
+  uint64_t totalSize;   ///< payload bytes of all parts
+};
+
+/// Description of one payload part, taken over from its SubTimeframeHeader.
+struct TimeframeDirectoryEntry
+{
+  int32_t flpId;
+  uint32_t dataType;
+  uint64_t size;
+  uint32_t checksum;
+  uint16_t flags;
+  uint16_t reserved;
+};
+
+inline void InitSubTimeframeHeader(SubTimeframeHeader& header, uint64_t timeframeId, int flpId, uint32_t dataType, uint64_t size)
+{
+  memset(&header, 0, sizeof(SubTimeframeHeader));
+  header.magic = kSubTimeframeMagic;
+  header.version = kTimeframeFormatVersion;
+  header.timeframeId = timeframeId;
+  header.flpId = flpId;
+  header.dataType = dataType;
+  header.size = size;
+}
+
+/// writes the part of header that is sent into buffer, which holds kSubTimeframeWireSize bytes
+inline void WriteSubTimeframeHeader(void* buffer, const SubTimeframeHeader& header)
+{
+  memcpy(buffer, &header, kSubTimeframeWireSize);
+}
+
+/// the header of a received sub-timeframe from its header part and the size of its payload part
+inline void ReadSubTimeframeHeader(SubTimeframeHeader& header, const void* data, size_t payloadSize)
+{
+  memcpy(&header, data, kSubTimeframeWireSize);
+  header.reserved = 0;
+  header.size = payloadSize;
+}
+
+/// true if the message holds a header of the supported version
+inline bool IsValidSubTimeframeHeader(const void* data, size_t size)
+{
+  const SubTimeframeHeader* header = static_cast<const SubTimeframeHeader*>(data);
+  return size >= kSubTimeframeWireSize && header->magic == kSubTimeframeMagic && header->version == kTimeframeFormatVersion;
+}
+
+/// false if the header carries a checksum that the payload does not match
+inline bool VerifyPayloadChecksum(const SubTimeframeHeader& header, const void* data, size_t size)
+{
+  return !(header.flags & kHasChecksum) || Crc32c(data, size) == header.checksum;
+}
+
+/// 64-bit words of the missing-part mask of a directory
+inline size_t GetMissingMaskWords(size_t numFLPs)
+{
+  return (numFLPs + 63) / 64;
+}
+
+inline size_t GetTimeframeDirectorySize(size_t numParts, size_t numFLPs)
+{
+  return sizeof(TimeframeDirectoryHeader) + numParts * sizeof(TimeframeDirectoryEntry)
+       + GetMissingMaskWords(numFLPs) * sizeof(uint64_t);
+}
+
+/// writes the directory for the parts described by headers into buffer, which holds
+/// GetTimeframeDirectorySize(numParts, numFLPs) bytes. present has a bit for each of the
+/// numFLPs FLPs that delivered, the others go into the missing-part mask and set kIncomplete.
+inline void WriteTimeframeDirectory(void* buffer, uint64_t timeframeId, const SubTimeframeHeader* headers, size_t numParts,
+                                    const uint64_t* present, size_t numFLPs)
+{
+  TimeframeDirectoryHeader* directory = static_cast<TimeframeDirectoryHeader*>(buffer);
+  TimeframeDirectoryEntry* entries = reinterpret_cast<TimeframeDirectoryEntry*>(directory + 1);
+  uint64_t* missing = reinterpret_cast<uint64_t*>(entries + numParts);
+
+  memset(directory, 0, sizeof(TimeframeDirectoryHeader));
+  directory->magic = kTimeframeDirectoryMagic;
+  directory->version = kTimeframeFormatVersion;
+  directory->timeframeId = timeframeId;
+  directory->numParts = numParts;
+  directory->numFLPs = numFLPs;
+
+  for (size_t w = 0; w < GetMissingMaskWords(numFLPs); ++w) {
+    uint64_t valid = numFLPs - w * 64 >= 64 ? ~0ULL : (1ULL << (numFLPs - w * 64)) - 1;
+    missing[w] = ~present[w] & valid;
+    if (missing[w] != 0) {
+      directory->flags |= kIncomplete;
+    }
+  }
+
+  for (size_t i = 0; i < numParts; ++i) {
+    entries[i].flpId = headers[i].flpId;
+    entries[i].dataType = headers[i].dataType;
+    entries[i].size = headers[i].size;
+    entries[i].checksum = headers[i].checksum;
+    entries[i].flags = headers[i].flags;
+    entries[i].reserved = 0;
+    directory->flags |= headers[i].flags & kChecksumFailed;
+    directory->totalSize += headers[i].size;
+  }
+}
+
+/// Read access to a received directory part, works on the message data in place.
+class TimeframeDirectory
+{
+  public:
+    TimeframeDirectory(const void* data, size_t size)
+      : fHeader(static_cast<const TimeframeDirectoryHeader*>(data))
+      , fEntries(reinterpret_cast<const TimeframeDirectoryEntry*>(fHeader + 1))
+      , fValid(size >= sizeof(TimeframeDirectoryHeader)
+               && fHeader->magic == kTimeframeDirectoryMagic
+               && fHeader->version == kTimeframeFormatVersion
+               && size >= GetTimeframeDirectorySize(fHeader->numParts, fHeader->numFLPs))
+    {
+    }
+
+    bool IsValid() const { return fValid; }
+
+    uint64_t GetTimeframeId() const { return fHeader->timeframeId; }
+    uint32_t GetNumParts() const { return fHeader->numParts; }
+    uint64_t GetTotalSize() const { return fHeader->totalSize; }
+    uint32_t GetNumFLPs() const { return fHeader->numFLPs; }
+    bool IsComplete() const { return !(fHeader->flags & kIncomplete); }
+    /// true if the EPN found a part that does not match its checksum, see the flags of the entries
+    bool HasChecksumFailure() const { return fHeader->flags & kChecksumFailed; }
+
+    /// true if the part of FLP flpIndex (flpId % numFLPs) is not in the timeframe, also for an
+    /// index outside of [0, numFLPs)
+    bool IsMissing(int flpIndex) const
+    {
+      if (flpIndex < 0 || static_cast<uint32_t>(flpIndex) >= fHeader->numFLPs) {
+        return true;
+      }
+      const uint64_t* missing = reinterpret_cast<const uint64_t*>(fEntries + fHeader->numParts);
+      return missing[flpIndex / 64] & (1ULL << (flpIndex % 64));
+    }
+
+    /// entry i describes message part i + 1 of the timeframe
+    const TimeframeDirectoryEntry& GetEntry(size_t i) const { return fEntries[i]; }
+
+    /// index of the entry of an FLP, -1 if it has none. The EPN orders the parts by
+    /// flpId % numParts, so the first probe hits unless the FLP ids have gaps.
+    int Find(int flpId) const
+    {
+      uint32_t n = fHeader->numParts;
+      if (n == 0) {
+        return -1;
+      }
+      uint32_t guess = static_cast<uint32_t>(flpId) % n;
+      if (fEntries[guess].flpId == flpId) {
+        return guess;
+      }
+      for (uint32_t i = 0; i < n; ++i) {
+        if (fEntries[i].flpId == flpId) {
+          return i;
+        }
+      }
+      return -1;
+    }
+
+  private:
+    const TimeframeDirectoryHeader* fHeader;
+    const TimeframeDirectoryEntry* fEntries;
+    bool fValid;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,394 @@
+/**
+ * TimeframeMerger.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <thread>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include "FairMQLogger.h"
+#include "FairMQPoller.h"
+
+#include "TimeframeMerger.h"
+#include "Placement.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+// parts taken from one input before the next one gets its turn.
+static const int kBatchSize = 16;
+
+TimeframeMerger::TimeframeMerger()
+  : fBufferSize(64)
+  , fInputBufferSize(16)
+  , fMaxSpinInUs(50)
+  , fBufferTimeoutInMs(1000)
+  , fTimeoutPolicy("discard")
+  , fForwardPartial(false)
+  , fWindow()
+  , fMessagePool()
+  , fTimers()
+  , fLoop()
+  , fNumWaiting()
+  , fHeaders()
+  , fParts()
+  , fMetricReceived(NULL)
+  , fMetricMerged(NULL)
+  , fMetricPartial(NULL)
+  , fMetricDiscarded(NULL)
+  , fMetricRejected(NULL)
+  , fMetricThrottled(NULL)
+  , fMetricMerging(NULL)
+  , fMetricMergeTime(NULL)
+{
+}
+
+TimeframeMerger::~TimeframeMerger()
+{
+}
+
+void TimeframeMerger::Init()
+{
+  FairMQDevice::Init();
+
+  if (fTimeoutPolicy == "partial") {
+    fForwardPartial = true;
+  } else {
+    if (fTimeoutPolicy != "discard") {
+      LOG(ERROR) << "Unknown timeout policy \"" << fTimeoutPolicy << "\", discarding incomplete timeframes";
+    }
+    fForwardPartial = false;
+  }
+
+  // the parts waiting on every input plus the header, data and directory in flight.
+  fMessagePool.Init(fTransportFactory, fNumInputs * fInputBufferSize + 3);
+  fWindow.Init(fBufferSize, fNumInputs, &fMessagePool);
+  fTimers.Init(chrono::milliseconds(1), fBufferSize, TimerWheel::Clock::now());
+
+  fNumWaiting.assign(fNumInputs, 0);
+  fHeaders.reserve(fNumInputs);
+  fParts.reserve(fNumInputs);
+
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  string label = Metrics::DeviceLabel(fId);
+  fMetricReceived = &metrics.AddCounter("o2_merger_sub_timeframes_received_total", "Sub-timeframes received on all inputs", label);
+  fMetricMerged = &metrics.AddCounter("o2_merger_timeframes_merged_total", "Timeframes forwarded with the parts of all inputs", label);
+  fMetricPartial = &metrics.AddCounter("o2_merger_timeframes_partial_total", "Incomplete timeframes forwarded with the parts they had", label);
+  fMetricDiscarded = &metrics.AddCounter("o2_merger_timeframes_discarded_total", "Incomplete timeframes discarded", label);
+  fMetricRejected = &metrics.AddCounter("o2_merger_sub_timeframes_rejected_total", "Invalid, duplicate and late sub-timeframes", label);
+  fMetricThrottled = &metrics.AddCounter("o2_merger_throttled_total", "Loop iterations in which only inputs with a full buffer had data", label);
+  fMetricMerging = &metrics.AddGauge("o2_merger_timeframes_merging", "Timeframes waiting for parts", label);
+  fMetricMergeTime = &metrics.AddHistogram("o2_merger_merge_time_us", "Time from the first to the last part of a timeframe", label);
+}
+
+void TimeframeMerger::Run()
+{
+  LOG(INFO) << ">>>>>>> Run <<<<<<<";
+
+  boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
+  Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
+
+  FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
+
+  LOG(INFO) << "Merging " << fNumInputs << " inputs, " << fBufferSize << " timeframes at a time, "
+            << (fForwardPartial ? "forwarding" : "discarding") << " incomplete ones after " << fBufferTimeoutInMs << " ms";
+
+  fLoop.Init(poller, fNumInputs, &fTimers, fMaxSpinInUs, 100, fId);
+
+  while (fState == RUNNING) {
+    // also forwards or discards the timeframes that reached the timeout.
+    fLoop.Wait();
+
+    bool received = false;
+    bool throttled = false;
+
+    for (int i = 0; i < fNumInputs; ++i) {
+      if (!poller->CheckInput(i)) {
+        continue;
+      }
+      if (fNumWaiting[i] >= fInputBufferSize) {
+        // leave it in the socket until this input's parts are merged or have timed out.
+        throttled = true;
+        continue;
+      }
+      for (int n = 0; n < kBatchSize && fNumWaiting[i] < fInputBufferSize && receive(i); ++n) {
+        received = true;
+      }
+    }
+
+    fMetricMerging->Set(fWindow.GetNumAssembling());
+
+    if (throttled && !received) {
+      // the poller keeps reporting the held back inputs, wait for a timeout to free some space.
+      fMetricThrottled->Increment();
+      this_thread::sleep_for(chrono::microseconds(100));
+    }
+  }
+
+  fLoop.LogStatistics();
+
+  fWindow.Clear();
+  fNumWaiting.assign(fNumInputs, 0);
+
+  LOG(INFO) << "Message pool: " << fMessagePool.GetNumAcquired() << " messages used, "
+            << fMessagePool.GetNumAllocations() << " allocated after start-up";
+
+  delete poller;
+
+  rateLogger.interrupt();
+  rateLogger.join();
+
+  FairMQDevice::Shutdown();
+
+  // notify parent thread about end of processing.
+  boost::lock_guard<boost::mutex> lock(fRunningMutex);
+  fRunningFinished = true;
+  fRunningCondition.notify_one();
+}
+
+bool TimeframeMerger::receive(int input)
+{
+  int NOBLOCK = fPayloadInputs->at(input)->NOBLOCK;
+
+  FairMQMessage* headerPart = fMessagePool.Acquire();
+  if (fPayloadInputs->at(input)->Receive(headerPart, NOBLOCK) <= 0) {
+    fMessagePool.Release(headerPart);
+    return false;
+  }
+
+  // the payload is part of the same multipart message and already there.
+  FairMQMessage* dataPart = fMessagePool.Acquire();
+  int rcvDataSize = fPayloadInputs->at(input)->Receive(dataPart);
+  fMetricReceived->Increment();
+
+  if (rcvDataSize < 0 || !IsValidSubTimeframeHeader(headerPart->GetData(), headerPart->GetSize())) {
+    LOG(ERROR) << "Received a sub-timeframe without a valid header on input " << input << ", dropping it";
+    fMessagePool.Release(dataPart);
+    fMessagePool.Release(headerPart);
+    fMetricRejected->Increment();
+    return true;
+  }
+
+  SubTimeframeHeader header;
+  ReadSubTimeframeHeader(header, headerPart->GetData(), rcvDataSize);
+  fMessagePool.Release(headerPart);
+
+  // an FLP feeding the input directly also sends keepalive and leave notices, they carry no timeframe.
+  if (header.flags & (kKeepalive | kLeaving)) {
+    fMessagePool.Release(dataPart);
+    return true;
+  }
+
+  uint64_t id = header.timeframeId;
+  TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+
+  // a newer timeframe needs the slot, the old one is done with as if it had timed out.
+  TimeframeWindow::Slot& slot = fWindow.Get(id);
+  if (slot.state == TimeframeWindow::Slot::Assembling && slot.id < id) {
+    LOG(WARN) << "Timeframe #" << slot.id << " incomplete when #" << id << " arrived for its slot";
+    fTimers.Cancel(slot.timer);
+    ExpireTimeframe(slot.id);
+  }
+
+  // a timeframe may have been started by a drop notice, it has its timer then.
+  bool started = !fWindow.IsAssembling(id);
+
+  if (header.flags & kDropped) {
+    fMessagePool.Release(dataPart);
+    drop(id, input, started, now);
+    return true;
+  }
+
+  switch (fWindow.Add(id, input, dataPart, now)) {
+    case TimeframeWindow::Added:
+      slot.headers[input] = header;
+      ++fNumWaiting[input];
+      if (started) {
+        slot.timer = fTimers.Schedule(now + chrono::milliseconds(fBufferTimeoutInMs),
+                                      &TimerWheel::Member<TimeframeMerger, &TimeframeMerger::ExpireTimeframe>, this, id);
+      }
+      break;
+    case TimeframeWindow::Completed:
+      slot.headers[input] = header;
+      ++fNumWaiting[input];
+      fTimers.Cancel(slot.timer);
+      fMetricMergeTime->Observe(chrono::duration_cast<chrono::microseconds>(now - slot.startTime).count());
+      forward(id);
+      if (slot.flpMask == slot.expectedMask) {
+        fMetricMerged->Increment();
+      } else {
+        // completed by the parts of the inputs that did not drop theirs.
+        fMetricPartial->Increment();
+      }
+      break;
+    default:
+      // duplicate, or the timeframe is already gone.
+      fMessagePool.Release(dataPart);
+      fMetricRejected->Increment();
+      break;
+  }
+
+  return true;
+}
+
+void TimeframeMerger::ExpireTimeframe(uint64_t id)
+{
+  TimeframeWindow::Slot& slot = fWindow.Get(id);
+
+  // the timer is not cancelled everywhere, so the slot may already hold another timeframe.
+  if (slot.state != TimeframeWindow::Slot::Assembling || slot.id != id) {
+    return;
+  }
+
+  if (fForwardPartial && slot.count > 0) {
+    forward(id);
+    fMetricPartial->Increment();
+  } else {
+    release(slot);
+    fWindow.Discard(id);
+    fMetricDiscarded->Increment();
+  }
+}
+
+void TimeframeMerger::drop(uint64_t id, int input, bool started, TimerWheel::Clock::time_point now)
+{
+  TimeframeWindow::Slot& slot = fWindow.Get(id);
+
+  if (!fForwardPartial) {
+    // the FLP behind the input gave up its part, the rest of the timeframe is of no use.
+    if (!started) {
+      fTimers.Cancel(slot.timer);
+      release(slot);
+    }
+    if (fWindow.Abandon(id)) {
+      LOG(WARN) << "Timeframe #" << id << " dropped on input " << input << ", discarding";
+      fMetricDiscarded->Increment();
+    }
+    return;
+  }
+
+  // the timeframe goes out without the part of the input, as after a timeout.
+  switch (fWindow.Skip(id, input, now)) {
+    case TimeframeWindow::Added:
+      if (started) {
+        slot.timer = fTimers.Schedule(now + chrono::milliseconds(fBufferTimeoutInMs),
+                                      &TimerWheel::Member<TimeframeMerger, &TimeframeMerger::ExpireTimeframe>, this, id);
+      }
+      break;
+    case TimeframeWindow::Completed:
+      if (!started) {
+        fTimers.Cancel(slot.timer);
+      }
+      ExpireTimeframe(id);
+      break;
+    default:
+      // already forwarded or discarded, or the input has delivered its part after all.
+      break;
+  }
+}
+
+void TimeframeMerger::forward(uint64_t id)
+{
+  int SNDMORE = fPayloadOutputs->at(0)->SNDMORE;
+
+  TimeframeWindow::Slot& slot = fWindow.Get(id);
+
+  fParts.clear();
+  fHeaders.clear();
+  for (int i = 0; i < fNumInputs; ++i) {
+    if (slot.parts[i] != NULL) {
+      fParts.push_back(slot.parts[i]);
+      fHeaders.push_back(slot.headers[i]);
+    }
+  }
+  release(slot);
+
+  FairMQMessage* directoryPart = fMessagePool.Acquire();
+  directoryPart->Rebuild(GetTimeframeDirectorySize(fParts.size(), fNumInputs));
+  WriteTimeframeDirectory(directoryPart->GetData(), id, fHeaders.data(), fParts.size(), slot.flpMask.data(), fNumInputs);
+  fPayloadOutputs->at(0)->Send(directoryPart, SNDMORE);
+  fMessagePool.Release(directoryPart);
+
+  for (size_t i = 0; i < fParts.size() - 1; ++i) {
+    fPayloadOutputs->at(0)->Send(fParts[i], SNDMORE);
+  }
+  fPayloadOutputs->at(0)->Send(fParts.back());
+
+  for (size_t i = 0; i < fParts.size(); ++i) {
+    fMessagePool.Release(fParts[i]);
+  }
+
+  fWindow.Close(id);
+}
+
+void TimeframeMerger::release(TimeframeWindow::Slot& slot)
+{
+  for (int i = 0; i < fNumInputs; ++i) {
+    if (slot.parts[i] != NULL) {
+      --fNumWaiting[i];
+    }
+  }
+}
+
+void TimeframeMerger::SetProperty(const int key, const string& value, const int slot/*= 0*/)
+{
+  switch (key) {
+    case TimeoutPolicy:
+      fTimeoutPolicy = value;
+      break;
+    default:
+      FairMQDevice::SetProperty(key, value, slot);
+      break;
+  }
+}
+
+string TimeframeMerger::GetProperty(const int key, const string& default_/*= ""*/, const int slot/*= 0*/)
+{
+  switch (key) {
+    case TimeoutPolicy:
+      return fTimeoutPolicy;
+    default:
+      return FairMQDevice::GetProperty(key, default_, slot);
+  }
+}
+
+void TimeframeMerger::SetProperty(const int key, const int value, const int slot/*= 0*/)
+{
+  switch (key) {
+    case BufferSize:
+      fBufferSize = value;
+      break;
+    case InputBufferSize:
+      fInputBufferSize = value;
+      break;
+    case MaxSpinInUs:
+      fMaxSpinInUs = value;
+      break;
+    case BufferTimeoutInMs:
+      fBufferTimeoutInMs = value;
+      break;
+    default:
+      FairMQDevice::SetProperty(key, value, slot);
+      break;
+  }
+}
+
+int TimeframeMerger::GetProperty(const int key, const int default_/*= 0*/, const int slot/*= 0*/)
+{
+  switch (key) {
+    case BufferSize:
+      return fBufferSize;
+    case InputBufferSize:
+      return fInputBufferSize;
+    case MaxSpinInUs:
+      return fMaxSpinInUs;
+    case BufferTimeoutInMs:
+      return fBufferTimeoutInMs;
+    default:
+      return FairMQDevice::GetProperty(key, default_, slot);
+  }
+}
@@ -0,0 +1,106 @@
+/**
+ * TimeframeMerger.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TIMEFRAMEMERGER_H_
+#define ALICEO2_DEVICES_TIMEFRAMEMERGER_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "FairMQDevice.h"
+
+#include "Metrics.h"
+
+#include "EventLoop.h"
+#include "MessagePool.h"
+#include "TimeframeHeader.h"
+#include "TimeframeWindow.h"
+#include "TimerWheel.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Merges N input streams by timeframe id.
+///
+/// Every input delivers sub-timeframes in the FLP wire format, a
+/// SubTimeframeHeader part followed by the payload. The parts of the same id
+/// are collected in a TimeframeWindow, with the input index in place of the
+/// FLP index, and leave on output 0 like the timeframes of an EPN: a
+/// directory part followed by the payloads in input order. Inputs running at
+/// different speeds therefore never get their parts glued to the wrong
+/// timeframe.
+///
+/// An input with InputBufferSize parts waiting is not read until some of
+/// them have left, so a fast input is held back by its socket buffer instead
+/// of pushing the slow ones out of the window. A timeframe still incomplete
+/// after BufferTimeoutInMs, or whose window slot is needed for a newer one,
+/// is either discarded or forwarded with the parts it has, see TimeoutPolicy.
+/// The same goes for a timeframe whose part an FLP dropped (kDropped).
+/// Messages come from a pool, the loop allocates nothing in steady state.
+class TimeframeMerger : public FairMQDevice
+{
+  public:
+    enum {
+      BufferSize = FairMQDevice::Last,
+      InputBufferSize,
+      MaxSpinInUs,
+      BufferTimeoutInMs,
+      TimeoutPolicy,
+      Last
+    };
+
+    TimeframeMerger();
+    virtual ~TimeframeMerger();
+
+    void ExpireTimeframe(uint64_t id);
+
+    virtual void SetProperty(const int key, const std::string& value, const int slot = 0);
+    virtual std::string GetProperty(const int key, const std::string& default_ = "", const int slot = 0);
+    virtual void SetProperty(const int key, const int value, const int slot = 0);
+    virtual int GetProperty(const int key, const int default_ = 0, const int slot = 0);
+
+  protected:
+    virtual void Init();
+    virtual void Run();
+
+  private:
+    bool receive(int input);
+    /// the input will not deliver its part of timeframe id, started tells whether the notice opens it
+    void drop(uint64_t id, int input, bool started, TimerWheel::Clock::time_point now);
+    void forward(uint64_t id);
+    void release(TimeframeWindow::Slot& slot);
+
+    int fBufferSize; // timeframes merged at the same time
+    int fInputBufferSize; // parts waiting per input before it is no longer read
+    int fMaxSpinInUs; // longest spin of the main loop before it sleeps, 0 never spins
+    int fBufferTimeoutInMs;
+    std::string fTimeoutPolicy; // "discard" or "partial"
+    bool fForwardPartial;
+
+    TimeframeWindow fWindow;
+    MessagePool fMessagePool;
+    TimerWheel fTimers;
+    EventLoop fLoop;
+
+    std::vector<int> fNumWaiting; // per input, parts held in the window
+    std::vector<SubTimeframeHeader> fHeaders; // headers of the parts being forwarded
+    std::vector<FairMQMessage*> fParts;
+
+    Metrics::Counter* fMetricReceived;
+    Metrics::Counter* fMetricMerged;
+    Metrics::Counter* fMetricPartial; // forwarded with parts missing
+    Metrics::Counter* fMetricDiscarded;
+    Metrics::Counter* fMetricRejected; // invalid, duplicate or late parts
+    Metrics::Counter* fMetricThrottled; // loop iterations with an input held back
+    Metrics::Gauge* fMetricMerging;
+    Metrics::Histogram* fMetricMergeTime; // us from the first to the last part
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
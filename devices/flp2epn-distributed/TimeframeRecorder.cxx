@@ -0,0 +1,236 @@
+/**
+ * TimeframeRecorder.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <chrono>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include "FairMQLogger.h"
+#include "FairMQPoller.h"
+
+#include "TimeframeRecorder.h"
+#include "TimeframeHeader.h"
+#include "Placement.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+// timeframes taken from the input before the loop looks at its state again.
+static const int kBatchSize = 16;
+
+TimeframeRecorder::TimeframeRecorder()
+  : fOutputFile()
+  , fMaxFileSizeInMB(0)
+  , fWriter()
+  , fMessagePool()
+  , fParts()
+  , fMetricRecorded(NULL)
+  , fMetricBytes(NULL)
+  , fMetricSkipped(NULL)
+  , fMetricRejected(NULL)
+  , fMetricWriteTime(NULL)
+{
+}
+
+TimeframeRecorder::~TimeframeRecorder()
+{
+}
+
+void TimeframeRecorder::Init()
+{
+  FairMQDevice::Init();
+
+  fMessagePool.Init(fTransportFactory, 64);
+
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  string label = Metrics::DeviceLabel(fId);
+  fMetricRecorded = &metrics.AddCounter("o2_recorder_timeframes_recorded_total", "Timeframes appended to the recording", label);
+  fMetricBytes = &metrics.AddCounter("o2_recorder_bytes_recorded_total", "Directory and payload bytes appended to the recording", label);
+  fMetricSkipped = &metrics.AddCounter("o2_recorder_timeframes_skipped_total", "Timeframes received after the recording was closed", label);
+  fMetricRejected = &metrics.AddCounter("o2_recorder_messages_rejected_total", "Messages dropped without a valid directory or with parts not matching it", label);
+  fMetricWriteTime = &metrics.AddHistogram("o2_recorder_write_time_us", "Time to append one timeframe", label);
+}
+
+void TimeframeRecorder::Run()
+{
+  LOG(INFO) << ">>>>>>> Run <<<<<<<";
+
+  boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
+  Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
+
+  FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
+
+  if (fWriter.Open(fOutputFile)) {
+    LOG(INFO) << "Recording timeframes to " << fOutputFile;
+  } else {
+    LOG(ERROR) << "Cannot record to " << fOutputFile << ", timeframes are only received";
+  }
+
+  while (fState == RUNNING) {
+    poller->Poll(100);
+
+    if (poller->CheckInput(0)) {
+      for (int n = 0; n < kBatchSize && receive(); ++n) {
+      }
+    }
+  }
+
+  if (fWriter.IsOpen()) {
+    LOG(INFO) << "Recording holds " << fWriter.GetNumTimeframes() << " timeframes in " << fWriter.GetSize() << " bytes";
+    fWriter.Close();
+  }
+
+  delete poller;
+
+  rateLogger.interrupt();
+  rateLogger.join();
+
+  FairMQDevice::Shutdown();
+
+  // notify parent thread about end of processing.
+  boost::lock_guard<boost::mutex> lock(fRunningMutex);
+  fRunningFinished = true;
+  fRunningCondition.notify_one();
+}
+
+bool TimeframeRecorder::receive()
+{
+  int NOBLOCK = fPayloadInputs->at(0)->NOBLOCK;
+
+  FairMQMessage* directoryPart = fMessagePool.Acquire();
+  if (fPayloadInputs->at(0)->Receive(directoryPart, NOBLOCK) <= 0) {
+    fMessagePool.Release(directoryPart);
+    return false;
+  }
+
+  int64_t time = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+
+  TimeframeDirectory directory(directoryPart->GetData(), directoryPart->GetSize());
+  if (!directory.IsValid()) {
+    LOG(ERROR) << "Received a message without a valid timeframe directory, dropping it";
+    skipRest();
+    fMessagePool.Release(directoryPart);
+    fMetricRejected->Increment();
+    return true;
+  }
+
+  // the payload is part of the same multipart message and already there.
+  fParts.clear();
+  while (fParts.size() < directory.GetNumParts() && hasMore()) {
+    FairMQMessage* part = fMessagePool.Acquire();
+    fPayloadInputs->at(0)->Receive(part);
+    fParts.push_back(part);
+  }
+
+  if (fParts.size() < directory.GetNumParts() || hasMore()) {
+    LOG(ERROR) << "Timeframe #" << directory.GetTimeframeId() << " does not have the " << directory.GetNumParts()
+               << " parts of its directory, dropping it";
+    skipRest();
+    release();
+    fMessagePool.Release(directoryPart);
+    fMetricRejected->Increment();
+    return true;
+  }
+
+  if (fWriter.IsOpen()) {
+    uint64_t size = directoryPart->GetSize();
+    for (size_t i = 0; i < fParts.size(); ++i) {
+      size += kTimeframeFileAlignment + fParts[i]->GetSize();
+    }
+
+    if (fMaxFileSizeInMB > 0 && fWriter.GetSize() + size > static_cast<uint64_t>(fMaxFileSizeInMB) << 20) {
+      LOG(WARN) << "Recording reached its maximum size with " << fWriter.GetNumTimeframes() << " timeframes, closing it";
+      fWriter.Close();
+    } else {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      uint64_t before = fWriter.GetSize();
+      if (fWriter.Append(directory.GetTimeframeId(), time, directoryPart, fParts)) {
+        fMetricWriteTime->Observe(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+        fMetricBytes->Increment(fWriter.GetSize() - before);
+        fMetricRecorded->Increment();
+      }
+    }
+  }
+
+  if (!fWriter.IsOpen()) {
+    fMetricSkipped->Increment();
+  }
+
+  release();
+  fMessagePool.Release(directoryPart);
+  return true;
+}
+
+bool TimeframeRecorder::hasMore()
+{
+  int64_t more = 0;
+  size_t moreSize = sizeof(more);
+  fPayloadInputs->at(0)->GetOption("rcv-more", &more, &moreSize);
+  return more != 0;
+}
+
+void TimeframeRecorder::skipRest()
+{
+  FairMQMessage* part = fMessagePool.Acquire();
+  while (hasMore()) {
+    fPayloadInputs->at(0)->Receive(part);
+  }
+  fMessagePool.Release(part);
+}
+
+void TimeframeRecorder::release()
+{
+  for (size_t i = 0; i < fParts.size(); ++i) {
+    fMessagePool.Release(fParts[i]);
+  }
+  fParts.clear();
+}
+
+void TimeframeRecorder::SetProperty(const int key, const string& value, const int slot/*= 0*/)
+{
+  switch (key) {
+    case OutputFile:
+      fOutputFile = value;
+      break;
+    default:
+      FairMQDevice::SetProperty(key, value, slot);
+      break;
+  }
+}
+
+string TimeframeRecorder::GetProperty(const int key, const string& default_/*= ""*/, const int slot/*= 0*/)
+{
+  switch (key) {
+    case OutputFile:
+      return fOutputFile;
+    default:
+      return FairMQDevice::GetProperty(key, default_, slot);
+  }
+}
+
+void TimeframeRecorder::SetProperty(const int key, const int value, const int slot/*= 0*/)
+{
+  switch (key) {
+    case MaxFileSizeInMB:
+      fMaxFileSizeInMB = value;
+      break;
+    default:
+      FairMQDevice::SetProperty(key, value, slot);
+      break;
+  }
+}
+
+int TimeframeRecorder::GetProperty(const int key, const int default_/*= 0*/, const int slot/*= 0*/)
+{
+  switch (key) {
+    case MaxFileSizeInMB:
+      return fMaxFileSizeInMB;
+    default:
+      return FairMQDevice::GetProperty(key, default_, slot);
+  }
+}
@@ -0,0 +1,79 @@
+/**
+ * TimeframeRecorder.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TIMEFRAMERECORDER_H_
+#define ALICEO2_DEVICES_TIMEFRAMERECORDER_H_
+
+#include <string>
+#include <vector>
+
+#include "FairMQDevice.h"
+
+#include "Metrics.h"
+
+#include "MessagePool.h"
+#include "TimeframeFile.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Sink at the output of an EPN that appends every timeframe it receives to
+/// a recording, see TimeframeFile.h.
+///
+/// Input 0 delivers timeframes in the EPN output format, a directory part
+/// followed by the payload parts it lists, as one multipart message. A message
+/// that does not start with a valid directory or has another number of parts
+/// than its directory lists is dropped whole: the parts are received up to the
+/// last one the socket reports, so the recorder stays in step with the
+/// messages and never blocks on a part that is not coming. Recording stops when the data file would grow beyond
+/// MaxFileSizeInMB or a write fails, the device keeps draining its input.
+class TimeframeRecorder : public FairMQDevice
+{
+  public:
+    enum {
+      OutputFile = FairMQDevice::Last,
+      MaxFileSizeInMB,
+      Last
+    };
+
+    TimeframeRecorder();
+    virtual ~TimeframeRecorder();
+
+    virtual void SetProperty(const int key, const std::string& value, const int slot = 0);
+    virtual std::string GetProperty(const int key, const std::string& default_ = "", const int slot = 0);
+    virtual void SetProperty(const int key, const int value, const int slot = 0);
+    virtual int GetProperty(const int key, const int default_ = 0, const int slot = 0);
+
+  protected:
+    virtual void Init();
+    virtual void Run();
+
+  private:
+    bool receive();
+    /// true if the last part received is followed by another one of the same message
+    bool hasMore();
+    /// receives and drops the rest of the current message
+    void skipRest();
+    void release();
+
+    std::string fOutputFile;
+    int fMaxFileSizeInMB; // 0 for no limit
+
+    TimeframeFileWriter fWriter;
+    MessagePool fMessagePool;
+    std::vector<FairMQMessage*> fParts;
+
+    Metrics::Counter* fMetricRecorded;
+    Metrics::Counter* fMetricBytes;
+    Metrics::Counter* fMetricSkipped; // received while not recording
+    Metrics::Counter* fMetricRejected; // messages without a directory or with parts not matching it
+    Metrics::Histogram* fMetricWriteTime; // us per timeframe
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,226 @@
+/**
+ * TimeframeReplayer.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include "FairMQLogger.h"
+
+#include "TimeframeReplayer.h"
+#include "Placement.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef chrono::steady_clock Clock;
+
+TimeframeReplayer::TimeframeReplayer()
+  : fInputFile()
+  , fTiming("rate")
+  , fEventRate(0)
+  , fMaxGapInMs(1000)
+  , fNumLoops(1)
+  , fRecordedTiming(false)
+  , fWarnedParts(false)
+  , fReader()
+  , fMetricSent(NULL)
+  , fMetricBytes(NULL)
+  , fMetricLag(NULL)
+{
+}
+
+TimeframeReplayer::~TimeframeReplayer()
+{
+}
+
+void TimeframeReplayer::Init()
+{
+  FairMQDevice::Init();
+
+  if (fTiming == "recorded") {
+    fRecordedTiming = true;
+  } else {
+    if (fTiming != "rate") {
+      LOG(ERROR) << "Unknown timing \"" << fTiming << "\", replaying at the given rate";
+    }
+    fRecordedTiming = false;
+  }
+
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  string label = Metrics::DeviceLabel(fId);
+  fMetricSent = &metrics.AddCounter("o2_replayer_timeframes_sent_total", "Recorded timeframes sent to the FLPs", label);
+  fMetricBytes = &metrics.AddCounter("o2_replayer_bytes_sent_total", "Payload bytes sent to the FLPs", label);
+  fMetricLag = &metrics.AddHistogram("o2_replayer_lag_us", "Time a timeframe left after its scheduled time", label);
+}
+
+void TimeframeReplayer::Run()
+{
+  LOG(INFO) << ">>>>>>> Run <<<<<<<";
+
+  boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
+  Placement::Default().PinHelper(rateLogger.native_handle(), "rate logger");
+
+  if (!fReader.Open(fInputFile)) {
+    LOG(ERROR) << "Cannot replay " << fInputFile;
+  } else if (fReader.GetNumTimeframes() == 0) {
+    LOG(WARN) << fInputFile << " holds no timeframes";
+  } else {
+    LOG(INFO) << "Replaying " << fReader.GetNumTimeframes() << " timeframes from " << fInputFile << " to " << fNumOutputs << " FLPs, "
+              << (fRecordedTiming ? string("at the recorded timing") : fEventRate > 0 ? to_string(fEventRate) + " per second" : string("as fast as possible"));
+
+    fReader.Prefetch(fReader.GetTimeframe(0));
+
+    // the schedule is absolute (seconds since start), so late wake-ups do not shift the following sends.
+    Clock::time_point start = Clock::now();
+    double next = 0.;
+    size_t numTimeframes = fReader.GetNumTimeframes();
+
+    for (int loop = 0; fState == RUNNING && (fNumLoops == 0 || loop < fNumLoops); ++loop) {
+      for (size_t i = 0; i < numTimeframes && fState == RUNNING; ++i) {
+        if (i > 0 || loop > 0) {
+          next += gapBefore(i);
+        }
+        Clock::time_point scheduled = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(next));
+
+        // sleep in short pieces to notice a state change during long gaps.
+        Clock::time_point now = Clock::now();
+        while (now < scheduled && fState == RUNNING) {
+          this_thread::sleep_until(min(scheduled, now + chrono::milliseconds(100)));
+          now = Clock::now();
+        }
+        if (fState != RUNNING) {
+          break;
+        }
+
+        fMetricLag->Observe(now > scheduled ? chrono::duration_cast<chrono::microseconds>(now - scheduled).count() : 0);
+
+        send(fReader.GetTimeframe(i));
+
+        // the kernel reads the next one while this one is on its way.
+        fReader.Prefetch(fReader.GetTimeframe((i + 1) % numTimeframes));
+      }
+    }
+
+    LOG(INFO) << "Replay finished after " << fMetricSent->Get() << " timeframes";
+  }
+
+  // messages still queued in the transport keep the mapping until they are gone.
+  fReader.Close();
+
+  rateLogger.interrupt();
+  rateLogger.join();
+
+  FairMQDevice::Shutdown();
+
+  // notify parent thread about end of processing.
+  boost::lock_guard<boost::mutex> lock(fRunningMutex);
+  fRunningFinished = true;
+  fRunningCondition.notify_one();
+}
+
+double TimeframeReplayer::gapBefore(size_t i) const
+{
+  if (!fRecordedTiming) {
+    return fEventRate > 0 ? 1. / fEventRate : 0.;
+  }
+  if (i == 0) {
+    // the recording starts over right away.
+    return 0.;
+  }
+  // the recording may span several recorder runs, so the clock can jump either way.
+  int64_t gap = fReader.GetTimeframe(i).time - fReader.GetTimeframe(i - 1).time;
+  return min(max(gap, static_cast<int64_t>(0)), static_cast<int64_t>(fMaxGapInMs) * 1000) / 1e6;
+}
+
+void TimeframeReplayer::send(const TimeframeFileReader::Timeframe& timeframe)
+{
+  if (!fWarnedParts && timeframe.numParts != static_cast<size_t>(fNumOutputs)) {
+    LOG(WARN) << "Timeframe #" << timeframe.timeframeId << " has " << timeframe.numParts << " parts for " << fNumOutputs
+              << " FLPs, missing ones are sent empty and extra ones are left out";
+    fWarnedParts = true;
+  }
+
+  for (int i = 0; i < fNumOutputs; ++i) {
+    FairMQMessage* msg = NULL;
+    if (static_cast<size_t>(i) < timeframe.numParts) {
+      const TimeframeFileReader::Part& part = fReader.GetPart(timeframe, i);
+      msg = fReader.CreateMessage(fTransportFactory, part);
+      fMetricBytes->Increment(part.size);
+    } else {
+      msg = fTransportFactory->CreateMessage();
+    }
+
+    // blocking, a replay loses nothing to a slow FLP.
+    fPayloadOutputs->at(i)->Send(msg);
+    delete msg;
+  }
+
+  fMetricSent->Increment();
+}
+
+void TimeframeReplayer::SetProperty(const int key, const string& value, const int slot/*= 0*/)
+{
+  switch (key) {
+    case InputFile:
+      fInputFile = value;
+      break;
+    case Timing:
+      fTiming = value;
+      break;
+    default:
+      FairMQDevice::SetProperty(key, value, slot);
+      break;
+  }
+}
+
+string TimeframeReplayer::GetProperty(const int key, const string& default_/*= ""*/, const int slot/*= 0*/)
+{
+  switch (key) {
+    case InputFile:
+      return fInputFile;
+    case Timing:
+      return fTiming;
+    default:
+      return FairMQDevice::GetProperty(key, default_, slot);
+  }
+}
+
+void TimeframeReplayer::SetProperty(const int key, const int value, const int slot/*= 0*/)
+{
+  switch (key) {
+    case EventRate:
+      fEventRate = value;
+      break;
+    case MaxGapInMs:
+      fMaxGapInMs = value;
+      break;
+    case NumLoops:
+      fNumLoops = value;
+      break;
+    default:
+      FairMQDevice::SetProperty(key, value, slot);
+      break;
+  }
+}
+
+int TimeframeReplayer::GetProperty(const int key, const int default_/*= 0*/, const int slot/*= 0*/)
+{
+  switch (key) {
+    case EventRate:
+      return fEventRate;
+    case MaxGapInMs:
+      return fMaxGapInMs;
+    case NumLoops:
+      return fNumLoops;
+    default:
+      return FairMQDevice::GetProperty(key, default_, slot);
+  }
+}
@@ -0,0 +1,80 @@
+/**
+ * TimeframeReplayer.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TIMEFRAMEREPLAYER_H_
+#define ALICEO2_DEVICES_TIMEFRAMEREPLAYER_H_
+
+#include <string>
+
+#include "FairMQDevice.h"
+
+#include "Metrics.h"
+
+#include "TimeframeFile.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Source in front of the FLPs that replays a recording of the EPN output.
+///
+/// Output i is connected to the data input of FLP i and gets payload part i
+/// of every recorded timeframe, so the FLPs send the recorded sub-timeframes
+/// again, one timeframe after the other. An output without a part in a
+/// timeframe gets an empty one, which keeps the timeframe ids of the FLPs in
+/// step. The messages point into the mapped recording, nothing is copied.
+///
+/// Timing "rate" sends EventRate timeframes per second, 0 as fast as the
+/// FLPs take them. Timing "recorded" reproduces the gaps between the
+/// timeframes as the recorder saw them, pauses longer than MaxGapInMs are
+/// shortened to it. The recording is played NumLoops times, 0 for no end.
+class TimeframeReplayer : public FairMQDevice
+{
+  public:
+    enum {
+      InputFile = FairMQDevice::Last,
+      Timing,
+      EventRate,
+      MaxGapInMs,
+      NumLoops,
+      Last
+    };
+
+    TimeframeReplayer();
+    virtual ~TimeframeReplayer();
+
+    virtual void SetProperty(const int key, const std::string& value, const int slot = 0);
+    virtual std::string GetProperty(const int key, const std::string& default_ = "", const int slot = 0);
+    virtual void SetProperty(const int key, const int value, const int slot = 0);
+    virtual int GetProperty(const int key, const int default_ = 0, const int slot = 0);
+
+  protected:
+    virtual void Init();
+    virtual void Run();
+
+  private:
+    /// seconds from the previous timeframe to timeframe i
+    double gapBefore(size_t i) const;
+    void send(const TimeframeFileReader::Timeframe& timeframe);
+
+    std::string fInputFile;
+    std::string fTiming; // "rate" or "recorded"
+    int fEventRate; // timeframes per second, 0 for no limit
+    int fMaxGapInMs;
+    int fNumLoops;
+
+    bool fRecordedTiming;
+    bool fWarnedParts; // about a timeframe with another number of parts than outputs
+    TimeframeFileReader fReader;
+
+    Metrics::Counter* fMetricSent;
+    Metrics::Counter* fMetricBytes;
+    Metrics::Histogram* fMetricLag; // us between the scheduled and the actual send
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ * TimeframeWindow.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm>
+
+#include "FairMQLogger.h"
+
+#include "TimeframeWindow.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+TimeframeWindow::TimeframeWindow()
+  : fSlots()
+  , fNumFLPs(0)
+  , fExpected()
+  , fNumExpected(0)
+  , fMessagePool(NULL)
+  , fNumAssembling(0)
+  , fNumDiscarded(0)
+  , fNumEvicted(0)
+{
+}
+
+TimeframeWindow::~TimeframeWindow()
+{
+}
+
+void TimeframeWindow::Init(size_t capacity, int numFLPs, MessagePool* pool)
+{
+  fNumFLPs = numFLPs;
+  fMessagePool = pool;
+
+  fExpected.assign((numFLPs + 63) / 64, 0);
+  for (int i = 0; i < numFLPs; ++i) {
+    fExpected[i / 64] |= 1ULL << (i % 64);
+  }
+  fNumExpected = numFLPs;
+
+  Slot empty;
+  empty.id = 0;
+  empty.state = Slot::Free;
+  empty.count = 0;
+  empty.missing = 0;
+  empty.released = false;
+  empty.timer = 0;
+  empty.flpMask.assign((numFLPs + 63) / 64, 0);
+  empty.expectedMask = fExpected;
+  empty.parts.assign(numFLPs, NULL);
+  empty.headers.assign(numFLPs, SubTimeframeHeader());
+
+  fSlots.assign(capacity > 0 ? capacity : 1, empty);
+}
+
+TimeframeWindow::Result TimeframeWindow::Add(uint64_t id, int flpIndex, FairMQMessage* part, chrono::steady_clock::time_point now)
+{
+  Slot& slot = Get(id);
+
+  Result result = open(slot, id, now);
+  if (result != Added) {
+    return result;
+  }
+
+  uint64_t bit = 1ULL << (flpIndex % 64);
+  if (slot.flpMask[flpIndex / 64] & bit) {
+    return Duplicate;
+  }
+  slot.flpMask[flpIndex / 64] |= bit;
+  slot.parts[flpIndex] = part;
+  ++slot.count;
+
+  // an FLP that has joined again since the timeframe started is taken along, but not waited for.
+  if (slot.expectedMask[flpIndex / 64] & bit) {
+    --slot.missing;
+  }
+
+  return slot.missing == 0 ? Completed : Added;
+}
+
+TimeframeWindow::Result TimeframeWindow::Skip(uint64_t id, int flpIndex, chrono::steady_clock::time_point now)
+{
+  Slot& slot = Get(id);
+
+  Result result = open(slot, id, now);
+  if (result != Added) {
+    return result;
+  }
+
+  uint64_t bit = 1ULL << (flpIndex % 64);
+  if (slot.flpMask[flpIndex / 64] & bit) {
+    return Duplicate;
+  }
+  if (!(slot.expectedMask[flpIndex / 64] & bit)) {
+    return Added;
+  }
+  slot.expectedMask[flpIndex / 64] &= ~bit;
+
+  return --slot.missing == 0 ? Completed : Added;
+}
+
+TimeframeWindow::Result TimeframeWindow::open(Slot& slot, uint64_t id, chrono::steady_clock::time_point now)
+{
+  if (slot.state != Slot::Free && slot.id != id) {
+    if (slot.id > id) {
+      return TooOld;
+    }
+    if (slot.state == Slot::Assembling) {
+      LOG(WARN) << "Timeframe #" << slot.id << " evicted by #" << id << " while incomplete, discarding";
+      ++fNumEvicted;
+      Discard(slot);
+    }
+    slot.state = Slot::Free;
+  }
+
+  if (slot.state == Slot::Closed) {
+    return slot.released ? Released : Late;
+  }
+
+  if (slot.state == Slot::Free) {
+    slot.id = id;
+    slot.state = Slot::Assembling;
+    slot.count = 0;
+    slot.missing = fNumExpected;
+    slot.startTime = now;
+    slot.timer = 0;
+    for (size_t i = 0; i < slot.flpMask.size(); ++i) {
+      slot.flpMask[i] = 0;
+      slot.expectedMask[i] = fExpected[i];
+    }
+    ++fNumAssembling;
+  }
+
+  return Added;
+}
+
+void TimeframeWindow::Expect(int flpIndex, bool expected)
+{
+  uint64_t bit = 1ULL << (flpIndex % 64);
+  bool was = fExpected[flpIndex / 64] & bit;
+
+  if (expected && !was) {
+    fExpected[flpIndex / 64] |= bit;
+    ++fNumExpected;
+  } else if (!expected && was) {
+    fExpected[flpIndex / 64] &= ~bit;
+    --fNumExpected;
+  }
+}
+
+void TimeframeWindow::Forgo(int flpIndex, vector<uint64_t>& completed)
+{
+  Expect(flpIndex, false);
+
+  size_t first = completed.size();
+  uint64_t bit = 1ULL << (flpIndex % 64);
+  for (size_t i = 0; i < fSlots.size(); ++i) {
+    Slot& slot = fSlots[i];
+    if (slot.state != Slot::Assembling || !(slot.expectedMask[flpIndex / 64] & bit)) {
+      continue;
+    }
+    slot.expectedMask[flpIndex / 64] &= ~bit;
+    if (!(slot.flpMask[flpIndex / 64] & bit) && --slot.missing == 0) {
+      completed.push_back(slot.id);
+    }
+  }
+
+  // in the order of the slots, which wraps around; forwarded oldest first.
+  sort(completed.begin() + first, completed.end());
+}
+
+void TimeframeWindow::Close(uint64_t id, bool released)
+{
+  Slot& slot = Get(id);
+
+  if (slot.state == Slot::Assembling) {
+    --fNumAssembling;
+  }
+  slot.state = Slot::Closed;
+  slot.released = released;
+  for (int i = 0; i < fNumFLPs; ++i) {
+    slot.parts[i] = NULL;
+  }
+}
+
+bool TimeframeWindow::Discard(uint64_t id)
+{
+  Slot& slot = Get(id);
+
+  if (slot.state != Slot::Assembling || slot.id != id) {
+    return false;
+  }
+
+  Discard(slot);
+  return true;
+}
+
+bool TimeframeWindow::Abandon(uint64_t id)
+{
+  Slot& slot = Get(id);
+
+  if (slot.state != Slot::Free && slot.id >= id) {
+    if (slot.id > id || slot.state == Slot::Closed) {
+      return false;
+    }
+    Discard(slot);
+    return true;
+  }
+
+  if (slot.state == Slot::Assembling) {
+    LOG(WARN) << "Timeframe #" << slot.id << " evicted by #" << id << " while incomplete, discarding";
+    ++fNumEvicted;
+    Discard(slot);
+  }
+
+  slot.id = id;
+  slot.state = Slot::Closed;
+  slot.released = false;
+  ++fNumDiscarded;
+  return true;
+}
+
+void TimeframeWindow::Clear()
+{
+  for (size_t i = 0; i < fSlots.size(); ++i) {
+    if (fSlots[i].state == Slot::Assembling) {
+      Discard(fSlots[i]);
+    }
+  }
+}
+
+void TimeframeWindow::Discard(Slot& slot)
+{
+  for (int i = 0; i < fNumFLPs; ++i) {
+    if (slot.parts[i] != NULL) {
+      if (fMessagePool) {
+        fMessagePool->Release(slot.parts[i]);
+      } else {
+        delete slot.parts[i];
+      }
+      slot.parts[i] = NULL;
+    }
+  }
+
+  slot.state = Slot::Closed;
+  slot.released = false;
+  --fNumAssembling;
+  ++fNumDiscarded;
+}
@@ -0,0 +1,128 @@
+/**
+ * TimeframeWindow.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TIMEFRAMEWINDOW_H_
+#define ALICEO2_DEVICES_TIMEFRAMEWINDOW_H_
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "FairMQMessage.h"
+
+#include "MessagePool.h"
+#include "TimeframeHeader.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Fixed-capacity assembly buffer for the sub-timeframes arriving at an EPN.
+///
+/// A timeframe lives in slot (id % capacity). Each slot keeps a bitmask of the
+/// FLPs that have delivered their part, so completeness and duplicate checks
+/// are O(1). A slot remembers the id it held after the timeframe is completed
+/// or discarded, and slot ids only grow, which gives a per-slot horizon: a part
+/// for an id that is not newer than its slot's id belongs to a timeframe that
+/// is already gone. Memory is bounded by the capacity, however long the run.
+///
+/// A timeframe is complete when the FLPs expected at its first part have
+/// delivered. That is all of them, unless the owner follows the FLPs that come
+/// and go with Expect() and Forgo().
+///
+/// With round-robin scheduling an EPN sees every n-th id; a prime capacity
+/// keeps those strided ids from crowding into a subset of the slots.
+class TimeframeWindow
+{
+  public:
+    enum Result {
+      Added,     ///< part stored, timeframe still incomplete
+      Completed, ///< part stored, all expected FLPs have delivered
+      TooOld,    ///< slot already holds a newer timeframe
+      Late,      ///< timeframe was already forwarded or discarded
+      Released,  ///< timeframe was forwarded without this part
+      Duplicate  ///< FLP already delivered this timeframe
+    };
+
+    struct Slot
+    {
+      enum State { Free, Assembling, Closed };
+
+      uint64_t id;
+      State state;
+      int count;
+      int missing; ///< expected FLPs that have not delivered yet
+      bool released; ///< closed at the release deadline, the late parts are Released
+      std::vector<uint64_t> flpMask;
+      std::vector<uint64_t> expectedMask;
+      std::vector<FairMQMessage*> parts; ///< indexed by FLP, NULL until arrived
+      std::vector<SubTimeframeHeader> headers; ///< indexed by FLP, filled in by the owner for the directory
+      std::chrono::steady_clock::time_point startTime;
+      uint64_t timer; ///< free for the owner, e.g. the id of the expiry timer
+    };
+
+    TimeframeWindow();
+    ~TimeframeWindow();
+
+    /// pool receives the parts of discarded timeframes, without one they are deleted
+    void Init(size_t capacity, int numFLPs, MessagePool* pool);
+
+    /// store the part of FLP flpIndex (0 <= flpIndex < numFLPs) for timeframe id.
+    /// On anything but Added/Completed the part is not stored and stays with the caller.
+    Result Add(uint64_t id, int flpIndex, FairMQMessage* part, std::chrono::steady_clock::time_point now);
+    /// the FLP will not deliver its part of timeframe id, which is started if it is not yet; its
+    /// bit stays clear in flpMask. Returns as Add, Completed once the other expected FLPs are in.
+    Result Skip(uint64_t id, int flpIndex, std::chrono::steady_clock::time_point now);
+
+    /// slot of an assembling timeframe, parts are in FLP order
+    Slot& Get(uint64_t id) { return fSlots[id % fSlots.size()]; }
+
+    /// expect the FLP in the timeframes started from now on or not
+    void Expect(int flpIndex, bool expected);
+    /// stop expecting the FLP, also in the timeframes assembling. Appends the ids of those
+    /// complete without it to completed, oldest first; their parts are in the slots as after Completed.
+    void Forgo(int flpIndex, std::vector<uint64_t>& completed);
+    int GetNumExpected() const { return fNumExpected; }
+
+    /// mark the timeframe as done after its parts have been handed over, late parts will be rejected.
+    /// The parts present may be fewer than the FLPs; released marks a timeframe forwarded at its
+    /// release deadline, whose late parts are then reported as Released rather than Late.
+    void Close(uint64_t id, bool released = false);
+    bool IsAssembling(uint64_t id) { return Get(id).state == Slot::Assembling && Get(id).id == id; }
+
+    /// discard the timeframe if it is still assembling, returns false if it is already gone.
+    bool Discard(uint64_t id);
+    /// discard the timeframe even if none of its parts has arrived yet, so that they are rejected
+    /// as late when they do. Returns false if it is already gone.
+    bool Abandon(uint64_t id);
+
+    /// release the parts of everything still assembling
+    void Clear();
+
+    size_t GetCapacity() const { return fSlots.size(); }
+    int GetNumAssembling() const { return fNumAssembling; }
+    unsigned long GetNumDiscarded() const { return fNumDiscarded; }
+    unsigned long GetNumEvicted() const { return fNumEvicted; }
+
+  private:
+    /// makes the slot assemble timeframe id, Added if it does, otherwise as Add
+    Result open(Slot& slot, uint64_t id, std::chrono::steady_clock::time_point now);
+    void Discard(Slot& slot);
+
+    std::vector<Slot> fSlots;
+    int fNumFLPs;
+    std::vector<uint64_t> fExpected; // copied into the slot of every new timeframe
+    int fNumExpected;
+    MessagePool* fMessagePool;
+
+    int fNumAssembling;
+    unsigned long fNumDiscarded; // timed out or evicted
+    unsigned long fNumEvicted;   // overwritten by a newer timeframe in the same slot
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
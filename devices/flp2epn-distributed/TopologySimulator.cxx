@@ -0,0 +1,747 @@
+/**
+ * TopologySimulator.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm> // max
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "FairMQLogger.h"
+
+#include "EPNSelector.h"
+#include "FlowControl.h"
+#include "SubTimeframeScheduler.h"
+#include "TimeframeAssembler.h"
+#include "TimeframeHeader.h"
+#include "TopologySimulator.h"
+#include "TrafficShaper.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+static int64_t toMicroseconds(TopologySimulator::Clock::duration d)
+{
+  return chrono::duration_cast<chrono::microseconds>(d).count();
+}
+
+/// mean and the bucket bounds of the median, the 99th percentile and the maximum of a histogram of the devices
+static string summarize(const AliceO2::Metrics::Histogram& histogram)
+{
+  vector<uint64_t> buckets;
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  histogram.Collect(buckets, count, sum);
+  if (count == 0) {
+    return "none";
+  }
+
+  const double quantiles[] = { 0.5, 0.99, 1. };
+  const char* names[] = { "p50", "p99", "max" };
+  ostringstream out;
+  out << "mean " << sum / count;
+  uint64_t seen = 0;
+  int q = 0;
+  for (int i = 0; i < AliceO2::Metrics::Histogram::kNumBuckets && q < 3; ++i) {
+    seen += buckets[i];
+    while (q < 3 && seen >= quantiles[q] * count) {
+      out << ", " << names[q] << " <= " << AliceO2::Metrics::Histogram::UpperBound(i);
+      ++q;
+    }
+  }
+  return out.str();
+}
+
+/// An FLP of the simulation: the SubTimeframeScheduler of FLPex, sending over the simulated uplink.
+class TopologySimulator::FLP : private SubTimeframeScheduler::Transport
+{
+  public:
+    FLP(TopologySimulator& sim, int index)
+      : fSim(sim)
+      , fIndex(index)
+      , fTimers()
+      , fScheduler()
+    {
+      const SimulationConfig& c = fSim.fConfig;
+      int numOutputs = c.numEPNs;
+
+      DropPolicy dropPolicy = kDropTimeframe;
+      ParseDropPolicy(c.queueDropPolicy, dropPolicy);
+
+      fTimers.Init(fSim.fResolution, 64 + 2, fSim.fNow);
+
+      fScheduler.Init(numOutputs, EPNSelector::Create(c.epnSelection, numOutputs), c.heartbeatTimeoutInMs, c.flowControl > 0,
+                      max(c.queueCapacity, 0), dropPolicy, &fTimers, this);
+      fScheduler.SetMetrics(&fSim.fNumDropped, &fSim.fNumDropNotices, &fSim.fNumCreditWaits, &fSim.fNumNoEPN,
+                            &fSim.fQueued, &fSim.fEPNsAlive, &fSim.fShapingDelay);
+
+      TrafficShaper& shaper = fScheduler.GetShaper();
+      shaper.Init(numOutputs, c.outputRate * 1e6, c.outputBurst);
+      if (c.numSlots > 0) {
+        // the simulation start stands in for the system clock shared by the FLPs.
+        shaper.SetTimeSlots(fIndex, c.numSlots, chrono::microseconds(c.slotLength), Clock::time_point());
+      }
+    }
+
+    void Dispatch(uint64_t id, uint64_t bytes)
+    {
+      SubTimeframeHeader h = SubTimeframeHeader();
+      h.timeframeId = id;
+      h.flpId = fIndex;
+      h.size = bytes;
+      fScheduler.Dispatch(h, fSim.fPlaceholder);
+    }
+
+    void UpdateHeartbeat(const EPNHeartbeat& heartbeat)
+    {
+      fScheduler.UpdateHeartbeat(heartbeat);
+    }
+
+    void UpdateCredit(const EPNCredit& credit)
+    {
+      fScheduler.UpdateCredit(credit);
+    }
+
+    void Wake()
+    {
+      fTimers.Advance(fSim.fNow);
+    }
+
+    size_t GetMaxQueueDepth() const { return fScheduler.GetShaper().GetMaxQueueDepth(); }
+    int GetNumAlive() const { return fScheduler.GetSelector().GetNumAlive(); }
+
+    unsigned long GetNumLateReports() const
+    {
+      const FreeBufferSelector* selector = dynamic_cast<const FreeBufferSelector*>(&fScheduler.GetSelector());
+      return selector ? selector->GetNumLateReports() : 0;
+    }
+
+  private:
+    virtual bool Send(int output, const SubTimeframeHeader& h, FairMQMessage* /*payload*/)
+    {
+      // the socket buffers are taken to be large enough, a send never has to be retried.
+      fSim.transmit(fIndex, output, h.timeframeId, h.size, 0);
+      return true;
+    }
+
+    virtual bool SendNotice(int output, const SubTimeframeHeader& h, uint16_t flag)
+    {
+      fSim.transmit(fIndex, output, h.timeframeId, 0, flag);
+      return true;
+    }
+
+    virtual void Release(FairMQMessage* /*payload*/)
+    {
+      // the placeholder stays with the simulator.
+    }
+
+    virtual Clock::time_point Now() const
+    {
+      return fSim.fNow;
+    }
+
+    virtual void Scheduled(Clock::time_point deadline)
+    {
+      fSim.wakeAt(kWakeFLP, fIndex, deadline);
+    }
+
+    TopologySimulator& fSim;
+    int fIndex;
+
+    TimerWheel fTimers;
+    SubTimeframeScheduler fScheduler;
+};
+
+/// An EPN of the simulation: the TimeframeAssembler of EPNex in single-threaded mode, with its heartbeats and credit.
+class TopologySimulator::EPN : private TimeframeAssembler::Output
+{
+  public:
+    EPN(TopologySimulator& sim, int index)
+      : fSim(sim)
+      , fIndex(index)
+      , fTimers()
+      , fAssembler()
+      , fFailed(false)
+      , fLastTimeframeId(0)
+      , fOccupancy()
+      , fCreditFinished(0)
+      , fBufferedBytes(0)
+      , fPeakBufferedBytes(0)
+    {
+      const SimulationConfig& c = fSim.fConfig;
+
+      fTimers.Init(fSim.fResolution, c.windowSize + 1, fSim.fNow);
+
+      fAssembler.Init(c.windowSize, c.numFLPs, &fSim.fParts, c.bufferTimeoutInMs, 0, &fTimers, this);
+      fAssembler.SetMetrics(&fSim.fNumCompleted, &fSim.fNumPartial, &fSim.fNumReleased, &fSim.fNumTimedOut,
+                            &fSim.fNumAbandoned, &fSim.fAssemblyTime);
+      fOccupancy.Init(max(c.occupancyInterval, 1));
+
+      schedule(fSim.fNow, &TimerWheel::Member<EPN, &EPN::sendHeartbeats>, 0);
+    }
+
+    ~EPN()
+    {
+      // the parts still assembling go back to the pool of the simulation.
+      fAssembler.Clear();
+    }
+
+    void Receive(const Event& e)
+    {
+      if (fFailed) {
+        ++fSim.fNumLost;
+        return;
+      }
+
+      uint64_t id = e.timeframeId;
+      if (id > fLastTimeframeId) {
+        fLastTimeframeId = id;
+      }
+      if (fOccupancy.IsDue(fLastTimeframeId)) {
+        sendHeartbeat();
+      }
+
+      Clock::time_point now = fSim.fNow;
+      int flpIndex = e.flp % fSim.fConfig.numFLPs;
+
+      if (e.flags & kDropped) {
+        fAssembler.Drop(id, flpIndex, now);
+        updateCredit();
+        return;
+      }
+
+      fSim.fTransferTime.Record(toMicroseconds(now - fSim.startOf(id)));
+
+      SubTimeframeHeader h = SubTimeframeHeader();
+      h.timeframeId = id;
+      h.flpId = e.flp;
+      h.size = e.bytes;
+
+      // counted before the Add(), which may forward the timeframe with this part right away.
+      fBufferedBytes += e.bytes;
+      FairMQMessage* part = fSim.fParts.Acquire();
+      switch (fAssembler.Add(h, flpIndex, part, now)) {
+        case TimeframeWindow::Added:
+          notePeak();
+          break;
+        case TimeframeWindow::Completed:
+          break;
+        default:
+          fSim.fParts.Release(part);
+          fBufferedBytes -= e.bytes;
+          ++fSim.fNumRejected;
+          break;
+      }
+      fSim.fBufferOccupancy.Record(fBufferedBytes >> 10);
+
+      updateCredit();
+    }
+
+    void Fail()
+    {
+      fFailed = true;
+      fSim.fNumLostAssembling += fAssembler.GetNumAssembling();
+      fAssembler.Clear();
+      fBufferedBytes = 0;
+    }
+
+    void Wake()
+    {
+      fTimers.Advance(fSim.fNow);
+    }
+
+    int GetNumAssembling() const { return fFailed ? 0 : fAssembler.GetNumAssembling(); }
+    unsigned long GetNumEvicted() const { return fAssembler.GetWindow().GetNumEvicted(); }
+    uint64_t GetPeakBufferedBytes() const { return fPeakBufferedBytes; }
+
+  private:
+    virtual void Forward(uint64_t id, TimeframeWindow::Slot& slot)
+    {
+      notePeak();
+      fSim.fTimeframeLatency.Record(toMicroseconds(fSim.fNow - fSim.startOf(id)));
+      fBufferedBytes -= heldBytes(slot);
+      for (size_t i = 0; i < slot.parts.size(); ++i) {
+        if (slot.parts[i]) {
+          fSim.fParts.Release(slot.parts[i]);
+        }
+      }
+    }
+
+    virtual void Discarding(const TimeframeWindow::Slot& slot)
+    {
+      fBufferedBytes -= heldBytes(slot);
+    }
+
+    virtual void Scheduled(Clock::time_point deadline)
+    {
+      fSim.wakeAt(kWakeEPN, fIndex, deadline);
+    }
+
+    void schedule(Clock::time_point deadline, TimerWheel::Callback callback, uint64_t cookie)
+    {
+      fTimers.Schedule(deadline, callback, this, cookie);
+      fSim.wakeAt(kWakeEPN, fIndex, deadline);
+    }
+
+    void notePeak()
+    {
+      fPeakBufferedBytes = max(fPeakBufferedBytes, fBufferedBytes);
+      fSim.fMaxBufferedBytes = max(fSim.fMaxBufferedBytes, fBufferedBytes);
+      fSim.fMaxAssembling = max(fSim.fMaxAssembling, fAssembler.GetNumAssembling());
+    }
+
+    uint64_t heldBytes(const TimeframeWindow::Slot& slot) const
+    {
+      uint64_t bytes = 0;
+      for (size_t i = 0; i < slot.parts.size(); ++i) {
+        if (slot.parts[i]) {
+          bytes += slot.headers[i].size;
+        }
+      }
+      return bytes;
+    }
+
+    void sendHeartbeat()
+    {
+      ControlMessage heartbeat = ControlMessage();
+      heartbeat.epn = fIndex;
+      heartbeat.freeSlots = fAssembler.GetCapacity() - fAssembler.GetNumAssembling();
+      heartbeat.effectiveFrom = fOccupancy.Stamp(fLastTimeframeId);
+      heartbeat.timestamp = toMicroseconds(fSim.fNow.time_since_epoch());
+      fSim.broadcast(heartbeat);
+    }
+
+    void sendHeartbeats(uint64_t)
+    {
+      if (fFailed) {
+        return;
+      }
+
+      sendHeartbeat();
+      sendCredit();
+
+      schedule(fSim.fNow + chrono::milliseconds(fSim.fConfig.heartbeatIntervalInMs),
+               &TimerWheel::Member<EPN, &EPN::sendHeartbeats>, 0);
+    }
+
+    void sendCredit()
+    {
+      int creditTimeframes = fSim.fConfig.creditTimeframes;
+
+      ControlMessage credit = ControlMessage();
+      credit.credit = true;
+      credit.epn = fIndex;
+      credit.finished = fAssembler.GetNumFinished();
+      credit.limit = credit.finished + (creditTimeframes > 0 ? creditTimeframes : fAssembler.GetCapacity());
+      fSim.broadcast(credit);
+
+      fCreditFinished = credit.finished;
+    }
+
+    void updateCredit()
+    {
+      int creditTimeframes = fSim.fConfig.creditTimeframes;
+      uint64_t step = max<uint64_t>((creditTimeframes > 0 ? creditTimeframes : fSim.fConfig.windowSize) / 4, 1);
+      if (fAssembler.GetNumFinished() >= fCreditFinished + step) {
+        sendCredit();
+      }
+    }
+
+    TopologySimulator& fSim;
+    int fIndex;
+
+    TimerWheel fTimers;
+    TimeframeAssembler fAssembler;
+    bool fFailed;
+
+    uint64_t fLastTimeframeId;
+    OccupancyStamper fOccupancy;
+    uint64_t fCreditFinished;
+    uint64_t fBufferedBytes;
+    uint64_t fPeakBufferedBytes;
+};
+
+TopologySimulator::TopologySimulator()
+  : fConfig()
+  , fPlaceholder(NULL)
+  , fParts()
+  , fFLPs()
+  , fEPNs()
+  , fPorts()
+  , fUplinks()
+  , fEvents()
+  , fControl(64)
+  , fNextSeq(0)
+  , fNow()
+  , fEnd()
+  , fPeriod()
+  , fResolution(chrono::milliseconds(1))
+  , fRandom()
+  , fUniform(0., 1.)
+  , fNumEvents(0)
+  , fWallSeconds(0.)
+  , fNumTimeframes(0)
+  , fNumSubTimeframes(0)
+  , fNumCompleted()
+  , fNumPartial()
+  , fNumReleased()
+  , fNumTimedOut()
+  , fNumEvicted(0)
+  , fNumAbandoned()
+  , fNumDropped()
+  , fNumDropNotices()
+  , fNumNoEPN()
+  , fNumRejected(0)
+  , fNumLost(0)
+  , fNumLostAssembling(0)
+  , fNumCreditWaits()
+  , fNumLateReports(0)
+  , fMaxFLPQueue(0)
+  , fMaxIncastBytes(0)
+  , fMaxIncastMessages(0)
+  , fMaxBufferedBytes(0)
+  , fMaxAssembling(0)
+  , fQueued()
+  , fEPNsAlive()
+  , fTimeframeLatency()
+  , fAssemblyTime()
+  , fTransferTime()
+  , fShapingDelay()
+  , fIncastQueue()
+  , fBufferOccupancy()
+  , fPeakBuffer()
+{
+}
+
+TopologySimulator::~TopologySimulator()
+{
+  delete fPlaceholder;
+}
+
+void TopologySimulator::Init(const SimulationConfig& config, FairMQTransportFactory* factory)
+{
+  fConfig = config;
+  fConfig.numFLPs = max(fConfig.numFLPs, 1);
+  fConfig.numEPNs = max(fConfig.numEPNs, 1);
+  fConfig.windowSize = max(fConfig.windowSize, 1);
+
+  DropPolicy policy;
+  if (!ParseDropPolicy(fConfig.queueDropPolicy, policy)) {
+    LOG(ERROR) << "Unknown drop policy \"" << fConfig.queueDropPolicy << "\", dropping whole timeframes";
+    fConfig.queueDropPolicy = "timeframe";
+  }
+  unique_ptr<EPNSelector> probe(EPNSelector::Create(fConfig.epnSelection, 1));
+  if (!probe) {
+    LOG(ERROR) << "Unknown EPN selection policy \"" << fConfig.epnSelection << "\", using round-robin";
+    fConfig.epnSelection = "round-robin";
+  }
+
+  delete fPlaceholder;
+  fPlaceholder = factory->CreateMessage();
+  fParts.Init(factory, 0);
+
+  fResolution = chrono::milliseconds(1);
+  if (fConfig.numSlots > 0) {
+    // the wheels tick on the slot boundaries, as in FLPex.
+    TrafficShaper slots;
+    slots.SetTimeSlots(0, fConfig.numSlots, chrono::microseconds(fConfig.slotLength), Clock::time_point());
+    fResolution = slots.GetSlotResolution(chrono::milliseconds(1));
+  }
+
+  fNow = Clock::time_point();
+  fPeriod = chrono::duration_cast<Clock::duration>(chrono::duration<double>(1. / max(fConfig.timeframeRate, 1e-3)));
+  fNumTimeframes = static_cast<uint64_t>(fConfig.durationInS * max(fConfig.timeframeRate, 1e-3));
+  // what is still in flight at the end of the generation has the buffer timeout to complete, twice for the queues.
+  fEnd = fNow + chrono::duration_cast<Clock::duration>(chrono::duration<double>(fConfig.durationInS))
+       + chrono::milliseconds(2 * fConfig.bufferTimeoutInMs + 1000);
+  fRandom.seed(fConfig.seed);
+
+  LOG(INFO) << "Simulating " << fConfig.numFLPs << " FLPs and " << fConfig.numEPNs << " EPNs, "
+            << fNumTimeframes << " timeframes of " << fConfig.numFLPs << " x " << fConfig.subTimeframeSize
+            << " bytes at " << fConfig.timeframeRate << " Hz";
+  double windowBytes = static_cast<double>(fConfig.numEPNs) * fConfig.windowSize * fConfig.numFLPs
+                     * (sizeof(FairMQMessage*) + sizeof(SubTimeframeHeader));
+  LOG(INFO) << "Assembly windows of " << fConfig.windowSize << " timeframes take " << windowBytes / (1 << 20)
+            << " MB, reduce the window size if that does not fit";
+
+  Port port;
+  port.free = fNow;
+  port.backlog = RingBuffer<pair<Clock::time_point, uint64_t> >(8);
+  port.queuedBytes = 0;
+  fPorts.assign(fConfig.numEPNs, port);
+  fUplinks.assign(fConfig.numFLPs, fNow);
+
+  fEPNs.clear();
+  for (int i = 0; i < fConfig.numEPNs; ++i) {
+    fEPNs.push_back(unique_ptr<EPN>(new EPN(*this, i)));
+  }
+  fFLPs.clear();
+  for (int i = 0; i < fConfig.numFLPs; ++i) {
+    fFLPs.push_back(unique_ptr<FLP>(new FLP(*this, i)));
+  }
+
+  if (fNumTimeframes > 0) {
+    for (int i = 0; i < fConfig.numFLPs; ++i) {
+      Event e = Event();
+      e.type = kGenerate;
+      e.flp = i;
+      e.timeframeId = 0;
+      e.time = fNow + chrono::microseconds(static_cast<int64_t>(fUniform(fRandom) * fConfig.skewInUs));
+      push(e);
+    }
+  }
+
+  if (fConfig.numFailedEPNs > 0) {
+    int numFailed = min(fConfig.numFailedEPNs, fConfig.numEPNs);
+    for (int k = 0; k < numFailed; ++k) {
+      Event e = Event();
+      e.type = kFailEPN;
+      e.epn = static_cast<int>(static_cast<int64_t>(k) * fConfig.numEPNs / numFailed);
+      e.time = fNow + chrono::duration_cast<Clock::duration>(chrono::duration<double>(fConfig.failAtInS));
+      push(e);
+    }
+  }
+}
+
+void TopologySimulator::push(Event& event)
+{
+  event.seq = fNextSeq++;
+  fEvents.push(event);
+}
+
+void TopologySimulator::wakeAt(EventType type, int node, Clock::time_point deadline)
+{
+  // the wheels started at the simulation start, their ticks are whole resolutions from there.
+  Clock::duration d = deadline - Clock::time_point();
+  Clock::duration::rep ticks = d.count() > 0 ? (d + fResolution - Clock::duration(1)) / fResolution : 0;
+
+  Event e = Event();
+  e.type = type;
+  e.flp = node;
+  e.epn = node;
+  e.time = max(fNow, Clock::time_point() + ticks * fResolution);
+  push(e);
+}
+
+TopologySimulator::Clock::time_point TopologySimulator::startOf(uint64_t id) const
+{
+  return Clock::time_point() + static_cast<Clock::duration::rep>(id) * fPeriod;
+}
+
+void TopologySimulator::transmit(int flp, int epn, uint64_t id, uint64_t bytes, uint16_t flags)
+{
+  uint64_t wire = bytes + kSubTimeframeWireSize;
+  Clock::duration oneWay = chrono::microseconds(fConfig.latencyInUs) / 2;
+  Clock::duration serialization(static_cast<Clock::duration::rep>(wire * 8. / fConfig.flpLinkGbps));
+
+  Clock::time_point start = max(fNow, fUplinks[flp]);
+  fUplinks[flp] = start + serialization;
+
+  Event e = Event();
+  e.type = kPortArrival;
+  e.flp = flp;
+  e.epn = epn;
+  e.flags = flags;
+  e.timeframeId = id;
+  e.bytes = bytes;
+  e.time = start + oneWay;
+  e.lastByte = fUplinks[flp] + oneWay;
+  push(e);
+
+  if (!(flags & kDropped)) {
+    ++fNumSubTimeframes;
+  }
+}
+
+void TopologySimulator::arriveAtPort(const Event& event)
+{
+  Port& port = fPorts[event.epn];
+  uint64_t wire = event.bytes + kSubTimeframeWireSize;
+
+  while (!port.backlog.empty() && port.backlog.front().first <= fNow) {
+    port.queuedBytes -= port.backlog.front().second;
+    port.backlog.pop();
+  }
+
+  Clock::duration serialization(static_cast<Clock::duration::rep>(wire * 8. / fConfig.epnLinkGbps));
+  Clock::time_point departure = max(max(fNow, port.free) + serialization, event.lastByte);
+  port.free = departure;
+  port.backlog.push(make_pair(departure, wire));
+  port.queuedBytes += wire;
+
+  fIncastQueue.Record(port.queuedBytes >> 10);
+  fMaxIncastBytes = max(fMaxIncastBytes, port.queuedBytes);
+  fMaxIncastMessages = max(fMaxIncastMessages, port.backlog.size());
+
+  Event e = event;
+  e.type = kReceive;
+  e.time = departure + chrono::microseconds(fConfig.latencyInUs) / 2;
+  push(e);
+}
+
+void TopologySimulator::broadcast(const ControlMessage& message)
+{
+  fControl.push(message);
+
+  Event e = Event();
+  e.type = kControl;
+  e.time = fNow + chrono::microseconds(fConfig.controlLatencyInUs);
+  push(e);
+}
+
+void TopologySimulator::deliverControl()
+{
+  ControlMessage message = fControl.front();
+  fControl.pop();
+
+  if (message.credit) {
+    EPNCredit credit;
+    credit.magic = kEPNCreditMagic;
+    credit.epnIndex = message.epn;
+    credit.session = 1;
+    credit.finished = message.finished;
+    credit.limit = message.limit;
+    credit.bytesPerFLP = (static_cast<uint64_t>(fConfig.creditBufferInMB) << 20) / fConfig.numFLPs;
+    for (size_t i = 0; i < fFLPs.size(); ++i) {
+      fFLPs[i]->UpdateCredit(credit);
+    }
+  } else {
+    EPNHeartbeat heartbeat;
+    heartbeat.epnIndex = message.epn;
+    heartbeat.freeSlots = message.freeSlots;
+    heartbeat.effectiveFrom = message.effectiveFrom;
+    heartbeat.session = 1;
+    heartbeat.timestamp = message.timestamp;
+    for (size_t i = 0; i < fFLPs.size(); ++i) {
+      fFLPs[i]->UpdateHeartbeat(heartbeat);
+    }
+  }
+}
+
+void TopologySimulator::generate(const Event& event)
+{
+  double spread = fConfig.sizeSpread * (2. * fUniform(fRandom) - 1.);
+  uint64_t bytes = max<int64_t>(static_cast<int64_t>(fConfig.subTimeframeSize * (1. + spread)), 1);
+
+  fFLPs[event.flp]->Dispatch(event.timeframeId, bytes);
+
+  uint64_t next = event.timeframeId + 1;
+  if (next < fNumTimeframes) {
+    Event e = event;
+    e.timeframeId = next;
+    e.time = startOf(next) + chrono::microseconds(static_cast<int64_t>(fUniform(fRandom) * fConfig.skewInUs));
+    push(e);
+  }
+}
+
+void TopologySimulator::Run()
+{
+  chrono::steady_clock::time_point wallStart = chrono::steady_clock::now();
+
+  while (!fEvents.empty() && fEvents.top().time <= fEnd) {
+    Event e = fEvents.top();
+    fEvents.pop();
+    fNow = e.time;
+    ++fNumEvents;
+
+    switch (e.type) {
+      case kGenerate:
+        generate(e);
+        break;
+      case kPortArrival:
+        arriveAtPort(e);
+        break;
+      case kReceive:
+        fEPNs[e.epn]->Receive(e);
+        break;
+      case kControl:
+        deliverControl();
+        break;
+      case kWakeFLP:
+        fFLPs[e.flp]->Wake();
+        break;
+      case kWakeEPN:
+        fEPNs[e.epn]->Wake();
+        break;
+      case kFailEPN:
+        LOG(INFO) << "EPN#" << e.epn << " fails at " << toMicroseconds(fNow.time_since_epoch()) / 1e6 << " s";
+        fEPNs[e.epn]->Fail();
+        break;
+    }
+  }
+
+  fWallSeconds = chrono::duration<double>(chrono::steady_clock::now() - wallStart).count();
+
+  fPeakBuffer.Reset();
+  fNumEvicted = 0;
+  for (size_t i = 0; i < fEPNs.size(); ++i) {
+    fPeakBuffer.Record(fEPNs[i]->GetPeakBufferedBytes() >> 10);
+    fNumEvicted += fEPNs[i]->GetNumEvicted();
+  }
+  fMaxFLPQueue = 0;
+  fNumLateReports = 0;
+  for (size_t i = 0; i < fFLPs.size(); ++i) {
+    fMaxFLPQueue = max(fMaxFLPQueue, fFLPs[i]->GetMaxQueueDepth());
+    fNumLateReports += fFLPs[i]->GetNumLateReports();
+  }
+}
+
+void TopologySimulator::Report(ostream& out) const
+{
+  int numAssembling = 0;
+  int minAlive = fConfig.numEPNs;
+  for (size_t i = 0; i < fEPNs.size(); ++i) {
+    numAssembling += fEPNs[i]->GetNumAssembling();
+  }
+  for (size_t i = 0; i < fFLPs.size(); ++i) {
+    minAlive = min(minAlive, fFLPs[i]->GetNumAlive());
+  }
+
+  double simulated = chrono::duration<double>(fNow.time_since_epoch()).count();
+
+  out << endl
+      << fConfig.numFLPs << " FLPs, " << fConfig.numEPNs << " EPNs, " << fConfig.epnSelection << " selection, "
+      << simulated << " s simulated in " << fixed << setprecision(1) << fWallSeconds << " s, "
+      << setprecision(0) << fNumEvents / max(fWallSeconds, 1e-9) << " events/s" << endl << endl;
+
+  out << "Timeframes" << endl
+      << "  generated                " << fNumTimeframes << endl
+      << "  completed                " << fNumCompleted.Get() << " (" << fNumPartial.Get() << " partial, "
+      << fNumReleased.Get() << " at the release deadline)" << endl
+      << "  timed out on the EPN     " << fNumTimedOut.Get() << endl
+      << "  evicted from the window  " << fNumEvicted << endl
+      << "  dropped by an FLP        " << fNumAbandoned.Get() << endl
+      << "  lost on failed EPNs      " << fNumLostAssembling << " assembling, " << fNumLost << " sub-timeframes arriving later" << endl
+      << "  still assembling         " << numAssembling << endl << endl;
+
+  out << "Sub-timeframes" << endl
+      << "  sent                     " << fNumSubTimeframes << endl
+      << "  dropped from FLP queues  " << fNumDropped.Get() << " (" << fNumDropNotices.Get() << " drop notices)" << endl
+      << "  discarded, no EPN alive  " << fNumNoEPN.Get() << endl
+      << "  rejected as late or dup  " << fNumRejected << endl
+      << "  waited for credit        " << fNumCreditWaits.Get() << endl
+      << "  largest FLP queue        " << fMaxFLPQueue << endl
+      << "  late occupancy reports   " << fNumLateReports << endl
+      << "  fewest EPNs alive        " << minAlive << " (seen by an FLP at the end)" << endl << endl;
+
+  out << "Buffers" << endl
+      << "  EPN buffer, KiB          " << fBufferOccupancy.Summary() << endl
+      << "  EPN peak buffer, KiB     " << fPeakBuffer.Summary() << endl
+      << "  most timeframes in an EPN window " << fMaxAssembling << " of " << fConfig.windowSize << endl
+      << "  incast queue, KiB        " << fIncastQueue.Summary() << endl
+      << "  largest incast queue     " << (fMaxIncastBytes >> 10) << " KiB, " << fMaxIncastMessages << " sub-timeframes" << endl << endl;
+
+  out << "Latencies, us" << endl
+      << "  timeframe                " << fTimeframeLatency.Summary() << endl
+      << "  assembly                 " << summarize(fAssemblyTime) << endl
+      << "  sub-timeframe transfer   " << fTransferTime.Summary() << endl
+      << "  shaping delay            " << summarize(fShapingDelay) << endl;
+}
+
+void TopologySimulator::WriteLatencyDistribution(ostream& out) const
+{
+  fTimeframeLatency.WriteDistribution(out);
+}
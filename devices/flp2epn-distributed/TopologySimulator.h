@@ -0,0 +1,235 @@
+/**
+ * TopologySimulator.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TOPOLOGYSIMULATOR_H_
+#define ALICEO2_DEVICES_TOPOLOGYSIMULATOR_H_
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <random>
+#include <ostream>
+#include <cstdint>
+
+#include "FairMQTransportFactory.h"
+
+#include "LatencyHistogram.h"
+#include "MessagePool.h"
+#include "Metrics.h"
+#include "RingBuffer.h"
+#include "TimerWheel.h"
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Parameters of a simulation run. The FLP and EPN parameters have the
+/// meaning and units of the device properties of the same name.
+struct SimulationConfig
+{
+  int numFLPs;
+  int numEPNs;
+
+  // load
+  double timeframeRate;      ///< timeframes per second
+  size_t subTimeframeSize;   ///< mean bytes
+  double sizeSpread;         ///< sizes are uniform within +- this fraction of the mean
+  int skewInUs;              ///< an FLP gets its part of a timeframe up to this late
+  double durationInS;        ///< time over which timeframes are generated
+
+  // network
+  double flpLinkGbps;
+  double epnLinkGbps;
+  int latencyInUs;           ///< one way FLP to EPN through the switch
+  int controlLatencyInUs;    ///< heartbeats and credit, EPN to FLP
+
+  // FLPex
+  std::string epnSelection;
+  int heartbeatTimeoutInMs;
+  int outputRate;            ///< MB/s per EPN, 0 for unlimited
+  int outputBurst;
+  int numSlots;              ///< FLP i sends in slot i
+  int slotLength;            ///< us
+  int flowControl;
+  int queueCapacity;
+  std::string queueDropPolicy;
+
+  // EPNex
+  int heartbeatIntervalInMs;
+  int occupancyInterval;     ///< timeframes per occupancy report
+  int bufferTimeoutInMs;
+  int windowSize;
+  int creditTimeframes;
+  int creditBufferInMB;
+
+  // failures
+  int numFailedEPNs;         ///< spread over the EPN indices
+  double failAtInS;
+
+  unsigned int seed;
+};
+
+/// Discrete-event simulation of the FLP to EPN topology.
+///
+/// Every FLP of the simulation runs the SubTimeframeScheduler of FLPex, every
+/// EPN the TimeframeAssembler of EPNex with the occupancy reports and the
+/// credit, each with its own TimerWheel. The sockets are replaced by the
+/// simulated network. Time is simulated, the timer wheels are advanced to
+/// their next tick as events come due.
+///
+/// The network is a non-blocking switch at message granularity: an FLP uplink
+/// and a switch port in front of every EPN serialize their messages one after
+/// the other at the link rate, and a message leaves the port no earlier than
+/// its last byte has arrived. The bytes waiting at a port are the incast
+/// queue. Heartbeats and credit have a fixed latency and take no bandwidth.
+class TopologySimulator
+{
+  public:
+    typedef TimerWheel::Clock Clock;
+
+    TopologySimulator();
+    ~TopologySimulator();
+
+    /// one empty message of the factory stands in for the payloads in the assembly windows
+    void Init(const SimulationConfig& config, FairMQTransportFactory* factory);
+
+    /// runs the generation time and the drain after it
+    void Run();
+
+    void Report(std::ostream& out) const;
+    /// percentile distribution of the timeframe latency in us, in the HdrHistogram text format
+    void WriteLatencyDistribution(std::ostream& out) const;
+
+  private:
+    class FLP;
+    class EPN;
+    friend class FLP;
+    friend class EPN;
+
+    enum EventType {
+      kGenerate,    ///< an FLP gets its part of a timeframe
+      kPortArrival, ///< the first byte of a sub-timeframe reaches the switch port of its EPN
+      kReceive,     ///< a sub-timeframe has arrived at its EPN
+      kControl,     ///< the oldest control message reaches the FLPs
+      kWakeFLP,     ///< a timer wheel tick is due
+      kWakeEPN,
+      kFailEPN
+    };
+
+    struct Event
+    {
+      Clock::time_point time;
+      uint64_t seq; // keeps events of the same time in the order they were scheduled
+      EventType type;
+      int flp;
+      int epn;
+      uint16_t flags;
+      uint64_t timeframeId;
+      uint64_t bytes;
+      Clock::time_point lastByte; // kPortArrival
+
+      bool operator>(const Event& other) const
+      {
+        return time > other.time || (time == other.time && seq > other.seq);
+      }
+    };
+
+    /// heartbeat or credit, they have the same latency so they are delivered in order
+    struct ControlMessage
+    {
+      bool credit;
+      int epn;
+      int32_t freeSlots;
+      uint64_t effectiveFrom;
+      int64_t timestamp;
+      uint64_t finished;
+      uint64_t limit;
+    };
+
+    struct Port
+    {
+      Clock::time_point free;
+      RingBuffer<std::pair<Clock::time_point, uint64_t> > backlog; // departure and bytes, in order
+      uint64_t queuedBytes;
+    };
+
+    void push(Event& event);
+    /// nominal start of a timeframe, the FLPs get their parts up to the skew later
+    Clock::time_point startOf(uint64_t id) const;
+    /// the wake-up for a timer of a wheel that started at the simulation start
+    void wakeAt(EventType type, int node, Clock::time_point deadline);
+
+    /// called by the FLPs
+    void transmit(int flp, int epn, uint64_t id, uint64_t bytes, uint16_t flags);
+    /// called by the EPNs
+    void broadcast(const ControlMessage& message);
+
+    void generate(const Event& event);
+    void arriveAtPort(const Event& event);
+    void deliverControl();
+
+    SimulationConfig fConfig;
+    FairMQMessage* fPlaceholder;
+    MessagePool fParts; // the parts in the windows of the EPNs, they own them like EPNex does
+
+    std::vector<std::unique_ptr<FLP> > fFLPs;
+    std::vector<std::unique_ptr<EPN> > fEPNs;
+    std::vector<Port> fPorts;
+    std::vector<Clock::time_point> fUplinks; // free from
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event> > fEvents;
+    RingBuffer<ControlMessage> fControl;
+    uint64_t fNextSeq;
+    Clock::time_point fNow;
+    Clock::time_point fEnd;
+    Clock::duration fPeriod; // between two timeframes
+    Clock::duration fResolution; // of the timer wheels
+
+    std::mt19937_64 fRandom;
+    std::uniform_real_distribution<double> fUniform;
+
+    // results
+    uint64_t fNumEvents;
+    double fWallSeconds;
+    uint64_t fNumTimeframes;
+    uint64_t fNumSubTimeframes;
+    // the counters of the devices, shared by all FLPs and EPNs
+    Metrics::Counter fNumCompleted;
+    Metrics::Counter fNumPartial;
+    Metrics::Counter fNumReleased;
+    Metrics::Counter fNumTimedOut;
+    uint64_t fNumEvicted;
+    Metrics::Counter fNumAbandoned;    // after a drop notice
+    Metrics::Counter fNumDropped;      // sub-timeframes, full FLP queues
+    Metrics::Counter fNumDropNotices;
+    Metrics::Counter fNumNoEPN;        // sub-timeframes, no EPN alive
+    uint64_t fNumRejected;     // late or duplicate parts
+    uint64_t fNumLost;         // sub-timeframes that reached a failed EPN
+    uint64_t fNumLostAssembling; // timeframes in the window of an EPN when it failed
+    Metrics::Counter fNumCreditWaits;
+    uint64_t fNumLateReports;
+    size_t fMaxFLPQueue;       // sub-timeframes queued on one FLP
+    uint64_t fMaxIncastBytes;
+    size_t fMaxIncastMessages;
+    uint64_t fMaxBufferedBytes; // on one EPN
+    int fMaxAssembling;
+
+    Metrics::Gauge fQueued;            // not reported, the last FLP to update it wins
+    Metrics::Gauge fEPNsAlive;
+
+    LatencyHistogram fTimeframeLatency; // us, timeframe start to completion
+    Metrics::Histogram fAssemblyTime;   // us, first to last part at the EPN
+    LatencyHistogram fTransferTime;     // us, timeframe start to arrival of a sub-timeframe
+    Metrics::Histogram fShapingDelay;   // us
+    LatencyHistogram fIncastQueue;      // KiB at a port, sampled at every arrival
+    LatencyHistogram fBufferOccupancy;  // KiB on an EPN, sampled at every arrival
+    LatencyHistogram fPeakBuffer;       // KiB, peak of every EPN
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
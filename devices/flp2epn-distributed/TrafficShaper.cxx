@@ -0,0 +1,163 @@
+/**
+ * TrafficShaper.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm>
+
+#include "TrafficShaper.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+TrafficShaper::TrafficShaper()
+  : fRate(0.)
+  , fTolerance(Clock::duration::zero())
+  , fTat()
+  , fSlot(0)
+  , fNumSlots(0)
+  , fSlotLength(Clock::duration::zero())
+  , fEpoch()
+  , fQueued()
+  , fTotalQueued(0)
+  , fMaxQueued(0)
+  , fNumReserved(0)
+  , fNumDelayed(0)
+  , fTotalDelay(Clock::duration::zero())
+  , fMaxDelay(Clock::duration::zero())
+{
+}
+
+TrafficShaper::~TrafficShaper()
+{
+}
+
+void TrafficShaper::Init(int numOutputs, double bytesPerSecond, size_t burstBytes)
+{
+  fRate = bytesPerSecond > 0. ? bytesPerSecond : 0.;
+  fTolerance = fRate > 0. ? chrono::duration_cast<Clock::duration>(chrono::duration<double>(burstBytes / fRate))
+                          : Clock::duration::zero();
+  fTat.assign(numOutputs, Clock::time_point());
+  fQueued.assign(numOutputs, 0);
+  fTotalQueued = 0;
+  ResetStatistics();
+}
+
+void TrafficShaper::SetTimeSlots(int slot, int numSlots, Clock::duration slotLength, Clock::time_point epoch)
+{
+  fNumSlots = (numSlots > 0 && slotLength > Clock::duration::zero()) ? numSlots : 0;
+  fSlot = fNumSlots > 0 ? slot % fNumSlots : 0;
+  fSlotLength = slotLength;
+  fEpoch = epoch;
+}
+
+TrafficShaper::Clock::time_point TrafficShaper::AlignToSlot(Clock::time_point t) const
+{
+  if (fNumSlots <= 0) {
+    return t;
+  }
+
+  Clock::duration cycle = fSlotLength * fNumSlots;
+  Clock::duration windowStart = fSlotLength * fSlot;
+
+  // position in the current cycle, also for times before the epoch.
+  Clock::duration offset = (t - fEpoch) % cycle;
+  if (offset < Clock::duration::zero()) {
+    offset += cycle;
+  }
+
+  if (offset >= windowStart && offset < windowStart + fSlotLength) {
+    return t;
+  }
+
+  Clock::duration wait = windowStart - offset;
+  if (wait < Clock::duration::zero()) {
+    wait += cycle;
+  }
+  return t + wait;
+}
+
+TrafficShaper::Clock::duration TrafficShaper::GetSlotResolution(Clock::duration resolution) const
+{
+  if (fNumSlots <= 0) {
+    return resolution;
+  }
+
+  // the greatest common divisor of the slot length and the resolution.
+  Clock::rep a = fSlotLength.count();
+  Clock::rep b = resolution.count();
+  while (b != 0) {
+    Clock::rep r = a % b;
+    a = b;
+    b = r;
+  }
+  return Clock::duration(a);
+}
+
+TrafficShaper::Clock::time_point TrafficShaper::Reserve(int output, size_t bytes, Clock::time_point now)
+{
+  ++fNumReserved;
+
+  if (!IsEnabled()) {
+    return now;
+  }
+
+  Clock::time_point departure = now;
+
+  if (fRate > 0.) {
+    // the bucket holds enough tokens once the theoretical arrival time is within the burst tolerance.
+    departure = max(now, fTat[output] - fTolerance);
+  }
+  if (fNumSlots > 0) {
+    departure = AlignToSlot(departure);
+  }
+  if (fRate > 0.) {
+    Clock::duration cost = chrono::duration_cast<Clock::duration>(chrono::duration<double>(bytes / fRate));
+    fTat[output] = max(fTat[output], departure) + cost;
+  }
+
+  if (departure > now) {
+    Clock::duration delay = departure - now;
+    ++fNumDelayed;
+    fTotalDelay += delay;
+    fMaxDelay = max(fMaxDelay, delay);
+  }
+
+  return departure;
+}
+
+void TrafficShaper::Refund(int output, size_t bytes)
+{
+  if (fRate > 0.) {
+    // the departures reserved in between stay as they are, the messages after them may leave earlier.
+    fTat[output] -= chrono::duration_cast<Clock::duration>(chrono::duration<double>(bytes / fRate));
+  }
+}
+
+void TrafficShaper::Enqueue(int output)
+{
+  ++fQueued[output];
+  fMaxQueued = max(fMaxQueued, ++fTotalQueued);
+}
+
+void TrafficShaper::Dequeue(int output)
+{
+  --fQueued[output];
+  --fTotalQueued;
+}
+
+TrafficShaper::Clock::duration TrafficShaper::GetAverageDelay() const
+{
+  return fNumReserved > 0 ? fTotalDelay / static_cast<Clock::rep>(fNumReserved) : Clock::duration::zero();
+}
+
+void TrafficShaper::ResetStatistics()
+{
+  fMaxQueued = fTotalQueued;
+  fNumReserved = 0;
+  fNumDelayed = 0;
+  fTotalDelay = Clock::duration::zero();
+  fMaxDelay = Clock::duration::zero();
+}
@@ -0,0 +1,91 @@
+/**
+ * TrafficShaper.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_DEVICES_TRAFFICSHAPER_H_
+#define ALICEO2_DEVICES_TRAFFICSHAPER_H_
+
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+namespace AliceO2 {
+namespace Devices {
+
+/// Computes departure times for the messages of an FLP so that the FLPs do
+/// not all converge on an EPN at the same moment (incast).
+///
+/// Every output has a token bucket (rate in bytes/s, burst in bytes),
+/// implemented as a virtual scheduling clock: Reserve() returns the earliest
+/// time a message may leave and charges its size, so the departure times of
+/// one output never decrease and the caller can keep a FIFO per output. In
+/// time-slot mode the departures are in addition confined to slot k of a cycle
+/// of n slots, aligned to a clock shared by all FLPs. The current time is
+/// always passed in. Not thread-safe.
+class TrafficShaper
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    TrafficShaper();
+    ~TrafficShaper();
+
+    /// bytesPerSecond <= 0 disables the rate limit
+    void Init(int numOutputs, double bytesPerSecond, size_t burstBytes);
+    /// send only during slot `slot` of every cycle of numSlots slots, counted from epoch (numSlots <= 0 disables)
+    void SetTimeSlots(int slot, int numSlots, Clock::duration slotLength, Clock::time_point epoch);
+
+    bool IsEnabled() const { return fRate > 0. || fNumSlots > 0; }
+    bool HasTimeSlots() const { return fNumSlots > 0; }
+
+    /// t if it is within the slot of the FLP or there are no slots, otherwise the start of the next slot
+    Clock::time_point AlignToSlot(Clock::time_point t) const;
+    /// the coarsest timer resolution up to `resolution` that puts a tick on every slot boundary,
+    /// for a TimerWheel started on a boundary. `resolution` itself without slots.
+    Clock::duration GetSlotResolution(Clock::duration resolution) const;
+
+    /// departure time of a message of `bytes` on `output`, charges its size to the bucket
+    Clock::time_point Reserve(int output, size_t bytes, Clock::time_point now);
+    /// gives the charge of a reserved message back to the bucket, for a message that never left
+    void Refund(int output, size_t bytes);
+
+    /// the caller keeps the queues, it reports them for the queue depth metrics
+    void Enqueue(int output);
+    void Dequeue(int output);
+
+    // metrics
+    size_t GetQueueDepth(int output) const { return fQueued.at(output); }
+    size_t GetQueueDepth() const { return fTotalQueued; }
+    size_t GetMaxQueueDepth() const { return fMaxQueued; }
+    unsigned long GetNumDelayed() const { return fNumDelayed; }
+    unsigned long GetNumReserved() const { return fNumReserved; }
+    Clock::duration GetMaxDelay() const { return fMaxDelay; }
+    Clock::duration GetAverageDelay() const;
+    /// reset the maxima and averages, e.g. after they have been reported
+    void ResetStatistics();
+
+  private:
+    double fRate; // bytes per second
+    Clock::duration fTolerance; // burst expressed as time
+    std::vector<Clock::time_point> fTat; // theoretical arrival time per output
+
+    int fSlot;
+    int fNumSlots;
+    Clock::duration fSlotLength;
+    Clock::time_point fEpoch;
+
+    std::vector<size_t> fQueued;
+    size_t fTotalQueued;
+    size_t fMaxQueued;
+    unsigned long fNumReserved;
+    unsigned long fNumDelayed;
+    Clock::duration fTotalDelay;
+    Clock::duration fMaxDelay;
+};
+
+} // namespace Devices
+} // namespace AliceO2
+
+#endif
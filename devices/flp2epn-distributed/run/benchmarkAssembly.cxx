@@ -0,0 +1,461 @@
+/**
+ * benchmarkAssembly.cxx
+ *
+ * Measures the assembly stage of EPNex without sockets, single-threaded and
+ * with assembly workers, for increasing FLP counts. The main thread plays the
+ * I/O thread: it copies every part into a pooled message as a receive would
+ * and hands it to the TimeframeAssembler, or to the AssemblyWorker of its
+ * shard. The timeframes come out with their directory, the output thread of
+ * the threaded mode returns the parts like EPNex::forwardTimeframes(). The
+ * payload checksums are verified where the device verifies them. Reports the
+ * assembled timeframes per second and the payload throughput.
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <cstring>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "Metrics.h"
+
+#include "AssemblyWorker.h"
+#include "Crc32c.h"
+#include "MessagePool.h"
+#include "SPSCQueue.h"
+#include "TimeframeAssembler.h"
+#include "TimeframeHeader.h"
+#include "TimerWheel.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef struct BenchmarkOptions
+{
+  vector<int> numFLPs;
+  vector<int> numWorkers;
+  int numTimeframes;
+  int partSize;
+  int windowSize;
+  int checksum;
+} BenchmarkOptions_t;
+
+struct Result
+{
+  int numFLPs;
+  int numWorkers;
+  uint64_t timeframes;
+  double bytes;
+  double seconds;
+};
+
+/// the counters the assembly expects from its device, not reported here
+struct Counters
+{
+  AliceO2::Metrics::Counter completed;
+  AliceO2::Metrics::Counter partial;
+  AliceO2::Metrics::Counter released;
+  AliceO2::Metrics::Counter discarded;
+  AliceO2::Metrics::Counter rejected;
+  AliceO2::Metrics::Counter late;
+  AliceO2::Metrics::Counter checksumFailures;
+  AliceO2::Metrics::Histogram assemblyTime;
+};
+
+inline bool parse_cmd_line(int _argc, char* _argv[], BenchmarkOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("num-flps", bpo::value< vector<int> >()->multitoken(), "FLP counts to run, default 2 4 8 16 32")
+    ("num-workers", bpo::value< vector<int> >()->multitoken(), "Assembly worker counts to run, 0 assembles on the I/O thread, default 0 1 2 4")
+    ("num-timeframes", bpo::value<int>()->default_value(50000), "Timeframes assembled per run")
+    ("part-size", bpo::value<int>()->default_value(16384), "Payload bytes per FLP and timeframe")
+    ("window-size", bpo::value<int>()->default_value(509), "Timeframes assembled at the same time, per worker in the threaded mode")
+    ("checksum", bpo::value<int>()->default_value(1), "Verify the CRC32C of every payload (1) or not (0)")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "EPN assembly benchmark" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  if (vm.count("num-flps")) {
+    _options->numFLPs = vm["num-flps"].as<vector<int>>();
+  } else {
+    _options->numFLPs = { 2, 4, 8, 16, 32 };
+  }
+  if (vm.count("num-workers")) {
+    _options->numWorkers = vm["num-workers"].as<vector<int>>();
+  } else {
+    _options->numWorkers = { 0, 1, 2, 4 };
+  }
+  _options->numTimeframes = max(vm["num-timeframes"].as<int>(), 1);
+  _options->partSize = max(vm["part-size"].as<int>(), 1);
+  _options->windowSize = max(vm["window-size"].as<int>(), 1);
+  _options->checksum = vm["checksum"].as<int>();
+
+  return true;
+}
+
+/// the receive of a part: a pooled message filled with the payload of the FLP, the header as the FLP sent it
+class PartSource
+{
+  public:
+    PartSource(const BenchmarkOptions& options, int numFLPs)
+      : fPayload(options.partSize)
+      , fChecksum(0)
+      , fNumFLPs(numFLPs)
+      , fChecksummed(options.checksum > 0)
+    {
+      mt19937_64 random(1);
+      for (size_t i = 0; i < fPayload.size(); ++i) {
+        fPayload[i] = static_cast<unsigned char>(random());
+      }
+      fChecksum = Crc32c(fPayload.data(), fPayload.size());
+    }
+
+    FairMQMessage* Receive(MessagePool& pool, uint64_t id, int flpIndex, SubTimeframeHeader& h) const
+    {
+      FairMQMessage* part = pool.Acquire();
+      part->Rebuild(fPayload.size());
+      memcpy(part->GetData(), fPayload.data(), fPayload.size());
+
+      InitSubTimeframeHeader(h, id, flpIndex, kDataTypeRaw, fPayload.size());
+      if (fChecksummed) {
+        h.checksum = fChecksum;
+        h.flags |= kHasChecksum;
+      }
+      return part;
+    }
+
+    int GetNumFLPs() const { return fNumFLPs; }
+
+  private:
+    vector<unsigned char> fPayload;
+    uint32_t fChecksum;
+    int fNumFLPs;
+    bool fChecksummed;
+};
+
+/// single-threaded mode: the assembler on the I/O thread, like EPNex::runSingle()
+class SingleOutput : public TimeframeAssembler::Output
+{
+  public:
+    SingleOutput(MessagePool& pool, int numFLPs)
+      : fPool(pool)
+      , fHeaders(numFLPs)
+      , fPresent(GetMissingMaskWords(numFLPs))
+      , fNumFLPs(numFLPs)
+      , fNumForwarded(0)
+      , fBytes(0.)
+    {
+    }
+
+    virtual void Forward(uint64_t id, TimeframeWindow::Slot& slot)
+    {
+      size_t numParts = 0;
+      fPresent.assign(fPresent.size(), 0);
+      for (int i = 0; i < fNumFLPs; ++i) {
+        if (slot.parts[i]) {
+          fHeaders[numParts++] = slot.headers[i];
+          fPresent[i / 64] |= 1ULL << (i % 64);
+        }
+      }
+
+      FairMQMessage* directoryPart = fPool.Acquire();
+      directoryPart->Rebuild(GetTimeframeDirectorySize(numParts, fNumFLPs));
+      WriteTimeframeDirectory(directoryPart->GetData(), id, fHeaders.data(), numParts, fPresent.data(), fNumFLPs);
+      fPool.Release(directoryPart);
+
+      // sent: the parts go back to the pool.
+      for (int i = 0; i < fNumFLPs; ++i) {
+        if (slot.parts[i]) {
+          fBytes += slot.parts[i]->GetSize();
+          fPool.Release(slot.parts[i]);
+          slot.parts[i] = NULL;
+        }
+      }
+      ++fNumForwarded;
+    }
+
+    uint64_t GetNumForwarded() const { return fNumForwarded; }
+    double GetBytes() const { return fBytes; }
+
+  private:
+    MessagePool& fPool;
+    vector<SubTimeframeHeader> fHeaders;
+    vector<uint64_t> fPresent;
+    int fNumFLPs;
+    uint64_t fNumForwarded;
+    double fBytes;
+};
+
+static Result runSingle(const PartSource& source, const BenchmarkOptions& options, FairMQTransportFactory* factory)
+{
+  int numFLPs = source.GetNumFLPs();
+  Result result = { numFLPs, 0, 0, 0., 0. };
+
+  MessagePool pool;
+  pool.Init(factory, 4 * numFLPs + 3);
+  TimerWheel timers;
+  timers.Init(chrono::milliseconds(1), options.windowSize + 2, TimerWheel::Clock::now());
+  SingleOutput output(pool, numFLPs);
+  TimeframeAssembler assembler;
+  assembler.Init(options.windowSize, numFLPs, &pool, 1000, 0, &timers, &output);
+  Counters counters;
+  assembler.SetMetrics(&counters.completed, &counters.partial, &counters.released, &counters.discarded,
+                       &counters.discarded, &counters.assemblyTime);
+
+  SubTimeframeHeader h;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int id = 0; id < options.numTimeframes; ++id) {
+    TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+    for (int flp = 0; flp < numFLPs; ++flp) {
+      FairMQMessage* part = source.Receive(pool, id, flp, h);
+      if (options.checksum > 0 && !VerifyPayloadChecksum(h, part->GetData(), part->GetSize())) {
+        counters.checksumFailures.Increment();
+      }
+      TimeframeWindow::Result added = assembler.Add(h, flp, part, now);
+      if (added != TimeframeWindow::Added && added != TimeframeWindow::Completed) {
+        pool.Release(part);
+      }
+    }
+    timers.Advance(now);
+  }
+  result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  result.timeframes = output.GetNumForwarded();
+  result.bytes = output.GetBytes();
+
+  assembler.Clear();
+
+  return result;
+}
+
+/// the output thread of the threaded mode, like EPNex::forwardTimeframes()
+static void forwardTimeframes(vector<unique_ptr<AssemblyWorker> >* workers, SPSCQueue<FairMQMessage*>* sent, int numFLPs,
+                              FairMQTransportFactory* factory, atomic<bool>* forwarding, atomic<uint64_t>* numForwarded,
+                              atomic<uint64_t>* bytes)
+{
+  MessagePool outputPool;
+  outputPool.Init(factory, 2);
+
+  vector<FairMQMessage*> parts;
+  vector<SubTimeframeHeader> headers;
+  vector<uint64_t> present(GetMissingMaskWords(numFLPs));
+  parts.reserve(numFLPs);
+  headers.reserve(numFLPs);
+
+  Backoff backoff;
+  size_t next = 0;
+
+  while (forwarding->load()) {
+    bool forwarded = false;
+
+    for (size_t n = 0; n < workers->size(); ++n) {
+      AssemblyWorker& worker = *(*workers)[(next + n) % workers->size()];
+      AssemblyWorker::Output output;
+      if (!worker.PopOutput(output)) {
+        continue;
+      }
+
+      uint64_t id = output.id;
+      parts.clear();
+      headers.clear();
+      present.assign(present.size(), 0);
+      Backoff partBackoff;
+      while (true) {
+        parts.push_back(output.data);
+        headers.push_back(output.header);
+        present[output.flpIndex / 64] |= 1ULL << (output.flpIndex % 64);
+        if (output.last) {
+          break;
+        }
+        while (!worker.PopOutput(output)) {
+          partBackoff.Pause();
+        }
+        partBackoff.Reset();
+      }
+
+      FairMQMessage* directoryPart = outputPool.Acquire();
+      directoryPart->Rebuild(GetTimeframeDirectorySize(parts.size(), numFLPs));
+      WriteTimeframeDirectory(directoryPart->GetData(), id, headers.data(), parts.size(), present.data(), numFLPs);
+      outputPool.Release(directoryPart);
+
+      uint64_t size = 0;
+      for (size_t i = 0; i < parts.size(); ++i) {
+        size += parts[i]->GetSize();
+        Backoff returnBackoff;
+        while (!sent->TryPush(parts[i])) {
+          returnBackoff.Pause();
+        }
+      }
+      bytes->fetch_add(size, memory_order_relaxed);
+      numForwarded->fetch_add(1, memory_order_release);
+
+      next = (next + n + 1) % workers->size();
+      forwarded = true;
+      break;
+    }
+
+    if (forwarded) {
+      backoff.Reset();
+    } else {
+      backoff.Pause();
+    }
+  }
+}
+
+static Result runWorkers(const PartSource& source, int numWorkers, const BenchmarkOptions& options, FairMQTransportFactory* factory)
+{
+  int numFLPs = source.GetNumFLPs();
+  Result result = { numFLPs, numWorkers, 0, 0., 0. };
+
+  // the queue capacity and the pool of EPNex::runWorkers().
+  size_t queueCapacity = 16 * numFLPs;
+  MessagePool pool;
+  pool.Init(factory, (queueCapacity + 1) * numWorkers + 2);
+
+  Counters counters;
+  vector<unique_ptr<AssemblyWorker> > workers;
+  for (int k = 0; k < numWorkers; ++k) {
+    workers.push_back(unique_ptr<AssemblyWorker>(new AssemblyWorker(queueCapacity)));
+    workers.back()->Init(factory, options.windowSize, numFLPs, 1000, 0, options.checksum > 0);
+    workers.back()->SetMetrics(&counters.completed, &counters.partial, &counters.released, &counters.discarded,
+                               &counters.rejected, &counters.late, &counters.checksumFailures, &counters.assemblyTime);
+    workers.back()->Start();
+  }
+
+  SPSCQueue<FairMQMessage*> sent(queueCapacity * numWorkers);
+  atomic<bool> forwarding(true);
+  atomic<uint64_t> numForwarded(0);
+  atomic<uint64_t> bytes(0);
+  thread output(forwardTimeframes, &workers, &sent, numFLPs, factory, &forwarding, &numForwarded, &bytes);
+
+  FairMQMessage* msg;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int id = 0; id < options.numTimeframes; ++id) {
+    AssemblyWorker& worker = *workers[id % numWorkers];
+    for (int flp = 0; flp < numFLPs; ++flp) {
+      AssemblyWorker::Part part = { static_cast<uint64_t>(id), flp, SubTimeframeHeader(), NULL };
+      part.data = source.Receive(pool, id, flp, part.header);
+
+      // as EPNex::pushToWorker(): the messages are taken back while the worker queue is full.
+      Backoff backoff;
+      while (!worker.Push(part)) {
+        for (int k = 0; k < numWorkers; ++k) {
+          while (workers[k]->PopReturned(msg)) {
+            pool.Release(msg);
+          }
+        }
+        while (sent.TryPop(msg)) {
+          pool.Release(msg);
+        }
+        backoff.Pause();
+      }
+    }
+    while (sent.TryPop(msg)) {
+      pool.Release(msg);
+    }
+  }
+
+  Backoff backoff;
+  chrono::steady_clock::time_point lastProgress = chrono::steady_clock::now();
+  uint64_t lastForwarded = 0;
+  while (numForwarded.load(memory_order_acquire) < static_cast<uint64_t>(options.numTimeframes)) {
+    while (sent.TryPop(msg)) {
+      pool.Release(msg);
+    }
+    uint64_t forwarded = numForwarded.load(memory_order_acquire);
+    if (forwarded != lastForwarded) {
+      lastForwarded = forwarded;
+      lastProgress = chrono::steady_clock::now();
+    } else if (chrono::steady_clock::now() - lastProgress > chrono::seconds(2)) {
+      LOG(WARN) << numFLPs << " FLPs, " << numWorkers << " workers: no progress for 2 s, stopping at " << forwarded << " timeframes";
+      break;
+    }
+    backoff.Pause();
+  }
+  result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  result.timeframes = numForwarded.load();
+  result.bytes = bytes.load();
+
+  forwarding = false;
+  output.join();
+  for (int k = 0; k < numWorkers; ++k) {
+    workers[k]->Stop();
+    while (workers[k]->PopReturned(msg)) {
+      pool.Release(msg);
+    }
+  }
+  while (sent.TryPop(msg)) {
+    pool.Release(msg);
+  }
+
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  BenchmarkOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  // only the messages of the factory are used, no sockets.
+  FairMQTransportFactory* factory = new FairMQTransportFactoryZMQ();
+
+  vector<Result> results;
+  for (size_t f = 0; f < options.numFLPs.size(); ++f) {
+    PartSource source(options, max(options.numFLPs[f], 1));
+    for (size_t w = 0; w < options.numWorkers.size(); ++w) {
+      if (options.numWorkers[w] > 0) {
+        results.push_back(runWorkers(source, options.numWorkers[w], options, factory));
+      } else {
+        results.push_back(runSingle(source, options, factory));
+      }
+    }
+  }
+
+  cout << endl << "EPN assembly of " << options.numTimeframes << " timeframes, " << options.partSize << " bytes per part, "
+       << (options.checksum > 0 ? "checksums verified" : "no checksums") << ", " << thread::hardware_concurrency() << " cores" << endl
+       << setw(8) << "FLPs" << setw(10) << "workers" << setw(12) << "timeframes"
+       << setw(14) << "timeframes/s" << setw(14) << "parts/s" << setw(10) << "GB/s" << endl;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    double seconds = r.seconds > 0. ? r.seconds : 1e-9;
+    cout << setw(8) << r.numFLPs << setw(10) << r.numWorkers << setw(12) << r.timeframes
+         << setw(14) << fixed << setprecision(0) << r.timeframes / seconds
+         << setw(14) << r.timeframes * r.numFLPs / seconds
+         << setw(10) << setprecision(2) << r.bytes / seconds / 1e9 << endl;
+  }
+
+  delete factory;
+
+  return 0;
+}
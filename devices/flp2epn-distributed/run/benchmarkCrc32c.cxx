@@ -0,0 +1,160 @@
+/**
+ * benchmarkCrc32c.cxx
+ *
+ * Measures the CRC32C of the sub-timeframe payloads per part size, with the
+ * hardware implementation and with the portable one, and reports the
+ * throughput on one core and the time it costs per GB. The FLP pays this once
+ * per payload with --checksum 1 and the EPN once more for the verification.
+ * The parts are taken one after the other from a buffer larger than the
+ * caches, as freshly received payloads would be.
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+
+#include "Crc32c.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef struct BenchmarkOptions
+{
+  vector<int> partSizes;
+  int totalInMB;
+  int bufferInMB;
+} BenchmarkOptions_t;
+
+struct Result
+{
+  int partSize;
+  string implementation;
+  double seconds;
+  double bytes;
+};
+
+typedef uint32_t (*Implementation)(const void*, size_t, uint32_t);
+
+inline bool parse_cmd_line(int _argc, char* _argv[], BenchmarkOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("part-sizes", bpo::value< vector<int> >()->multitoken(), "Part sizes in bytes to run, default 4 kB 64 kB 1 MB 16 MB")
+    ("total", bpo::value<int>()->default_value(4096), "MB checksummed per part size and implementation")
+    ("buffer", bpo::value<int>()->default_value(256), "MB of payload the parts are taken from, larger than the caches")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "CRC32C benchmark" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  if (vm.count("part-sizes")) {
+    _options->partSizes = vm["part-sizes"].as<vector<int>>();
+  } else {
+    for (int size = 4096; size <= 16 << 20; size *= 16) {
+      _options->partSizes.push_back(size);
+    }
+  }
+  _options->totalInMB = max(vm["total"].as<int>(), 1);
+  _options->bufferInMB = max(vm["buffer"].as<int>(), 1);
+
+  return true;
+}
+
+static Result run(Implementation crc, const string& name, int partSize, const vector<unsigned char>& buffer, const BenchmarkOptions& options)
+{
+  Result result = { partSize, name, 0., 0. };
+
+  size_t size = min(static_cast<size_t>(max(partSize, 1)), buffer.size());
+  size_t numParts = (static_cast<size_t>(options.totalInMB) << 20) / size + 1;
+  size_t position = 0;
+  uint32_t sum = 0;
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (size_t i = 0; i < numParts; ++i) {
+    if (position + size > buffer.size()) {
+      position = 0;
+    }
+    sum ^= crc(buffer.data() + position, size, 0);
+    position += size;
+  }
+  result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  result.bytes = static_cast<double>(numParts) * size;
+
+  // keeps the loop from being optimised away.
+  LOG(DEBUG) << name << ", " << partSize << " byte parts: " << sum;
+
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  BenchmarkOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  if (Crc32c("123456789", 9) != 0xe3069283 || Crc32cPortable("123456789", 9) != 0xe3069283) {
+    LOG(ERROR) << "CRC32C of the check string is wrong";
+    return 1;
+  }
+
+  vector<unsigned char> buffer(static_cast<size_t>(options.bufferInMB) << 20);
+  mt19937_64 random(1);
+  for (size_t i = 0; i < buffer.size(); i += 8) {
+    uint64_t word = random();
+    for (size_t k = 0; k < 8 && i + k < buffer.size(); ++k) {
+      buffer[i + k] = static_cast<unsigned char>(word >> (8 * k));
+    }
+  }
+
+  if (Crc32c(buffer.data() + 3, buffer.size() - 3) != Crc32cPortable(buffer.data() + 3, buffer.size() - 3)) {
+    LOG(ERROR) << GetCrc32cImplementation() << " and slicing-by-8 disagree";
+    return 1;
+  }
+
+  vector<Result> results;
+  for (size_t i = 0; i < options.partSizes.size(); ++i) {
+    if (HasHardwareCrc32c()) {
+      results.push_back(run(&Crc32c, GetCrc32cImplementation(), options.partSizes[i], buffer, options));
+    }
+    results.push_back(run(&Crc32cPortable, "slicing-by-8", options.partSizes[i], buffer, options));
+  }
+
+  cout << endl << "CRC32C on one core, parts from " << options.bufferInMB << " MB of payload" << endl
+       << setw(12) << "part bytes" << setw(16) << "implementation" << setw(10) << "GB/s" << setw(10) << "ms/GB" << endl;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    double seconds = r.seconds > 0. ? r.seconds : 1e-9;
+    cout << setw(12) << r.partSize
+         << setw(16) << r.implementation
+         << setw(10) << fixed << setprecision(2) << r.bytes / seconds / 1e9
+         << setw(10) << setprecision(1) << seconds * 1e3 / (r.bytes / 1e9) << endl;
+  }
+
+  return 0;
+}
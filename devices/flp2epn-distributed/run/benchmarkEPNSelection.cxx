@@ -0,0 +1,298 @@
+/**
+ * benchmarkEPNSelection.cxx
+ *
+ * Simulates the timeframe distribution to EPNs of mixed speed and reports tail
+ * latency and discard rate for each EPN selection policy. No transport is
+ * involved, the selectors are the ones used by FLPex. The EPNs send their
+ * occupancy reports like EPNex: stamped by an OccupancyStamper from the newest
+ * timeframe they have received, when that enters a new epoch and with every
+ * heartbeat.
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <random>
+#include <algorithm>
+#include <memory>
+
+#include "boost/program_options.hpp"
+
+#include "EPNSelector.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef struct BenchmarkOptions
+{
+  int numEPNs;
+  int numTimeframes;
+  int bufferSize;
+  double serviceTimeInMs;
+  double slowFraction;
+  double slowFactor;
+  double load;
+  double heartbeatIntervalInMs;
+  double reportDelayInMs;
+  int occupancyInterval;
+} BenchmarkOptions_t;
+
+struct PendingReport
+{
+  double deliveryTime;
+  int epn;
+  EPNOccupancy occupancy;
+};
+
+struct Result
+{
+  string policy;
+  int completed;
+  int discardedFull;
+  int discardedSplit;
+  unsigned long lateReports;
+  vector<double> latencies;
+};
+
+inline bool parse_cmd_line(int _argc, char* _argv[], BenchmarkOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("num-epns", bpo::value<int>()->default_value(32), "Number of EPNs")
+    ("num-timeframes", bpo::value<int>()->default_value(1000000), "Number of simulated timeframes")
+    ("buffer-size", bpo::value<int>()->default_value(16), "Timeframes an EPN can hold before it discards")
+    ("service-time", bpo::value<double>()->default_value(10.), "Mean processing time of a timeframe on a fast EPN in milliseconds")
+    ("slow-fraction", bpo::value<double>()->default_value(0.25), "Fraction of slow EPNs")
+    ("slow-factor", bpo::value<double>()->default_value(3.), "Processing time of a slow EPN relative to a fast one")
+    ("load", bpo::value<double>()->default_value(0.85), "Timeframe rate relative to the total EPN capacity")
+    ("heartbeat-interval", bpo::value<double>()->default_value(3000.), "Interval of the EPN heartbeats in milliseconds, each with an occupancy report")
+    ("report-delay", bpo::value<double>()->default_value(1.), "Extra delivery delay of the reports to the second FLP in milliseconds")
+    ("occupancy-interval", bpo::value<int>()->default_value(32), "Timeframes per occupancy report, as --occupancy-interval of the EPNs")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    cout << "EPN selection benchmark" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  _options->numEPNs = vm["num-epns"].as<int>();
+  _options->numTimeframes = vm["num-timeframes"].as<int>();
+  _options->bufferSize = vm["buffer-size"].as<int>();
+  _options->serviceTimeInMs = vm["service-time"].as<double>();
+  _options->slowFraction = vm["slow-fraction"].as<double>();
+  _options->slowFactor = vm["slow-factor"].as<double>();
+  _options->load = vm["load"].as<double>();
+  _options->heartbeatIntervalInMs = vm["heartbeat-interval"].as<double>();
+  _options->reportDelayInMs = vm["report-delay"].as<double>();
+  _options->occupancyInterval = vm["occupancy-interval"].as<int>();
+
+  return true;
+}
+
+// Two FLPs with their own selector each; the second one receives the occupancy
+// reports later. A timeframe for which they disagree never completes.
+class Simulation
+{
+  public:
+    Simulation(EPNSelector* flpA, const BenchmarkOptions& o)
+      : fFLPA(flpA)
+      , fOptions(o)
+      , fStampers(o.numEPNs)
+      , fNewest(o.numEPNs, 0)
+      , fPending()
+    {
+      for (int i = 0; i < o.numEPNs; ++i) {
+        fStampers[i].Init(o.occupancyInterval);
+      }
+    }
+
+    /// a part of timeframe id reached the EPN, which reports once the id enters a new epoch
+    void Receive(int epn, uint64_t id, double now, size_t numHeld)
+    {
+      fNewest[epn] = max(fNewest[epn], id);
+      if (fStampers[epn].IsDue(fNewest[epn])) {
+        SendReport(epn, now, numHeld);
+      }
+    }
+
+    /// the occupancy of the EPN, to the first FLP right away and to the second one after the delay
+    void SendReport(int epn, double now, size_t numHeld)
+    {
+      PendingReport report;
+      report.deliveryTime = now + fOptions.reportDelayInMs;
+      report.epn = epn;
+      report.occupancy.effectiveFrom = fStampers[epn].Stamp(fNewest[epn]);
+      report.occupancy.freeSlots = fOptions.bufferSize - numHeld;
+      fFLPA->Report(epn, report.occupancy);
+      fPending.push_back(report);
+    }
+
+    void Deliver(EPNSelector* flpB, double now)
+    {
+      while (!fPending.empty() && fPending.front().deliveryTime <= now) {
+        flpB->Report(fPending.front().epn, fPending.front().occupancy);
+        fPending.pop_front();
+      }
+    }
+
+  private:
+    EPNSelector* fFLPA;
+    const BenchmarkOptions& fOptions;
+    vector<OccupancyStamper> fStampers;
+    vector<uint64_t> fNewest; // newest timeframe id received, per EPN
+    deque<PendingReport> fPending; // reports on their way to the second FLP
+};
+
+static unsigned long getNumLateReports(const EPNSelector& selector)
+{
+  const FreeBufferSelector* freeBuffer = dynamic_cast<const FreeBufferSelector*>(&selector);
+  return freeBuffer ? freeBuffer->GetNumLateReports() : 0;
+}
+
+Result simulate(const string& policy, const BenchmarkOptions& o, const vector<double>& serviceTimes)
+{
+  unique_ptr<EPNSelector> flpA(EPNSelector::Create(policy, o.numEPNs));
+  unique_ptr<EPNSelector> flpB(EPNSelector::Create(policy, o.numEPNs));
+
+  double capacity = 0.; // timeframes per millisecond
+  for (int i = 0; i < o.numEPNs; ++i) {
+    capacity += 1. / serviceTimes[i];
+    // the static weights are the known relative speeds.
+    flpA->SetWeight(i, serviceTimes[0] / serviceTimes[i]);
+    flpB->SetWeight(i, serviceTimes[0] / serviceTimes[i]);
+  }
+  double interval = 1. / (capacity * o.load);
+
+  mt19937_64 rng(12345);
+  vector<exponential_distribution<double>> service;
+  for (int i = 0; i < o.numEPNs; ++i) {
+    service.push_back(exponential_distribution<double>(1. / serviceTimes[i]));
+  }
+
+  vector<deque<double>> queues(o.numEPNs); // completion times of the timeframes held by each EPN
+  Simulation sim(flpA.get(), o);
+  double nextHeartbeat = 0.;
+
+  Result r;
+  r.policy = policy;
+  r.completed = 0;
+  r.discardedFull = 0;
+  r.discardedSplit = 0;
+  r.lateReports = 0;
+  r.latencies.reserve(o.numTimeframes);
+
+  for (int id = 0; id < o.numTimeframes; ++id) {
+    double now = id * interval;
+
+    for (int i = 0; i < o.numEPNs; ++i) {
+      while (!queues[i].empty() && queues[i].front() <= now) {
+        queues[i].pop_front();
+      }
+    }
+
+    while (nextHeartbeat <= now) {
+      for (int i = 0; i < o.numEPNs; ++i) {
+        sim.SendReport(i, nextHeartbeat, queues[i].size());
+      }
+      nextHeartbeat += o.heartbeatIntervalInMs;
+    }
+    sim.Deliver(flpB.get(), now);
+
+    int epn = flpA->Select(id);
+    int epnB = flpB->Select(id);
+    // each EPN gets the part of the FLP that chose it, and learns about the timeframe id from it.
+    sim.Receive(epn, id, now, queues[epn].size());
+    if (epnB != epn) {
+      sim.Receive(epnB, id, now, queues[epnB].size());
+      ++r.discardedSplit;
+      continue;
+    }
+
+    deque<double>& q = queues[epn];
+    if (q.size() >= static_cast<size_t>(o.bufferSize)) {
+      ++r.discardedFull;
+      continue;
+    }
+
+    double start = q.empty() ? now : max(now, q.back());
+    double end = start + service[epn](rng);
+    q.push_back(end);
+
+    r.latencies.push_back(end - now);
+    ++r.completed;
+  }
+
+  r.lateReports = getNumLateReports(*flpA) + getNumLateReports(*flpB);
+  sort(r.latencies.begin(), r.latencies.end());
+
+  return r;
+}
+
+double percentile(const vector<double>& sorted, double p)
+{
+  if (sorted.empty()) {
+    return 0.;
+  }
+  size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[i];
+}
+
+int main(int argc, char** argv)
+{
+  BenchmarkOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  // the slow EPNs are spread over the index range, not clustered at one end.
+  vector<double> serviceTimes(options.numEPNs, options.serviceTimeInMs);
+  int numSlow = static_cast<int>(options.numEPNs * options.slowFraction + 0.5);
+  for (int i = 0; i < numSlow; ++i) {
+    serviceTimes[(i * options.numEPNs) / numSlow] = options.serviceTimeInMs * options.slowFactor;
+  }
+
+  cout << options.numEPNs << " EPNs (" << numSlow << " slower by " << options.slowFactor << "x), "
+       << options.numTimeframes << " timeframes at " << options.load * 100. << "% load, "
+       << "buffer " << options.bufferSize << " timeframes" << endl << endl;
+
+  cout << left << setw(16) << "policy" << right
+       << setw(12) << "discard %" << setw(12) << "(full)" << setw(12) << "(split)"
+       << setw(12) << "p50 ms" << setw(12) << "p99 ms" << setw(12) << "p99.9 ms" << setw(12) << "max ms"
+       << setw(12) << "late rep." << endl;
+
+  const char* policies[] = { "round-robin", "weighted-hash", "free-buffer" };
+
+  for (int p = 0; p < 3; ++p) {
+    Result r = simulate(policies[p], options, serviceTimes);
+
+    double discarded = 100. * (r.discardedFull + r.discardedSplit) / options.numTimeframes;
+
+    cout << left << setw(16) << r.policy << right << fixed << setprecision(3)
+         << setw(12) << discarded << setw(12) << r.discardedFull << setw(12) << r.discardedSplit
+         << setprecision(2)
+         << setw(12) << percentile(r.latencies, 0.5)
+         << setw(12) << percentile(r.latencies, 0.99)
+         << setw(12) << percentile(r.latencies, 0.999)
+         << setw(12) << (r.latencies.empty() ? 0. : r.latencies.back())
+         << setw(12) << r.lateReports << endl;
+  }
+
+  return 0;
+}
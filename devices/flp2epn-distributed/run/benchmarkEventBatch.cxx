@@ -0,0 +1,226 @@
+/**
+ * benchmarkEventBatch.cxx
+ *
+ * Sends small events from one thread to another over a push/pull pair,
+ * packed into EventBatch messages of a given number of events, and reports
+ * the event and byte throughput per batch size. A batch size of 1 sends
+ * every event as a message of its own, as the FLP does without batching.
+ * The receiver walks every event of a batch, as an EPN consumer would.
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstring>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "EventBatch.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef struct BenchmarkOptions
+{
+  vector<int> batchSizes;
+  int eventSize;
+  int numEvents;
+  string transport;
+  int port;
+} BenchmarkOptions_t;
+
+struct Result
+{
+  int batchSize;
+  unsigned long events;
+  unsigned long messages;
+  double seconds;
+  double bytes;
+};
+
+inline bool parse_cmd_line(int _argc, char* _argv[], BenchmarkOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("batch-sizes", bpo::value< vector<int> >()->multitoken(), "Events per message to run, default 1 2 4 ... 1024")
+    ("event-size", bpo::value<int>()->default_value(64), "Bytes per event")
+    ("num-events", bpo::value<int>()->default_value(2000000), "Events sent per batch size")
+    ("transport", bpo::value<string>()->default_value("inproc"), "inproc, or tcp over the loopback interface")
+    ("port", bpo::value<int>()->default_value(5580), "First tcp port, every batch size uses the next one")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "Event batching benchmark" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  if (vm.count("batch-sizes")) {
+    _options->batchSizes = vm["batch-sizes"].as<vector<int>>();
+  } else {
+    for (int n = 1; n <= 1024; n *= 2) {
+      _options->batchSizes.push_back(n);
+    }
+  }
+  _options->eventSize = max(vm["event-size"].as<int>(), 1);
+  _options->numEvents = vm["num-events"].as<int>();
+  _options->transport = vm["transport"].as<string>();
+  _options->port = vm["port"].as<int>();
+
+  return true;
+}
+
+static void sendEvents(FairMQSocket* socket, FairMQTransportFactory* factory, int batchSize, const BenchmarkOptions& options)
+{
+  // the events come from a buffer, as from the input of an FLP; only the first byte changes.
+  vector<char> event(options.eventSize, 0);
+
+  if (batchSize <= 1) {
+    for (int i = 0; i < options.numEvents; ++i) {
+      event[0] = static_cast<char>(i);
+      FairMQMessage* msg = factory->CreateMessage(options.eventSize);
+      memcpy(msg->GetData(), event.data(), options.eventSize);
+      socket->Send(msg);
+      delete msg;
+    }
+    return;
+  }
+
+  EventBatchBuilder batch;
+  batch.Init(batchSize, 0);
+  FairMQMessage* msg = factory->CreateMessage();
+
+  for (int i = 0; i < options.numEvents; ++i) {
+    event[0] = static_cast<char>(i);
+    batch.Add(event.data(), options.eventSize);
+    if (batch.IsFull() || i == options.numEvents - 1) {
+      batch.Flush(msg);
+      socket->Send(msg);
+    }
+  }
+
+  delete msg;
+}
+
+static Result run(int batchSize, const BenchmarkOptions& options, FairMQTransportFactory* factory)
+{
+  static int runNumber = 0;
+  ++runNumber;
+
+  Result result;
+  result.batchSize = batchSize;
+  result.events = 0;
+  result.messages = 0;
+  result.bytes = 0.;
+
+  stringstream address;
+  if (options.transport == "tcp") {
+    address << "tcp://127.0.0.1:" << options.port + runNumber - 1;
+  } else {
+    address << "inproc://benchmark-event-batch-" << runNumber;
+  }
+
+  FairMQSocket* sink = factory->CreateSocket("pull", 0, 1);
+  sink->Bind(address.str());
+  FairMQSocket* source = factory->CreateSocket("push", 0, 1);
+  source->Connect(address.str());
+
+  FairMQMessage* msg = factory->CreateMessage();
+  unsigned long checksum = 0;
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  thread sender(sendEvents, source, factory, batchSize, cref(options));
+
+  while (result.events < static_cast<unsigned long>(options.numEvents)) {
+    if (sink->Receive(msg) <= 0) {
+      continue;
+    }
+    ++result.messages;
+    result.bytes += msg->GetSize();
+
+    if (batchSize <= 1) {
+      checksum += static_cast<unsigned char>(*static_cast<char*>(msg->GetData()));
+      ++result.events;
+    } else {
+      EventBatch batch(msg->GetData(), msg->GetSize());
+      if (!batch.IsValid()) {
+        LOG(ERROR) << "Received a malformed batch of " << msg->GetSize() << " bytes";
+        break;
+      }
+      for (EventBatch::Iterator event = batch.begin(); event != batch.end(); ++event) {
+        checksum += static_cast<unsigned char>((*event).data[0]);
+        ++result.events;
+      }
+    }
+    msg->Rebuild();
+  }
+
+  result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  sender.join();
+
+  LOG(DEBUG) << "Batch size " << batchSize << ": checksum " << checksum;
+
+  delete msg;
+  source->Close();
+  delete source;
+  sink->Close();
+  delete sink;
+
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  BenchmarkOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  // one factory, so that all sockets share the context that inproc needs.
+  FairMQTransportFactory* factory = new FairMQTransportFactoryZMQ();
+
+  vector<Result> results;
+  for (size_t i = 0; i < options.batchSizes.size(); ++i) {
+    results.push_back(run(options.batchSizes[i], options, factory));
+  }
+
+  cout << endl << options.eventSize << " byte events over " << options.transport << endl
+       << setw(8) << "batch" << setw(14) << "messages/s" << setw(14) << "events/s"
+       << setw(10) << "MB/s" << setw(12) << "ns/event" << endl;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    double seconds = r.seconds > 0. ? r.seconds : 1e-9;
+    cout << setw(8) << r.batchSize
+         << setw(14) << fixed << setprecision(0) << r.messages / seconds
+         << setw(14) << r.events / seconds
+         << setw(10) << setprecision(1) << r.bytes / seconds / 1e6
+         << setw(12) << setprecision(1) << (r.events > 0 ? seconds * 1e9 / r.events : 0.) << endl;
+  }
+
+  delete factory;
+
+  return 0;
+}
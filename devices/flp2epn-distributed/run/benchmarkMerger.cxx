@@ -0,0 +1,357 @@
+/**
+ * benchmarkMerger.cxx
+ *
+ * Feeds FrameBuilder and TimeframeMerger with N inputs over inproc sockets
+ * and reports the merged timeframes per second, the throughput and the
+ * number of output frames that combine parts of different timeframes. The
+ * inputs are driven by one thread each, so they run at slightly different
+ * speeds, as real ones do; --jitter widens the difference.
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <cstring>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "FrameBuilder.h"
+#include "TimeframeMerger.h"
+#include "TimeframeHeader.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef struct BenchmarkOptions
+{
+  string device;
+  vector<int> numInputs;
+  int numTimeframes;
+  int partSize;
+  int jitter;
+  int bufferSize;
+  int inputBufferSize;
+} BenchmarkOptions_t;
+
+struct Result
+{
+  int numInputs;
+  string device;
+  unsigned long frames;
+  unsigned long misaligned;
+  double seconds;
+  double bytes;
+};
+
+inline bool parse_cmd_line(int _argc, char* _argv[], BenchmarkOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("device", bpo::value<string>()->default_value("both"), "Device to benchmark: framebuilder/merger/both")
+    ("num-inputs", bpo::value< vector<int> >()->multitoken(), "Input counts to run, default 2 4 8 16 32")
+    ("num-timeframes", bpo::value<int>()->default_value(20000), "Timeframes sent on every input")
+    ("part-size", bpo::value<int>()->default_value(4096), "Payload bytes per input and timeframe")
+    ("jitter", bpo::value<int>()->default_value(0), "Maximum random pause in microseconds between two sends of an input")
+    ("buffer-size", bpo::value<int>()->default_value(64), "Merger: timeframes merged at the same time")
+    ("input-buffer-size", bpo::value<int>()->default_value(16), "Merger: parts waiting per input before it is held back")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "Merger benchmark" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  _options->device = vm["device"].as<string>();
+  if (vm.count("num-inputs")) {
+    _options->numInputs = vm["num-inputs"].as<vector<int>>();
+  } else {
+    _options->numInputs = { 2, 4, 8, 16, 32 };
+  }
+  _options->numTimeframes = vm["num-timeframes"].as<int>();
+  _options->partSize = max(vm["part-size"].as<int>(), static_cast<int>(sizeof(uint64_t)));
+  _options->jitter = vm["jitter"].as<int>();
+  _options->bufferSize = vm["buffer-size"].as<int>();
+  _options->inputBufferSize = vm["input-buffer-size"].as<int>();
+
+  return true;
+}
+
+/// one input: sends the timeframe ids in order, the payload starts with the id.
+static void sendInput(FairMQSocket* socket, FairMQTransportFactory* factory, int input, bool withHeader,
+                      const BenchmarkOptions& options, atomic<bool>* stop)
+{
+  int SNDMORE = socket->SNDMORE;
+  int NOBLOCK = socket->NOBLOCK;
+
+  mt19937 random(input);
+  uniform_int_distribution<int> pause(0, options.jitter);
+
+  for (int id = 0; id < options.numTimeframes && !stop->load(); ++id) {
+    FairMQMessage* dataPart = factory->CreateMessage(options.partSize);
+    uint64_t id64 = id;
+    memcpy(dataPart->GetData(), &id64, sizeof(uint64_t));
+
+    FairMQMessage* headerPart = NULL;
+    if (withHeader) {
+      headerPart = factory->CreateMessage(kSubTimeframeWireSize);
+      SubTimeframeHeader header;
+      InitSubTimeframeHeader(header, id, input, kDataTypeRaw, options.partSize);
+      WriteSubTimeframeHeader(headerPart->GetData(), header);
+    }
+
+    // non-blocking, so that the thread notices the end of a run that did not get all data through.
+    while (!stop->load()) {
+      if (headerPart) {
+        if (socket->Send(headerPart, SNDMORE | NOBLOCK) <= 0) {
+          this_thread::sleep_for(chrono::microseconds(10));
+          continue;
+        }
+        delete headerPart;
+        headerPart = NULL;
+      }
+      if (socket->Send(dataPart, NOBLOCK) > 0) {
+        break;
+      }
+      this_thread::sleep_for(chrono::microseconds(10));
+    }
+
+    delete headerPart;
+    delete dataPart;
+
+    if (options.jitter > 0) {
+      this_thread::sleep_for(chrono::microseconds(pause(random)));
+    }
+  }
+}
+
+static uint64_t payloadId(FairMQMessage* msg)
+{
+  uint64_t id = 0;
+  if (msg->GetSize() >= sizeof(uint64_t)) {
+    memcpy(&id, msg->GetData(), sizeof(uint64_t));
+  }
+  return id;
+}
+
+static Result run(const string& device, int numInputs, const BenchmarkOptions& options, FairMQTransportFactory* factory)
+{
+  static int runNumber = 0;
+  ++runNumber;
+
+  Result result;
+  result.numInputs = numInputs;
+  result.device = device;
+  result.frames = 0;
+  result.misaligned = 0;
+  result.bytes = 0.;
+
+  bool isMerger = device == "merger";
+
+  stringstream prefix;
+  prefix << "inproc://benchmark-merger-" << runNumber << "-";
+
+  FairMQSocket* sink = factory->CreateSocket("pull", 0, 1);
+  sink->Bind(prefix.str() + "out");
+
+  FairMQDevice* dut;
+  if (isMerger) {
+    TimeframeMerger* merger = new TimeframeMerger();
+    merger->SetProperty(TimeframeMerger::BufferSize, options.bufferSize);
+    merger->SetProperty(TimeframeMerger::InputBufferSize, options.inputBufferSize);
+    dut = merger;
+  } else {
+    dut = new FrameBuilder();
+  }
+
+  dut->SetTransport(factory);
+  dut->SetProperty(FairMQDevice::Id, device);
+  dut->SetProperty(FairMQDevice::NumIoThreads, 1);
+  dut->SetProperty(FairMQDevice::NumInputs, numInputs);
+  dut->SetProperty(FairMQDevice::NumOutputs, 1);
+  dut->ChangeState(FairMQDevice::INIT);
+
+  for (int i = 0; i < numInputs; ++i) {
+    stringstream address;
+    address << prefix.str() << "in-" << i;
+    dut->SetProperty(FairMQDevice::InputSocketType, "pull", i);
+    dut->SetProperty(FairMQDevice::InputRcvBufSize, 100, i);
+    dut->SetProperty(FairMQDevice::InputMethod, "bind", i);
+    dut->SetProperty(FairMQDevice::InputAddress, address.str(), i);
+    dut->SetProperty(FairMQDevice::LogInputRate, 0, i);
+  }
+  dut->SetProperty(FairMQDevice::OutputSocketType, "push");
+  dut->SetProperty(FairMQDevice::OutputSndBufSize, 100);
+  dut->SetProperty(FairMQDevice::OutputMethod, "connect");
+  dut->SetProperty(FairMQDevice::OutputAddress, prefix.str() + "out");
+  dut->SetProperty(FairMQDevice::LogOutputRate, 0);
+
+  dut->ChangeState(FairMQDevice::SETOUTPUT);
+  dut->ChangeState(FairMQDevice::SETINPUT);
+#ifdef FAIRMQ_INTERFACE_VERSION
+  dut->ChangeState(FairMQDevice::BIND);
+  dut->ChangeState(FairMQDevice::CONNECT);
+#endif
+  dut->ChangeState(FairMQDevice::RUN);
+
+  vector<FairMQSocket*> inputs;
+  for (int i = 0; i < numInputs; ++i) {
+    stringstream address;
+    address << prefix.str() << "in-" << i;
+    inputs.push_back(factory->CreateSocket("push", i, 1));
+    inputs.back()->Connect(address.str());
+  }
+
+  atomic<bool> stop(false);
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  vector<thread> senders;
+  for (int i = 0; i < numInputs; ++i) {
+    senders.push_back(thread(sendInput, inputs[i], factory, i, isMerger, cref(options), &stop));
+  }
+
+  // the sink knows the shape of a frame: numInputs parts from FrameBuilder,
+  // a directory and the parts it lists from the merger.
+  int NOBLOCK = sink->NOBLOCK;
+  FairMQMessage* msg = factory->CreateMessage();
+  chrono::steady_clock::time_point lastFrame = start;
+  int partsLeft = 0;
+  uint64_t frameId = 0;
+  bool aligned = true;
+
+  while (result.frames < static_cast<unsigned long>(options.numTimeframes)) {
+    if (sink->Receive(msg, NOBLOCK) <= 0) {
+      if (chrono::steady_clock::now() - lastFrame > chrono::seconds(2)) {
+        LOG(WARN) << device << " with " << numInputs << " inputs: no progress for 2 s, stopping at " << result.frames << " frames";
+        break;
+      }
+      this_thread::sleep_for(chrono::microseconds(10));
+      continue;
+    }
+
+    result.bytes += msg->GetSize();
+
+    if (partsLeft == 0) {
+      // first part of a frame
+      aligned = true;
+      if (isMerger) {
+        TimeframeDirectory directory(msg->GetData(), msg->GetSize());
+        frameId = directory.GetTimeframeId();
+        partsLeft = directory.IsValid() ? directory.GetNumParts() : 0;
+        if (partsLeft == 0) {
+          ++result.misaligned;
+          ++result.frames;
+        }
+        msg->Rebuild();
+        continue;
+      }
+      frameId = payloadId(msg);
+      partsLeft = numInputs;
+    }
+
+    if (payloadId(msg) != frameId) {
+      aligned = false;
+    }
+    msg->Rebuild();
+
+    if (--partsLeft == 0) {
+      ++result.frames;
+      if (!aligned) {
+        ++result.misaligned;
+      }
+      lastFrame = chrono::steady_clock::now();
+    }
+  }
+
+  result.seconds = chrono::duration<double>(lastFrame - start).count();
+
+  stop = true;
+  for (size_t i = 0; i < senders.size(); ++i) {
+    senders[i].join();
+  }
+
+  dut->ChangeState(FairMQDevice::STOP);
+  dut->ChangeState(FairMQDevice::END);
+  delete dut;
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    inputs[i]->Close();
+    delete inputs[i];
+  }
+  delete msg;
+  sink->Close();
+  delete sink;
+
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  BenchmarkOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  vector<string> devices;
+  if (options.device == "both" || options.device == "framebuilder") {
+    devices.push_back("framebuilder");
+  }
+  if (options.device == "both" || options.device == "merger") {
+    devices.push_back("merger");
+  }
+  if (devices.empty()) {
+    LOG(ERROR) << "Unknown device " << options.device;
+    return 1;
+  }
+
+  // one factory, so that all sockets share the context that inproc needs.
+  FairMQTransportFactory* factory = new FairMQTransportFactoryZMQ();
+
+  vector<Result> results;
+  for (size_t n = 0; n < options.numInputs.size(); ++n) {
+    for (size_t d = 0; d < devices.size(); ++d) {
+      results.push_back(run(devices[d], options.numInputs[n], options, factory));
+    }
+  }
+
+  cout << endl
+       << setw(8) << "inputs" << setw(14) << "device"
+       << setw(12) << "frames" << setw(12) << "misaligned"
+       << setw(14) << "frames/s" << setw(10) << "GB/s" << endl;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    double seconds = r.seconds > 0. ? r.seconds : 1e-9;
+    cout << setw(8) << r.numInputs << setw(14) << r.device
+         << setw(12) << r.frames << setw(12) << r.misaligned
+         << setw(14) << fixed << setprecision(0) << r.frames / seconds
+         << setw(10) << setprecision(2) << r.bytes / seconds / 1e9 << endl;
+  }
+
+  delete factory;
+
+  return 0;
+}
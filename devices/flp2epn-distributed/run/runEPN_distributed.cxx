@@ -12,14 +12,18 @@
 
 #include "FairMQLogger.h"
 #include "FairMQTransportFactoryZMQ.h"
+#include "ShmTransportFactory.h"
 
 #include "EPNex.h"
+#include "Placement.h"
+#include "MetricsExporter.h"
 
 using namespace std;
 
 using namespace AliceO2::Devices;
 
 EPNex epn;
+AliceO2::Metrics::Exporter metricsExporter;
 
 static void s_signal_handler (int signal)
 {
@@ -46,11 +50,34 @@ typedef struct DeviceOptions
 {
   string id;
   int ioThreads;
+  string transport;
+  string shmSegment;
+  int shmSizeInMB;
+  int shmAllLocal;
+  string metricsTarget;
+  string metricsFormat;
+  int metricsInterval;
+  string cpusMain;
+  string cpusIo;
+  string cpusHelper;
+  string numaNode;
   int numOutputs;
   int heartbeatIntervalInMs;
   int bufferTimeoutInMs;
   int numFLPs;
   int testMode;
+  int windowSize;
+  int numWorkers;
+  int creditTimeframes;
+  int creditBufferInMB;
+  int maxSpinInUs;
+  int membershipTimeoutInMs;
+  int verifyChecksums;
+  string releasePolicy;
+  int releaseDeadlineInMs;
+  int occupancyInterval;
+  int epnIndex;
+  vector<string> heartbeatAddress;
   string inputSocketType;
   int inputBufSize;
   string inputMethod;
@@ -73,11 +100,34 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
   desc.add_options()
     ("id", bpo::value<string>()->required(), "Device ID")
     ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+    ("transport", bpo::value<string>()->default_value("zeromq"), "Transport: zeromq/shmem (payloads in shared memory between the devices of a node)")
+    ("shm-segment", bpo::value<string>()->default_value("o2payload"), "Name of the shared memory segment (shmem)")
+    ("shm-size", bpo::value<int>()->default_value(1024), "Size of the shared memory segment in MB (shmem)")
+    ("shm-all-local", bpo::value<int>()->default_value(0), "Treat all peers as on this node, 1/0 (shmem)")
+    ("metrics-target", bpo::value<string>()->default_value(""), "Export metrics to a file, or serve them on tcp://*:port, empty to disable")
+    ("metrics-format", bpo::value<string>()->default_value("prometheus"), "Format of the metrics snapshots: prometheus/json")
+    ("metrics-interval", bpo::value<int>()->default_value(1000), "Interval in ms between the metrics snapshots written to a file")
+    ("cpus-main", bpo::value<string>()->default_value(""), "CPUs of the device and its processing threads, e.g. \"0-7,16\", \"node\" for those of --numa-node")
+    ("cpus-io", bpo::value<string>()->default_value(""), "CPUs of the I/O threads of the transport")
+    ("cpus-helper", bpo::value<string>()->default_value(""), "CPUs of the helper threads (rate logger, ack listener, metrics)")
+    ("numa-node", bpo::value<string>()->default_value(""), "NUMA node for the payload memory, or the network interface whose node to use, e.g. ib0")
     ("num-outputs", bpo::value<int>()->required(), "Number of EPN output sockets")
     ("heartbeat-interval", bpo::value<int>()->default_value(5000), "Heartbeat interval in milliseconds")
     ("buffer-timeout", bpo::value<int>()->default_value(1000), "Buffer timeout in milliseconds")
     ("num-flps", bpo::value<int>()->required(), "Number of FLPs")
     ("test-mode", bpo::value<int>()->default_value(0), "Run in test mode")
+    ("window-size", bpo::value<int>()->default_value(509), "Number of timeframes that can be assembled at the same time (preferably prime)")
+    ("num-workers", bpo::value<int>()->default_value(0), "Number of assembly threads, 0 assembles on the receiving thread")
+    ("credit-timeframes", bpo::value<int>()->default_value(0), "Timeframes the FLPs may have in flight to this EPN, 0 for the capacity of the assembly window(s)")
+    ("credit-buffer", bpo::value<int>()->default_value(0), "Payload in MB all FLPs together may have in flight to this EPN, 0 for no limit")
+    ("max-spin", bpo::value<int>()->default_value(50), "Longest time the main loop polls without blocking after it had work, in us, 0 always blocks")
+    ("membership-timeout", bpo::value<int>()->default_value(3000), "Time in milliseconds after which a silent FLP is no longer waited for, 0 to always wait for all FLPs")
+    ("verify-checksums", bpo::value<int>()->default_value(1), "Verify the payloads that carry a checksum (1) or not (0)")
+    ("release-policy", bpo::value<string>()->default_value("complete"), "When to forward a timeframe: complete, or early with the parts it has at the release deadline")
+    ("release-deadline", bpo::value<int>()->default_value(100), "Early release: time in milliseconds from the first part of a timeframe to forwarding it")
+    ("occupancy-interval", bpo::value<int>()->default_value(32), "Timeframes per occupancy report for the free-buffer selection, more than are in flight to the EPN")
+    ("epn-index", bpo::value<int>()->default_value(0), "Position of this EPN in the output list of the FLPs")
+    ("heartbeat-address", bpo::value< vector<string> >(), "Heartbeat input address of an FLP, once per FLP; the heartbeat output connects to all of them")
     ("input-socket-type", bpo::value<string>()->required(), "Input socket type: sub/pull")
     ("input-buff-size", bpo::value<int>()->required(), "Input buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
     ("input-method", bpo::value<string>()->required(), "Input method: bind/connect")
@@ -108,6 +158,50 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     _options->ioThreads = vm["io-threads"].as<int>();
   }
 
+  if (vm.count("transport")) {
+    _options->transport = vm["transport"].as<string>();
+  }
+
+  if (vm.count("shm-segment")) {
+    _options->shmSegment = vm["shm-segment"].as<string>();
+  }
+
+  if (vm.count("shm-size")) {
+    _options->shmSizeInMB = vm["shm-size"].as<int>();
+  }
+
+  if (vm.count("shm-all-local")) {
+    _options->shmAllLocal = vm["shm-all-local"].as<int>();
+  }
+
+  if (vm.count("metrics-target")) {
+    _options->metricsTarget = vm["metrics-target"].as<string>();
+  }
+
+  if (vm.count("metrics-format")) {
+    _options->metricsFormat = vm["metrics-format"].as<string>();
+  }
+
+  if (vm.count("metrics-interval")) {
+    _options->metricsInterval = vm["metrics-interval"].as<int>();
+  }
+
+  if (vm.count("cpus-main")) {
+    _options->cpusMain = vm["cpus-main"].as<string>();
+  }
+
+  if (vm.count("cpus-io")) {
+    _options->cpusIo = vm["cpus-io"].as<string>();
+  }
+
+  if (vm.count("cpus-helper")) {
+    _options->cpusHelper = vm["cpus-helper"].as<string>();
+  }
+
+  if (vm.count("numa-node")) {
+    _options->numaNode = vm["numa-node"].as<string>();
+  }
+
   if (vm.count("num-outputs")) {
     _options->numOutputs = vm["num-outputs"].as<int>();
   }
@@ -128,6 +222,54 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     _options->testMode = vm["test-mode"].as<int>();
   }
 
+  if (vm.count("window-size")) {
+    _options->windowSize = vm["window-size"].as<int>();
+  }
+
+  if (vm.count("num-workers")) {
+    _options->numWorkers = vm["num-workers"].as<int>();
+  }
+
+  if (vm.count("credit-timeframes")) {
+    _options->creditTimeframes = vm["credit-timeframes"].as<int>();
+  }
+
+  if (vm.count("credit-buffer")) {
+    _options->creditBufferInMB = vm["credit-buffer"].as<int>();
+  }
+
+  if (vm.count("max-spin")) {
+    _options->maxSpinInUs = vm["max-spin"].as<int>();
+  }
+
+  if (vm.count("membership-timeout")) {
+    _options->membershipTimeoutInMs = vm["membership-timeout"].as<int>();
+  }
+
+  if (vm.count("verify-checksums")) {
+    _options->verifyChecksums = vm["verify-checksums"].as<int>();
+  }
+
+  if (vm.count("release-policy")) {
+    _options->releasePolicy = vm["release-policy"].as<string>();
+  }
+
+  if (vm.count("release-deadline")) {
+    _options->releaseDeadlineInMs = vm["release-deadline"].as<int>();
+  }
+
+  if (vm.count("occupancy-interval")) {
+    _options->occupancyInterval = vm["occupancy-interval"].as<int>();
+  }
+
+  if (vm.count("epn-index")) {
+    _options->epnIndex = vm["epn-index"].as<int>();
+  }
+
+  if (vm.count("heartbeat-address")) {
+    _options->heartbeatAddress = vm["heartbeat-address"].as<vector<string>>();
+  }
+
   if (vm.count("input-socket-type")) {
     _options->inputSocketType = vm["input-socket-type"].as<string>();
   }
@@ -186,7 +328,31 @@ int main(int argc, char** argv)
 
   LOG(INFO) << "PID: " << getpid();
 
-  FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+  AliceO2::Devices::Placement& placement = AliceO2::Devices::Placement::Default();
+  if (!placement.Configure(options.cpusMain, options.cpusIo, options.cpusHelper, options.numaNode)) {
+    return 1;
+  }
+
+  AliceO2::Metrics::Exporter::Format metricsFormat;
+  if (!AliceO2::Metrics::Exporter::ParseFormat(options.metricsFormat, metricsFormat)) {
+    LOG(ERROR) << "Unknown metrics format " << options.metricsFormat;
+    return 1;
+  }
+  placement.EnterHelperScope();
+  metricsExporter.Start(options.metricsTarget, metricsFormat, options.metricsInterval);
+  placement.EnterMainScope();
+
+  FairMQTransportFactory* transportFactory;
+  if (options.transport == "shmem") {
+    // payloads in shared memory, handles and everything for other nodes over zeromq
+    transportFactory = new AliceO2::Shmem::TransportFactory(new FairMQTransportFactoryZMQ(), options.shmSegment,
+                                                            static_cast<size_t>(options.shmSizeInMB) << 20, options.shmAllLocal);
+  } else if (options.transport == "zeromq") {
+    transportFactory = new FairMQTransportFactoryZMQ();
+  } else {
+    LOG(ERROR) << "Unknown transport " << options.transport;
+    return 1;
+  }
 
   epn.SetTransport(transportFactory);
 
@@ -199,6 +365,20 @@ int main(int argc, char** argv)
   epn.SetProperty(EPNex::BufferTimeoutInMs, options.bufferTimeoutInMs);
   epn.SetProperty(EPNex::NumFLPs, options.numFLPs);
   epn.SetProperty(EPNex::TestMode, options.testMode);
+  epn.SetProperty(EPNex::WindowSize, options.windowSize);
+  epn.SetProperty(EPNex::NumWorkers, options.numWorkers);
+  epn.SetProperty(EPNex::CreditTimeframes, options.creditTimeframes);
+  epn.SetProperty(EPNex::CreditBufferInMB, options.creditBufferInMB);
+  epn.SetProperty(EPNex::MaxSpinInUs, options.maxSpinInUs);
+  epn.SetProperty(EPNex::MembershipTimeoutInMs, options.membershipTimeoutInMs);
+  epn.SetProperty(EPNex::VerifyChecksums, options.verifyChecksums);
+  epn.SetProperty(EPNex::ReleasePolicy, options.releasePolicy);
+  epn.SetProperty(EPNex::ReleaseDeadlineInMs, options.releaseDeadlineInMs);
+  epn.SetProperty(EPNex::OccupancyInterval, options.occupancyInterval);
+  epn.SetProperty(EPNex::EPNIndex, options.epnIndex);
+  for (size_t i = 0; i < options.heartbeatAddress.size(); ++i) {
+    epn.SetProperty(EPNex::HeartbeatAddress, options.heartbeatAddress.at(i), i);
+  }
 
   epn.ChangeState(EPNex::INIT);
 
@@ -217,6 +397,8 @@ int main(int argc, char** argv)
   }
 
   try {
+    // the transport starts its I/O threads with the first socket, they inherit the CPUs of this thread.
+    placement.EnterIoScope();
     epn.ChangeState(EPNex::SETOUTPUT);
     epn.ChangeState(EPNex::SETINPUT);
 // temporary check to allow compilation with older fairmq version
@@ -224,7 +406,9 @@ int main(int argc, char** argv)
     epn.ChangeState(EPNex::BIND);
     epn.ChangeState(EPNex::CONNECT);
 #endif
+    placement.EnterMainScope();
     epn.ChangeState(EPNex::RUN);
+    placement.Report();
   } catch (const exception& e) {
       LOG(ERROR) << e.what();
   }
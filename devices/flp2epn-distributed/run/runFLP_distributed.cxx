@@ -12,14 +12,18 @@
 
 #include "FairMQLogger.h"
 #include "FairMQTransportFactoryZMQ.h"
+#include "ShmTransportFactory.h"
 
 #include "FLPex.h"
+#include "Placement.h"
+#include "MetricsExporter.h"
 
 using namespace std;
 
 using namespace AliceO2::Devices;
 
 FLPex flp;
+AliceO2::Metrics::Exporter metricsExporter;
 
 static void s_signal_handler (int signal)
 {
@@ -47,11 +51,35 @@ typedef struct DeviceOptions
   string id;
   int eventSize;
   int ioThreads;
+  string transport;
+  string shmSegment;
+  int shmSizeInMB;
+  int shmAllLocal;
+  string metricsTarget;
+  string metricsFormat;
+  int metricsInterval;
+  string cpusMain;
+  string cpusIo;
+  string cpusHelper;
+  string numaNode;
   int numInputs;
   int numOutputs;
   int heartbeatTimeoutInMs;
   int testMode;
   int sendOffset;
+  string epnSelection;
+  string epnWeights;
+  int outputRate;
+  int outputBurst;
+  int numSlots;
+  int slotLength;
+  int flowControl;
+  int queueCapacity;
+  int maxSpinInUs;
+  int batchEvents;
+  int keepaliveIntervalInMs;
+  int checksum;
+  string dropPolicy;
   vector<string> inputSocketType;
   vector<int> inputBufSize;
   vector<string> inputMethod;
@@ -75,11 +103,35 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     ("id", bpo::value<string>()->required(), "Device ID")
     ("event-size", bpo::value<int>()->default_value(1000), "Event size in bytes")
     ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+    ("transport", bpo::value<string>()->default_value("zeromq"), "Transport: zeromq/shmem (payloads in shared memory between the devices of a node)")
+    ("shm-segment", bpo::value<string>()->default_value("o2payload"), "Name of the shared memory segment (shmem)")
+    ("shm-size", bpo::value<int>()->default_value(1024), "Size of the shared memory segment in MB (shmem)")
+    ("shm-all-local", bpo::value<int>()->default_value(0), "Treat all peers as on this node, 1/0 (shmem)")
+    ("metrics-target", bpo::value<string>()->default_value(""), "Export metrics to a file, or serve them on tcp://*:port, empty to disable")
+    ("metrics-format", bpo::value<string>()->default_value("prometheus"), "Format of the metrics snapshots: prometheus/json")
+    ("metrics-interval", bpo::value<int>()->default_value(1000), "Interval in ms between the metrics snapshots written to a file")
+    ("cpus-main", bpo::value<string>()->default_value(""), "CPUs of the device and its processing threads, e.g. \"0-7,16\", \"node\" for those of --numa-node")
+    ("cpus-io", bpo::value<string>()->default_value(""), "CPUs of the I/O threads of the transport")
+    ("cpus-helper", bpo::value<string>()->default_value(""), "CPUs of the helper threads (rate logger, ack listener, metrics)")
+    ("numa-node", bpo::value<string>()->default_value(""), "NUMA node for the payload memory, or the network interface whose node to use, e.g. ib0")
     ("num-inputs", bpo::value<int>()->required(), "Number of FLP input sockets")
     ("num-outputs", bpo::value<int>()->required(), "Number of FLP output sockets")
     ("heartbeat-timeout", bpo::value<int>()->default_value(20000), "Heartbeat timeout in milliseconds")
     ("test-mode", bpo::value<int>()->default_value(0), "Run in test mode")
-    ("send-offset", bpo::value<int>()->default_value(0), "Offset for staggered sending")
+    ("send-offset", bpo::value<int>()->default_value(0), "Slot of this FLP in time-slotted sending (see --num-slots)")
+    ("epn-selection", bpo::value<string>()->default_value("round-robin"), "EPN selection policy: round-robin/weighted-hash/free-buffer")
+    ("epn-weights", bpo::value<string>()->default_value(""), "Comma-separated relative EPN capacities for weighted-hash/free-buffer")
+    ("output-rate", bpo::value<int>()->default_value(0), "Rate limit per EPN in MB/s, 0 for unlimited")
+    ("output-burst", bpo::value<int>()->default_value(0), "Burst size of the rate limit in bytes")
+    ("num-slots", bpo::value<int>()->default_value(0), "Number of send slots per cycle, the FLP sends in slot <send-offset>; 0 to disable")
+    ("slot-length", bpo::value<int>()->default_value(1000), "Length of a send slot in microseconds")
+    ("flow-control", bpo::value<int>()->default_value(0), "Send only against the buffer credit granted by the EPNs, 1/0")
+    ("queue-capacity", bpo::value<int>()->default_value(256), "Sub-timeframes queued per EPN before dropping, 0 for unbounded")
+    ("max-spin", bpo::value<int>()->default_value(50), "Longest time the main loop polls without blocking after it had work, in us, 0 always blocks")
+    ("batch-events", bpo::value<int>()->default_value(1), "Events packed into one sub-timeframe, the same on all FLPs; sub-timeframe #n holds the events #n*N to #n*N+N-1, 1 sends each on its own")
+    ("keepalive-interval", bpo::value<int>()->default_value(1000), "Interval of the keepalive notices to the EPNs in milliseconds, 0 to disable")
+    ("checksum", bpo::value<int>()->default_value(0), "Put the CRC32C of every payload into its header (1) or not (0)")
+    ("drop-policy", bpo::value<string>()->default_value("timeframe"), "What to drop from a full queue: oldest/newest/timeframe (newest, and the EPN discards the whole timeframe)")
     ("input-socket-type", bpo::value< vector<string> >()->required(), "Input socket type: sub/pull")
     ("input-buff-size", bpo::value< vector<int> >()->required(), "Input buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
     ("input-method", bpo::value< vector<string> >()->required(), "Input method: bind/connect")
@@ -114,6 +166,50 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     _options->ioThreads = vm["io-threads"].as<int>();
   }
 
+  if (vm.count("transport")) {
+    _options->transport = vm["transport"].as<string>();
+  }
+
+  if (vm.count("shm-segment")) {
+    _options->shmSegment = vm["shm-segment"].as<string>();
+  }
+
+  if (vm.count("shm-size")) {
+    _options->shmSizeInMB = vm["shm-size"].as<int>();
+  }
+
+  if (vm.count("shm-all-local")) {
+    _options->shmAllLocal = vm["shm-all-local"].as<int>();
+  }
+
+  if (vm.count("metrics-target")) {
+    _options->metricsTarget = vm["metrics-target"].as<string>();
+  }
+
+  if (vm.count("metrics-format")) {
+    _options->metricsFormat = vm["metrics-format"].as<string>();
+  }
+
+  if (vm.count("metrics-interval")) {
+    _options->metricsInterval = vm["metrics-interval"].as<int>();
+  }
+
+  if (vm.count("cpus-main")) {
+    _options->cpusMain = vm["cpus-main"].as<string>();
+  }
+
+  if (vm.count("cpus-io")) {
+    _options->cpusIo = vm["cpus-io"].as<string>();
+  }
+
+  if (vm.count("cpus-helper")) {
+    _options->cpusHelper = vm["cpus-helper"].as<string>();
+  }
+
+  if (vm.count("numa-node")) {
+    _options->numaNode = vm["numa-node"].as<string>();
+  }
+
   if (vm.count("num-inputs")) {
     _options->numInputs = vm["num-inputs"].as<int>();
   }
@@ -134,6 +230,58 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     _options->sendOffset = vm["send-offset"].as<int>();
   }
 
+  if (vm.count("epn-selection")) {
+    _options->epnSelection = vm["epn-selection"].as<string>();
+  }
+
+  if (vm.count("epn-weights")) {
+    _options->epnWeights = vm["epn-weights"].as<string>();
+  }
+
+  if (vm.count("output-rate")) {
+    _options->outputRate = vm["output-rate"].as<int>();
+  }
+
+  if (vm.count("output-burst")) {
+    _options->outputBurst = vm["output-burst"].as<int>();
+  }
+
+  if (vm.count("num-slots")) {
+    _options->numSlots = vm["num-slots"].as<int>();
+  }
+
+  if (vm.count("slot-length")) {
+    _options->slotLength = vm["slot-length"].as<int>();
+  }
+
+  if (vm.count("flow-control")) {
+    _options->flowControl = vm["flow-control"].as<int>();
+  }
+
+  if (vm.count("queue-capacity")) {
+    _options->queueCapacity = vm["queue-capacity"].as<int>();
+  }
+
+  if (vm.count("max-spin")) {
+    _options->maxSpinInUs = vm["max-spin"].as<int>();
+  }
+
+  if (vm.count("batch-events")) {
+    _options->batchEvents = vm["batch-events"].as<int>();
+  }
+
+  if (vm.count("keepalive-interval")) {
+    _options->keepaliveIntervalInMs = vm["keepalive-interval"].as<int>();
+  }
+
+  if (vm.count("checksum")) {
+    _options->checksum = vm["checksum"].as<int>();
+  }
+
+  if (vm.count("drop-policy")) {
+    _options->dropPolicy = vm["drop-policy"].as<string>();
+  }
+
   if (vm.count("input-socket-type")) {
     _options->inputSocketType = vm["input-socket-type"].as<vector<string>>();
   }
@@ -192,7 +340,31 @@ int main(int argc, char** argv)
 
   LOG(INFO) << "PID: " << getpid();
 
-  FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+  AliceO2::Devices::Placement& placement = AliceO2::Devices::Placement::Default();
+  if (!placement.Configure(options.cpusMain, options.cpusIo, options.cpusHelper, options.numaNode)) {
+    return 1;
+  }
+
+  AliceO2::Metrics::Exporter::Format metricsFormat;
+  if (!AliceO2::Metrics::Exporter::ParseFormat(options.metricsFormat, metricsFormat)) {
+    LOG(ERROR) << "Unknown metrics format " << options.metricsFormat;
+    return 1;
+  }
+  placement.EnterHelperScope();
+  metricsExporter.Start(options.metricsTarget, metricsFormat, options.metricsInterval);
+  placement.EnterMainScope();
+
+  FairMQTransportFactory* transportFactory;
+  if (options.transport == "shmem") {
+    // payloads in shared memory, handles and everything for other nodes over zeromq
+    transportFactory = new AliceO2::Shmem::TransportFactory(new FairMQTransportFactoryZMQ(), options.shmSegment,
+                                                            static_cast<size_t>(options.shmSizeInMB) << 20, options.shmAllLocal);
+  } else if (options.transport == "zeromq") {
+    transportFactory = new FairMQTransportFactoryZMQ();
+  } else {
+    LOG(ERROR) << "Unknown transport " << options.transport;
+    return 1;
+  }
 
   flp.SetTransport(transportFactory);
 
@@ -205,6 +377,19 @@ int main(int argc, char** argv)
   flp.SetProperty(FLPex::HeartbeatTimeoutInMs, options.heartbeatTimeoutInMs);
   flp.SetProperty(FLPex::TestMode, options.testMode);
   flp.SetProperty(FLPex::SendOffset, options.sendOffset);
+  flp.SetProperty(FLPex::EPNSelection, options.epnSelection);
+  flp.SetProperty(FLPex::EPNWeights, options.epnWeights);
+  flp.SetProperty(FLPex::OutputRate, options.outputRate);
+  flp.SetProperty(FLPex::OutputBurst, options.outputBurst);
+  flp.SetProperty(FLPex::NumSlots, options.numSlots);
+  flp.SetProperty(FLPex::SlotLength, options.slotLength);
+  flp.SetProperty(FLPex::FlowControl, options.flowControl);
+  flp.SetProperty(FLPex::QueueCapacity, options.queueCapacity);
+  flp.SetProperty(FLPex::MaxSpinInUs, options.maxSpinInUs);
+  flp.SetProperty(FLPex::BatchEvents, options.batchEvents);
+  flp.SetProperty(FLPex::KeepaliveIntervalInMs, options.keepaliveIntervalInMs);
+  flp.SetProperty(FLPex::Checksum, options.checksum);
+  flp.SetProperty(FLPex::QueueDropPolicy, options.dropPolicy);
 
   flp.ChangeState(FLPex::INIT);
 
@@ -225,6 +410,8 @@ int main(int argc, char** argv)
   }
 
   try {
+    // the transport starts its I/O threads with the first socket, they inherit the CPUs of this thread.
+    placement.EnterIoScope();
     flp.ChangeState(FLPex::SETOUTPUT);
     flp.ChangeState(FLPex::SETINPUT);
 // temporary check to allow compilation with older fairmq version
@@ -232,7 +419,9 @@ int main(int argc, char** argv)
     flp.ChangeState(FLPex::BIND);
     flp.ChangeState(FLPex::CONNECT);
 #endif
+    placement.EnterMainScope();
     flp.ChangeState(FLPex::RUN);
+    placement.Report();
   } catch (const exception& e) {
       LOG(ERROR) << e.what();
   }
@@ -0,0 +1,311 @@
+/**
+ * runTimeframeMerger.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <csignal>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "TimeframeMerger.h"
+#include "Placement.h"
+#include "MetricsExporter.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+TimeframeMerger merger;
+AliceO2::Metrics::Exporter metricsExporter;
+
+static void s_signal_handler (int signal)
+{
+  cout << endl << "Caught signal " << signal << endl;
+
+  merger.ChangeState(TimeframeMerger::STOP);
+  merger.ChangeState(TimeframeMerger::END);
+
+  cout << "Shutdown complete. Bye!" << endl;
+  exit(1);
+}
+
+static void s_catch_signals (void)
+{
+  struct sigaction action;
+  action.sa_handler = s_signal_handler;
+  action.sa_flags = 0;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+}
+
+typedef struct DeviceOptions
+{
+  string id;
+  int ioThreads;
+  string metricsTarget;
+  string metricsFormat;
+  int metricsInterval;
+  string cpusMain;
+  string cpusIo;
+  string cpusHelper;
+  string numaNode;
+  int numInputs;
+  int bufferSize;
+  int inputBufferSize;
+  int maxSpinInUs;
+  int bufferTimeoutInMs;
+  string timeoutPolicy;
+  vector<string> inputSocketType;
+  vector<int> inputBufSize;
+  vector<string> inputMethod;
+  vector<string> inputAddress;
+  vector<int> logInputRate;
+  string outputSocketType;
+  int outputBufSize;
+  string outputMethod;
+  string outputAddress;
+  int logOutputRate;
+} DeviceOptions_t;
+
+inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("id", bpo::value<string>()->required(), "Device ID")
+    ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+    ("metrics-target", bpo::value<string>()->default_value(""), "Export metrics to a file, or serve them on tcp://*:port, empty to disable")
+    ("metrics-format", bpo::value<string>()->default_value("prometheus"), "Format of the metrics snapshots: prometheus/json")
+    ("metrics-interval", bpo::value<int>()->default_value(1000), "Interval in ms between the metrics snapshots written to a file")
+    ("cpus-main", bpo::value<string>()->default_value(""), "CPUs of the device and its processing threads, e.g. \"0-7,16\", \"node\" for those of --numa-node")
+    ("cpus-io", bpo::value<string>()->default_value(""), "CPUs of the I/O threads of the transport")
+    ("cpus-helper", bpo::value<string>()->default_value(""), "CPUs of the helper threads (rate logger, ack listener, metrics)")
+    ("numa-node", bpo::value<string>()->default_value(""), "NUMA node for the payload memory, or the network interface whose node to use, e.g. ib0")
+    ("num-inputs", bpo::value<int>()->required(), "Number of inputs to merge")
+    ("buffer-size", bpo::value<int>()->default_value(64), "Number of timeframes that can be merged at the same time")
+    ("input-buffer-size", bpo::value<int>()->default_value(16), "Parts waiting per input before the input is no longer read")
+    ("max-spin", bpo::value<int>()->default_value(50), "Longest time the main loop polls without blocking after it had work, in us, 0 always blocks")
+    ("buffer-timeout", bpo::value<int>()->default_value(1000), "Time in milliseconds after which an incomplete timeframe is given up")
+    ("timeout-policy", bpo::value<string>()->default_value("discard"), "What happens to an incomplete timeframe: discard/partial")
+    ("input-socket-type", bpo::value< vector<string> >()->required(), "Input socket type: sub/pull")
+    ("input-buff-size", bpo::value< vector<int> >()->required(), "Input buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
+    ("input-method", bpo::value< vector<string> >()->required(), "Input method: bind/connect")
+    ("input-address", bpo::value< vector<string> >()->required(), "Input address, e.g.: \"tcp://localhost:5555\"")
+    ("log-input-rate", bpo::value< vector<int> >()->required(), "Log input rate on socket, 1/0")
+    ("output-socket-type", bpo::value<string>()->required(), "Output socket type: pub/push")
+    ("output-buff-size", bpo::value<int>()->required(), "Output buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
+    ("output-method", bpo::value<string>()->required(), "Output method: bind/connect")
+    ("output-address", bpo::value<string>()->required(), "Output address, e.g.: \"tcp://localhost:5555\"")
+    ("log-output-rate", bpo::value<int>()->default_value(1), "Log output rate on socket, 1/0")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "Timeframe merger" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  if (vm.count("id")) {
+    _options->id = vm["id"].as<string>();
+  }
+
+  if (vm.count("io-threads")) {
+    _options->ioThreads = vm["io-threads"].as<int>();
+  }
+
+  if (vm.count("metrics-target")) {
+    _options->metricsTarget = vm["metrics-target"].as<string>();
+  }
+
+  if (vm.count("metrics-format")) {
+    _options->metricsFormat = vm["metrics-format"].as<string>();
+  }
+
+  if (vm.count("metrics-interval")) {
+    _options->metricsInterval = vm["metrics-interval"].as<int>();
+  }
+
+  if (vm.count("cpus-main")) {
+    _options->cpusMain = vm["cpus-main"].as<string>();
+  }
+
+  if (vm.count("cpus-io")) {
+    _options->cpusIo = vm["cpus-io"].as<string>();
+  }
+
+  if (vm.count("cpus-helper")) {
+    _options->cpusHelper = vm["cpus-helper"].as<string>();
+  }
+
+  if (vm.count("numa-node")) {
+    _options->numaNode = vm["numa-node"].as<string>();
+  }
+
+  if (vm.count("num-inputs")) {
+    _options->numInputs = vm["num-inputs"].as<int>();
+  }
+
+  if (vm.count("buffer-size")) {
+    _options->bufferSize = vm["buffer-size"].as<int>();
+  }
+
+  if (vm.count("input-buffer-size")) {
+    _options->inputBufferSize = vm["input-buffer-size"].as<int>();
+  }
+
+  if (vm.count("max-spin")) {
+    _options->maxSpinInUs = vm["max-spin"].as<int>();
+  }
+
+  if (vm.count("buffer-timeout")) {
+    _options->bufferTimeoutInMs = vm["buffer-timeout"].as<int>();
+  }
+
+  if (vm.count("timeout-policy")) {
+    _options->timeoutPolicy = vm["timeout-policy"].as<string>();
+  }
+
+  if (vm.count("input-socket-type")) {
+    _options->inputSocketType = vm["input-socket-type"].as<vector<string>>();
+  }
+
+  if (vm.count("input-buff-size")) {
+    _options->inputBufSize = vm["input-buff-size"].as<vector<int>>();
+  }
+
+  if (vm.count("input-method")) {
+    _options->inputMethod = vm["input-method"].as<vector<string>>();
+  }
+
+  if (vm.count("input-address")) {
+    _options->inputAddress = vm["input-address"].as<vector<string>>();
+  }
+
+  if (vm.count("log-input-rate")) {
+    _options->logInputRate = vm["log-input-rate"].as<vector<int>>();
+  }
+
+  if (vm.count("output-socket-type")) {
+    _options->outputSocketType = vm["output-socket-type"].as<string>();
+  }
+
+  if (vm.count("output-buff-size")) {
+    _options->outputBufSize = vm["output-buff-size"].as<int>();
+  }
+
+  if (vm.count("output-method")) {
+    _options->outputMethod = vm["output-method"].as<string>();
+  }
+
+  if (vm.count("output-address")) {
+    _options->outputAddress = vm["output-address"].as<string>();
+  }
+
+  if (vm.count("log-output-rate")) {
+    _options->logOutputRate = vm["log-output-rate"].as<int>();
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  s_catch_signals();
+
+  DeviceOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  LOG(INFO) << "PID: " << getpid();
+
+  AliceO2::Devices::Placement& placement = AliceO2::Devices::Placement::Default();
+  if (!placement.Configure(options.cpusMain, options.cpusIo, options.cpusHelper, options.numaNode)) {
+    return 1;
+  }
+
+  AliceO2::Metrics::Exporter::Format metricsFormat;
+  if (!AliceO2::Metrics::Exporter::ParseFormat(options.metricsFormat, metricsFormat)) {
+    LOG(ERROR) << "Unknown metrics format " << options.metricsFormat;
+    return 1;
+  }
+  placement.EnterHelperScope();
+  metricsExporter.Start(options.metricsTarget, metricsFormat, options.metricsInterval);
+  placement.EnterMainScope();
+
+  FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+
+  merger.SetTransport(transportFactory);
+
+  merger.SetProperty(TimeframeMerger::Id, options.id);
+  merger.SetProperty(TimeframeMerger::NumIoThreads, options.ioThreads);
+
+  merger.SetProperty(TimeframeMerger::NumInputs, options.numInputs);
+  merger.SetProperty(TimeframeMerger::NumOutputs, 1);
+  merger.SetProperty(TimeframeMerger::BufferSize, options.bufferSize);
+  merger.SetProperty(TimeframeMerger::InputBufferSize, options.inputBufferSize);
+  merger.SetProperty(TimeframeMerger::MaxSpinInUs, options.maxSpinInUs);
+  merger.SetProperty(TimeframeMerger::BufferTimeoutInMs, options.bufferTimeoutInMs);
+  merger.SetProperty(TimeframeMerger::TimeoutPolicy, options.timeoutPolicy);
+
+  merger.ChangeState(TimeframeMerger::INIT);
+
+  for (int i = 0; i < options.numInputs; ++i) {
+    merger.SetProperty(TimeframeMerger::InputSocketType, options.inputSocketType.at(i), i);
+    merger.SetProperty(TimeframeMerger::InputRcvBufSize, options.inputBufSize.at(i), i);
+    merger.SetProperty(TimeframeMerger::InputMethod, options.inputMethod.at(i), i);
+    merger.SetProperty(TimeframeMerger::InputAddress, options.inputAddress.at(i), i);
+    merger.SetProperty(TimeframeMerger::LogInputRate, options.logInputRate.at(i), i);
+  }
+
+  merger.SetProperty(TimeframeMerger::OutputSocketType, options.outputSocketType);
+  merger.SetProperty(TimeframeMerger::OutputSndBufSize, options.outputBufSize);
+  merger.SetProperty(TimeframeMerger::OutputMethod, options.outputMethod);
+  merger.SetProperty(TimeframeMerger::OutputAddress, options.outputAddress);
+  merger.SetProperty(TimeframeMerger::LogOutputRate, options.logOutputRate);
+
+  try {
+    // the transport starts its I/O threads with the first socket, they inherit the CPUs of this thread.
+    placement.EnterIoScope();
+    merger.ChangeState(TimeframeMerger::SETOUTPUT);
+    merger.ChangeState(TimeframeMerger::SETINPUT);
+// temporary check to allow compilation with older fairmq version
+#ifdef FAIRMQ_INTERFACE_VERSION
+    merger.ChangeState(TimeframeMerger::BIND);
+    merger.ChangeState(TimeframeMerger::CONNECT);
+#endif
+    placement.EnterMainScope();
+    merger.ChangeState(TimeframeMerger::RUN);
+    placement.Report();
+  } catch (const exception& e) {
+      LOG(ERROR) << e.what();
+  }
+
+  // wait until the running thread has finished processing.
+  boost::unique_lock<boost::mutex> lock(merger.fRunningMutex);
+  while (!merger.fRunningFinished) {
+    merger.fRunningCondition.wait(lock);
+  }
+
+  merger.ChangeState(TimeframeMerger::STOP);
+  merger.ChangeState(TimeframeMerger::END);
+
+  return 0;
+}
@@ -0,0 +1,246 @@
+/**
+ * runTimeframeRecorder.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <csignal>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "TimeframeRecorder.h"
+#include "Placement.h"
+#include "MetricsExporter.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+TimeframeRecorder recorder;
+AliceO2::Metrics::Exporter metricsExporter;
+
+static void s_signal_handler (int signal)
+{
+  cout << endl << "Caught signal " << signal << endl;
+
+  recorder.ChangeState(TimeframeRecorder::STOP);
+  recorder.ChangeState(TimeframeRecorder::END);
+
+  cout << "Shutdown complete. Bye!" << endl;
+  exit(1);
+}
+
+static void s_catch_signals (void)
+{
+  struct sigaction action;
+  action.sa_handler = s_signal_handler;
+  action.sa_flags = 0;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+}
+
+typedef struct DeviceOptions
+{
+  string id;
+  int ioThreads;
+  string metricsTarget;
+  string metricsFormat;
+  int metricsInterval;
+  string cpusMain;
+  string cpusIo;
+  string cpusHelper;
+  string numaNode;
+  string outputFile;
+  int maxFileSize;
+  string inputSocketType;
+  int inputBufSize;
+  string inputMethod;
+  string inputAddress;
+  int logInputRate;
+} DeviceOptions_t;
+
+inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("id", bpo::value<string>()->required(), "Device ID")
+    ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+    ("metrics-target", bpo::value<string>()->default_value(""), "Export metrics to a file, or serve them on tcp://*:port, empty to disable")
+    ("metrics-format", bpo::value<string>()->default_value("prometheus"), "Format of the metrics snapshots: prometheus/json")
+    ("metrics-interval", bpo::value<int>()->default_value(1000), "Interval in ms between the metrics snapshots written to a file")
+    ("cpus-main", bpo::value<string>()->default_value(""), "CPUs of the device and its processing threads, e.g. \"0-7,16\", \"node\" for those of --numa-node")
+    ("cpus-io", bpo::value<string>()->default_value(""), "CPUs of the I/O threads of the transport")
+    ("cpus-helper", bpo::value<string>()->default_value(""), "CPUs of the helper threads (rate logger, ack listener, metrics)")
+    ("numa-node", bpo::value<string>()->default_value(""), "NUMA node for the payload memory, or the network interface whose node to use, e.g. ib0")
+    ("output-file", bpo::value<string>()->required(), "Recording to append the timeframes to, the index goes to <output-file>.idx")
+    ("max-file-size", bpo::value<int>()->default_value(0), "Size in MB at which the recording is closed, 0 for no limit")
+    ("input-socket-type", bpo::value<string>()->required(), "Input socket type: sub/pull")
+    ("input-buff-size", bpo::value<int>()->required(), "Input buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
+    ("input-method", bpo::value<string>()->required(), "Input method: bind/connect")
+    ("input-address", bpo::value<string>()->required(), "Input address, e.g.: \"tcp://localhost:5555\"")
+    ("log-input-rate", bpo::value<int>()->default_value(1), "Log input rate on socket, 1/0")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "Timeframe recorder" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  if (vm.count("id")) {
+    _options->id = vm["id"].as<string>();
+  }
+
+  if (vm.count("io-threads")) {
+    _options->ioThreads = vm["io-threads"].as<int>();
+  }
+
+  if (vm.count("metrics-target")) {
+    _options->metricsTarget = vm["metrics-target"].as<string>();
+  }
+
+  if (vm.count("metrics-format")) {
+    _options->metricsFormat = vm["metrics-format"].as<string>();
+  }
+
+  if (vm.count("metrics-interval")) {
+    _options->metricsInterval = vm["metrics-interval"].as<int>();
+  }
+
+  if (vm.count("cpus-main")) {
+    _options->cpusMain = vm["cpus-main"].as<string>();
+  }
+
+  if (vm.count("cpus-io")) {
+    _options->cpusIo = vm["cpus-io"].as<string>();
+  }
+
+  if (vm.count("cpus-helper")) {
+    _options->cpusHelper = vm["cpus-helper"].as<string>();
+  }
+
+  if (vm.count("numa-node")) {
+    _options->numaNode = vm["numa-node"].as<string>();
+  }
+
+  if (vm.count("output-file")) {
+    _options->outputFile = vm["output-file"].as<string>();
+  }
+
+  if (vm.count("max-file-size")) {
+    _options->maxFileSize = vm["max-file-size"].as<int>();
+  }
+
+  if (vm.count("input-socket-type")) {
+    _options->inputSocketType = vm["input-socket-type"].as<string>();
+  }
+
+  if (vm.count("input-buff-size")) {
+    _options->inputBufSize = vm["input-buff-size"].as<int>();
+  }
+
+  if (vm.count("input-method")) {
+    _options->inputMethod = vm["input-method"].as<string>();
+  }
+
+  if (vm.count("input-address")) {
+    _options->inputAddress = vm["input-address"].as<string>();
+  }
+
+  if (vm.count("log-input-rate")) {
+    _options->logInputRate = vm["log-input-rate"].as<int>();
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  s_catch_signals();
+
+  DeviceOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  LOG(INFO) << "PID: " << getpid();
+
+  AliceO2::Devices::Placement& placement = AliceO2::Devices::Placement::Default();
+  if (!placement.Configure(options.cpusMain, options.cpusIo, options.cpusHelper, options.numaNode)) {
+    return 1;
+  }
+
+  AliceO2::Metrics::Exporter::Format metricsFormat;
+  if (!AliceO2::Metrics::Exporter::ParseFormat(options.metricsFormat, metricsFormat)) {
+    LOG(ERROR) << "Unknown metrics format " << options.metricsFormat;
+    return 1;
+  }
+  placement.EnterHelperScope();
+  metricsExporter.Start(options.metricsTarget, metricsFormat, options.metricsInterval);
+  placement.EnterMainScope();
+
+  FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+
+  recorder.SetTransport(transportFactory);
+
+  recorder.SetProperty(TimeframeRecorder::Id, options.id);
+  recorder.SetProperty(TimeframeRecorder::NumIoThreads, options.ioThreads);
+
+  recorder.SetProperty(TimeframeRecorder::NumInputs, 1);
+  recorder.SetProperty(TimeframeRecorder::NumOutputs, 0);
+  recorder.SetProperty(TimeframeRecorder::OutputFile, options.outputFile);
+  recorder.SetProperty(TimeframeRecorder::MaxFileSizeInMB, options.maxFileSize);
+
+  recorder.ChangeState(TimeframeRecorder::INIT);
+
+  recorder.SetProperty(TimeframeRecorder::InputSocketType, options.inputSocketType);
+  recorder.SetProperty(TimeframeRecorder::InputRcvBufSize, options.inputBufSize);
+  recorder.SetProperty(TimeframeRecorder::InputMethod, options.inputMethod);
+  recorder.SetProperty(TimeframeRecorder::InputAddress, options.inputAddress);
+  recorder.SetProperty(TimeframeRecorder::LogInputRate, options.logInputRate);
+
+  try {
+    // the transport starts its I/O threads with the first socket, they inherit the CPUs of this thread.
+    placement.EnterIoScope();
+    recorder.ChangeState(TimeframeRecorder::SETOUTPUT);
+    recorder.ChangeState(TimeframeRecorder::SETINPUT);
+// temporary check to allow compilation with older fairmq version
+#ifdef FAIRMQ_INTERFACE_VERSION
+    recorder.ChangeState(TimeframeRecorder::BIND);
+    recorder.ChangeState(TimeframeRecorder::CONNECT);
+#endif
+    placement.EnterMainScope();
+    recorder.ChangeState(TimeframeRecorder::RUN);
+    placement.Report();
+  } catch (const exception& e) {
+      LOG(ERROR) << e.what();
+  }
+
+  // wait until the running thread has finished processing.
+  boost::unique_lock<boost::mutex> lock(recorder.fRunningMutex);
+  while (!recorder.fRunningFinished) {
+    recorder.fRunningCondition.wait(lock);
+  }
+
+  recorder.ChangeState(TimeframeRecorder::STOP);
+  recorder.ChangeState(TimeframeRecorder::END);
+
+  return 0;
+}
@@ -0,0 +1,275 @@
+/**
+ * runTimeframeReplayer.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <csignal>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "TimeframeReplayer.h"
+#include "Placement.h"
+#include "MetricsExporter.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+TimeframeReplayer replayer;
+AliceO2::Metrics::Exporter metricsExporter;
+
+static void s_signal_handler (int signal)
+{
+  cout << endl << "Caught signal " << signal << endl;
+
+  replayer.ChangeState(TimeframeReplayer::STOP);
+  replayer.ChangeState(TimeframeReplayer::END);
+
+  cout << "Shutdown complete. Bye!" << endl;
+  exit(1);
+}
+
+static void s_catch_signals (void)
+{
+  struct sigaction action;
+  action.sa_handler = s_signal_handler;
+  action.sa_flags = 0;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+}
+
+typedef struct DeviceOptions
+{
+  string id;
+  int ioThreads;
+  string metricsTarget;
+  string metricsFormat;
+  int metricsInterval;
+  string cpusMain;
+  string cpusIo;
+  string cpusHelper;
+  string numaNode;
+  string inputFile;
+  string timing;
+  int eventRate;
+  int maxGap;
+  int numLoops;
+  int numOutputs;
+  vector<string> outputSocketType;
+  vector<int> outputBufSize;
+  vector<string> outputMethod;
+  vector<string> outputAddress;
+  vector<int> logOutputRate;
+} DeviceOptions_t;
+
+inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("id", bpo::value<string>()->required(), "Device ID")
+    ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+    ("metrics-target", bpo::value<string>()->default_value(""), "Export metrics to a file, or serve them on tcp://*:port, empty to disable")
+    ("metrics-format", bpo::value<string>()->default_value("prometheus"), "Format of the metrics snapshots: prometheus/json")
+    ("metrics-interval", bpo::value<int>()->default_value(1000), "Interval in ms between the metrics snapshots written to a file")
+    ("cpus-main", bpo::value<string>()->default_value(""), "CPUs of the device and its processing threads, e.g. \"0-7,16\", \"node\" for those of --numa-node")
+    ("cpus-io", bpo::value<string>()->default_value(""), "CPUs of the I/O threads of the transport")
+    ("cpus-helper", bpo::value<string>()->default_value(""), "CPUs of the helper threads (rate logger, ack listener, metrics)")
+    ("numa-node", bpo::value<string>()->default_value(""), "NUMA node for the payload memory, or the network interface whose node to use, e.g. ib0")
+    ("input-file", bpo::value<string>()->required(), "Recording to replay, with its index in <input-file>.idx")
+    ("timing", bpo::value<string>()->default_value("rate"), "Pace of the replay: rate (--event-rate) or recorded")
+    ("event-rate", bpo::value<int>()->default_value(0), "Timeframes per second with --timing rate, 0 for as fast as possible")
+    ("max-gap", bpo::value<int>()->default_value(1000), "Longest pause in ms between two timeframes with --timing recorded")
+    ("num-loops", bpo::value<int>()->default_value(1), "Number of times the recording is replayed, 0 for no end")
+    ("num-outputs", bpo::value<int>()->required(), "Number of FLPs, output i gets the recorded parts of FLP i")
+    ("output-socket-type", bpo::value< vector<string> >()->required(), "Output socket type: pub/push")
+    ("output-buff-size", bpo::value< vector<int> >()->required(), "Output buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
+    ("output-method", bpo::value< vector<string> >()->required(), "Output method: bind/connect")
+    ("output-address", bpo::value< vector<string> >()->required(), "Output address, e.g.: \"tcp://localhost:5555\"")
+    ("log-output-rate", bpo::value< vector<int> >()->required(), "Log output rate on socket, 1/0")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "Timeframe replayer" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  if (vm.count("id")) {
+    _options->id = vm["id"].as<string>();
+  }
+
+  if (vm.count("io-threads")) {
+    _options->ioThreads = vm["io-threads"].as<int>();
+  }
+
+  if (vm.count("metrics-target")) {
+    _options->metricsTarget = vm["metrics-target"].as<string>();
+  }
+
+  if (vm.count("metrics-format")) {
+    _options->metricsFormat = vm["metrics-format"].as<string>();
+  }
+
+  if (vm.count("metrics-interval")) {
+    _options->metricsInterval = vm["metrics-interval"].as<int>();
+  }
+
+  if (vm.count("cpus-main")) {
+    _options->cpusMain = vm["cpus-main"].as<string>();
+  }
+
+  if (vm.count("cpus-io")) {
+    _options->cpusIo = vm["cpus-io"].as<string>();
+  }
+
+  if (vm.count("cpus-helper")) {
+    _options->cpusHelper = vm["cpus-helper"].as<string>();
+  }
+
+  if (vm.count("numa-node")) {
+    _options->numaNode = vm["numa-node"].as<string>();
+  }
+
+  if (vm.count("input-file")) {
+    _options->inputFile = vm["input-file"].as<string>();
+  }
+
+  if (vm.count("timing")) {
+    _options->timing = vm["timing"].as<string>();
+  }
+
+  if (vm.count("event-rate")) {
+    _options->eventRate = vm["event-rate"].as<int>();
+  }
+
+  if (vm.count("max-gap")) {
+    _options->maxGap = vm["max-gap"].as<int>();
+  }
+
+  if (vm.count("num-loops")) {
+    _options->numLoops = vm["num-loops"].as<int>();
+  }
+
+  if (vm.count("num-outputs")) {
+    _options->numOutputs = vm["num-outputs"].as<int>();
+  }
+
+  if (vm.count("output-socket-type")) {
+    _options->outputSocketType = vm["output-socket-type"].as<vector<string>>();
+  }
+
+  if (vm.count("output-buff-size")) {
+    _options->outputBufSize = vm["output-buff-size"].as<vector<int>>();
+  }
+
+  if (vm.count("output-method")) {
+    _options->outputMethod = vm["output-method"].as<vector<string>>();
+  }
+
+  if (vm.count("output-address")) {
+    _options->outputAddress = vm["output-address"].as<vector<string>>();
+  }
+
+  if (vm.count("log-output-rate")) {
+    _options->logOutputRate = vm["log-output-rate"].as<vector<int>>();
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  s_catch_signals();
+
+  DeviceOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  LOG(INFO) << "PID: " << getpid();
+
+  AliceO2::Devices::Placement& placement = AliceO2::Devices::Placement::Default();
+  if (!placement.Configure(options.cpusMain, options.cpusIo, options.cpusHelper, options.numaNode)) {
+    return 1;
+  }
+
+  AliceO2::Metrics::Exporter::Format metricsFormat;
+  if (!AliceO2::Metrics::Exporter::ParseFormat(options.metricsFormat, metricsFormat)) {
+    LOG(ERROR) << "Unknown metrics format " << options.metricsFormat;
+    return 1;
+  }
+  placement.EnterHelperScope();
+  metricsExporter.Start(options.metricsTarget, metricsFormat, options.metricsInterval);
+  placement.EnterMainScope();
+
+  FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+
+  replayer.SetTransport(transportFactory);
+
+  replayer.SetProperty(TimeframeReplayer::Id, options.id);
+  replayer.SetProperty(TimeframeReplayer::NumIoThreads, options.ioThreads);
+
+  replayer.SetProperty(TimeframeReplayer::NumInputs, 0);
+  replayer.SetProperty(TimeframeReplayer::NumOutputs, options.numOutputs);
+  replayer.SetProperty(TimeframeReplayer::InputFile, options.inputFile);
+  replayer.SetProperty(TimeframeReplayer::Timing, options.timing);
+  replayer.SetProperty(TimeframeReplayer::EventRate, options.eventRate);
+  replayer.SetProperty(TimeframeReplayer::MaxGapInMs, options.maxGap);
+  replayer.SetProperty(TimeframeReplayer::NumLoops, options.numLoops);
+
+  replayer.ChangeState(TimeframeReplayer::INIT);
+
+  for (int i = 0; i < options.numOutputs; ++i) {
+    replayer.SetProperty(TimeframeReplayer::OutputSocketType, options.outputSocketType.at(i), i);
+    replayer.SetProperty(TimeframeReplayer::OutputSndBufSize, options.outputBufSize.at(i), i);
+    replayer.SetProperty(TimeframeReplayer::OutputMethod, options.outputMethod.at(i), i);
+    replayer.SetProperty(TimeframeReplayer::OutputAddress, options.outputAddress.at(i), i);
+    replayer.SetProperty(TimeframeReplayer::LogOutputRate, options.logOutputRate.at(i), i);
+  }
+
+  try {
+    // the transport starts its I/O threads with the first socket, they inherit the CPUs of this thread.
+    placement.EnterIoScope();
+    replayer.ChangeState(TimeframeReplayer::SETOUTPUT);
+    replayer.ChangeState(TimeframeReplayer::SETINPUT);
+// temporary check to allow compilation with older fairmq version
+#ifdef FAIRMQ_INTERFACE_VERSION
+    replayer.ChangeState(TimeframeReplayer::BIND);
+    replayer.ChangeState(TimeframeReplayer::CONNECT);
+#endif
+    placement.EnterMainScope();
+    replayer.ChangeState(TimeframeReplayer::RUN);
+    placement.Report();
+  } catch (const exception& e) {
+      LOG(ERROR) << e.what();
+  }
+
+  // wait until the running thread has finished processing.
+  boost::unique_lock<boost::mutex> lock(replayer.fRunningMutex);
+  while (!replayer.fRunningFinished) {
+    replayer.fRunningCondition.wait(lock);
+  }
+
+  replayer.ChangeState(TimeframeReplayer::STOP);
+  replayer.ChangeState(TimeframeReplayer::END);
+
+  return 0;
+}
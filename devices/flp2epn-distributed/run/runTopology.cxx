@@ -0,0 +1,482 @@
+/**
+ * runTopology.cxx
+ *
+ * Runs a whole FLP to EPN topology in one process: samplers, FLPs and EPNs
+ * as in flp_epn_topology.xml, each device in its own threads, wired with
+ * inproc sockets of one transport factory. Starts in milliseconds instead of
+ * one process and a set of tcp ports per device, can run for a fixed number
+ * of timeframes and prints the metrics of all devices summed up at the end.
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <csignal>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "FLPexSampler.h"
+#include "FLPex.h"
+#include "EPNex.h"
+#include "Metrics.h"
+#include "MetricsExporter.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef chrono::steady_clock Clock;
+
+AliceO2::Metrics::Exporter metricsExporter;
+
+static volatile sig_atomic_t gStopRequested = 0;
+
+static void s_signal_handler (int /*signal*/)
+{
+  gStopRequested = 1;
+}
+
+static void s_catch_signals (void)
+{
+  struct sigaction action;
+  action.sa_handler = s_signal_handler;
+  action.sa_flags = 0;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+}
+
+typedef struct TopologyOptions
+{
+  int numSamplers;
+  int numFLPs;
+  int numEPNs;
+  int numTimeframes;
+  int timeout;
+  int startDelay;
+  int ioThreads;
+  int buffSize;
+  int signalBuffSize;
+  int logRates;
+  string metricsTarget;
+  string metricsFormat;
+  int metricsInterval;
+  // sampler
+  int eventRate;
+  string arrival;
+  // FLP
+  int eventSize;
+  int heartbeatTimeoutInMs;
+  string epnSelection;
+  int flowControl;
+  int queueCapacity;
+  string dropPolicy;
+  int maxSpinInUs;
+  int keepaliveIntervalInMs;
+  int checksum;
+  // EPN
+  int heartbeatIntervalInMs;
+  int bufferTimeoutInMs;
+  int windowSize;
+  int numWorkers;
+  int creditTimeframes;
+  int creditBufferInMB;
+  int membershipTimeoutInMs;
+  int verifyChecksums;
+  string releasePolicy;
+  int releaseDeadlineInMs;
+} TopologyOptions_t;
+
+inline bool parse_cmd_line(int _argc, char* _argv[], TopologyOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("num-samplers", bpo::value<int>()->default_value(1), "Number of samplers, FLP i gets the timeframe IDs of sampler i % n and EPN k acknowledges to sampler k % n")
+    ("num-flps", bpo::value<int>()->default_value(3), "Number of FLPs")
+    ("num-epns", bpo::value<int>()->default_value(3), "Number of EPNs")
+    ("num-timeframes", bpo::value<int>()->default_value(1000), "Stop after this many timeframes are completed or discarded by the EPNs, 0 to run until interrupted")
+    ("timeout", bpo::value<int>()->default_value(60), "Stop after this many seconds in any case, 0 for no limit")
+    ("start-delay", bpo::value<int>()->default_value(100), "Delay of the samplers before the first timeframe in milliseconds, for the subscriptions to settle")
+    ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads of the shared transport")
+    ("buff-size", bpo::value<int>()->default_value(2), "High-water mark of the data and control sockets in messages")
+    ("signal-buff-size", bpo::value<int>()->default_value(100), "High-water mark of the timeframe ID and acknowledgement sockets in messages")
+    ("log-rates", bpo::value<int>()->default_value(0), "Log the socket rates of the data path (1) or not (0)")
+    ("metrics-target", bpo::value<string>()->default_value(""), "Export the metrics of all devices to a file, udp://host:port or tcp://host:port, empty to disable")
+    ("metrics-format", bpo::value<string>()->default_value("prometheus"), "Metrics format: prometheus or json")
+    ("metrics-interval", bpo::value<int>()->default_value(1000), "Interval between metrics exports in milliseconds")
+    ("event-rate", bpo::value<int>()->default_value(100), "Sampler: timeframes per second, 0 as fast as possible")
+    ("arrival", bpo::value<string>()->default_value("constant"), "Sampler: arrival process, constant or poisson")
+    ("event-size", bpo::value<int>()->default_value(1000000), "FLP: bytes of a sub-timeframe")
+    ("heartbeat-timeout", bpo::value<int>()->default_value(20000), "FLP: heartbeat timeout in milliseconds")
+    ("epn-selection", bpo::value<string>()->default_value("round-robin"), "FLP: EPN selection policy: round-robin, weighted-hash or free-buffer")
+    ("flow-control", bpo::value<int>()->default_value(0), "FLP: send against the credit of the EPNs (1) or not (0)")
+    ("queue-capacity", bpo::value<int>()->default_value(256), "FLP: sub-timeframes queued per EPN, 0 for unbounded")
+    ("drop-policy", bpo::value<string>()->default_value("timeframe"), "FLP: what to drop from a full queue: oldest, newest or timeframe")
+    ("max-spin", bpo::value<int>()->default_value(50), "FLP and EPN: longest time the main loop polls without blocking after it had work, in us, 0 always blocks")
+    ("keepalive-interval", bpo::value<int>()->default_value(1000), "FLP: interval of the keepalive notices to the EPNs in milliseconds, 0 to disable")
+    ("checksum", bpo::value<int>()->default_value(0), "FLP: put the CRC32C of every payload into its header (1) or not (0)")
+    ("heartbeat-interval", bpo::value<int>()->default_value(5000), "EPN: heartbeat interval in milliseconds")
+    ("buffer-timeout", bpo::value<int>()->default_value(1000), "EPN: buffer timeout in milliseconds")
+    ("window-size", bpo::value<int>()->default_value(509), "EPN: timeframes assembled at the same time")
+    ("num-workers", bpo::value<int>()->default_value(0), "EPN: number of assembly threads, 0 assembles on the receiving thread")
+    ("credit-timeframes", bpo::value<int>()->default_value(0), "EPN: timeframes the FLPs may have in flight, 0 for the window size")
+    ("credit-buffer", bpo::value<int>()->default_value(0), "EPN: MB the FLPs may have in flight together, 0 for no limit")
+    ("membership-timeout", bpo::value<int>()->default_value(3000), "EPN: time in milliseconds after which a silent FLP is no longer waited for, 0 to always wait for all FLPs")
+    ("verify-checksums", bpo::value<int>()->default_value(1), "EPN: verify the payloads that carry a checksum (1) or not (0)")
+    ("release-policy", bpo::value<string>()->default_value("complete"), "EPN: when to forward a timeframe: complete, or early with the parts it has at the release deadline")
+    ("release-deadline", bpo::value<int>()->default_value(100), "EPN: early release: time in milliseconds from the first part of a timeframe to forwarding it")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "FLP to EPN topology in one process" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  _options->numSamplers = vm["num-samplers"].as<int>();
+  _options->numFLPs = vm["num-flps"].as<int>();
+  _options->numEPNs = vm["num-epns"].as<int>();
+  _options->numTimeframes = vm["num-timeframes"].as<int>();
+  _options->timeout = vm["timeout"].as<int>();
+  _options->startDelay = vm["start-delay"].as<int>();
+  _options->ioThreads = vm["io-threads"].as<int>();
+  _options->buffSize = vm["buff-size"].as<int>();
+  _options->signalBuffSize = vm["signal-buff-size"].as<int>();
+  _options->logRates = vm["log-rates"].as<int>();
+  _options->metricsTarget = vm["metrics-target"].as<string>();
+  _options->metricsFormat = vm["metrics-format"].as<string>();
+  _options->metricsInterval = vm["metrics-interval"].as<int>();
+  _options->eventRate = vm["event-rate"].as<int>();
+  _options->arrival = vm["arrival"].as<string>();
+  _options->eventSize = vm["event-size"].as<int>();
+  _options->heartbeatTimeoutInMs = vm["heartbeat-timeout"].as<int>();
+  _options->epnSelection = vm["epn-selection"].as<string>();
+  _options->flowControl = vm["flow-control"].as<int>();
+  _options->queueCapacity = vm["queue-capacity"].as<int>();
+  _options->dropPolicy = vm["drop-policy"].as<string>();
+  _options->maxSpinInUs = vm["max-spin"].as<int>();
+  _options->keepaliveIntervalInMs = vm["keepalive-interval"].as<int>();
+  _options->checksum = vm["checksum"].as<int>();
+  _options->heartbeatIntervalInMs = vm["heartbeat-interval"].as<int>();
+  _options->bufferTimeoutInMs = vm["buffer-timeout"].as<int>();
+  _options->windowSize = vm["window-size"].as<int>();
+  _options->numWorkers = vm["num-workers"].as<int>();
+  _options->creditTimeframes = vm["credit-timeframes"].as<int>();
+  _options->creditBufferInMB = vm["credit-buffer"].as<int>();
+  _options->membershipTimeoutInMs = vm["membership-timeout"].as<int>();
+  _options->verifyChecksums = vm["verify-checksums"].as<int>();
+  _options->releasePolicy = vm["release-policy"].as<string>();
+  _options->releaseDeadlineInMs = vm["release-deadline"].as<int>();
+
+  if (_options->numSamplers < 1 || _options->numFLPs < 1 || _options->numEPNs < 1) {
+    throw runtime_error("The topology needs at least one sampler, FLP and EPN.");
+  }
+
+  return true;
+}
+
+static string address(const string& device, int index, const string& socket)
+{
+  stringstream ss;
+  ss << "inproc://" << device << "-" << index << "-" << socket;
+  return ss.str();
+}
+
+static void setInput(FairMQDevice& device, int slot, const string& type, int buffSize, const string& method, const string& address, int logRate)
+{
+  device.SetProperty(FairMQDevice::InputSocketType, type, slot);
+  device.SetProperty(FairMQDevice::InputRcvBufSize, buffSize, slot);
+  device.SetProperty(FairMQDevice::InputMethod, method, slot);
+  device.SetProperty(FairMQDevice::InputAddress, address, slot);
+  device.SetProperty(FairMQDevice::LogInputRate, logRate, slot);
+}
+
+static void setOutput(FairMQDevice& device, int slot, const string& type, int buffSize, const string& method, const string& address, int logRate)
+{
+  device.SetProperty(FairMQDevice::OutputSocketType, type, slot);
+  device.SetProperty(FairMQDevice::OutputSndBufSize, buffSize, slot);
+  device.SetProperty(FairMQDevice::OutputMethod, method, slot);
+  device.SetProperty(FairMQDevice::OutputAddress, address, slot);
+  device.SetProperty(FairMQDevice::LogOutputRate, logRate, slot);
+}
+
+static void waitUntilFinished(FairMQDevice& device)
+{
+  boost::unique_lock<boost::mutex> lock(device.fRunningMutex);
+  while (!device.fRunningFinished) {
+    device.fRunningCondition.wait(lock);
+  }
+}
+
+/// highest value of the power of two bucket that holds the given fraction of the counts
+static uint64_t bucketPercentile(const vector<uint64_t>& buckets, uint64_t count, double fraction)
+{
+  uint64_t rank = static_cast<uint64_t>(fraction * count);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen > rank) {
+      return AliceO2::Metrics::Histogram::UpperBound(i);
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  s_catch_signals();
+
+  TopologyOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  AliceO2::Metrics::Exporter::Format metricsFormat;
+  if (!AliceO2::Metrics::Exporter::ParseFormat(options.metricsFormat, metricsFormat)) {
+    LOG(ERROR) << "Unknown metrics format " << options.metricsFormat;
+    return 1;
+  }
+  metricsExporter.Start(options.metricsTarget, metricsFormat, options.metricsInterval);
+
+  Clock::time_point startup = Clock::now();
+
+  // one factory, so that all sockets share the context that inproc needs.
+  FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+
+  vector<unique_ptr<FLPexSampler>> samplers;
+  vector<unique_ptr<FLPex>> flps;
+  vector<unique_ptr<EPNex>> epns;
+  vector<FairMQDevice*> devices; // in the order of shutdown: samplers, FLPs, EPNs
+  vector<FairMQDevice*> started; // devices with a running thread
+
+  for (int s = 0; s < options.numSamplers; ++s) {
+    samplers.push_back(unique_ptr<FLPexSampler>(new FLPexSampler()));
+    FLPexSampler& sampler = *samplers.back();
+    devices.push_back(&sampler);
+
+    sampler.SetTransport(transportFactory);
+    sampler.SetProperty(FLPexSampler::Id, to_string(101 + s));
+    sampler.SetProperty(FLPexSampler::NumIoThreads, options.ioThreads);
+    sampler.SetProperty(FLPexSampler::EventRate, options.eventRate);
+    sampler.SetProperty(FLPexSampler::Arrival, options.arrival);
+    sampler.SetProperty(FLPexSampler::StartDelay, options.startDelay);
+    sampler.SetProperty(FLPexSampler::NumTimeframes, options.numTimeframes);
+    sampler.SetProperty(FLPexSampler::NumInputs, 1);
+    sampler.SetProperty(FLPexSampler::NumOutputs, 1);
+
+    sampler.ChangeState(FLPexSampler::INIT);
+
+    setInput(sampler, 0, "pull", options.signalBuffSize, "bind", address("sampler", s, "ack"), 0);
+    setOutput(sampler, 0, "pub", options.signalBuffSize, "bind", address("sampler", s, "signal"), 0);
+  }
+
+  for (int i = 0; i < options.numFLPs; ++i) {
+    flps.push_back(unique_ptr<FLPex>(new FLPex()));
+    FLPex& flp = *flps.back();
+    devices.push_back(&flp);
+
+    flp.SetTransport(transportFactory);
+    flp.SetProperty(FLPex::Id, to_string(i + 1));
+    flp.SetProperty(FLPex::NumIoThreads, options.ioThreads);
+    flp.SetProperty(FLPex::EventSize, options.eventSize);
+    flp.SetProperty(FLPex::NumInputs, 3);
+    flp.SetProperty(FLPex::NumOutputs, options.numEPNs);
+    flp.SetProperty(FLPex::HeartbeatTimeoutInMs, options.heartbeatTimeoutInMs);
+    flp.SetProperty(FLPex::TestMode, 1);
+    flp.SetProperty(FLPex::SendOffset, i);
+    flp.SetProperty(FLPex::EPNSelection, options.epnSelection);
+    flp.SetProperty(FLPex::FlowControl, options.flowControl);
+    flp.SetProperty(FLPex::QueueCapacity, options.queueCapacity);
+    flp.SetProperty(FLPex::QueueDropPolicy, options.dropPolicy);
+    flp.SetProperty(FLPex::MaxSpinInUs, options.maxSpinInUs);
+    flp.SetProperty(FLPex::KeepaliveIntervalInMs, options.keepaliveIntervalInMs);
+    flp.SetProperty(FLPex::Checksum, options.checksum);
+
+    flp.ChangeState(FLPex::INIT);
+
+    setInput(flp, 0, "sub", options.buffSize, "bind", address("flp", i, "command"), 0);
+    setInput(flp, 1, "sub", options.buffSize, "bind", address("flp", i, "heartbeat"), 0);
+    setInput(flp, 2, "sub", options.signalBuffSize, "connect", address("sampler", i % options.numSamplers, "signal"), 0);
+    for (int k = 0; k < options.numEPNs; ++k) {
+      setOutput(flp, k, "push", options.buffSize, "connect", address("epn", k, "data"), options.logRates);
+    }
+  }
+
+  for (int k = 0; k < options.numEPNs; ++k) {
+    epns.push_back(unique_ptr<EPNex>(new EPNex()));
+    EPNex& epn = *epns.back();
+    devices.push_back(&epn);
+
+    epn.SetTransport(transportFactory);
+    epn.SetProperty(EPNex::Id, "EPN" + to_string(k));
+    epn.SetProperty(EPNex::NumIoThreads, options.ioThreads);
+    epn.SetProperty(EPNex::NumInputs, 1);
+    epn.SetProperty(EPNex::NumOutputs, 3);
+    epn.SetProperty(EPNex::HeartbeatIntervalInMs, options.heartbeatIntervalInMs);
+    epn.SetProperty(EPNex::BufferTimeoutInMs, options.bufferTimeoutInMs);
+    epn.SetProperty(EPNex::NumFLPs, options.numFLPs);
+    epn.SetProperty(EPNex::TestMode, 1);
+    epn.SetProperty(EPNex::WindowSize, options.windowSize);
+    epn.SetProperty(EPNex::NumWorkers, options.numWorkers);
+    epn.SetProperty(EPNex::CreditTimeframes, options.creditTimeframes);
+    epn.SetProperty(EPNex::CreditBufferInMB, options.creditBufferInMB);
+    epn.SetProperty(EPNex::MaxSpinInUs, options.maxSpinInUs);
+    epn.SetProperty(EPNex::MembershipTimeoutInMs, options.membershipTimeoutInMs);
+    epn.SetProperty(EPNex::VerifyChecksums, options.verifyChecksums);
+    epn.SetProperty(EPNex::ReleasePolicy, options.releasePolicy);
+    epn.SetProperty(EPNex::ReleaseDeadlineInMs, options.releaseDeadlineInMs);
+    epn.SetProperty(EPNex::EPNIndex, k);
+    for (int i = 0; i < options.numFLPs; ++i) {
+      epn.SetProperty(EPNex::HeartbeatAddress, address("flp", i, "heartbeat"), i);
+    }
+
+    epn.ChangeState(EPNex::INIT);
+
+    setInput(epn, 0, "pull", options.buffSize, "bind", address("epn", k, "data"), options.logRates);
+    // heartbeats and credit. The EPN connects to the FLPs when it starts running, after they have all
+    // bound, so that it only binds and connects to the samplers while it is set up.
+    setOutput(epn, 0, "pub", options.buffSize, "bind", address("epn", k, "heartbeat"), 0);
+    // the next processing step is not part of the topology, a pub without subscribers drops the timeframes
+    setOutput(epn, 1, "pub", options.buffSize, "bind", address("epn", k, "output"), 0);
+    setOutput(epn, 2, "push", options.signalBuffSize, "connect", address("sampler", k % options.numSamplers, "ack"), 0);
+  }
+
+  // older zeromq versions refuse an inproc connect to an unbound address. The samplers only bind, the EPNs
+  // connect to the samplers and the FLPs to both, so setting them up in that order binds every address before
+  // it is connected to, also with the older fairmq versions that bind and connect in SETOUTPUT and SETINPUT.
+  vector<FairMQDevice*> setup;
+  for (size_t s = 0; s < samplers.size(); ++s) {
+    setup.push_back(samplers[s].get());
+  }
+  for (size_t k = 0; k < epns.size(); ++k) {
+    setup.push_back(epns[k].get());
+  }
+  for (size_t i = 0; i < flps.size(); ++i) {
+    setup.push_back(flps[i].get());
+  }
+
+  try {
+    for (size_t d = 0; d < setup.size(); ++d) {
+      setup[d]->ChangeState(FairMQDevice::SETOUTPUT);
+      setup[d]->ChangeState(FairMQDevice::SETINPUT);
+    }
+// temporary check to allow compilation with older fairmq version
+#ifdef FAIRMQ_INTERFACE_VERSION
+    for (size_t d = 0; d < setup.size(); ++d) {
+      setup[d]->ChangeState(FairMQDevice::BIND);
+    }
+    for (size_t d = 0; d < setup.size(); ++d) {
+      setup[d]->ChangeState(FairMQDevice::CONNECT);
+    }
+#endif
+    // EPNs first, so that their heartbeats are on the way when the FLPs start.
+    for (size_t d = devices.size(); d-- > 0;) {
+      devices[d]->ChangeState(FairMQDevice::RUN);
+      started.push_back(devices[d]);
+    }
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    gStopRequested = 1;
+  }
+
+  Clock::time_point up = Clock::now();
+  LOG(INFO) << options.numSamplers << " samplers, " << options.numFLPs << " FLPs and " << options.numEPNs << " EPNs running after "
+            << chrono::duration_cast<chrono::microseconds>(up - startup).count() / 1000. << " ms";
+
+  AliceO2::Metrics::Registry& metrics = AliceO2::Metrics::Registry::Default();
+  Clock::time_point deadline = up + chrono::seconds(options.timeout);
+  uint64_t numDone = 0;
+
+  while (!gStopRequested) {
+    this_thread::sleep_for(chrono::milliseconds(10));
+
+    numDone = metrics.SumCounter("o2_epn_timeframes_completed_total") + metrics.SumCounter("o2_epn_timeframes_discarded_total");
+    if (options.numTimeframes > 0 && numDone >= static_cast<uint64_t>(options.numTimeframes)) {
+      break;
+    }
+    if (options.timeout > 0 && Clock::now() >= deadline) {
+      LOG(WARN) << "Timeout after " << options.timeout << " s with " << numDone << " timeframes done";
+      break;
+    }
+  }
+
+  Clock::time_point finished = Clock::now();
+  double seconds = chrono::duration<double>(finished - up - chrono::milliseconds(options.startDelay)).count();
+  seconds = max(seconds, 1e-9);
+
+  for (size_t d = 0; d < devices.size(); ++d) {
+    devices[d]->ChangeState(FairMQDevice::STOP);
+  }
+  for (size_t d = 0; d < started.size(); ++d) {
+    waitUntilFinished(*started[d]);
+  }
+  for (size_t d = 0; d < devices.size(); ++d) {
+    devices[d]->ChangeState(FairMQDevice::END);
+  }
+
+  metricsExporter.Stop();
+
+  uint64_t numCompleted = metrics.SumCounter("o2_epn_timeframes_completed_total");
+  uint64_t receivedBytes = metrics.SumCounter("o2_epn_received_bytes_total");
+
+  vector<uint64_t> buckets;
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  metrics.CollectHistogram("o2_epn_assembly_time_us", buckets, count, sum);
+
+  cout << endl
+       << options.numSamplers << " samplers, " << options.numFLPs << " FLPs, " << options.numEPNs << " EPNs over inproc, running after "
+       << fixed << setprecision(1) << chrono::duration_cast<chrono::microseconds>(up - startup).count() / 1000. << " ms, "
+       << setprecision(2) << seconds << " s of timeframes" << endl << endl;
+
+  cout << "Timeframes" << endl
+       << "  completed                " << numCompleted << endl
+       << "  discarded on the EPN     " << metrics.SumCounter("o2_epn_timeframes_discarded_total") << endl
+       << "  discarded, no EPN alive  " << metrics.SumCounter("o2_flp_timeframes_discarded_total") << " (summed over the FLPs)" << endl
+       << "  rate                     " << setprecision(1) << numCompleted / seconds << " /s" << endl << endl;
+
+  cout << "Sub-timeframes" << endl
+       << "  sent                     " << metrics.SumCounter("o2_flp_sub_timeframes_sent_total") << endl
+       << "  received                 " << metrics.SumCounter("o2_epn_sub_timeframes_received_total") << endl
+       << "  dropped from FLP queues  " << metrics.SumCounter("o2_flp_sub_timeframes_dropped_total") << endl
+       << "  rejected as late or dup  " << metrics.SumCounter("o2_epn_sub_timeframes_rejected_total") << endl
+       << "  send errors              " << metrics.SumCounter("o2_flp_send_errors_total") << endl
+       << "  waited for credit        " << metrics.SumCounter("o2_flp_credit_waits_total") << endl
+       << "  throughput               " << setprecision(1) << receivedBytes / seconds / 1e6 << " MB/s" << endl << endl;
+
+  cout << "Assembly time, us" << endl
+       << "  mean                     " << setprecision(0) << (count > 0 ? static_cast<double>(sum) / count : 0.) << endl
+       << "  p50 below                " << bucketPercentile(buckets, count, 0.5) << endl
+       << "  p99 below                " << bucketPercentile(buckets, count, 0.99) << endl;
+
+  started.clear();
+  devices.clear();
+  epns.clear();
+  flps.clear();
+  samplers.clear();
+
+  delete transportFactory;
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * simulateFLP2EPN.cxx
+ *
+ * Discrete-event simulation of the FLP to EPN topology at full scale on one
+ * machine, to size the EPN buffers, the timeouts and the traffic shaping.
+ * The FLPs and EPNs run the scheduling and assembly code of FLPex and EPNex
+ * against a switch model, see TopologySimulator.
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <fstream>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "TopologySimulator.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef struct SimulationOptions
+{
+  SimulationConfig config;
+  string latencyFile;
+} SimulationOptions_t;
+
+inline bool parse_cmd_line(int _argc, char* _argv[], SimulationOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("num-flps", bpo::value<int>()->default_value(250), "Number of FLPs")
+    ("num-epns", bpo::value<int>()->default_value(1000), "Number of EPNs")
+    ("timeframe-rate", bpo::value<double>()->default_value(50.), "Timeframes per second")
+    ("sub-timeframe-size", bpo::value<int>()->default_value(10000000), "Mean bytes of a sub-timeframe")
+    ("size-spread", bpo::value<double>()->default_value(0.2), "Sub-timeframe sizes vary uniformly by this fraction of the mean")
+    ("skew", bpo::value<int>()->default_value(100), "Largest delay of an FLP getting its part of a timeframe in microseconds")
+    ("duration", bpo::value<double>()->default_value(60.), "Simulated seconds of timeframe generation")
+    ("flp-link", bpo::value<double>()->default_value(100.), "FLP link bandwidth in Gb/s")
+    ("epn-link", bpo::value<double>()->default_value(100.), "EPN link bandwidth in Gb/s")
+    ("latency", bpo::value<int>()->default_value(20), "One-way latency from an FLP to an EPN in microseconds")
+    ("control-latency", bpo::value<int>()->default_value(50), "Latency of heartbeats and credit in microseconds")
+    ("epn-selection", bpo::value<string>()->default_value("round-robin"), "FLP: EPN selection policy: round-robin, weighted-hash or free-buffer")
+    ("heartbeat-timeout", bpo::value<int>()->default_value(20000), "FLP: heartbeat timeout in milliseconds")
+    ("output-rate", bpo::value<int>()->default_value(0), "FLP: output rate limit per EPN in MB/s, 0 for unlimited")
+    ("output-burst", bpo::value<int>()->default_value(0), "FLP: burst size of the output rate limit in bytes")
+    ("num-slots", bpo::value<int>()->default_value(0), "FLP: number of send slots in a cycle, FLP i sends in slot i, 0 to disable")
+    ("slot-length", bpo::value<int>()->default_value(1000), "FLP: length of a send slot in microseconds")
+    ("flow-control", bpo::value<int>()->default_value(0), "FLP: send against the credit of the EPNs (1) or not (0)")
+    ("queue-capacity", bpo::value<int>()->default_value(256), "FLP: sub-timeframes queued per EPN, 0 for unbounded")
+    ("queue-drop-policy", bpo::value<string>()->default_value("timeframe"), "FLP: what to drop from a full queue: oldest, newest or timeframe")
+    ("heartbeat-interval", bpo::value<int>()->default_value(3000), "EPN: heartbeat interval in milliseconds")
+    ("occupancy-interval", bpo::value<int>()->default_value(32), "EPN: timeframes per occupancy report")
+    ("buffer-timeout", bpo::value<int>()->default_value(1000), "EPN: buffer timeout in milliseconds")
+    ("window-size", bpo::value<int>()->default_value(31), "EPN: timeframes assembled at the same time, the memory of the simulation grows with it")
+    ("credit-timeframes", bpo::value<int>()->default_value(0), "EPN: timeframes the FLPs may have in flight, 0 for the window size")
+    ("credit-buffer", bpo::value<int>()->default_value(0), "EPN: MB the FLPs may have in flight together, 0 for no limit")
+    ("fail-epns", bpo::value<int>()->default_value(0), "Number of EPNs that fail")
+    ("fail-at", bpo::value<double>()->default_value(10.), "Simulated second at which they fail")
+    ("seed", bpo::value<unsigned int>()->default_value(1), "Seed of the random sizes and skews")
+    ("latency-file", bpo::value<string>()->default_value(""), "Write the percentile distribution of the timeframe latency to this file")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "FLP to EPN topology simulation" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  SimulationConfig& c = _options->config;
+  c.numFLPs = vm["num-flps"].as<int>();
+  c.numEPNs = vm["num-epns"].as<int>();
+  c.timeframeRate = vm["timeframe-rate"].as<double>();
+  c.subTimeframeSize = max(vm["sub-timeframe-size"].as<int>(), 1);
+  c.sizeSpread = vm["size-spread"].as<double>();
+  c.skewInUs = vm["skew"].as<int>();
+  c.durationInS = vm["duration"].as<double>();
+  c.flpLinkGbps = vm["flp-link"].as<double>();
+  c.epnLinkGbps = vm["epn-link"].as<double>();
+  c.latencyInUs = vm["latency"].as<int>();
+  c.controlLatencyInUs = vm["control-latency"].as<int>();
+  c.epnSelection = vm["epn-selection"].as<string>();
+  c.heartbeatTimeoutInMs = vm["heartbeat-timeout"].as<int>();
+  c.outputRate = vm["output-rate"].as<int>();
+  c.outputBurst = vm["output-burst"].as<int>();
+  c.numSlots = vm["num-slots"].as<int>();
+  c.slotLength = vm["slot-length"].as<int>();
+  c.flowControl = vm["flow-control"].as<int>();
+  c.queueCapacity = vm["queue-capacity"].as<int>();
+  c.queueDropPolicy = vm["queue-drop-policy"].as<string>();
+  c.heartbeatIntervalInMs = vm["heartbeat-interval"].as<int>();
+  c.occupancyInterval = vm["occupancy-interval"].as<int>();
+  c.bufferTimeoutInMs = vm["buffer-timeout"].as<int>();
+  c.windowSize = vm["window-size"].as<int>();
+  c.creditTimeframes = vm["credit-timeframes"].as<int>();
+  c.creditBufferInMB = vm["credit-buffer"].as<int>();
+  c.numFailedEPNs = vm["fail-epns"].as<int>();
+  c.failAtInS = vm["fail-at"].as<double>();
+  c.seed = vm["seed"].as<unsigned int>();
+  _options->latencyFile = vm["latency-file"].as<string>();
+
+  if (c.flpLinkGbps <= 0. || c.epnLinkGbps <= 0.) {
+    throw runtime_error("The link bandwidths have to be positive.");
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  SimulationOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  // only for the placeholder message of the assembly windows, nothing is sent.
+  FairMQTransportFactory* factory = new FairMQTransportFactoryZMQ();
+
+  {
+    TopologySimulator simulator;
+    simulator.Init(options.config, factory);
+    simulator.Run();
+    simulator.Report(cout);
+
+    if (!options.latencyFile.empty()) {
+      ofstream out(options.latencyFile.c_str());
+      if (out) {
+        simulator.WriteLatencyDistribution(out);
+      } else {
+        LOG(ERROR) << "Could not write " << options.latencyFile;
+      }
+    }
+  }
+
+  delete factory;
+
+  return 0;
+}
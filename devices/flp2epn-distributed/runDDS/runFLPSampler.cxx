@@ -14,9 +14,11 @@
 
 #include "FairMQLogger.h"
 #include "FairMQTransportFactoryZMQ.h"
+#include "ShmTransportFactory.h"
 #include "FairMQTools.h"
 
 #include "FLPexSampler.h"
+#include "Placement.h"
 
 // DDS
 #include "KeyValue.h"
@@ -53,7 +55,24 @@ typedef struct DeviceOptions
 {
   string id;
   int eventRate;
+  string arrival;
+  int burstSize;
+  int burstOn;
+  int burstOff;
+  int maxInFlight;
+  int histogramInterval;
+  int startDelay;
+  int numTimeframes;
+  int batchEvents;
   int ioThreads;
+  string transport;
+  string shmSegment;
+  int shmSizeInMB;
+  int shmAllLocal;
+  string cpusMain;
+  string cpusIo;
+  string cpusHelper;
+  string numaNode;
   string inputSocketType;
   int inputBufSize;
   string inputMethod;
@@ -75,8 +94,25 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
   bpo::options_description desc("Options");
   desc.add_options()
     ("id", bpo::value<string>()->required(), "Device ID")
-    ("event-rate", bpo::value<int>()->default_value(0), "Event rate limit in maximum number of events per second")
+    ("event-rate", bpo::value<int>()->default_value(0), "Timeframe rate in timeframes per second (average over the on periods), 0 for unlimited")
+    ("arrival", bpo::value<string>()->default_value("constant"), "Arrival process of the timeframes: constant/poisson")
+    ("burst-size", bpo::value<int>()->default_value(1), "Number of timeframes sent back to back at every arrival")
+    ("burst-on", bpo::value<int>()->default_value(0), "Length of the on periods in ms, 0 sends continuously")
+    ("burst-off", bpo::value<int>()->default_value(0), "Length of the pause between the on periods in ms")
+    ("max-in-flight", bpo::value<int>()->default_value(10000), "Number of unacknowledged timeframes tracked for the RTT")
+    ("histogram-interval", bpo::value<int>()->default_value(10), "Interval in seconds between the RTT histogram summaries in the log")
+    ("start-delay", bpo::value<int>()->default_value(10000), "Delay before the first timeframe in milliseconds, for the FLPs and EPNs to connect")
+    ("num-timeframes", bpo::value<int>()->default_value(0), "Stop sending after this many timeframes, 0 for no limit")
+    ("batch-events", bpo::value<int>()->default_value(1), "Events per sub-timeframe, as --batch-events of the FLPs")
     ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+    ("transport", bpo::value<string>()->default_value("zeromq"), "Transport: zeromq/shmem (payloads in shared memory between the devices of a node)")
+    ("shm-segment", bpo::value<string>()->default_value("o2payload"), "Name of the shared memory segment (shmem)")
+    ("shm-size", bpo::value<int>()->default_value(1024), "Size of the shared memory segment in MB (shmem)")
+    ("shm-all-local", bpo::value<int>()->default_value(0), "Treat all peers as on this node, 1/0 (shmem)")
+    ("cpus-main", bpo::value<string>()->default_value(""), "CPUs of the device and its processing threads, e.g. \"0-7,16\", \"node\" for those of --numa-node")
+    ("cpus-io", bpo::value<string>()->default_value(""), "CPUs of the I/O threads of the transport")
+    ("cpus-helper", bpo::value<string>()->default_value(""), "CPUs of the helper threads (rate logger, ack listener, metrics)")
+    ("numa-node", bpo::value<string>()->default_value(""), "NUMA node for the payload memory, or the network interface whose node to use, e.g. ib0")
     ("input-socket-type", bpo::value<string>()->required(), "Input socket type: sub/pull")
     ("input-buff-size", bpo::value<int>()->required(), "Input buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
     ("input-method", bpo::value<string>()->required(), "Input method: bind/connect")
@@ -107,10 +143,78 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     _options->eventRate = vm["event-rate"].as<int>();
   }
 
+  if (vm.count("arrival")) {
+    _options->arrival = vm["arrival"].as<string>();
+  }
+
+  if (vm.count("burst-size")) {
+    _options->burstSize = vm["burst-size"].as<int>();
+  }
+
+  if (vm.count("burst-on")) {
+    _options->burstOn = vm["burst-on"].as<int>();
+  }
+
+  if (vm.count("burst-off")) {
+    _options->burstOff = vm["burst-off"].as<int>();
+  }
+
+  if (vm.count("max-in-flight")) {
+    _options->maxInFlight = vm["max-in-flight"].as<int>();
+  }
+
+  if (vm.count("histogram-interval")) {
+    _options->histogramInterval = vm["histogram-interval"].as<int>();
+  }
+
+  if (vm.count("start-delay")) {
+    _options->startDelay = vm["start-delay"].as<int>();
+  }
+
+  if (vm.count("num-timeframes")) {
+    _options->numTimeframes = vm["num-timeframes"].as<int>();
+  }
+
+  if (vm.count("batch-events")) {
+    _options->batchEvents = vm["batch-events"].as<int>();
+  }
+
   if (vm.count("io-threads")) {
     _options->ioThreads = vm["io-threads"].as<int>();
   }
 
+  if (vm.count("transport")) {
+    _options->transport = vm["transport"].as<string>();
+  }
+
+  if (vm.count("shm-segment")) {
+    _options->shmSegment = vm["shm-segment"].as<string>();
+  }
+
+  if (vm.count("shm-size")) {
+    _options->shmSizeInMB = vm["shm-size"].as<int>();
+  }
+
+  if (vm.count("shm-all-local")) {
+    _options->shmAllLocal = vm["shm-all-local"].as<int>();
+  }
+
+  if (vm.count("cpus-main")) {
+    _options->cpusMain = vm["cpus-main"].as<string>();
+  }
+
+  if (vm.count("cpus-io")) {
+    _options->cpusIo = vm["cpus-io"].as<string>();
+  }
+
+  if (vm.count("cpus-helper")) {
+    _options->cpusHelper = vm["cpus-helper"].as<string>();
+  }
+
+  if (vm.count("numa-node")) {
+    _options->numaNode = vm["numa-node"].as<string>();
+  }
+
   if (vm.count("input-socket-type")) {
     _options->inputSocketType = vm["input-socket-type"].as<string>();
   }
@@ -185,13 +289,37 @@ int main(int argc, char** argv)
 
   LOG(INFO) << "PID: " << getpid();
 
-  FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+  AliceO2::Devices::Placement& placement = AliceO2::Devices::Placement::Default();
+  if (!placement.Configure(options.cpusMain, options.cpusIo, options.cpusHelper, options.numaNode)) {
+    return 1;
+  }
+
+  FairMQTransportFactory* transportFactory;
+  if (options.transport == "shmem") {
+    // payloads in shared memory, handles and everything for other nodes over zeromq
+    transportFactory = new AliceO2::Shmem::TransportFactory(new FairMQTransportFactoryZMQ(), options.shmSegment,
+                                                            static_cast<size_t>(options.shmSizeInMB) << 20, options.shmAllLocal);
+  } else if (options.transport == "zeromq") {
+    transportFactory = new FairMQTransportFactoryZMQ();
+  } else {
+    LOG(ERROR) << "Unknown transport " << options.transport;
+    return 1;
+  }
 
   sampler.SetTransport(transportFactory);
 
   sampler.SetProperty(FLPexSampler::Id, options.id);
   sampler.SetProperty(FLPexSampler::NumIoThreads, options.ioThreads);
   sampler.SetProperty(FLPexSampler::EventRate, options.eventRate);
+  sampler.SetProperty(FLPexSampler::Arrival, options.arrival);
+  sampler.SetProperty(FLPexSampler::BurstSize, options.burstSize);
+  sampler.SetProperty(FLPexSampler::BurstOn, options.burstOn);
+  sampler.SetProperty(FLPexSampler::BurstOff, options.burstOff);
+  sampler.SetProperty(FLPexSampler::MaxInFlight, options.maxInFlight);
+  sampler.SetProperty(FLPexSampler::HistogramInterval, options.histogramInterval);
+  sampler.SetProperty(FLPexSampler::StartDelay, options.startDelay);
+  sampler.SetProperty(FLPexSampler::NumTimeframes, options.numTimeframes);
+  sampler.SetProperty(FLPexSampler::BatchEvents, options.batchEvents);
 
   sampler.SetProperty(FLPexSampler::NumInputs, 1);
   sampler.SetProperty(FLPexSampler::NumOutputs, 1);
@@ -210,6 +338,8 @@ int main(int argc, char** argv)
   sampler.SetProperty(FLPexSampler::OutputAddress, initialOutputAddress);
   sampler.SetProperty(FLPexSampler::LogOutputRate, options.logOutputRate);
 
+  // the transport starts its I/O threads with the first socket, they inherit the CPUs of this thread.
+  placement.EnterIoScope();
   sampler.ChangeState(FLPexSampler::SETOUTPUT);
   sampler.ChangeState(FLPexSampler::SETINPUT);
   sampler.ChangeState(FLPexSampler::BIND);
@@ -221,7 +351,9 @@ int main(int argc, char** argv)
   ddsKeyValue.putValue("testFLPSamplerInputAddress", sampler.GetProperty(FLPexSampler::InputAddress, "", 0));
 
   sampler.ChangeState(FLPexSampler::CONNECT);
+  placement.EnterMainScope();
   sampler.ChangeState(FLPexSampler::RUN);
+  placement.Report();
 
   // wait until the running thread has finished processing.
   boost::unique_lock<boost::mutex> lock(sampler.fRunningMutex);
@@ -20,12 +20,17 @@
 
 O2FLPex::O2FLPex() :
   fEventSize(10000),
-  fHeartbeatTimeoutInMs(20000)
+  fHeartbeatTimeoutInMs(20000),
+  fOutputHeartbeat(),
+  fPayload(NULL)
 {
 }
 
 O2FLPex::~O2FLPex()
 {
+  if (fPayload) {
+    fPayload->Unref();
+  }
 }
 
 void O2FLPex::Init()
@@ -37,6 +42,29 @@ void O2FLPex::Init()
   for (int i = 0; i < fNumOutputs; ++i) {
     fOutputHeartbeat.push_back(nullTime);
   }
+
+  srand(time(NULL));
+
+  stringstream ss(fId);
+
+  int Flp_id;
+  ss >> Flp_id;
+
+  fPayload = AliceO2::Devices::SharedBuffer::Create(fEventSize * sizeof(Content));
+  if (!fPayload) {
+    throw runtime_error("Could not allocate the payload");
+  }
+
+  Content* payload = static_cast<Content*>(fPayload->GetData());
+  for (int i = 0; i < fEventSize; ++i) {
+        (&payload[i])->id = Flp_id;
+        (&payload[i])->x = rand() % 100 + 1;
+        (&payload[i])->y = rand() % 100 + 1;
+        (&payload[i])->z = rand() % 100 + 1;
+        (&payload[i])->a = (rand() % 100 + 1) / (rand() % 100 + 1);
+        (&payload[i])->b = (rand() % 100 + 1) / (rand() % 100 + 1);
+        // LOG(INFO) << (&payload[i])->id << " " << (&payload[i])->x << " " << (&payload[i])->y << " " << (&payload[i])->z << " " << (&payload[i])->a << " " << (&payload[i])->b;
+  }
 }
 
 bool O2FLPex::updateIPHeartbeat (string str)
@@ -71,26 +99,6 @@ void O2FLPex::Run()
 
   boost::thread rateLogger (boost::bind(&FairMQDevice::LogSocketRates, this));
 
-  srand(time(NULL));
- 
-  stringstream ss(fId);
-
-  int Flp_id;
-  ss >> Flp_id;
-
-  Content* payload = new Content[fEventSize];
-  for (int i = 0; i < fEventSize; ++i) {
-        (&payload[i])->id = Flp_id;
-        (&payload[i])->x = rand() % 100 + 1;
-        (&payload[i])->y = rand() % 100 + 1;
-        (&payload[i])->z = rand() % 100 + 1;
-        (&payload[i])->a = (rand() % 100 + 1) / (rand() % 100 + 1);
-        (&payload[i])->b = (rand() % 100 + 1) / (rand() % 100 + 1);
-        // LOG(INFO) << (&payload[i])->id << " " << (&payload[i])->x << " " << (&payload[i])->y << " " << (&payload[i])->z << " " << (&payload[i])->a << " " << (&payload[i])->b;
-  }
-
-  delete[] payload;
-  
   while ( fState == RUNNING ) {
     // Receive heartbeat
     FairMQMessage* heartbeatMsg = fTransportFactory->CreateMessage();
@@ -116,9 +124,9 @@ void O2FLPex::Run()
       }
       
       // LOG(INFO) << "Pubishing payload to EPN " << i;
-      FairMQMessage* payloadMsg = fTransportFactory->CreateMessage(fEventSize * sizeof(Content));
-      memcpy(payloadMsg->GetData(), payload, fEventSize * sizeof(Content));
-      
+      // all EPNs get a message over the same payload, no copy per destination.
+      FairMQMessage* payloadMsg = fPayload->CreateMessage(fTransportFactory);
+
       fPayloadOutputs->at(i)->Send(payloadMsg);
       
       delete payloadMsg;
@@ -12,6 +12,8 @@
 
 #include "FairMQDevice.h"
 
+#include "SharedBuffer.h"
+
 struct Content {
   int id;
   double a;
@@ -50,6 +52,8 @@ class O2FLPex: public FairMQDevice
 
   private:
     vector<boost::posix_time::ptime> fOutputHeartbeat;
+    /// the payload, referenced by the messages to all EPNs
+    AliceO2::Devices::SharedBuffer* fPayload;
     bool updateIPHeartbeat (string str);
 };
 
@@ -0,0 +1,248 @@
+/**
+ * benchmarkFanout.cxx
+ *
+ * Sends one payload to N EPN sockets, either as a fresh message with a copy
+ * of the payload per EPN, as O2FLPex did before, or as zero-copy messages
+ * over one SharedBuffer, as it does now. Every EPN is a pull socket drained
+ * by its own thread. Reports the delivered rate, the bytes the sender
+ * copied and the CPU time the sender spent per payload, for every EPN
+ * count.
+ *
+ * @since 2026-10-17
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstring>
+
+#include <sys/resource.h>
+
+#include "boost/program_options.hpp"
+
+#include "FairMQLogger.h"
+#include "FairMQTransportFactoryZMQ.h"
+
+#include "SharedBuffer.h"
+
+using namespace std;
+
+using namespace AliceO2::Devices;
+
+typedef struct BenchmarkOptions
+{
+  string mode;
+  vector<int> numEPNs;
+  int eventSize;
+  int numPayloads;
+  string transport;
+  int basePort;
+} BenchmarkOptions_t;
+
+struct Result
+{
+  int numEPNs;
+  string mode;
+  double seconds;
+  double senderSeconds;
+  double bytes;
+  double copied;
+  unsigned long messages;
+};
+
+inline bool parse_cmd_line(int _argc, char* _argv[], BenchmarkOptions* _options)
+{
+  if (_options == NULL)
+    throw runtime_error("Internal error: options' container is empty.");
+
+  namespace bpo = boost::program_options;
+  bpo::options_description desc("Options");
+  desc.add_options()
+    ("mode", bpo::value<string>()->default_value("both"), "Fan-out to benchmark: copy/shared/both")
+    ("num-epns", bpo::value< vector<int> >()->multitoken(), "EPN counts to run, default 1 2 4 8 16 32")
+    ("event-size", bpo::value<int>()->default_value(1 << 20), "Payload size in bytes")
+    ("num-payloads", bpo::value<int>()->default_value(2000), "Payloads sent to every EPN")
+    ("transport", bpo::value<string>()->default_value("inproc"), "Sockets between sender and EPNs: inproc/tcp")
+    ("base-port", bpo::value<int>()->default_value(5700), "tcp: port of the first EPN, the others follow")
+    ("help", "Print help messages");
+
+  bpo::variables_map vm;
+  bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+  if (vm.count("help")) {
+    LOG(INFO) << "Fan-out benchmark" << endl << desc;
+    return false;
+  }
+
+  bpo::notify(vm);
+
+  _options->mode = vm["mode"].as<string>();
+  if (vm.count("num-epns")) {
+    _options->numEPNs = vm["num-epns"].as<vector<int>>();
+  } else {
+    _options->numEPNs = { 1, 2, 4, 8, 16, 32 };
+  }
+  _options->eventSize = vm["event-size"].as<int>();
+  _options->numPayloads = vm["num-payloads"].as<int>();
+  _options->transport = vm["transport"].as<string>();
+  _options->basePort = vm["base-port"].as<int>();
+
+  return true;
+}
+
+/// CPU time of the calling thread in seconds
+static double threadCpuSeconds()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_THREAD, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static void receiveEPN(FairMQSocket* socket, FairMQTransportFactory* factory, int numPayloads, double* bytes)
+{
+  FairMQMessage* msg = factory->CreateMessage();
+  for (int i = 0; i < numPayloads; ++i) {
+    if (socket->Receive(msg) > 0) {
+      *bytes += msg->GetSize();
+    }
+    msg->Rebuild();
+  }
+  delete msg;
+}
+
+static Result run(const string& mode, int numEPNs, const BenchmarkOptions& options, FairMQTransportFactory* factory)
+{
+  static int runNumber = 0;
+  ++runNumber;
+
+  Result result;
+  result.numEPNs = numEPNs;
+  result.mode = mode;
+  result.copied = 0.;
+  result.messages = 0;
+
+  bool shared = mode == "shared";
+
+  vector<FairMQSocket*> epns;
+  vector<FairMQSocket*> outputs;
+  for (int i = 0; i < numEPNs; ++i) {
+    stringstream address;
+    if (options.transport == "tcp") {
+      address << "tcp://127.0.0.1:" << options.basePort + i;
+    } else {
+      address << "inproc://benchmark-fanout-" << runNumber << "-" << i;
+    }
+    epns.push_back(factory->CreateSocket("pull", i, 1));
+    epns.back()->Bind(address.str());
+    outputs.push_back(factory->CreateSocket("push", i, 1));
+    outputs.back()->Connect(address.str());
+  }
+
+  // the payload O2FLPex prepares once in Init().
+  SharedBuffer* payload = SharedBuffer::Create(options.eventSize);
+  memset(payload->GetData(), 0x5a, options.eventSize);
+
+  vector<double> bytes(numEPNs, 0.);
+  vector<thread> receivers;
+  for (int i = 0; i < numEPNs; ++i) {
+    receivers.push_back(thread(receiveEPN, epns[i], factory, options.numPayloads, &bytes[i]));
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  double cpuStart = threadCpuSeconds();
+
+  for (int n = 0; n < options.numPayloads; ++n) {
+    for (int i = 0; i < numEPNs; ++i) {
+      FairMQMessage* msg;
+      if (shared) {
+        msg = payload->CreateMessage(factory);
+      } else {
+        msg = factory->CreateMessage(options.eventSize);
+        memcpy(msg->GetData(), payload->GetData(), options.eventSize);
+        result.copied += options.eventSize;
+      }
+      outputs[i]->Send(msg);
+      delete msg;
+      ++result.messages;
+    }
+  }
+
+  result.senderSeconds = threadCpuSeconds() - cpuStart;
+
+  for (size_t i = 0; i < receivers.size(); ++i) {
+    receivers[i].join();
+  }
+
+  result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  result.bytes = 0.;
+  for (int i = 0; i < numEPNs; ++i) {
+    result.bytes += bytes[i];
+  }
+
+  for (int i = 0; i < numEPNs; ++i) {
+    outputs[i]->Close();
+    delete outputs[i];
+    epns[i]->Close();
+    delete epns[i];
+  }
+  payload->Unref();
+
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  BenchmarkOptions_t options;
+  try {
+    if (!parse_cmd_line(argc, argv, &options))
+      return 0;
+  } catch (const exception& e) {
+    LOG(ERROR) << e.what();
+    return 1;
+  }
+
+  vector<string> modes;
+  if (options.mode == "both" || options.mode == "copy") {
+    modes.push_back("copy");
+  }
+  if (options.mode == "both" || options.mode == "shared") {
+    modes.push_back("shared");
+  }
+  if (modes.empty() || (options.transport != "inproc" && options.transport != "tcp")) {
+    LOG(ERROR) << "Unknown mode " << options.mode << " or transport " << options.transport;
+    return 1;
+  }
+
+  // one factory, so that all sockets share the context that inproc needs.
+  FairMQTransportFactory* factory = new FairMQTransportFactoryZMQ();
+
+  vector<Result> results;
+  for (size_t n = 0; n < options.numEPNs.size(); ++n) {
+    for (size_t m = 0; m < modes.size(); ++m) {
+      results.push_back(run(modes[m], options.numEPNs[n], options, factory));
+    }
+  }
+
+  cout << endl
+       << setw(6) << "EPNs" << setw(8) << "mode"
+       << setw(14) << "payloads/s" << setw(10) << "GB/s"
+       << setw(16) << "copied MB/pl" << setw(16) << "sender us/pl" << endl;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    double seconds = r.seconds > 0. ? r.seconds : 1e-9;
+    double payloads = options.numPayloads;
+    cout << setw(6) << r.numEPNs << setw(8) << r.mode
+         << setw(14) << fixed << setprecision(0) << payloads / seconds
+         << setw(10) << setprecision(2) << r.bytes / seconds / 1e9
+         << setw(16) << setprecision(2) << r.copied / payloads / 1e6
+         << setw(16) << setprecision(1) << r.senderSeconds / payloads * 1e6 << endl;
+  }
+
+  delete factory;
+
+  return 0;
+}
@@ -10,6 +10,7 @@
 
 #include "O2EPNex.h"
 #include "FairMQLogger.h"
+#include "EventBatch.h"
 
 O2EPNex::O2EPNex()
 {
@@ -21,10 +22,18 @@ void O2EPNex::Run()
 
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
 
+  unsigned long numMessages = 0;
+  unsigned long numEvents = 0;
+
   while ( fState == RUNNING ) {
     FairMQMessage* msg = fTransportFactory->CreateMessage();
 
-    fPayloadInputs->at(0)->Receive(msg);
+    if (fPayloadInputs->at(0)->Receive(msg) > 0) {
+      ++numMessages;
+      // a message from a batching FLP packs many events, any other one is a single event.
+      AliceO2::Devices::EventBatch batch(msg->GetData(), msg->GetSize());
+      numEvents += batch.IsValid() ? batch.GetNumEvents() : 1;
+    }
 
     int inputSize = msg->GetSize();
     int numInput = inputSize / sizeof(Content);
@@ -37,6 +46,8 @@ void O2EPNex::Run()
     delete msg;
   }
 
+  LOG(INFO) << "Received " << numEvents << " events in " << numMessages << " messages";
+
   rateLogger.interrupt();
   rateLogger.join();
 
@@ -10,6 +10,9 @@
 
 #include "O2EpnMerger.h"
 #include "FairMQLogger.h"
+#include "Metrics.h"
+
+using namespace AliceO2;
 
 O2EpnMerger::O2EpnMerger()
 {
@@ -20,48 +23,18 @@ void O2EpnMerger::Run()
   LOG(INFO) << ">>>>>>> Run <<<<<<<";
 
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
-    //--------------------
-    
-  FairMQPoller* poller = fTransportFactory->CreatePoller(*fPayloadInputs);
-    
-  bool received = false;
-  int NoOfMsgParts=fNumInputs-1;
-    
-  while ( fState == RUNNING ) {
-    FairMQMessage* msg = fTransportFactory->CreateMessage();
-    poller->Poll(100);
-        for(int i = 0; i < fNumInputs; i++) {
-            if (poller->CheckInput(i)){
-                received = fPayloadInputs->at(i)->Receive(msg);
-                // LOG(INFO) << "------ recieve Msg from " << i ;
-            }
-            if (received) {
-                if(i<NoOfMsgParts){
-                    fPayloadOutputs->at(0)->Send(msg, "snd-more");
-                    //    LOG(INFO) << "------ Send  Msg Part " << i ;
-                }else{
-                    fPayloadOutputs->at(0)->Send(msg);
-                    //    LOG(INFO) << "------ Send  last Msg Part " << i ;
-                }
-                received = false;
-            }
-        }
-        
-        delete msg;
-    }
-    
-    delete poller;
-    
-    rateLogger.interrupt();
-    rateLogger.join();
-//--------------------
-    
-    
-    
-  while ( fState == RUNNING ) {
-    FairMQMessage* msg = fTransportFactory->CreateMessage();
 
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  Metrics::Counter& partsMetric = metrics.AddCounter("o2_merger_parts_total", "Message parts received", Metrics::DeviceLabel(fId));
+  Metrics::Counter& bytesMetric = metrics.AddCounter("o2_merger_bytes_total", "Bytes received", Metrics::DeviceLabel(fId));
+
+  // merging the inputs by timeframe is done by the TimeframeMerger device, this one only consumes.
+  FairMQMessage* msg = fTransportFactory->CreateMessage();
+
+  while ( fState == RUNNING ) {
     fPayloadInputs->at(0)->Receive(msg);
+    partsMetric.Increment();
+    bytesMetric.Increment(msg->GetSize());
 
     int inputSize = msg->GetSize();
     int numInput = inputSize / sizeof(Content);
@@ -71,9 +44,11 @@ void O2EpnMerger::Run()
     //     LOG(INFO) << (&input[i])->x << " " << (&input[i])->y << " " << (&input[i])->z << " " << (&input[i])->a << " " << (&input[i])->b;
     // }
 
-    delete msg;
+    msg->Rebuild();
   }
 
+  delete msg;
+
   rateLogger.interrupt();
   rateLogger.join();
 
@@ -6,7 +6,8 @@
  */
 
 #include <vector>
-#include <stdlib.h>     /* srand, rand */
+#include <sstream>
+#include <algorithm>
 #include <time.h>       /* time */
 
 #include <boost/thread.hpp>
@@ -14,10 +15,17 @@
 
 #include "O2FLPex.h"
 #include "FairMQLogger.h"
+#include "EventBatch.h"
 
 
 O2FLPex::O2FLPex() :
-  fEventSize(10000)
+  fEventSize(10000),
+  fPayloadSizes(),
+  fPayloadBuffers(8),
+  fPayloadRefresh(0),
+  fBatchEvents(1),
+  fBatchBytes(0),
+  fPayloadGenerator()
 {
 }
 
@@ -28,6 +36,17 @@ O2FLPex::~O2FLPex()
 void O2FLPex::Init()
 {
   FairMQDevice::Init();
+
+  string sizes = fPayloadSizes;
+  if (sizes.empty()) {
+    stringstream ss;
+    ss << "fixed:" << fEventSize * sizeof(Content);
+    sizes = ss.str();
+  }
+
+  if (!fPayloadGenerator.Init(sizes, fPayloadBuffers, fPayloadRefresh, time(NULL))) {
+    throw runtime_error("Invalid payload configuration: " + sizes);
+  }
 }
 
 void O2FLPex::Run()
@@ -37,32 +56,23 @@ void O2FLPex::Run()
 
   boost::thread rateLogger(boost::bind(&FairMQDevice::LogSocketRates, this));
 
-  srand(time(NULL));
+  LOG(DEBUG) << "Mean message size: " << fPayloadGenerator.GetMeanSize() << " bytes.";
 
-  LOG(DEBUG) << "Message size: " << fEventSize * sizeof(Content) << " bytes.";
+  if (fBatchEvents > 1) {
+    runBatched();
+  } else {
+    // the payloads are prepared in Init(), every message only references one of them.
+    while ( fState == RUNNING ) {
+      FairMQMessage* msg = fPayloadGenerator.CreateMessage(fTransportFactory);
 
-  while ( fState == RUNNING ) {
-
-    Content* payload = new Content[fEventSize];
+      fPayloadOutputs->at(0)->Send(msg);
 
-    for (int i = 0; i < fEventSize; ++i) {
-      (&payload[i])->x = rand() % 100 + 1;
-      (&payload[i])->y = rand() % 100 + 1;
-      (&payload[i])->z = rand() % 100 + 1;
-      (&payload[i])->a = (rand() % 100 + 1) / (rand() % 100 + 1);
-      (&payload[i])->b = (rand() % 100 + 1) / (rand() % 100 + 1);
-      // LOG(INFO) << (&payload[i])->x << " " << (&payload[i])->y << " " << (&payload[i])->z << " " << (&payload[i])->a << " " << (&payload[i])->b;
+      delete msg;
     }
-
-    FairMQMessage* msg = fTransportFactory->CreateMessage(fEventSize * sizeof(Content));
-    memcpy(msg->GetData(), payload, fEventSize * sizeof(Content));
-
-    fPayloadOutputs->at(0)->Send(msg);
-
-    delete[] payload;
-    delete msg;
   }
 
+  LOG(INFO) << "Sent " << fPayloadGenerator.GetNumMessages() << " payloads, " << fPayloadGenerator.GetNumRefreshed() << " buffer refreshes";
+
   rateLogger.interrupt();
 
   rateLogger.join();
@@ -75,6 +85,35 @@ void O2FLPex::Run()
   fRunningCondition.notify_one();
 }
 
+void O2FLPex::runBatched()
+{
+  LOG(INFO) << "Packing " << fBatchEvents << " payloads into a message"
+            << (fBatchBytes > 0 ? ", at most " + to_string(fBatchBytes) + " bytes" : string(""));
+
+  AliceO2::Devices::EventBatchBuilder batch;
+  batch.Init(fBatchEvents, max(fBatchBytes, 0));
+
+  FairMQMessage* batchMsg = fTransportFactory->CreateMessage();
+
+  while ( fState == RUNNING ) {
+    FairMQMessage* msg = fPayloadGenerator.CreateMessage(fTransportFactory);
+
+    if (!batch.Fits(msg->GetSize())) {
+      batch.Flush(batchMsg);
+      fPayloadOutputs->at(0)->Send(batchMsg);
+    }
+    batch.Add(msg->GetData(), msg->GetSize());
+    delete msg;
+
+    if (batch.IsFull()) {
+      batch.Flush(batchMsg);
+      fPayloadOutputs->at(0)->Send(batchMsg);
+    }
+  }
+
+  delete batchMsg;
+}
+
 void O2FLPex::Log(int intervalInMs)
 {
   timestamp_t t0;
@@ -112,6 +151,9 @@ void O2FLPex::Log(int intervalInMs)
 void O2FLPex::SetProperty(const int key, const string& value, const int slot/*= 0*/)
 {
   switch (key) {
+  case PayloadSizes:
+    fPayloadSizes = value;
+    break;
   default:
     FairMQDevice::SetProperty(key, value, slot);
     break;
@@ -121,6 +163,8 @@ void O2FLPex::SetProperty(const int key, const string& value, const int slot/*=
 string O2FLPex::GetProperty(const int key, const string& default_/*= ""*/, const int slot/*= 0*/)
 {
   switch (key) {
+  case PayloadSizes:
+    return fPayloadSizes;
   default:
     return FairMQDevice::GetProperty(key, default_, slot);
   }
@@ -132,6 +176,18 @@ void O2FLPex::SetProperty(const int key, const int value, const int slot/*= 0*/)
   case EventSize:
     fEventSize = value;
     break;
+  case PayloadBuffers:
+    fPayloadBuffers = value;
+    break;
+  case PayloadRefresh:
+    fPayloadRefresh = value;
+    break;
+  case BatchEvents:
+    fBatchEvents = value;
+    break;
+  case BatchBytes:
+    fBatchBytes = value;
+    break;
   default:
     FairMQDevice::SetProperty(key, value, slot);
     break;
@@ -143,6 +199,14 @@ int O2FLPex::GetProperty(const int key, const int default_/*= 0*/, const int slo
   switch (key) {
   case EventSize:
     return fEventSize;
+  case PayloadBuffers:
+    return fPayloadBuffers;
+  case PayloadRefresh:
+    return fPayloadRefresh;
+  case BatchEvents:
+    return fBatchEvents;
+  case BatchBytes:
+    return fBatchBytes;
   default:
     return FairMQDevice::GetProperty(key, default_, slot);
   }
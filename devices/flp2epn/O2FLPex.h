@@ -12,6 +12,8 @@
 
 #include "FairMQDevice.h"
 
+#include "PayloadGenerator.h"
+
 struct Content {
   int id;
   double a;
@@ -27,6 +29,11 @@ class O2FLPex: public FairMQDevice
     enum {
       InputFile = FairMQDevice::Last,
       EventSize,
+      PayloadSizes,
+      PayloadBuffers,
+      PayloadRefresh,
+      BatchEvents,
+      BatchBytes,
       Last
     };
     O2FLPex();
@@ -40,9 +47,16 @@ class O2FLPex: public FairMQDevice
 
   protected:
     int fEventSize;
+    string fPayloadSizes; ///< PayloadGenerator size specification, empty for fEventSize Content structs
+    int fPayloadBuffers;
+    int fPayloadRefresh;
+    int fBatchEvents; ///< payloads packed into one EventBatch message, up to 1 sends each on its own
+    int fBatchBytes; ///< payload bytes per batch, 0 for no limit
+    AliceO2::Devices::PayloadGenerator fPayloadGenerator;
 
     virtual void Init();
     virtual void Run();
+    void runBatched();
 };
 
 #endif
@@ -12,6 +12,7 @@
 
 #include "FairMQLogger.h"
 #include "O2EpnMerger.h"
+#include "MetricsExporter.h"
 
 #ifdef NANOMSG
     #include "FairMQTransportFactoryNN.h"
@@ -22,6 +23,7 @@
 using namespace std;
 
 O2EpnMerger epn;
+AliceO2::Metrics::Exporter metricsExporter;
 
 static void s_signal_handler (int signal)
 {
@@ -48,6 +50,9 @@ typedef struct DeviceOptions
 {
     string id;
     int ioThreads;
+    string metricsTarget;
+    string metricsFormat;
+    int metricsInterval;
     string inputSocketType;
     int inputBufSize;
     string inputMethod;
@@ -64,6 +69,9 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     desc.add_options()
         ("id", bpo::value<string>()->required(), "Device ID")
         ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+        ("metrics-target", bpo::value<string>()->default_value(""), "Export metrics to a file, or serve them on tcp://*:port, empty to disable")
+        ("metrics-format", bpo::value<string>()->default_value("prometheus"), "Format of the metrics snapshots: prometheus/json")
+        ("metrics-interval", bpo::value<int>()->default_value(1000), "Interval in ms between the metrics snapshots written to a file")
         ("input-socket-type", bpo::value<string>()->required(), "Input socket type: sub/pull")
         ("input-buff-size", bpo::value<int>()->required(), "Input buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
         ("input-method", bpo::value<string>()->required(), "Input method: bind/connect")
@@ -87,6 +95,15 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     if ( vm.count("io-threads") )
         _options->ioThreads = vm["io-threads"].as<int>();
 
+    if ( vm.count("metrics-target") )
+        _options->metricsTarget = vm["metrics-target"].as<string>();
+
+    if ( vm.count("metrics-format") )
+        _options->metricsFormat = vm["metrics-format"].as<string>();
+
+    if ( vm.count("metrics-interval") )
+        _options->metricsInterval = vm["metrics-interval"].as<int>();
+
     if ( vm.count("input-socket-type") )
         _options->inputSocketType = vm["input-socket-type"].as<string>();
 
@@ -120,6 +137,14 @@ int main(int argc, char** argv)
 
     LOG(INFO) << "PID: " << getpid();
 
+    AliceO2::Metrics::Exporter::Format metricsFormat;
+    if (!AliceO2::Metrics::Exporter::ParseFormat(options.metricsFormat, metricsFormat))
+    {
+        LOG(ERROR) << "Unknown metrics format " << options.metricsFormat;
+        return 1;
+    }
+    metricsExporter.Start(options.metricsTarget, metricsFormat, options.metricsInterval);
+
 #ifdef NANOMSG
     FairMQTransportFactory* transportFactory = new FairMQTransportFactoryNN();
 #else
@@ -48,6 +48,11 @@ typedef struct DeviceOptions
 {
     string id;
     int eventSize;
+    string payloadSizes;
+    int payloadBuffers;
+    int payloadRefresh;
+    int batchEvents;
+    int batchBytes;
     int ioThreads;
     string outputSocketType;
     int outputBufSize;
@@ -65,6 +70,11 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     desc.add_options()
         ("id", bpo::value<string>()->required(), "Device ID")
         ("event-size", bpo::value<int>()->default_value(1000), "Event size in bytes")
+        ("payload-sizes", bpo::value<string>()->default_value(""), "Payload sizes: fixed:<bytes>, lognormal:<mean>:<deviation>[:<max>] or trace:<file>, overrides event-size")
+        ("payload-buffers", bpo::value<int>()->default_value(8), "Number of pre-generated payload buffers")
+        ("payload-refresh", bpo::value<int>()->default_value(0), "Refill a payload buffer with new data after this many uses, 0 to never refill")
+        ("batch-events", bpo::value<int>()->default_value(1), "Payloads packed into one message, 1 sends each on its own")
+        ("batch-bytes", bpo::value<int>()->default_value(0), "Payload bytes packed into one message, 0 for no limit")
         ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
         ("output-socket-type", bpo::value<string>()->required(), "Output socket type: pub/push")
         ("output-buff-size", bpo::value<int>()->required(), "Output buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
@@ -89,6 +99,21 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     if ( vm.count("event-size") )
         _options->eventSize = vm["event-size"].as<int>();
 
+    if ( vm.count("payload-sizes") )
+        _options->payloadSizes = vm["payload-sizes"].as<string>();
+
+    if ( vm.count("payload-buffers") )
+        _options->payloadBuffers = vm["payload-buffers"].as<int>();
+
+    if ( vm.count("payload-refresh") )
+        _options->payloadRefresh = vm["payload-refresh"].as<int>();
+
+    if ( vm.count("batch-events") )
+        _options->batchEvents = vm["batch-events"].as<int>();
+
+    if ( vm.count("batch-bytes") )
+        _options->batchBytes = vm["batch-bytes"].as<int>();
+
     if ( vm.count("io-threads") )
         _options->ioThreads = vm["io-threads"].as<int>();
 
@@ -136,6 +161,11 @@ int main(int argc, char** argv)
     flp.SetProperty(O2FLPex::Id, options.id);
     flp.SetProperty(O2FLPex::NumIoThreads, options.ioThreads);
     flp.SetProperty(O2FLPex::EventSize, options.eventSize);
+    flp.SetProperty(O2FLPex::PayloadSizes, options.payloadSizes);
+    flp.SetProperty(O2FLPex::PayloadBuffers, options.payloadBuffers);
+    flp.SetProperty(O2FLPex::PayloadRefresh, options.payloadRefresh);
+    flp.SetProperty(O2FLPex::BatchEvents, options.batchEvents);
+    flp.SetProperty(O2FLPex::BatchBytes, options.batchBytes);
 
     flp.SetProperty(O2FLPex::NumInputs, 0);
     flp.SetProperty(O2FLPex::NumOutputs, 1);
@@ -0,0 +1,260 @@
+/**
+ * Metrics.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <map>
+#include <stdexcept>
+
+#include "Metrics.h"
+
+using namespace std;
+
+using namespace AliceO2::Metrics;
+
+uint64_t Counter::Get() const
+{
+  uint64_t value = 0;
+  for (unsigned i = 0; i <= kNumShards; ++i) {
+    value += fShards[i].value.load(memory_order_relaxed);
+  }
+  return value;
+}
+
+void Histogram::Collect(vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum) const
+{
+  buckets.assign(kNumBuckets, 0);
+  count = 0;
+  sum = 0;
+  for (unsigned s = 0; s <= kNumShards; ++s) {
+    for (int i = 0; i < kNumBuckets; ++i) {
+      uint64_t n = fShards[s].buckets[i].load(memory_order_relaxed);
+      buckets[i] += n;
+      count += n;
+    }
+    sum += fShards[s].sum.load(memory_order_relaxed);
+  }
+}
+
+Registry::Registry()
+  : fMutex()
+  , fEntries()
+{
+}
+
+Registry::~Registry()
+{
+}
+
+Registry& Registry::Default()
+{
+  static Registry registry;
+  return registry;
+}
+
+Registry::Entry& Registry::Find(const string& name, const string& help, const string& labels, Type type)
+{
+  boost::lock_guard<boost::mutex> lock(fMutex);
+
+  for (size_t i = 0; i < fEntries.size(); ++i) {
+    Entry& entry = *fEntries[i];
+    if (entry.name == name && entry.labels == labels) {
+      if (entry.type != type) {
+        throw runtime_error("metric " + name + " is already registered with a different type");
+      }
+      return entry;
+    }
+  }
+
+  unique_ptr<Entry> entry(new Entry());
+  entry->name = name;
+  entry->help = help;
+  entry->labels = labels;
+  entry->type = type;
+  switch (type) {
+    case kCounter:
+      entry->counter.reset(new Counter());
+      break;
+    case kGauge:
+      entry->gauge.reset(new Gauge());
+      break;
+    case kHistogram:
+      entry->histogram.reset(new Histogram());
+      break;
+  }
+  fEntries.push_back(move(entry));
+  return *fEntries.back();
+}
+
+Counter& Registry::AddCounter(const string& name, const string& help, const string& labels)
+{
+  return *Find(name, help, labels, kCounter).counter;
+}
+
+Gauge& Registry::AddGauge(const string& name, const string& help, const string& labels)
+{
+  return *Find(name, help, labels, kGauge).gauge;
+}
+
+Histogram& Registry::AddHistogram(const string& name, const string& help, const string& labels)
+{
+  return *Find(name, help, labels, kHistogram).histogram;
+}
+
+uint64_t Registry::SumCounter(const string& name) const
+{
+  boost::lock_guard<boost::mutex> lock(fMutex);
+
+  uint64_t value = 0;
+  for (size_t i = 0; i < fEntries.size(); ++i) {
+    const Entry& entry = *fEntries[i];
+    if (entry.type == kCounter && entry.name == name) {
+      value += entry.counter->Get();
+    }
+  }
+  return value;
+}
+
+void Registry::CollectHistogram(const string& name, vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum) const
+{
+  boost::lock_guard<boost::mutex> lock(fMutex);
+
+  buckets.assign(Histogram::kNumBuckets, 0);
+  count = 0;
+  sum = 0;
+
+  vector<uint64_t> b;
+  uint64_t c = 0;
+  uint64_t s = 0;
+  for (size_t i = 0; i < fEntries.size(); ++i) {
+    const Entry& entry = *fEntries[i];
+    if (entry.type == kHistogram && entry.name == name) {
+      entry.histogram->Collect(b, c, s);
+      for (int j = 0; j < Histogram::kNumBuckets; ++j) {
+        buckets[j] += b[j];
+      }
+      count += c;
+      sum += s;
+    }
+  }
+}
+
+namespace {
+
+string WithLabels(const string& name, const string& labels, const string& extra = "")
+{
+  if (labels.empty() && extra.empty()) {
+    return name;
+  }
+  return name + "{" + labels + (!labels.empty() && !extra.empty() ? "," : "") + extra + "}";
+}
+
+string Escape(const string& s)
+{
+  string escaped;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '"' || s[i] == '\\') {
+      escaped += '\\';
+    }
+    escaped += s[i];
+  }
+  return escaped;
+}
+
+} // namespace
+
+void Registry::WritePrometheus(ostream& out) const
+{
+  boost::lock_guard<boost::mutex> lock(fMutex);
+
+  // the format wants all series of one metric together, under a single HELP and TYPE line.
+  multimap<string, const Entry*> byName;
+  for (size_t i = 0; i < fEntries.size(); ++i) {
+    byName.insert(make_pair(fEntries[i]->name, fEntries[i].get()));
+  }
+
+  string previous;
+  vector<uint64_t> buckets;
+
+  for (auto it = byName.begin(); it != byName.end(); ++it) {
+    const Entry& entry = *it->second;
+
+    if (entry.name != previous) {
+      static const char* types[] = { "counter", "gauge", "histogram" };
+      out << "# HELP " << entry.name << " " << entry.help << "\n";
+      out << "# TYPE " << entry.name << " " << types[entry.type] << "\n";
+      previous = entry.name;
+    }
+
+    switch (entry.type) {
+      case kCounter:
+        out << WithLabels(entry.name, entry.labels) << " " << entry.counter->Get() << "\n";
+        break;
+      case kGauge:
+        out << WithLabels(entry.name, entry.labels) << " " << entry.gauge->Get() << "\n";
+        break;
+      case kHistogram: {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        entry.histogram->Collect(buckets, count, sum);
+
+        int last = Histogram::kNumBuckets - 1;
+        while (last > 0 && buckets[last] == 0) {
+          --last;
+        }
+        uint64_t cumulative = 0;
+        for (int i = 0; i <= last; ++i) {
+          cumulative += buckets[i];
+          out << WithLabels(entry.name + "_bucket", entry.labels, "le=\"" + to_string(Histogram::UpperBound(i)) + "\"")
+              << " " << cumulative << "\n";
+        }
+        out << WithLabels(entry.name + "_bucket", entry.labels, "le=\"+Inf\"") << " " << count << "\n";
+        out << WithLabels(entry.name + "_sum", entry.labels) << " " << sum << "\n";
+        out << WithLabels(entry.name + "_count", entry.labels) << " " << count << "\n";
+        break;
+      }
+    }
+  }
+}
+
+void Registry::WriteJSON(ostream& out) const
+{
+  boost::lock_guard<boost::mutex> lock(fMutex);
+
+  vector<uint64_t> buckets;
+
+  out << "{\"metrics\":[";
+  for (size_t i = 0; i < fEntries.size(); ++i) {
+    const Entry& entry = *fEntries[i];
+
+    out << (i > 0 ? "," : "") << "\n{\"name\":\"" << entry.name << "\",\"labels\":\"" << Escape(entry.labels) << "\"";
+    switch (entry.type) {
+      case kCounter:
+        out << ",\"type\":\"counter\",\"value\":" << entry.counter->Get();
+        break;
+      case kGauge:
+        out << ",\"type\":\"gauge\",\"value\":" << entry.gauge->Get();
+        break;
+      case kHistogram: {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        entry.histogram->Collect(buckets, count, sum);
+
+        // only the non-empty buckets, as pairs of upper bound and count.
+        out << ",\"type\":\"histogram\",\"count\":" << count << ",\"sum\":" << sum << ",\"buckets\":[";
+        bool first = true;
+        for (int b = 0; b < Histogram::kNumBuckets; ++b) {
+          if (buckets[b] > 0) {
+            out << (first ? "" : ",") << "[" << Histogram::UpperBound(b) << "," << buckets[b] << "]";
+            first = false;
+          }
+        }
+        out << "]";
+        break;
+      }
+    }
+    out << "}";
+  }
+  out << "\n]}\n";
+}
@@ -0,0 +1,192 @@
+/**
+ * Metrics.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_METRICS_METRICS_H_
+#define ALICEO2_METRICS_METRICS_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <cstdint>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace AliceO2 {
+namespace Metrics {
+
+/// Number of thread-owned shards of counters and histograms. The first
+/// kNumShards threads that update a metric each own a shard, which they update
+/// with a plain load and store of their own cache line. Any further threads
+/// share one extra shard and pay for an atomic add.
+static const unsigned kNumShards = 16;
+
+/// shard of the calling thread, kNumShards for the shared one
+inline unsigned ThreadShard()
+{
+  static std::atomic<unsigned> next(0);
+  static thread_local unsigned shard = next.fetch_add(1, std::memory_order_relaxed);
+  return shard < kNumShards ? shard : kNumShards;
+}
+
+/// add to a sharded value, non-atomically if the calling thread owns the shard
+inline void AddToShard(std::atomic<uint64_t>& value, unsigned shard, uint64_t n)
+{
+  if (shard < kNumShards) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  } else {
+    value.fetch_add(n, std::memory_order_relaxed);
+  }
+}
+
+/// Monotonic counter, e.g. messages or bytes sent.
+class Counter
+{
+  public:
+    Counter() : fShards() {}
+
+    void Increment(uint64_t n = 1)
+    {
+      unsigned shard = ThreadShard();
+      AddToShard(fShards[shard].value, shard, n);
+    }
+
+    uint64_t Get() const;
+
+  private:
+    Counter(const Counter&);
+    Counter& operator=(const Counter&);
+
+    struct Shard
+    {
+      std::atomic<uint64_t> value;
+      char padding[64 - sizeof(std::atomic<uint64_t>)];
+      Shard() : value(0) {}
+    };
+
+    Shard fShards[kNumShards + 1];
+};
+
+/// Current value of a quantity that goes up and down, e.g. a buffer depth.
+/// Usually written by a single thread, so it is not sharded.
+class Gauge
+{
+  public:
+    Gauge() : fValue(0) {}
+
+    void Set(int64_t value) { fValue.store(value, std::memory_order_relaxed); }
+    void Add(int64_t delta) { fValue.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t Get() const { return fValue.load(std::memory_order_relaxed); }
+
+  private:
+    Gauge(const Gauge&);
+    Gauge& operator=(const Gauge&);
+
+    std::atomic<int64_t> fValue;
+};
+
+/// Histogram with power of two buckets: bucket 0 counts zeros, bucket i the
+/// values in [2^(i-1), 2^i). Coarse, but an update is a bit scan and two
+/// additions, cheap enough for every message. Use LatencyHistogram where
+/// precise percentiles are needed.
+class Histogram
+{
+  public:
+    static const int kNumBuckets = 65;
+
+    Histogram() : fShards() {}
+
+    void Observe(uint64_t value)
+    {
+      unsigned shard = ThreadShard();
+      AddToShard(fShards[shard].buckets[value == 0 ? 0 : 64 - __builtin_clzll(value)], shard, 1);
+      AddToShard(fShards[shard].sum, shard, value);
+    }
+
+    /// counts per bucket summed over the shards, and their total and sum
+    void Collect(std::vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum) const;
+
+    /// highest value counted in bucket i
+    static uint64_t UpperBound(int i) { return i == 0 ? 0 : (i == 64 ? UINT64_MAX : (1ULL << i) - 1); }
+
+  private:
+    Histogram(const Histogram&);
+    Histogram& operator=(const Histogram&);
+
+    struct Shard
+    {
+      std::atomic<uint64_t> buckets[kNumBuckets];
+      std::atomic<uint64_t> sum;
+      char padding[64 - (kNumBuckets + 1) * sizeof(std::atomic<uint64_t>) % 64];
+      Shard() : sum(0) { for (int i = 0; i < kNumBuckets; ++i) { buckets[i] = 0; } }
+    };
+
+    Shard fShards[kNumShards + 1];
+};
+
+/// the label that distinguishes the metrics of several devices in one process
+inline std::string DeviceLabel(const std::string& id)
+{
+  return "device=\"" + id + "\"";
+}
+
+/// Named metrics of a process. Registration takes a lock and returns a
+/// reference that stays valid for the lifetime of the registry, the devices
+/// keep it and update the metric without any lookup. Registering the same name
+/// and labels twice returns the same metric.
+class Registry
+{
+  public:
+    Registry();
+    ~Registry();
+
+    /// the registry of the process, used by the devices and the exporter
+    static Registry& Default();
+
+    /// labels in the Prometheus syntax without braces, e.g. device="EPN1"
+    Counter& AddCounter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& AddGauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& AddHistogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /// a counter summed over all its labels, e.g. over the devices of the process; 0 if not registered
+    uint64_t SumCounter(const std::string& name) const;
+    /// a histogram merged over all its labels, as Histogram::Collect
+    void CollectHistogram(const std::string& name, std::vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum) const;
+
+    /// snapshot in the Prometheus text exposition format
+    void WritePrometheus(std::ostream& out) const;
+    /// snapshot as one JSON object
+    void WriteJSON(std::ostream& out) const;
+
+  private:
+    Registry(const Registry&);
+    Registry& operator=(const Registry&);
+
+    enum Type { kCounter, kGauge, kHistogram };
+
+    struct Entry
+    {
+      std::string name;
+      std::string help;
+      std::string labels;
+      Type type;
+      std::unique_ptr<Counter> counter;
+      std::unique_ptr<Gauge> gauge;
+      std::unique_ptr<Histogram> histogram;
+    };
+
+    Entry& Find(const std::string& name, const std::string& help, const std::string& labels, Type type);
+
+    mutable boost::mutex fMutex;
+    std::vector<std::unique_ptr<Entry>> fEntries;
+};
+
+} // namespace Metrics
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * MetricsExporter.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <fstream>
+#include <sstream>
+#include <cstdio> // rename
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "FairMQLogger.h"
+
+#include "MetricsExporter.h"
+
+using namespace std;
+
+using namespace AliceO2::Metrics;
+
+Exporter::Exporter(Registry& registry)
+  : fRegistry(registry)
+  , fTarget()
+  , fFormat(Prometheus)
+  , fIntervalInMs(1000)
+  , fListenSocket(-1)
+  , fThread()
+{
+}
+
+Exporter::~Exporter()
+{
+  Stop();
+}
+
+bool Exporter::ParseFormat(const string& name, Format& format)
+{
+  if (name == "prometheus") {
+    format = Prometheus;
+  } else if (name == "json") {
+    format = JSON;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool Exporter::Start(const string& target, Format format, int intervalInMs)
+{
+  Stop();
+
+  if (target.empty()) {
+    return true;
+  }
+
+  fTarget = target;
+  fFormat = format;
+  fIntervalInMs = intervalInMs > 0 ? intervalInMs : 1000;
+
+  if (target.compare(0, 6, "tcp://") == 0) {
+    size_t colon = target.rfind(':');
+    if (colon == string::npos || colon < 6) {
+      LOG(ERROR) << "Metrics target " << target << " has no port";
+      return false;
+    }
+    string host = target.substr(6, colon - 6);
+    string port = target.substr(colon + 1);
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* addresses = NULL;
+    if (getaddrinfo(host == "*" ? NULL : host.c_str(), port.c_str(), &hints, &addresses) != 0 || addresses == NULL) {
+      LOG(ERROR) << "Cannot resolve metrics target " << target;
+      return false;
+    }
+
+    fListenSocket = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+    int reuse = 1;
+    setsockopt(fListenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (fListenSocket < 0
+        || ::bind(fListenSocket, addresses->ai_addr, addresses->ai_addrlen) != 0
+        || listen(fListenSocket, 8) != 0) {
+      LOG(ERROR) << "Cannot listen on metrics target " << target << ": " << strerror(errno);
+      freeaddrinfo(addresses);
+      if (fListenSocket >= 0) {
+        close(fListenSocket);
+      }
+      fListenSocket = -1;
+      return false;
+    }
+    freeaddrinfo(addresses);
+
+    fThread = boost::thread(&Exporter::Serve, this);
+  } else {
+    fThread = boost::thread(&Exporter::WriteFile, this);
+  }
+
+  LOG(INFO) << "Exporting metrics to " << target;
+  return true;
+}
+
+void Exporter::Stop()
+{
+  if (fThread.joinable()) {
+    fThread.interrupt();
+    fThread.join();
+  }
+  if (fListenSocket >= 0) {
+    close(fListenSocket);
+    fListenSocket = -1;
+  }
+}
+
+void Exporter::Write(ostream& out) const
+{
+  if (fFormat == JSON) {
+    fRegistry.WriteJSON(out);
+  } else {
+    fRegistry.WritePrometheus(out);
+  }
+}
+
+void Exporter::WriteFile()
+{
+  string temporary = fTarget + ".tmp";
+
+  while (true) {
+    {
+      ofstream out(temporary.c_str());
+      Write(out);
+    }
+    if (rename(temporary.c_str(), fTarget.c_str()) != 0) {
+      LOG(ERROR) << "Cannot write metrics to " << fTarget << ": " << strerror(errno);
+    }
+
+    try {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(fIntervalInMs));
+    } catch (boost::thread_interrupted&) {
+      break;
+    }
+  }
+
+  // one final snapshot with the values at shutdown.
+  ofstream out(temporary.c_str());
+  Write(out);
+  out.close();
+  rename(temporary.c_str(), fTarget.c_str());
+}
+
+void Exporter::Serve()
+{
+  pollfd listener;
+  listener.fd = fListenSocket;
+  listener.events = POLLIN;
+
+  while (!boost::this_thread::interruption_requested()) {
+    if (poll(&listener, 1, 100) <= 0) {
+      continue;
+    }
+
+    int client = accept(fListenSocket, NULL, NULL);
+    if (client < 0) {
+      continue;
+    }
+
+    // the request is not interpreted, every client gets the current snapshot.
+    pollfd request;
+    request.fd = client;
+    request.events = POLLIN;
+    char buffer[1024];
+    if (poll(&request, 1, 100) > 0) {
+      recv(client, buffer, sizeof(buffer), 0);
+    }
+
+    stringstream body;
+    Write(body);
+    string content = body.str();
+
+    stringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+             << "Content-Type: " << (fFormat == JSON ? "application/json" : "text/plain; version=0.0.4") << "\r\n"
+             << "Content-Length: " << content.size() << "\r\n\r\n"
+             << content;
+    string data = response.str();
+
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t n = send(client, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        break;
+      }
+      sent += n;
+    }
+
+    close(client);
+  }
+}
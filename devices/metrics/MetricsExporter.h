@@ -0,0 +1,62 @@
+/**
+ * MetricsExporter.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_METRICS_METRICSEXPORTER_H_
+#define ALICEO2_METRICS_METRICSEXPORTER_H_
+
+#include <string>
+
+#include <boost/thread.hpp>
+
+#include "Metrics.h"
+
+namespace AliceO2 {
+namespace Metrics {
+
+/// Background thread that publishes snapshots of a registry, either
+///  - written to a file every interval (replaced atomically, so a reader such
+///    as the node exporter's textfile collector never sees a partial file), or
+///  - served on tcp://*:port (or tcp://host:port) to every client that
+///    connects, as a minimal HTTP response, so Prometheus can scrape it directly.
+class Exporter
+{
+  public:
+    enum Format {
+      Prometheus,
+      JSON
+    };
+
+    explicit Exporter(Registry& registry = Registry::Default());
+    ~Exporter();
+
+    /// "prometheus" or "json", false for anything else
+    static bool ParseFormat(const std::string& name, Format& format);
+
+    /// returns false if the target cannot be opened, an empty target does nothing
+    bool Start(const std::string& target, Format format, int intervalInMs);
+    void Stop();
+
+    void Write(std::ostream& out) const;
+
+  private:
+    Exporter(const Exporter&);
+    Exporter& operator=(const Exporter&);
+
+    void WriteFile();
+    void Serve();
+
+    Registry& fRegistry;
+    std::string fTarget;
+    Format fFormat;
+    int fIntervalInMs;
+    int fListenSocket; // -1 when writing to a file
+    boost::thread fThread;
+};
+
+} // namespace Metrics
+} // namespace AliceO2
+
+#endif
@@ -12,53 +12,192 @@
  * @author A. Rybalchenko
  */
 
-#include <map>
-
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include <cmath>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
 
 #include "RoundtripClient.h"
 #include "FairMQLogger.h"
 
 using namespace std;
-using boost::posix_time::ptime;
+using namespace std::chrono;
+using AliceO2::Devices::SharedBuffer;
+using AliceO2::Devices::LatencyHistogram;
 
 RoundtripClient::RoundtripClient()
     : fText()
+    , fMinSize(64)
+    , fMaxSize(1 << 30)
+    , fStepsPerDoubling(1)
+    , fWarmup(100)
+    , fRepetitions(10000)
+    , fDataPerSizeInMB(4096)
+    , fWindow(1)
+    , fZeroCopy(1)
+    , fOutputFormat("table")
+    , fOutputFile()
+    , fTransportName()
+    , fBuffer(NULL)
+{
+}
+
+RoundtripClient::~RoundtripClient()
+{
+    if (fBuffer)
+    {
+        fBuffer->Unref();
+    }
+}
+
+vector<size_t> RoundtripClient::sizes() const
+{
+    vector<size_t> result;
+    double factor = pow(2., 1. / max(fStepsPerDoubling, 1));
+
+    for (double s = max(fMinSize, 1); s <= fMaxSize * (1. + 1e-9); s *= factor)
+    {
+        size_t size = llround(s);
+        if (result.empty() || size != result.back())
+        {
+            result.push_back(size);
+        }
+    }
+
+    return result;
+}
+
+FairMQMessage* RoundtripClient::createRequest(size_t size)
+{
+    if (fZeroCopy)
+    {
+        return fBuffer->CreateMessage(fTransportFactory, size);
+    }
+
+    FairMQMessage* msg = fTransportFactory->CreateMessage(size);
+    memcpy(msg->GetData(), fBuffer->GetData(), size);
+    return msg;
+}
+
+double RoundtripClient::exchange(size_t size, int count, LatencyHistogram* histogram)
 {
+    FairMQSocket* socket = fPayloadOutputs->at(0);
+    FairMQMessage* reply = fTransportFactory->CreateMessage();
+
+    // the replies come in the order of the requests, so the send times form a ring.
+    vector<steady_clock::time_point> sendTimes(fWindow);
+    int sent = 0;
+    int received = 0;
+
+    steady_clock::time_point start = steady_clock::now();
+
+    while (received < count && fState == RUNNING)
+    {
+        while (sent < count && sent - received < fWindow)
+        {
+            FairMQMessage* request = createRequest(size);
+            sendTimes[sent % fWindow] = steady_clock::now();
+            socket->Send(request);
+            delete request;
+            ++sent;
+        }
+
+        socket->Receive(reply);
+        steady_clock::time_point now = steady_clock::now();
+
+        if (histogram)
+        {
+            histogram->Record(duration_cast<nanoseconds>(now - sendTimes[received % fWindow]).count());
+        }
+
+        reply->Rebuild();
+        ++received;
+    }
+
+    double seconds = duration<double>(steady_clock::now() - start).count();
+
+    delete reply;
+
+    return seconds;
 }
 
 void RoundtripClient::Run()
 {
-    ptime startTime;
-    ptime endTime;
+    vector<size_t> sizeList = sizes();
+    string socketType = GetProperty(OutputSocketType, "", 0);
+
+    if (fWindow > 1 && socketType == "req")
+    {
+        LOG(WARN) << "A req socket allows only one request in flight, using a window of 1";
+        fWindow = 1;
+    }
+    fWindow = max(fWindow, 1);
 
-    map<int,int> averageTimes;
+    if (!sizeList.empty())
+    {
+        fBuffer = SharedBuffer::Create(sizeList.back());
+    }
 
-    int size = 0;
+    if (!fBuffer)
+    {
+        LOG(ERROR) << "No sizes to measure or no memory for " << fMaxSize << " bytes";
+    }
+    else
+    {
+        memset(fBuffer->GetData(), 0x5a, fBuffer->GetSize());
 
-    while (size < 20000000)
+        LOG(INFO) << "Round trips of " << sizeList.size() << " sizes from " << sizeList.front() << " to " << sizeList.back()
+                  << " bytes, window " << fWindow << (fZeroCopy ? ", zero-copy" : ", copied");
+    }
+
+    vector<Result> results;
+
+    for (size_t i = 0; fBuffer && i < sizeList.size() && fState == RUNNING; ++i)
     {
-        size += 1000000;
-        void* buffer = operator new[](size);
-        FairMQMessage* msg = fTransportFactory->CreateMessage(buffer, size);
-        FairMQMessage* reply = fTransportFactory->CreateMessage();
+        size_t size = sizeList.at(i);
 
-        startTime = boost::posix_time::microsec_clock::local_time();
+        // large messages are repeated only until the data limit, but often enough for the median.
+        long long repetitions = fRepetitions;
+        if (fDataPerSizeInMB > 0)
+        {
+            repetitions = min(repetitions, max(10LL, fDataPerSizeInMB * 1048576LL / static_cast<long long>(size)));
+        }
 
-        fPayloadOutputs->at(0)->Send(msg);
-        fPayloadOutputs->at(0)->Receive(reply);
+        exchange(size, min(static_cast<long long>(fWarmup), repetitions), NULL);
 
-        endTime = boost::posix_time::microsec_clock::local_time();
+        Result result;
+        result.size = size;
+        result.repetitions = repetitions;
+        result.seconds = exchange(size, repetitions, &result.roundtrip);
 
-        averageTimes[size] = (endTime - startTime).total_microseconds();
+        LOG(INFO) << size << " bytes: median " << result.roundtrip.GetValueAtPercentile(50.) / 1000. << " us, p99 "
+                  << result.roundtrip.GetValueAtPercentile(99.) / 1000. << " us, "
+                  << size * repetitions / result.seconds / 1e9 << " GB/s";
 
-        delete msg;
-        delete reply;
+        results.push_back(result);
     }
 
-    for (auto it = averageTimes.begin(); it != averageTimes.end(); ++it)
+    if (!results.empty())
     {
-        std::cout << it->first << ": " << it->second << " microseconds" << std::endl;
+        if (fOutputFile.empty())
+        {
+            writeResults(cout, results, socketType);
+        }
+        else
+        {
+            ofstream out(fOutputFile.c_str());
+            if (out)
+            {
+                writeResults(out, results, socketType);
+            }
+            else
+            {
+                LOG(ERROR) << "Could not open " << fOutputFile << ", writing the results to stdout";
+                writeResults(cout, results, socketType);
+            }
+        }
     }
 
     FairMQDevice::Shutdown();
@@ -68,6 +207,71 @@ void RoundtripClient::Run()
     fRunningCondition.notify_one();
 }
 
+void RoundtripClient::writeResults(ostream& out, const vector<Result>& results, const string& socketType) const
+{
+    double percentiles[] = { 50., 99., 99.9 };
+
+    if (fOutputFormat == "csv")
+    {
+        out << "transport,socket,window,zero_copy,size,repetitions,mean_us,p50_us,p99_us,p999_us,max_us,msgs_per_s,gbytes_per_s\n";
+    }
+    else if (fOutputFormat == "json")
+    {
+        out << "{\"transport\": \"" << fTransportName << "\", \"socket\": \"" << socketType << "\", \"window\": " << fWindow
+            << ", \"zeroCopy\": " << (fZeroCopy ? "true" : "false") << ", \"results\": [\n";
+    }
+    else
+    {
+        out << setw(12) << "size" << setw(8) << "reps" << setw(12) << "mean us" << setw(12) << "p50 us"
+            << setw(12) << "p99 us" << setw(12) << "p99.9 us" << setw(12) << "max us" << setw(12) << "msg/s" << setw(10) << "GB/s" << "\n";
+    }
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results.at(i);
+        double seconds = r.seconds > 0. ? r.seconds : 1e-9;
+        double rate = r.repetitions / seconds;
+        double throughput = r.size * rate / 1e9;
+
+        if (fOutputFormat == "csv")
+        {
+            out << fTransportName << "," << socketType << "," << fWindow << "," << fZeroCopy << ","
+                << r.size << "," << r.repetitions << "," << fixed << setprecision(3) << r.roundtrip.GetMean() / 1000.;
+            for (int p = 0; p < 3; ++p)
+            {
+                out << "," << r.roundtrip.GetValueAtPercentile(percentiles[p]) / 1000.;
+            }
+            out << "," << r.roundtrip.GetMax() / 1000. << "," << setprecision(1) << rate << "," << setprecision(4) << throughput << "\n";
+        }
+        else if (fOutputFormat == "json")
+        {
+            out << "  {\"size\": " << r.size << ", \"repetitions\": " << r.repetitions
+                << fixed << setprecision(3) << ", \"meanUs\": " << r.roundtrip.GetMean() / 1000.
+                << ", \"p50Us\": " << r.roundtrip.GetValueAtPercentile(50.) / 1000.
+                << ", \"p99Us\": " << r.roundtrip.GetValueAtPercentile(99.) / 1000.
+                << ", \"p999Us\": " << r.roundtrip.GetValueAtPercentile(99.9) / 1000.
+                << ", \"maxUs\": " << r.roundtrip.GetMax() / 1000.
+                << ", \"msgsPerS\": " << setprecision(1) << rate
+                << ", \"gbytesPerS\": " << setprecision(4) << throughput << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        else
+        {
+            out << setw(12) << r.size << setw(8) << r.repetitions << fixed << setprecision(2) << setw(12) << r.roundtrip.GetMean() / 1000.;
+            for (int p = 0; p < 3; ++p)
+            {
+                out << setw(12) << r.roundtrip.GetValueAtPercentile(percentiles[p]) / 1000.;
+            }
+            out << setw(12) << r.roundtrip.GetMax() / 1000. << setw(12) << setprecision(0) << rate << setw(10) << setprecision(3) << throughput << "\n";
+        }
+    }
+
+    if (fOutputFormat == "json")
+    {
+        out << "]}\n";
+    }
+
+    out.flush();
+}
 
 void RoundtripClient::SetProperty(const int key, const string& value, const int slot /*= 0*/)
 {
@@ -76,6 +280,15 @@ void RoundtripClient::SetProperty(const int key, const string& value, const int
         case Text:
             fText = value;
             break;
+        case OutputFormat:
+            fOutputFormat = value;
+            break;
+        case OutputFile:
+            fOutputFile = value;
+            break;
+        case TransportName:
+            fTransportName = value;
+            break;
         default:
             FairMQDevice::SetProperty(key, value, slot);
             break;
@@ -89,6 +302,12 @@ string RoundtripClient::GetProperty(const int key, const string& default_ /*= ""
         case Text:
             return fText;
             break;
+        case OutputFormat:
+            return fOutputFormat;
+        case OutputFile:
+            return fOutputFile;
+        case TransportName:
+            return fTransportName;
         default:
             return FairMQDevice::GetProperty(key, default_, slot);
     }
@@ -98,6 +317,30 @@ void RoundtripClient::SetProperty(const int key, const int value, const int slot
 {
     switch (key)
     {
+        case MinSize:
+            fMinSize = value;
+            break;
+        case MaxSize:
+            fMaxSize = value;
+            break;
+        case StepsPerDoubling:
+            fStepsPerDoubling = value;
+            break;
+        case Warmup:
+            fWarmup = value;
+            break;
+        case Repetitions:
+            fRepetitions = value;
+            break;
+        case DataPerSizeInMB:
+            fDataPerSizeInMB = value;
+            break;
+        case Window:
+            fWindow = value;
+            break;
+        case ZeroCopy:
+            fZeroCopy = value;
+            break;
         default:
             FairMQDevice::SetProperty(key, value, slot);
             break;
@@ -108,6 +351,22 @@ int RoundtripClient::GetProperty(const int key, const int default_ /*= 0*/, cons
 {
     switch (key)
     {
+        case MinSize:
+            return fMinSize;
+        case MaxSize:
+            return fMaxSize;
+        case StepsPerDoubling:
+            return fStepsPerDoubling;
+        case Warmup:
+            return fWarmup;
+        case Repetitions:
+            return fRepetitions;
+        case DataPerSizeInMB:
+            return fDataPerSizeInMB;
+        case Window:
+            return fWindow;
+        case ZeroCopy:
+            return fZeroCopy;
         default:
             return FairMQDevice::GetProperty(key, default_, slot);
     }
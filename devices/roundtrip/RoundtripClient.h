@@ -16,19 +16,48 @@
 #define ROUNDTRIPCLIENT_H_
 
 #include <string>
+#include <vector>
+#include <ostream>
 
 #include "FairMQDevice.h"
 
+#include "SharedBuffer.h"
+#include "LatencyHistogram.h"
+
+/// Latency and throughput benchmark of a transport, against RoundtripServer.
+///
+/// For every message size from MinSize to MaxSize, StepsPerDoubling sizes per
+/// power of two, the client sends Warmup unmeasured messages and then
+/// Repetitions measured ones, with at most Window messages waiting for their
+/// reply. Window 1 measures the latency of single round trips, a larger one
+/// the throughput of a pipelined stream, which needs a socket pair that
+/// allows it (pair, dealer), not req/rep. Large sizes are repeated only until
+/// DataPerSizeInMB is sent. All requests reference one buffer, either
+/// zero-copy or copied into a new message as an application would.
+///
+/// The results, percentiles of the round trip time and the rates per size, go
+/// to OutputFile (stdout if empty) as a table, CSV or JSON.
 class RoundtripClient : public FairMQDevice
 {
   public:
     enum
     {
         Text = FairMQDevice::Last,
+        MinSize,
+        MaxSize,
+        StepsPerDoubling,
+        Warmup,
+        Repetitions,
+        DataPerSizeInMB,
+        Window,
+        ZeroCopy,
+        OutputFormat,
+        OutputFile,
+        TransportName,
         Last
     };
     RoundtripClient();
-    virtual ~RoundtripClient() {};
+    virtual ~RoundtripClient();
 
     virtual void SetProperty(const int key, const std::string& value, const int slot = 0);
     virtual std::string GetProperty(const int key, const std::string& default_ = "", const int slot = 0);
@@ -36,9 +65,37 @@ class RoundtripClient : public FairMQDevice
     virtual int GetProperty(const int key, const int default_ = 0, const int slot = 0);
 
   protected:
+    struct Result
+    {
+        size_t size;
+        int repetitions;
+        double seconds;
+        AliceO2::Devices::LatencyHistogram roundtrip; ///< nanoseconds
+    };
+
     std::string fText;
+    int fMinSize;
+    int fMaxSize;
+    int fStepsPerDoubling;
+    int fWarmup;
+    int fRepetitions;
+    int fDataPerSizeInMB;
+    int fWindow;
+    int fZeroCopy;
+    std::string fOutputFormat; ///< table/csv/json
+    std::string fOutputFile;
+    std::string fTransportName; ///< only written into the results
 
     virtual void Run();
+
+  private:
+    std::vector<size_t> sizes() const;
+    FairMQMessage* createRequest(size_t size);
+    /// count round trips of size bytes, recorded in histogram unless NULL, returns the seconds taken
+    double exchange(size_t size, int count, AliceO2::Devices::LatencyHistogram* histogram);
+    void writeResults(std::ostream& out, const std::vector<Result>& results, const std::string& socketType) const;
+
+    AliceO2::Devices::SharedBuffer* fBuffer;
 };
 
 #endif /* ROUNDTRIPCLIENT_H_ */
@@ -17,23 +17,83 @@
 
 using namespace std;
 
+RoundtripServer::RoundtripServer()
+    : fEcho(0)
+{
+}
+
 void RoundtripServer::Run()
 {
+    FairMQSocket* socket = fPayloadInputs->at(0);
+    FairMQMessage* request = fTransportFactory->CreateMessage();
+
     while (fState == RUNNING)
     {
-        FairMQMessage* request = fTransportFactory->CreateMessage();
-        fPayloadInputs->at(0)->Receive(request);
-        delete request;
-
-        void* buffer = operator new[](1);
-        FairMQMessage* reply = fTransportFactory->CreateMessage(buffer, 1);
-        fPayloadInputs->at(0)->Send(reply);
-        delete reply;
+        socket->Receive(request);
+
+        if (fEcho)
+        {
+            // sending hands the data over, the message is empty afterwards.
+            socket->Send(request);
+        }
+        else
+        {
+            FairMQMessage* reply = fTransportFactory->CreateMessage(1);
+            socket->Send(reply);
+            delete reply;
+        }
+
+        request->Rebuild();
     }
 
+    delete request;
+
     FairMQDevice::Shutdown();
 
     boost::lock_guard<boost::mutex> lock(fRunningMutex);
     fRunningFinished = true;
     fRunningCondition.notify_one();
 }
+
+void RoundtripServer::SetProperty(const int key, const string& value, const int slot /*= 0*/)
+{
+    switch (key)
+    {
+        default:
+            FairMQDevice::SetProperty(key, value, slot);
+            break;
+    }
+}
+
+string RoundtripServer::GetProperty(const int key, const string& default_ /*= ""*/, const int slot /*= 0*/)
+{
+    switch (key)
+    {
+        default:
+            return FairMQDevice::GetProperty(key, default_, slot);
+    }
+}
+
+void RoundtripServer::SetProperty(const int key, const int value, const int slot /*= 0*/)
+{
+    switch (key)
+    {
+        case Echo:
+            fEcho = value;
+            break;
+        default:
+            FairMQDevice::SetProperty(key, value, slot);
+            break;
+    }
+}
+
+int RoundtripServer::GetProperty(const int key, const int default_ /*= 0*/, const int slot /*= 0*/)
+{
+    switch (key)
+    {
+        case Echo:
+            return fEcho;
+        default:
+            return FairMQDevice::GetProperty(key, default_, slot);
+    }
+}
@@ -15,15 +15,31 @@
 #ifndef ROUNDTRIPSERVER_H_
 #define ROUNDTRIPSERVER_H_
 
+#include <string>
+
 #include "FairMQDevice.h"
 
+/// Answers every message of RoundtripClient, with a one byte reply or, with
+/// Echo, with the message itself.
 class RoundtripServer : public FairMQDevice
 {
   public:
-    RoundtripServer() {};
+    enum
+    {
+        Echo = FairMQDevice::Last,
+        Last
+    };
+    RoundtripServer();
     virtual ~RoundtripServer() {};
 
+    virtual void SetProperty(const int key, const std::string& value, const int slot = 0);
+    virtual std::string GetProperty(const int key, const std::string& default_ = "", const int slot = 0);
+    virtual void SetProperty(const int key, const int value, const int slot = 0);
+    virtual int GetProperty(const int key, const int default_ = 0, const int slot = 0);
+
   protected:
+    int fEcho;
+
     virtual void Run();
 };
 
@@ -20,10 +20,9 @@
 #include "FairMQLogger.h"
 #include "RoundtripClient.h"
 
+#include "FairMQTransportFactoryZMQ.h"
 #ifdef NANOMSG
 #include "FairMQTransportFactoryNN.h"
-#else
-#include "FairMQTransportFactoryZMQ.h"
 #endif
 
 using namespace std;
@@ -54,9 +53,26 @@ static void s_catch_signals(void)
 typedef struct DeviceOptions
 {
     DeviceOptions() :
-        text() {}
+        text(), transport(), socketType(), address(), ioThreads(1), bufSize(10000),
+        minSize(64), maxSize(1 << 30), stepsPerDoubling(1), warmup(100), repetitions(10000),
+        dataPerSizeInMB(4096), window(1), zeroCopy(1), outputFormat(), outputFile() {}
 
     string text;
+    string transport;
+    string socketType;
+    string address;
+    int ioThreads;
+    int bufSize;
+    int minSize;
+    int maxSize;
+    int stepsPerDoubling;
+    int warmup;
+    int repetitions;
+    int dataPerSizeInMB;
+    int window;
+    int zeroCopy;
+    string outputFormat;
+    string outputFile;
 } DeviceOptions_t;
 
 inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
@@ -68,6 +84,25 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     bpo::options_description desc("Options");
     desc.add_options()
         ("text,t", bpo::value<string>()->default_value("something"), "Text to send to server")
+#ifdef NANOMSG
+        ("transport", bpo::value<string>()->default_value("nanomsg"), "Transport: zeromq/nanomsg")
+#else
+        ("transport", bpo::value<string>()->default_value("zeromq"), "Transport: zeromq")
+#endif
+        ("socket-type", bpo::value<string>()->default_value("req"), "Socket type: req, or pair for a window above 1")
+        ("address", bpo::value<string>()->default_value("tcp://localhost:5005"), "Address of the server")
+        ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+        ("buff-size", bpo::value<int>()->default_value(10000), "Socket buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
+        ("min-size", bpo::value<int>()->default_value(64), "Smallest message size in bytes")
+        ("max-size", bpo::value<int>()->default_value(1 << 30), "Largest message size in bytes")
+        ("steps-per-doubling", bpo::value<int>()->default_value(1), "Number of sizes per power of two")
+        ("warmup", bpo::value<int>()->default_value(100), "Unmeasured round trips before every size")
+        ("repetitions", bpo::value<int>()->default_value(10000), "Measured round trips per size")
+        ("data-per-size", bpo::value<int>()->default_value(4096), "Fewer repetitions for large sizes, to send at most this many MB per size, 0 for no limit")
+        ("window", bpo::value<int>()->default_value(1), "Messages in flight, 1 for latency, more for throughput")
+        ("zero-copy", bpo::value<int>()->default_value(1), "Send the buffer zero-copy, or copy it into every message, 1/0")
+        ("output-format", bpo::value<string>()->default_value("table"), "Format of the results: table/csv/json")
+        ("output-file", bpo::value<string>()->default_value(""), "File for the results, stdout if empty")
         ("help", "Print help messages");
 
     bpo::variables_map vm;
@@ -75,7 +110,7 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
 
     if ( vm.count("help") )
     {
-        LOG(INFO) << "EPN" << endl << desc;
+        LOG(INFO) << "Roundtrip client" << endl << desc;
         return false;
     }
 
@@ -84,6 +119,51 @@ inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
     if ( vm.count("text") )
         _options->text = vm["text"].as<string>();
 
+    if ( vm.count("transport") )
+        _options->transport = vm["transport"].as<string>();
+
+    if ( vm.count("socket-type") )
+        _options->socketType = vm["socket-type"].as<string>();
+
+    if ( vm.count("address") )
+        _options->address = vm["address"].as<string>();
+
+    if ( vm.count("io-threads") )
+        _options->ioThreads = vm["io-threads"].as<int>();
+
+    if ( vm.count("buff-size") )
+        _options->bufSize = vm["buff-size"].as<int>();
+
+    if ( vm.count("min-size") )
+        _options->minSize = vm["min-size"].as<int>();
+
+    if ( vm.count("max-size") )
+        _options->maxSize = vm["max-size"].as<int>();
+
+    if ( vm.count("steps-per-doubling") )
+        _options->stepsPerDoubling = vm["steps-per-doubling"].as<int>();
+
+    if ( vm.count("warmup") )
+        _options->warmup = vm["warmup"].as<int>();
+
+    if ( vm.count("repetitions") )
+        _options->repetitions = vm["repetitions"].as<int>();
+
+    if ( vm.count("data-per-size") )
+        _options->dataPerSizeInMB = vm["data-per-size"].as<int>();
+
+    if ( vm.count("window") )
+        _options->window = vm["window"].as<int>();
+
+    if ( vm.count("zero-copy") )
+        _options->zeroCopy = vm["zero-copy"].as<int>();
+
+    if ( vm.count("output-format") )
+        _options->outputFormat = vm["output-format"].as<string>();
+
+    if ( vm.count("output-file") )
+        _options->outputFile = vm["output-file"].as<string>();
+
     return true;
 }
 
@@ -105,28 +185,50 @@ int main(int argc, char** argv)
 
     LOG(INFO) << "PID: " << getpid();
 
+    FairMQTransportFactory* transportFactory = NULL;
+    if (options.transport == "zeromq")
+    {
+        transportFactory = new FairMQTransportFactoryZMQ();
+    }
 #ifdef NANOMSG
-    FairMQTransportFactory* transportFactory = new FairMQTransportFactoryNN();
-#else
-    FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+    else if (options.transport == "nanomsg")
+    {
+        transportFactory = new FairMQTransportFactoryNN();
+    }
 #endif
+    else
+    {
+        LOG(ERROR) << "Transport " << options.transport << " is not available";
+        return 1;
+    }
 
     client.SetTransport(transportFactory);
 
     client.SetProperty(RoundtripClient::Id, "client");
-    client.SetProperty(RoundtripClient::NumIoThreads, 1);
+    client.SetProperty(RoundtripClient::NumIoThreads, options.ioThreads);
     client.SetProperty(RoundtripClient::NumInputs, 0);
     client.SetProperty(RoundtripClient::NumOutputs, 1);
 
     client.ChangeState(RoundtripClient::INIT);
 
-    client.SetProperty(RoundtripClient::OutputSocketType, "req", 0);
-    client.SetProperty(RoundtripClient::OutputSndBufSize, 10000, 0);
-    client.SetProperty(RoundtripClient::OutputRcvBufSize, 10000, 0);
+    client.SetProperty(RoundtripClient::OutputSocketType, options.socketType, 0);
+    client.SetProperty(RoundtripClient::OutputSndBufSize, options.bufSize, 0);
+    client.SetProperty(RoundtripClient::OutputRcvBufSize, options.bufSize, 0);
     client.SetProperty(RoundtripClient::OutputMethod, "connect", 0);
-    client.SetProperty(RoundtripClient::OutputAddress, "tcp://localhost:5005", 0);
+    client.SetProperty(RoundtripClient::OutputAddress, options.address, 0);
 
     client.SetProperty(RoundtripClient::Text, options.text);
+    client.SetProperty(RoundtripClient::TransportName, options.transport);
+    client.SetProperty(RoundtripClient::MinSize, options.minSize);
+    client.SetProperty(RoundtripClient::MaxSize, options.maxSize);
+    client.SetProperty(RoundtripClient::StepsPerDoubling, options.stepsPerDoubling);
+    client.SetProperty(RoundtripClient::Warmup, options.warmup);
+    client.SetProperty(RoundtripClient::Repetitions, options.repetitions);
+    client.SetProperty(RoundtripClient::DataPerSizeInMB, options.dataPerSizeInMB);
+    client.SetProperty(RoundtripClient::Window, options.window);
+    client.SetProperty(RoundtripClient::ZeroCopy, options.zeroCopy);
+    client.SetProperty(RoundtripClient::OutputFormat, options.outputFormat);
+    client.SetProperty(RoundtripClient::OutputFile, options.outputFile);
 
     client.ChangeState(RoundtripClient::SETOUTPUT);
     client.ChangeState(RoundtripClient::SETINPUT);
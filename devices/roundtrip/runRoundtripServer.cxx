@@ -15,13 +15,14 @@
 #include <iostream>
 #include <csignal>
 
+#include "boost/program_options.hpp"
+
 #include "FairMQLogger.h"
 #include "RoundtripServer.h"
 
+#include "FairMQTransportFactoryZMQ.h"
 #ifdef NANOMSG
 #include "FairMQTransportFactoryNN.h"
-#else
-#include "FairMQTransportFactoryZMQ.h"
 #endif
 
 using namespace std;
@@ -49,32 +50,121 @@ static void s_catch_signals(void)
     sigaction(SIGTERM, &action, NULL);
 }
 
+typedef struct DeviceOptions
+{
+    DeviceOptions() :
+        transport(), socketType(), address(), ioThreads(1), bufSize(10000), echo(0) {}
+
+    string transport;
+    string socketType;
+    string address;
+    int ioThreads;
+    int bufSize;
+    int echo;
+} DeviceOptions_t;
+
+inline bool parse_cmd_line(int _argc, char* _argv[], DeviceOptions* _options)
+{
+    if (_options == NULL)
+        throw runtime_error("Internal error: options' container is empty.");
+
+    namespace bpo = boost::program_options;
+    bpo::options_description desc("Options");
+    desc.add_options()
+#ifdef NANOMSG
+        ("transport", bpo::value<string>()->default_value("nanomsg"), "Transport: zeromq/nanomsg")
+#else
+        ("transport", bpo::value<string>()->default_value("zeromq"), "Transport: zeromq")
+#endif
+        ("socket-type", bpo::value<string>()->default_value("rep"), "Socket type: rep, or pair for a pipelining client")
+        ("address", bpo::value<string>()->default_value("tcp://*:5005"), "Address to bind to")
+        ("io-threads", bpo::value<int>()->default_value(1), "Number of I/O threads")
+        ("buff-size", bpo::value<int>()->default_value(10000), "Socket buffer size in number of messages (ZeroMQ)/bytes(nanomsg)")
+        ("echo", bpo::value<int>()->default_value(0), "Send every message back instead of a one byte reply, 1/0")
+        ("help", "Print help messages");
+
+    bpo::variables_map vm;
+    bpo::store(bpo::parse_command_line(_argc, _argv, desc), vm);
+
+    if ( vm.count("help") )
+    {
+        LOG(INFO) << "Roundtrip server" << endl << desc;
+        return false;
+    }
+
+    bpo::notify(vm);
+
+    if ( vm.count("transport") )
+        _options->transport = vm["transport"].as<string>();
+
+    if ( vm.count("socket-type") )
+        _options->socketType = vm["socket-type"].as<string>();
+
+    if ( vm.count("address") )
+        _options->address = vm["address"].as<string>();
+
+    if ( vm.count("io-threads") )
+        _options->ioThreads = vm["io-threads"].as<int>();
+
+    if ( vm.count("buff-size") )
+        _options->bufSize = vm["buff-size"].as<int>();
+
+    if ( vm.count("echo") )
+        _options->echo = vm["echo"].as<int>();
+
+    return true;
+}
+
 int main(int argc, char** argv)
 {
     s_catch_signals();
 
+    DeviceOptions_t options;
+    try
+    {
+        if (!parse_cmd_line(argc, argv, &options))
+            return 0;
+    }
+    catch (exception& e)
+    {
+        LOG(ERROR) << e.what();
+        return 1;
+    }
+
     LOG(INFO) << "PID: " << getpid();
 
+    FairMQTransportFactory* transportFactory = NULL;
+    if (options.transport == "zeromq")
+    {
+        transportFactory = new FairMQTransportFactoryZMQ();
+    }
 #ifdef NANOMSG
-    FairMQTransportFactory* transportFactory = new FairMQTransportFactoryNN();
-#else
-    FairMQTransportFactory* transportFactory = new FairMQTransportFactoryZMQ();
+    else if (options.transport == "nanomsg")
+    {
+        transportFactory = new FairMQTransportFactoryNN();
+    }
 #endif
+    else
+    {
+        LOG(ERROR) << "Transport " << options.transport << " is not available";
+        return 1;
+    }
 
     server.SetTransport(transportFactory);
 
     server.SetProperty(RoundtripServer::Id, "server");
-    server.SetProperty(RoundtripServer::NumIoThreads, 1);
+    server.SetProperty(RoundtripServer::NumIoThreads, options.ioThreads);
     server.SetProperty(RoundtripServer::NumInputs, 1);
     server.SetProperty(RoundtripServer::NumOutputs, 0);
+    server.SetProperty(RoundtripServer::Echo, options.echo);
 
     server.ChangeState(RoundtripServer::INIT);
 
-    server.SetProperty(RoundtripServer::InputSocketType, "rep", 0);
-    server.SetProperty(RoundtripServer::InputSndBufSize, 10000, 0);
-    server.SetProperty(RoundtripServer::InputRcvBufSize, 10000, 0);
+    server.SetProperty(RoundtripServer::InputSocketType, options.socketType, 0);
+    server.SetProperty(RoundtripServer::InputSndBufSize, options.bufSize, 0);
+    server.SetProperty(RoundtripServer::InputRcvBufSize, options.bufSize, 0);
     server.SetProperty(RoundtripServer::InputMethod, "bind", 0);
-    server.SetProperty(RoundtripServer::InputAddress, "tcp://*:5005", 0);
+    server.SetProperty(RoundtripServer::InputAddress, options.address, 0);
 
     server.ChangeState(RoundtripServer::SETOUTPUT);
     server.ChangeState(RoundtripServer::SETINPUT);
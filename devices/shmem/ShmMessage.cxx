@@ -0,0 +1,145 @@
+/**
+ * ShmMessage.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include "ShmMessage.h"
+#include "ShmSegment.h"
+
+using namespace std;
+
+using namespace AliceO2::Shmem;
+
+Message::Message(Segment* segment, FairMQTransportFactory* inner)
+  : fSegment(segment)
+  , fInnerFactory(inner)
+  , fHandle(0)
+  , fSize(0)
+  , fInner(NULL)
+{
+}
+
+Message::Message(Segment* segment, FairMQTransportFactory* inner, size_t size)
+  : fSegment(segment)
+  , fInnerFactory(inner)
+  , fHandle(0)
+  , fSize(0)
+  , fInner(NULL)
+{
+  allocate(size);
+}
+
+Message::Message(Segment* segment, FairMQTransportFactory* inner, void* data, size_t size, fairmq_free_fn* ffn, void* hint)
+  : fSegment(segment)
+  , fInnerFactory(inner)
+  , fHandle(0)
+  , fSize(0)
+  , fInner(inner->CreateMessage(data, size, ffn, hint))
+{
+}
+
+Message::~Message()
+{
+  CloseMessage();
+}
+
+void Message::allocate(size_t size)
+{
+  if (fSegment) {
+    fHandle = fSegment->Allocate(size);
+  }
+
+  if (fHandle) {
+    fSize = size;
+  } else {
+    // no segment or no room left in it: a message of the regular transport, which the sockets copy.
+    fInner = fInnerFactory->CreateMessage(size);
+  }
+}
+
+void Message::adopt(uint64_t handle, size_t size)
+{
+  CloseMessage();
+  fHandle = handle;
+  fSize = size;
+}
+
+void Message::release()
+{
+  fHandle = 0;
+  fSize = 0;
+}
+
+void Message::Rebuild()
+{
+  CloseMessage();
+}
+
+void Message::Rebuild(size_t size)
+{
+  CloseMessage();
+  allocate(size);
+}
+
+void Message::Rebuild(void* data, size_t size, fairmq_free_fn* ffn, void* hint)
+{
+  CloseMessage();
+  fInner = fInnerFactory->CreateMessage(data, size, ffn, hint);
+}
+
+void* Message::GetMessage()
+{
+  return fInner ? fInner->GetMessage() : NULL;
+}
+
+void* Message::GetData()
+{
+  if (fHandle) {
+    return fSegment->GetData(fHandle);
+  }
+  return fInner ? fInner->GetData() : NULL;
+}
+
+size_t Message::GetSize()
+{
+  if (fHandle) {
+    return fSize;
+  }
+  return fInner ? fInner->GetSize() : 0;
+}
+
+void Message::SetMessage(void* data, size_t size)
+{
+  if (fInner) {
+    fInner->SetMessage(data, size);
+  }
+}
+
+void Message::CloseMessage()
+{
+  if (fHandle) {
+    fSegment->Unref(fHandle);
+    release();
+  }
+  if (fInner) {
+    delete fInner;
+    fInner = NULL;
+  }
+}
+
+void Message::Copy(FairMQMessage* msg)
+{
+  Message* other = static_cast<Message*>(msg);
+
+  CloseMessage();
+
+  if (other->fHandle) {
+    fSegment->Ref(other->fHandle);
+    fHandle = other->fHandle;
+    fSize = other->fSize;
+  } else if (other->fInner) {
+    fInner = fInnerFactory->CreateMessage();
+    fInner->Copy(other->fInner);
+  }
+}
@@ -0,0 +1,73 @@
+/**
+ * ShmMessage.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_SHMEM_MESSAGE_H_
+#define ALICEO2_SHMEM_MESSAGE_H_
+
+#include <cstdint>
+#include <cstddef>
+
+#include "FairMQMessage.h"
+#include "FairMQTransportFactory.h"
+
+namespace AliceO2 {
+namespace Shmem {
+
+class Segment;
+class Socket;
+
+/// Message of the shared memory transport. It holds either a chunk of the
+/// segment, with one reference to it, or a message of the regular transport:
+/// for data the caller brings along (zero-copy with a free function), for
+/// data from other nodes and when the segment is full.
+class Message : public FairMQMessage
+{
+  public:
+    Message(Segment* segment, FairMQTransportFactory* inner);
+    Message(Segment* segment, FairMQTransportFactory* inner, size_t size);
+    Message(Segment* segment, FairMQTransportFactory* inner, void* data, size_t size, fairmq_free_fn* ffn, void* hint);
+    virtual ~Message();
+
+    virtual void Rebuild();
+    virtual void Rebuild(size_t size);
+    virtual void Rebuild(void* data, size_t size, fairmq_free_fn* ffn = NULL, void* hint = NULL);
+
+    virtual void* GetMessage();
+    virtual void* GetData();
+    virtual size_t GetSize();
+
+    virtual void SetMessage(void* data, size_t size);
+
+    virtual void CloseMessage();
+    /// shares the data of msg: one more reference to its chunk, or a copy of its regular message
+    virtual void Copy(FairMQMessage* msg);
+
+    /// true if the data lives in the segment
+    bool IsShared() const { return fHandle != 0; }
+
+  private:
+    friend class Socket;
+
+    Message(const Message&);
+    Message& operator=(const Message&);
+
+    void allocate(size_t size);
+    /// takes over a chunk with its reference
+    void adopt(uint64_t handle, size_t size);
+    /// gives up the chunk without dropping the reference, which went along with the handle
+    void release();
+
+    Segment* fSegment;
+    FairMQTransportFactory* fInnerFactory;
+    uint64_t fHandle;
+    size_t fSize;
+    FairMQMessage* fInner;
+};
+
+} // namespace Shmem
+} // namespace AliceO2
+
+#endif
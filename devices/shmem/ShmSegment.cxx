@@ -0,0 +1,368 @@
+/**
+ * ShmSegment.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <random>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "FairMQLogger.h"
+
+#include "ShmSegment.h"
+
+using namespace std;
+
+using namespace AliceO2::Shmem;
+
+namespace {
+
+const uint64_t kSegmentMagic = 0x544e4d474553324fULL; // "O2SEGMNT"
+const uint64_t kStaleMagic = 0x454c415453324fULL; // "O2STALE", being removed
+const uint64_t kChunkMagic = 0x214b4e554843324fULL; // "O2CHUNK!"
+const size_t kPageSize = 4096;
+const size_t kMaxSize = 64ULL << 32;
+
+string path(const string& name)
+{
+  return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+} // namespace
+
+// the atomics live in memory shared between processes, which works only for lock-free ones.
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "shared memory needs lock-free atomics");
+
+const int Segment::kMaxProcesses;
+
+struct Segment::Header
+{
+  atomic<uint64_t> magic; ///< written last by the creator
+  uint64_t id;
+  uint64_t size;
+  uint64_t dataStart;
+  atomic<uint64_t> top; ///< start of the part not cut into chunks yet
+  /// per size class: handle / 64 of the first free chunk, and a tag against ABA in the upper 32 bits
+  atomic<uint64_t> freeLists[kNumClasses];
+  atomic<int32_t> processes[kMaxProcesses]; ///< ids of the attached processes, 0 for a free entry
+};
+
+struct Segment::ChunkHeader
+{
+  atomic<int32_t> refs;
+  uint32_t sizeClass;
+  atomic<uint64_t> next; ///< free list link, handle / 64
+  uint64_t magic;
+};
+
+Segment* Segment::Open(const string& name, size_t size)
+{
+  // a few times, in case other processes are replacing a stale segment of the same name.
+  for (int attempt = 0; attempt < 10; ++attempt) {
+    bool stale = false;
+    Segment* segment = open(name, size, stale);
+    if (segment || !stale) {
+      return segment;
+    }
+    usleep(1000);
+  }
+
+  LOG(ERROR) << "Could not replace the stale shared memory segment " << path(name);
+  return NULL;
+}
+
+Segment* Segment::open(const string& name, size_t size, bool& stale)
+{
+  string shmPath = path(name);
+
+  int fd = shm_open(shmPath.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  bool creator = fd >= 0;
+
+  if (creator) {
+    // chunks are found by their offset / 64 in 32 bits.
+    size = (min(max(size, 16 * kPageSize), kMaxSize) + kPageSize - 1) & ~(kPageSize - 1);
+    if (ftruncate(fd, size) != 0) {
+      LOG(ERROR) << "Could not size the shared memory segment " << shmPath << " to " << size << " bytes: " << strerror(errno);
+      close(fd);
+      shm_unlink(shmPath.c_str());
+      return NULL;
+    }
+  } else {
+    if (errno != EEXIST || (fd = shm_open(shmPath.c_str(), O_RDWR, 0600)) < 0) {
+      LOG(ERROR) << "Could not open the shared memory segment " << shmPath << ": " << strerror(errno);
+      return NULL;
+    }
+    // the creator may not have sized it yet.
+    struct stat st;
+    st.st_size = 0;
+    for (int i = 0; i < 1000 && (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)); ++i) {
+      usleep(1000);
+    }
+    if (static_cast<size_t>(st.st_size) < sizeof(Header)) {
+      LOG(ERROR) << "The shared memory segment " << shmPath << " was not set up by its creator";
+      close(fd);
+      return NULL;
+    }
+    size = st.st_size;
+  }
+
+  void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    LOG(ERROR) << "Could not map the shared memory segment " << shmPath << ": " << strerror(errno);
+    if (creator) {
+      shm_unlink(shmPath.c_str());
+    }
+    return NULL;
+  }
+
+  Segment* segment = new Segment(shmPath, static_cast<char*>(base), size);
+  Header* header = segment->header();
+
+  if (creator) {
+    random_device device;
+    header->id = (static_cast<uint64_t>(device()) << 32) ^ device() ^ static_cast<uint64_t>(time(NULL)) ^ getpid();
+    header->size = size;
+    header->dataStart = (sizeof(Header) + kPageSize - 1) & ~(kPageSize - 1);
+    header->top.store(header->dataStart, memory_order_relaxed);
+    for (int i = 0; i < kNumClasses; ++i) {
+      header->freeLists[i].store(0, memory_order_relaxed);
+    }
+    for (int i = 0; i < kMaxProcesses; ++i) {
+      header->processes[i].store(0, memory_order_relaxed);
+    }
+    header->processes[0].store(getpid(), memory_order_relaxed);
+    segment->fProcessIndex = 0;
+    header->magic.store(kSegmentMagic, memory_order_release);
+    LOG(INFO) << "Created the shared memory segment " << shmPath << " of " << size << " bytes";
+  } else {
+    uint64_t magic = header->magic.load(memory_order_acquire);
+    for (int i = 0; i < 1000 && magic != kSegmentMagic && magic != kStaleMagic; ++i) {
+      usleep(1000);
+      magic = header->magic.load(memory_order_acquire);
+    }
+    if (magic == kStaleMagic) {
+      // another process is removing it.
+      stale = true;
+      delete segment;
+      return NULL;
+    }
+    if (magic != kSegmentMagic || header->size != size) {
+      LOG(ERROR) << "The shared memory segment " << shmPath << " is not a payload segment or was not set up by its creator";
+      delete segment;
+      return NULL;
+    }
+    if (!segment->attach()) {
+      if (segment->condemn()) {
+        LOG(WARN) << "The shared memory segment " << shmPath << " was left behind by processes that are gone, replacing it";
+        shm_unlink(shmPath.c_str());
+      }
+      stale = true;
+      delete segment;
+      return NULL;
+    }
+    LOG(INFO) << "Attached to the shared memory segment " << shmPath << " of " << size << " bytes";
+  }
+
+  return segment;
+}
+
+bool Segment::Remove(const string& name)
+{
+  return shm_unlink(path(name).c_str()) == 0;
+}
+
+Segment::Segment(const string& name, char* base, size_t size)
+  : fName(name)
+  , fBase(base)
+  , fSize(size)
+  , fProcessIndex(-1)
+{
+  static_assert(sizeof(ChunkHeader) <= kChunkHeaderSize, "chunk header does not fit");
+}
+
+Segment::~Segment()
+{
+  if (fProcessIndex >= 0) {
+    header()->processes[fProcessIndex].store(0);
+    if (condemn()) {
+      shm_unlink(fName.c_str());
+      LOG(INFO) << "Removed the shared memory segment " << fName << " after its last process";
+    }
+  }
+  munmap(fBase, fSize);
+}
+
+bool Segment::attach()
+{
+  if (!isInUse()) {
+    return false;
+  }
+
+  int32_t pid = getpid();
+  for (int i = 0; i < kMaxProcesses && fProcessIndex < 0; ++i) {
+    int32_t expected = 0;
+    if (header()->processes[i].compare_exchange_strong(expected, pid)) {
+      fProcessIndex = i;
+    }
+  }
+  if (fProcessIndex < 0) {
+    LOG(WARN) << "More than " << kMaxProcesses << " processes attached to the shared memory segment " << fName
+              << ", it may be removed while this one still uses it";
+  }
+
+  // the last process may be detaching right now, see condemn().
+  if (header()->magic.load() != kSegmentMagic) {
+    if (fProcessIndex >= 0) {
+      header()->processes[fProcessIndex].store(0);
+      fProcessIndex = -1;
+    }
+    return false;
+  }
+  return true;
+}
+
+bool Segment::isInUse()
+{
+  bool inUse = false;
+  for (int i = 0; i < kMaxProcesses; ++i) {
+    int32_t pid = header()->processes[i].load();
+    if (pid == 0) {
+      continue;
+    }
+    if (kill(pid, 0) == 0 || errno == EPERM) {
+      inUse = true;
+    } else {
+      header()->processes[i].compare_exchange_strong(pid, 0);
+    }
+  }
+  return inUse;
+}
+
+bool Segment::condemn()
+{
+  if (isInUse()) {
+    return false;
+  }
+  uint64_t magic = kSegmentMagic;
+  if (!header()->magic.compare_exchange_strong(magic, kStaleMagic)) {
+    return false;
+  }
+  // a process that registered before the mark sees it in the table, one after it sees the mark in attach().
+  if (isInUse()) {
+    header()->magic.store(kSegmentMagic);
+    return false;
+  }
+  return true;
+}
+
+uint64_t Segment::GetId() const
+{
+  return header()->id;
+}
+
+size_t Segment::GetUsedSize() const
+{
+  return header()->top.load(memory_order_relaxed) - header()->dataStart;
+}
+
+uint64_t Segment::Allocate(size_t size)
+{
+  int shift = kMinClassShift;
+  while (shift < kMinClassShift + kNumClasses && (1ULL << shift) < size + kChunkHeaderSize) {
+    ++shift;
+  }
+  int sizeClass = shift - kMinClassShift;
+  if (sizeClass >= kNumClasses) {
+    return 0;
+  }
+
+  uint64_t handle = pop(sizeClass);
+
+  if (handle == 0) {
+    uint64_t bytes = 1ULL << shift;
+    uint64_t top = header()->top.load(memory_order_relaxed);
+    do {
+      if (top + bytes > fSize) {
+        return 0;
+      }
+    } while (!header()->top.compare_exchange_weak(top, top + bytes, memory_order_relaxed));
+
+    handle = top;
+    ChunkHeader* c = chunk(handle);
+    c->sizeClass = sizeClass;
+    c->next.store(0, memory_order_relaxed);
+    c->magic = kChunkMagic;
+  }
+
+  chunk(handle)->refs.store(1, memory_order_relaxed);
+
+  return handle;
+}
+
+void Segment::Ref(uint64_t handle)
+{
+  chunk(handle)->refs.fetch_add(1, memory_order_relaxed);
+}
+
+void Segment::Unref(uint64_t handle)
+{
+  ChunkHeader* c = chunk(handle);
+  if (c->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+    push(c->sizeClass, handle);
+  }
+}
+
+bool Segment::IsValid(uint64_t handle, size_t size) const
+{
+  if (handle % kChunkHeaderSize != 0 || handle < header()->dataStart || handle + kChunkHeaderSize > fSize) {
+    return false;
+  }
+  const ChunkHeader* c = chunk(handle);
+  if (c->magic != kChunkMagic || c->sizeClass >= static_cast<uint32_t>(kNumClasses)) {
+    return false;
+  }
+  uint64_t bytes = 1ULL << (c->sizeClass + kMinClassShift);
+  return handle + bytes <= fSize && size + kChunkHeaderSize <= bytes;
+}
+
+uint64_t Segment::pop(int sizeClass)
+{
+  atomic<uint64_t>& list = header()->freeLists[sizeClass];
+  uint64_t head = list.load(memory_order_acquire);
+
+  while (true) {
+    uint64_t index = head & 0xffffffffULL;
+    if (index == 0) {
+      return 0;
+    }
+    // next may be stale if another process took the chunk meanwhile, the tag makes the exchange fail then.
+    uint64_t next = chunk(index * kChunkHeaderSize)->next.load(memory_order_relaxed);
+    uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+    if (list.compare_exchange_weak(head, newHead, memory_order_acq_rel, memory_order_acquire)) {
+      return index * kChunkHeaderSize;
+    }
+  }
+}
+
+void Segment::push(int sizeClass, uint64_t handle)
+{
+  atomic<uint64_t>& list = header()->freeLists[sizeClass];
+  ChunkHeader* c = chunk(handle);
+  uint64_t index = handle / kChunkHeaderSize;
+  uint64_t head = list.load(memory_order_relaxed);
+  uint64_t newHead;
+
+  do {
+    c->next.store(head & 0xffffffffULL, memory_order_relaxed);
+    newHead = (((head >> 32) + 1) << 32) | index;
+  } while (!list.compare_exchange_weak(head, newHead, memory_order_release, memory_order_relaxed));
+}
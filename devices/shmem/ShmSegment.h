@@ -0,0 +1,102 @@
+/**
+ * ShmSegment.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_SHMEM_SEGMENT_H_
+#define ALICEO2_SHMEM_SEGMENT_H_
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace AliceO2 {
+namespace Shmem {
+
+/// A named POSIX shared memory segment that the processes of one node use
+/// for the payloads they pass to each other.
+///
+/// The segment is carved into chunks of power of two sizes, 256 bytes and up,
+/// each with a 64 byte header that holds its reference count. Free chunks of
+/// every size go to a lock-free list (a Treiber stack with an ABA tag in the
+/// head), fresh ones are cut from the unused end of the segment. Chunks never
+/// change their size, so the segment suits traffic with a stable set of sizes
+/// best. Everything in the segment is addressed by its offset, the handle,
+/// which is the same in every process.
+///
+/// The first process that opens a name creates the segment, later ones attach
+/// to it. The segment keeps the process ids of the attached processes: the
+/// last one to detach unlinks it, and a process that finds only processes that
+/// are gone, after a crash, replaces it with a new one. So every run starts
+/// with an empty segment, chunks leaked by a crash included. The processes
+/// have to share a process id namespace.
+class Segment
+{
+  public:
+    /// attaches to the segment of this name, creates it with size bytes if it
+    /// does not exist yet. NULL (and logs why) on failure.
+    static Segment* Open(const std::string& name, size_t size);
+    /// unlinks the segment, the memory goes away when the last process detaches
+    static bool Remove(const std::string& name);
+
+    /// detaches, and unlinks the segment if no other live process is attached
+    ~Segment();
+
+    /// handle of a chunk for size bytes with one reference, 0 if no memory is left
+    uint64_t Allocate(size_t size);
+    void Ref(uint64_t handle);
+    /// returns the chunk to its free list with the last reference
+    void Unref(uint64_t handle);
+
+    void* GetData(uint64_t handle) const { return fBase + handle + kChunkHeaderSize; }
+    /// true if handle can be a chunk of this segment holding size bytes, for handles from other processes
+    bool IsValid(uint64_t handle, size_t size) const;
+
+    const std::string& GetName() const { return fName; }
+    /// random, tells apart segments of the same name on different nodes
+    uint64_t GetId() const;
+    size_t GetSize() const { return fSize; }
+    /// bytes cut into chunks so far, free or not
+    size_t GetUsedSize() const;
+
+  private:
+    static const size_t kChunkHeaderSize = 64;
+    static const int kMinClassShift = 8;
+    static const int kNumClasses = 32;
+    static const int kMaxProcesses = 256;
+
+    struct Header;
+    struct ChunkHeader;
+
+    /// stale is set if the name held a segment of processes that are gone, Open() tries again then
+    static Segment* open(const std::string& name, size_t size, bool& stale);
+
+    Segment(const std::string& name, char* base, size_t size);
+    Segment(const Segment&);
+    Segment& operator=(const Segment&);
+
+    Header* header() const { return reinterpret_cast<Header*>(fBase); }
+    ChunkHeader* chunk(uint64_t handle) const { return reinterpret_cast<ChunkHeader*>(fBase + handle); }
+
+    /// registers this process, false if no live process uses the segment any more
+    bool attach();
+    /// true if a process in the table is alive, clears the entries of the ones that are gone
+    bool isInUse();
+    /// marks the segment for removal if no live process uses it, true if this process did
+    bool condemn();
+
+    uint64_t pop(int sizeClass);
+    void push(int sizeClass, uint64_t handle);
+
+    std::string fName;
+    char* fBase;
+    size_t fSize;
+    int fProcessIndex; // entry of this process in the table, -1 if not registered
+};
+
+} // namespace Shmem
+} // namespace AliceO2
+
+#endif
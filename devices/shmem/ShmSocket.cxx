@@ -0,0 +1,236 @@
+/**
+ * ShmSocket.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include <cstring>
+
+#include "FairMQLogger.h"
+
+#include "ShmSocket.h"
+#include "ShmMessage.h"
+#include "ShmSegment.h"
+#include "ShmTransportFactory.h"
+
+using namespace std;
+
+using namespace AliceO2::Shmem;
+
+namespace {
+
+const uint64_t kHandleMagic = 0x454c444e4148324fULL; // "O2HANDLE"
+
+} // namespace
+
+Socket::Socket(TransportFactory* factory, const string& type, FairMQSocket* inner, FairMQTransportFactory* innerFactory, Segment* segment)
+  : FairMQSocket(inner->SNDMORE, inner->RCVMORE, inner->NOBLOCK)
+  , fFactory(factory)
+  , fInner(inner)
+  , fInnerFactory(innerFactory)
+  , fWire(innerFactory->CreateMessage())
+  , fSegment(segment)
+  , fFanOut(type == "pub" || type == "xpub")
+  , fLocal(!fFanOut && factory->IsAllLocal())
+  , fNumRemoteEndpoints(0)
+  , fBytesTx(0)
+  , fBytesRx(0)
+  , fMessagesTx(0)
+  , fMessagesRx(0)
+{
+}
+
+Socket::~Socket()
+{
+  delete fWire;
+  delete fInner;
+}
+
+string Socket::GetId()
+{
+  return fInner->GetId();
+}
+
+bool Socket::isLocalAddress(const string& address)
+{
+  return address.compare(0, 6, "ipc://") == 0
+      || address.compare(0, 9, "inproc://") == 0
+      || address.compare(0, 16, "tcp://127.0.0.1:") == 0
+      || address.compare(0, 16, "tcp://localhost:") == 0;
+}
+
+void Socket::Bind(const string& address)
+{
+  addEndpoint(address);
+  fInner->Bind(address);
+}
+
+void Socket::Connect(const string& address)
+{
+  addEndpoint(address);
+  fInner->Connect(address);
+}
+
+void Socket::addEndpoint(const string& address)
+{
+  // the messages of a socket spread over all its peers, one peer on another node takes copies for all.
+  if (!isLocalAddress(address)) {
+    ++fNumRemoteEndpoints;
+  }
+  fLocal = !fFanOut && (fFactory->IsAllLocal() || fNumRemoteEndpoints == 0);
+}
+
+int Socket::flagsOf(const string& flag) const
+{
+  if (flag == "snd-more") {
+    return SNDMORE;
+  }
+  if (flag == "rcv-more") {
+    return RCVMORE;
+  }
+  if (flag == "no-block") {
+    return NOBLOCK;
+  }
+  return 0;
+}
+
+int Socket::Send(FairMQMessage* msg, const string& flag)
+{
+  return Send(msg, flagsOf(flag));
+}
+
+int Socket::Send(FairMQMessage* msg, const int flags)
+{
+  Message* message = static_cast<Message*>(msg);
+
+  if (!message->fHandle) {
+    int n;
+    if (message->fInner) {
+      n = fInner->Send(message->fInner, flags);
+    } else {
+      // an empty message still takes its frame, a multipart message would lose one part otherwise.
+      fWire->Rebuild();
+      n = fInner->Send(fWire, flags);
+    }
+    if (n > 0) {
+      fBytesTx += n;
+      ++fMessagesTx;
+    }
+    return n;
+  }
+
+  size_t size = message->fSize;
+
+  if (fLocal) {
+    Handle handle = { kHandleMagic, fSegment->GetId(), message->fHandle, size };
+    fWire->Rebuild(sizeof(Handle));
+    memcpy(fWire->GetData(), &handle, sizeof(Handle));
+    int n = fInner->Send(fWire, flags);
+    if (n <= 0) {
+      return n;
+    }
+    // the reference went along with the handle, the receiver drops it.
+    message->release();
+    fFactory->CountHandleSent();
+  } else {
+    fWire->Rebuild(size);
+    memcpy(fWire->GetData(), message->GetData(), size);
+    int n = fInner->Send(fWire, flags);
+    if (n <= 0) {
+      return n;
+    }
+    message->CloseMessage();
+    fFactory->CountRemoteCopy();
+  }
+
+  fBytesTx += size;
+  ++fMessagesTx;
+  return size;
+}
+
+int Socket::Receive(FairMQMessage* msg, const string& flag)
+{
+  return Receive(msg, flagsOf(flag));
+}
+
+int Socket::Receive(FairMQMessage* msg, const int flags)
+{
+  Message* message = static_cast<Message*>(msg);
+
+  int n = fInner->Receive(fWire, flags);
+  if (n <= 0) {
+    return n;
+  }
+
+  Handle handle;
+  if (fSegment && fWire->GetSize() == sizeof(Handle)) {
+    memcpy(&handle, fWire->GetData(), sizeof(Handle));
+    if (handle.magic == kHandleMagic) {
+      if (handle.segmentId == fSegment->GetId() && fSegment->IsValid(handle.offset, handle.size)) {
+        message->adopt(handle.offset, handle.size);
+        fBytesRx += handle.size;
+        ++fMessagesRx;
+        return handle.size;
+      }
+      // the data is not reachable from here, and its chunk stays with the sender's segment for good.
+      LOG(ERROR) << "Received a handle into another shared memory segment than " << fSegment->GetName()
+                 << ", the sender is not on this node or uses another segment, dropping it";
+      message->CloseMessage();
+      fFactory->CountForeignHandle();
+      return -1;
+    }
+  }
+
+  message->CloseMessage();
+  // the payload goes along with the wire message, the socket takes a new one for the next.
+  message->fInner = fWire;
+  fWire = fInnerFactory->CreateMessage();
+  fBytesRx += n;
+  ++fMessagesRx;
+  return n;
+}
+
+void* Socket::GetSocket()
+{
+  return fInner->GetSocket();
+}
+
+int Socket::GetSocket(int nothing)
+{
+  return fInner->GetSocket(nothing);
+}
+
+void Socket::Close()
+{
+  fInner->Close();
+}
+
+void Socket::SetOption(const string& option, const void* value, size_t valueSize)
+{
+  fInner->SetOption(option, value, valueSize);
+}
+
+void Socket::GetOption(const string& option, void* value, size_t* valueSize)
+{
+  fInner->GetOption(option, value, valueSize);
+}
+
+unsigned long Socket::GetBytesTx()
+{
+  return fBytesTx;
+}
+
+unsigned long Socket::GetBytesRx()
+{
+  return fBytesRx;
+}
+
+unsigned long Socket::GetMessagesTx()
+{
+  return fMessagesTx;
+}
+
+unsigned long Socket::GetMessagesRx()
+{
+  return fMessagesRx;
+}
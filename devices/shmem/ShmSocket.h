@@ -0,0 +1,101 @@
+/**
+ * ShmSocket.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_SHMEM_SOCKET_H_
+#define ALICEO2_SHMEM_SOCKET_H_
+
+#include <string>
+#include <cstdint>
+
+#include "FairMQSocket.h"
+#include "FairMQTransportFactory.h"
+
+namespace AliceO2 {
+namespace Shmem {
+
+class Segment;
+class TransportFactory;
+
+/// Socket of the shared memory transport, around a socket of the regular one.
+///
+/// Towards a peer on the same node, a message whose data lives in the segment
+/// goes out as a small handle message and its chunk reference goes along to
+/// the receiver, which maps it back. Every other message, and every message
+/// towards another node, goes out as a regular message. The peers count as
+/// local if all the addresses the socket binds or connects to are ipc://,
+/// inproc:// or loopback ones, or if the factory was told that all peers are
+/// local. A pub socket never does: a handle has exactly one receiver. A handle
+/// into another segment is dropped on receipt, Receive() returns -1 for it.
+class Socket : public FairMQSocket
+{
+  public:
+    /// takes ownership of inner
+    Socket(TransportFactory* factory, const std::string& type, FairMQSocket* inner, FairMQTransportFactory* innerFactory, Segment* segment);
+    virtual ~Socket();
+
+    virtual std::string GetId();
+
+    virtual void Bind(const std::string& address);
+    virtual void Connect(const std::string& address);
+
+    virtual int Send(FairMQMessage* msg, const std::string& flag = "");
+    virtual int Send(FairMQMessage* msg, const int flags);
+    virtual int Receive(FairMQMessage* msg, const std::string& flag = "");
+    virtual int Receive(FairMQMessage* msg, const int flags);
+
+    virtual void* GetSocket();
+    virtual int GetSocket(int nothing);
+    virtual void Close();
+
+    virtual void SetOption(const std::string& option, const void* value, size_t valueSize);
+    virtual void GetOption(const std::string& option, void* value, size_t* valueSize);
+
+    /// payload bytes and messages, handles count with the size of their chunk data
+    virtual unsigned long GetBytesTx();
+    virtual unsigned long GetBytesRx();
+    virtual unsigned long GetMessagesTx();
+    virtual unsigned long GetMessagesRx();
+
+    FairMQSocket* GetInner() { return fInner; }
+    bool IsLocal() const { return fLocal; }
+
+  private:
+    /// what goes over the wire in place of a payload in the segment
+    struct Handle
+    {
+        uint64_t magic;
+        uint64_t segmentId;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    Socket(const Socket&);
+    Socket& operator=(const Socket&);
+
+    static bool isLocalAddress(const std::string& address);
+    void addEndpoint(const std::string& address);
+    int flagsOf(const std::string& flag) const;
+
+    TransportFactory* fFactory;
+    FairMQSocket* fInner;
+    FairMQTransportFactory* fInnerFactory;
+    /// carries the handles and copies over the inner socket, reused from message to message
+    FairMQMessage* fWire;
+    Segment* fSegment;
+    bool fFanOut;
+    bool fLocal;
+    int fNumRemoteEndpoints;
+
+    unsigned long fBytesTx;
+    unsigned long fBytesRx;
+    unsigned long fMessagesTx;
+    unsigned long fMessagesRx;
+};
+
+} // namespace Shmem
+} // namespace AliceO2
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * ShmTransportFactory.cxx
+ *
+ * @since 2026-10-17
+ */
+
+#include "FairMQLogger.h"
+
+#include "Metrics.h"
+
+#include "ShmTransportFactory.h"
+#include "ShmSegment.h"
+#include "ShmMessage.h"
+#include "ShmSocket.h"
+
+using namespace std;
+
+using namespace AliceO2;
+using namespace AliceO2::Shmem;
+
+TransportFactory::TransportFactory(FairMQTransportFactory* inner, const string& segmentName, size_t segmentSize, bool allLocal)
+  : fInner(inner)
+  , fSegment(Segment::Open(segmentName, segmentSize))
+  , fAllLocal(allLocal)
+{
+  if (!fSegment) {
+    LOG(WARN) << "No shared memory segment, all payloads go over the regular transport";
+  }
+
+  Metrics::Registry& metrics = Metrics::Registry::Default();
+  string label = "segment=\"" + segmentName + "\"";
+  fMetricHandles = &metrics.AddCounter("o2_shm_handles_sent_total", "Payloads passed as handles into the shared memory segment", label);
+  fMetricRemoteCopies = &metrics.AddCounter("o2_shm_remote_copies_total", "Payloads copied out of the segment for peers on other nodes", label);
+  fMetricFallbacks = &metrics.AddCounter("o2_shm_fallback_allocations_total", "Messages allocated outside the segment because it was full or missing", label);
+  fMetricForeignHandles = &metrics.AddCounter("o2_shm_foreign_handles_total", "Handles received into another segment and dropped", label);
+  fMetricUsedBytes = &metrics.AddGauge("o2_shm_segment_used_bytes", "Bytes of the segment cut into chunks, free or not", label);
+}
+
+TransportFactory::~TransportFactory()
+{
+  delete fSegment;
+  delete fInner;
+}
+
+FairMQMessage* TransportFactory::CreateMessage()
+{
+  return new Message(fSegment, fInner);
+}
+
+FairMQMessage* TransportFactory::CreateMessage(size_t size)
+{
+  Message* msg = new Message(fSegment, fInner, size);
+  if (!msg->IsShared()) {
+    fMetricFallbacks->Increment();
+  } else {
+    fMetricUsedBytes->Set(fSegment->GetUsedSize());
+  }
+  return msg;
+}
+
+FairMQMessage* TransportFactory::CreateMessage(void* data, size_t size, fairmq_free_fn* ffn, void* hint)
+{
+  // the data is somewhere the peers cannot see, it goes over the regular transport.
+  return new Message(fSegment, fInner, data, size, ffn, hint);
+}
+
+FairMQSocket* TransportFactory::CreateSocket(const string& type, int num, int numIoThreads)
+{
+  return new Socket(this, type, fInner->CreateSocket(type, num, numIoThreads), fInner, fSegment);
+}
+
+FairMQPoller* TransportFactory::CreatePoller(const vector<FairMQSocket*>& inputs)
+{
+  vector<FairMQSocket*> innerInputs;
+  innerInputs.reserve(inputs.size());
+  for (vector<FairMQSocket*>::const_iterator it = inputs.begin(); it != inputs.end(); ++it) {
+    innerInputs.push_back(static_cast<Socket*>(*it)->GetInner());
+  }
+  return fInner->CreatePoller(innerInputs);
+}
+
+void TransportFactory::CountHandleSent()
+{
+  fMetricHandles->Increment();
+}
+
+void TransportFactory::CountRemoteCopy()
+{
+  fMetricRemoteCopies->Increment();
+}
+
+void TransportFactory::CountForeignHandle()
+{
+  fMetricForeignHandles->Increment();
+}
@@ -0,0 +1,73 @@
+/**
+ * ShmTransportFactory.h
+ *
+ * @since 2026-10-17
+ */
+
+#ifndef ALICEO2_SHMEM_TRANSPORTFACTORY_H_
+#define ALICEO2_SHMEM_TRANSPORTFACTORY_H_
+
+#include <string>
+#include <vector>
+
+#include "FairMQTransportFactory.h"
+
+namespace AliceO2 {
+namespace Metrics {
+class Counter;
+class Gauge;
+}
+
+namespace Shmem {
+
+class Segment;
+
+/// Transport for devices on one node: payloads live in a shared memory
+/// segment and only handles to them travel over the sockets of the regular
+/// (inner) transport, which also carries everything to other nodes.
+///
+/// A chunk is owned by the messages that reference it: sending one hands its
+/// reference to the single receiver of the handle, so pub sockets always copy.
+/// Chunks in flight when a process dies or stops are lost until the segment
+/// is removed, which its last process does, or replaced after a crash.
+class TransportFactory : public FairMQTransportFactory
+{
+  public:
+    /// takes ownership of inner. Without a usable segment every call goes to inner.
+    TransportFactory(FairMQTransportFactory* inner, const std::string& segmentName, size_t segmentSize, bool allLocal = false);
+    virtual ~TransportFactory();
+
+    virtual FairMQMessage* CreateMessage();
+    virtual FairMQMessage* CreateMessage(size_t size);
+    virtual FairMQMessage* CreateMessage(void* data, size_t size, fairmq_free_fn* ffn = NULL, void* hint = NULL);
+
+    virtual FairMQSocket* CreateSocket(const std::string& type, int num, int numIoThreads);
+
+    virtual FairMQPoller* CreatePoller(const std::vector<FairMQSocket*>& inputs);
+
+    Segment* GetSegment() { return fSegment; }
+    bool IsAllLocal() const { return fAllLocal; }
+
+    void CountHandleSent();
+    void CountRemoteCopy();
+    void CountForeignHandle();
+
+  private:
+    TransportFactory(const TransportFactory&);
+    TransportFactory& operator=(const TransportFactory&);
+
+    FairMQTransportFactory* fInner;
+    Segment* fSegment;
+    bool fAllLocal;
+
+    Metrics::Counter* fMetricHandles;
+    Metrics::Counter* fMetricRemoteCopies;
+    Metrics::Counter* fMetricFallbacks;
+    Metrics::Counter* fMetricForeignHandles;
+    Metrics::Gauge* fMetricUsedBytes;
+};
+
+} // namespace Shmem
+} // namespace AliceO2
+
+#endif